@@ -38,9 +38,16 @@
 #ifndef MESH_NAVIGATION__MESH_PLANNER_H
 #define MESH_NAVIGATION__MESH_PLANNER_H
 
+#include <list>
+
 #include <mbf_mesh_core/mesh_planner.h>
 #include <mbf_msgs/action/get_path.hpp>
+#include <mesh_map/eikonal_update.h>
+#include <mesh_map/fast_iterative_method.h>
 #include <mesh_map/mesh_map.h>
+#include <mesh_map/path_simplification.h>
+#include <mesh_map/stamped_vertex_map.h>
+#include <mesh_map/vertex_queue.h>
 #include <nav_msgs/msg/path.hpp>
 #include <rclcpp/rclcpp.hpp>
 
@@ -66,7 +73,7 @@ public:
    * @param start The start pose
    * @param goal The goal pose
    * @param tolerance The goal tolerance, TODO is currently not used
-   * @param plan The computed plan
+   * @param plan The computed plan, dense or sparse depending on the plan_output parameter
    * @param cost The computed cost for the plan
    * @param message a detailed outcome message
    * @return result outcome code, see the GetPath action definition
@@ -81,6 +88,23 @@ public:
    */
   virtual bool cancel() override;
 
+  /**
+   * @brief The back tracked path of the latest plan with one point per step width, ordered from the start to the
+   *        goal. Each point is stored with the face containing it.
+   */
+  const mesh_map::MeshPath& densePath() const
+  {
+    return dense_path_;
+  }
+
+  /**
+   * @brief The points of the dense path which have been selected for the sparse plan, see mesh_map::simplifyPath()
+   */
+  const mesh_map::MeshPath& sparsePath() const
+  {
+    return sparse_path_;
+  }
+
   /**
    * @brief Initializes the planner plugin with a user configured name and a shared pointer to the mesh map
    * @param name The user configured name, which is used as namespace for parameters, etc.
@@ -89,18 +113,26 @@ public:
    */
   virtual bool initialize(const std::string& plugin_name, const std::shared_ptr<mesh_map::MeshMap>& mesh_map_ptr, const rclcpp::Node::SharedPtr& node) override;
 
+  /**
+   * @brief Creates a planner for concurrent queries against the given costs, see mbf_mesh_core::MeshPlanner. The
+   *        context copies the current configuration, but it runs the fast iterative method on a single thread and
+   *        never repairs incrementally, since the queries are planned in parallel against one fixed snapshot.
+   * @param costs The cost snapshot which all queries of the context are planned against
+   * @return the new context
+   */
+  virtual mbf_mesh_core::MeshPlanner::Ptr createContext(const mesh_map::CostSnapshot::ConstPtr& costs) override;
+
 protected:
 
   /**
    * @brief Computes a wavefront propagation from the start until it reached the goal
    * @param start The seed of the wave, i.e. the robot's goal pose
    * @param goal The goal of the wavefront, where it will stop propagating
-   * @param path The backtracked path
+   * @param path The backtracked path from the goal of the wavefront to its seed
    * @param message String with additional information wrt. the outcome. Will be transmitted to the action caller.
    * @return a ExePath action related outcome code
    */
-  uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
-                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path,
+  uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal, mesh_map::MeshPath& path,
                                 std::string& message);
 
   /**
@@ -110,7 +142,8 @@ protected:
    * @param goal The goal of the wavefront, where it will stop propagating
    * @param edge_weights The edge weights map to use for vertex distances in a triangle
    * @param costs The combined vertex costs to use during the propagation
-   * @param path The backtracked path
+   * @param cost_revision The cost revision of the costs, see MeshMap::costRevision()
+   * @param path The backtracked path from the goal of the wavefront to its seed
    * @param message String with additional information wrt. the outcome. Will be transmitted to the action caller.
    * @param distances The computed distances
    * @param predecessors The backtracked predecessors
@@ -118,52 +151,126 @@ protected:
    */
   uint32_t waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
                                 const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
-                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path, std::string& message,
-                                lvr2::DenseVertexMap<float>& distances,
-                                lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
+                                const uint64_t cost_revision, mesh_map::MeshPath& path, std::string& message,
+                                mesh_map::StampedVertexMap<float>& distances,
+                                mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors);
 
   /**
-   * Single source update step using the Hesse normal form to determine if the direction vector is cutting the current triangle
+   * Single source update step with the eikonal kernel selected by the update_scheme and update_precision parameters
    * @param distances Distance map to the goal which stores the current state of all distances to the goal
    * @param edge_weights Distances assigned to each edge
+   * @param topology The topology snapshot of the mesh to look up the triangle's edges
+   * @param fh The triangle which is spanned by v1, v2 and v3
    * @param v1 The first vertex of the triangle
    * @param v2 The second vertex of the triangle
    * @param v3 The thrid vertex of the triangle
    * @return true if the newly computed distance is shorter than before and if the current triangle is cut
    */
-  inline bool waveFrontUpdateWithS(lvr2::DenseVertexMap<float>& distances,
-                                   const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::VertexHandle& v1,
-                                   const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
+  inline bool waveFrontUpdate(mesh_map::StampedVertexMap<float>& distances, const lvr2::DenseEdgeMap<float>& edge_weights,
+                              const mesh_map::MeshTopology& topology, const lvr2::FaceHandle& fh,
+                              const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
 
   /**
-   * Fast Marching Method update step using the Law of Cosines to determine if the direction vector is cutting the current triangle
-   * @param distances Distance map to the goal which stores the current state of all distances to the goal
-   * @param edge_weights Distances assigned to each edge
-   * @param v1 The first vertex of the triangle
-   * @param v2 The second vertex of the triangle
-   * @param v3 The thrid vertex of the triangle
-   * @return true if the newly computed distance is shorter than before and if the current triangle is cut
+   * @brief Propagates the wave front from the seeded start face with the multi-threaded Fast Iterative Method. The
+   *        predecessors, directions and cutting faces are derived afterwards from the converged distances with the
+   *        sequential update.
+   * @param start_face The face containing the seed, its vertices have to be contained in distances
+   * @param goal_vertices The vertices of the face containing the robot's position
+   * @param edge_weights The edge weights map to use for vertex distances in a triangle
+   * @param costs The combined vertex costs to use during the propagation
+   * @param distances The computed distances
+   * @param[out] goal_dist The distance up to which the wave front has been propagated
+   * @return The number of vertices which have been assigned a distance
    */
-  inline bool waveFrontUpdateFMM(lvr2::DenseVertexMap<float>& distances, const lvr2::DenseEdgeMap<float>& edge_weights,
-                              const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
+  size_t fastIterativePropagation(const lvr2::FaceHandle& start_face,
+                                  const std::array<lvr2::VertexHandle, 3>& goal_vertices,
+                                  const lvr2::DenseEdgeMap<float>& edge_weights,
+                                  const lvr2::DenseVertexMap<float>& costs,
+                                  mesh_map::StampedVertexMap<float>& distances, float& goal_dist);
 
   /**
-   * Single source update step using the Law of Cosines to determine if the direction vector is cutting the current triangle
-   * @param distances Distance map to the goal which stores the current state of all distances to the goal
-   * @param edge_weights Distances assigned to each edge
-   * @param v1 The first vertex of the triangle
-   * @param v2 The second vertex of the triangle
-   * @param v3 The thrid vertex of the triangle
-   * @return true if the newly computed distance is shorter than before and if the current triangle is cut
+   * @brief Prepares the incremental repair of the previous wave front propagation after cost changes. The region
+   *        which depends on the changed vertices is invalidated and its boundary is pushed into the queue.
+   * @param start The seed of the wave, i.e. the robot's goal pose
+   * @param start_face The face containing the seed
+   * @param goal_vertices The vertices of the face containing the robot's position
+   * @param pq The queue of the wave front propagation to fill with the boundary of the invalidated region
+   * @param repaired The invalidated vertices are added to this vector
+   * @return false if the previous propagation can not be repaired and has to be recomputed from scratch
    */
-  inline bool waveFrontUpdate(lvr2::DenseVertexMap<float>& distances, const lvr2::DenseEdgeMap<float>& edge_weights,
-                              const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
+  bool prepareRepair(const mesh_map::Vector& start, const lvr2::FaceHandle& start_face,
+                     const std::array<lvr2::VertexHandle, 3>& goal_vertices, mesh_map::VertexQueue& pq,
+                     std::vector<lvr2::VertexHandle>& repaired);
+
+  /**
+   * @brief Checks whether the active propagation has been seeded at the given position and face with the current
+   *        cost limit
+   */
+  bool seedMatches(const mesh_map::Vector& seed, const lvr2::FaceHandle& seed_face) const;
+
+  /**
+   * @brief Checks whether the active propagation answers a query by back tracking alone: it has been seeded at the
+   *        given seed, computed for the given cost revision and expanded beyond the robot's position.
+   * @param seed The seed of the wave, i.e. the robot's goal pose
+   * @param seed_face The face containing the seed
+   * @param goal_vertices The vertices of the face containing the robot's position
+   * @param cost_revision The current cost revision of the map, see MeshMap::costRevision()
+   */
+  bool propagationCovers(const mesh_map::Vector& seed, const lvr2::FaceHandle& seed_face,
+                         const std::array<lvr2::VertexHandle, 3>& goal_vertices, const uint64_t cost_revision) const;
+
+  /**
+   * @brief Makes the propagation of the given seed the active one, if it is kept in the goal cache. Otherwise the
+   *        active propagation is moved into the cache, if it is complete, and the active buffers are reset for a new
+   *        propagation. The least recently used propagations are evicted beyond goal_cache_size.
+   * @param seed The seed of the wave, i.e. the robot's goal pose
+   */
+  void selectCachedPropagation(const mesh_map::Vector& seed);
+
+  /**
+   * @brief Restricts the next propagation to a corridor around the route on the coarse graph of the map
+   *        (hierarchical planning). The corridor covers the vertices of the coarse nodes within corridor_width of the
+   *        route and always contains the vertices of the start and goal faces.
+   * @param start The seed of the wave, i.e. the robot's goal pose
+   * @param goal The goal of the wavefront, i.e. the robot's position
+   * @param costs The combined vertex costs to block coarse nodes
+   * @return true if corridor_ has been computed; false if no coarse route has been found
+   */
+  bool computeCorridor(const mesh_map::Vector& start, const mesh_map::Vector& goal,
+                       const lvr2::DenseVertexMap<float>& costs);
 
   /**
    * @brief Computes the vector field in a post processing. It rotates the predecessor edges by the stored angles
    */
   void computeVectorMap();
 
+  /**
+   * @brief Computes the vector field only in a corridor of path_corridor_width around the path. The corridor grows
+   *        from the predecessor chains of the goal face over the vertices of the latest propagation.
+   * @param goal_vertices The vertices of the face containing the robot's position
+   * @return The number of vertices in the corridor
+   */
+  size_t computePathVectorMap(const std::array<lvr2::VertexHandle, 3>& goal_vertices);
+
+  /**
+   * @brief Computes the vector field at the given vertex, if it got a predecessor and a cutting face
+   */
+  void computeVector(const lvr2::VertexHandle& v3);
+
+  /**
+   * @brief Prepares the vector field for the changes of the current query. The published field is shared with the
+   * controller, thus it is copied if it is kept for a repair and replaced by an empty field otherwise.
+   *
+   * @param keep true if the current vectors are repaired, false if the field is rebuilt from scratch
+   */
+  void detachVectorField(const bool keep);
+
+  /**
+   * @brief Hands the vector field over to the controller via the map. Contexts of concurrent queries keep their field
+   *        for the back tracking only.
+   */
+  void shareVectorField();
+
   /**
    * @brief gets called on new incoming reconfigure parameters
    *
@@ -181,6 +288,9 @@ private:
   //! shared pointer to the mesh map
   mesh_map::MeshMap::Ptr mesh_map_;
 
+  //! costs all queries are planned against if this is a context of concurrent queries, empty otherwise
+  mesh_map::CostSnapshot::ConstPtr context_costs_;
+
   //! the user defined plugin name
   std::string name_;
 
@@ -192,6 +302,7 @@ private:
 
   //! publisher for the backtracked path
   rclcpp::Publisher<nav_msgs::msg::Path>::SharedPtr path_pub_;
+  rclcpp::Publisher<nav_msgs::msg::Path>::SharedPtr sparse_path_pub_;
 
   //! the map coordinate frame / system id
   std::string map_frame_;
@@ -209,22 +320,143 @@ private:
     double cost_limit = 1.0;
     //! The vector field back tracking step width.
     double step_width = 0.4;
+    //! The plan returned to the caller, dense with one pose per step width or sparse
+    std::string plan_output = "dense";
+    //! Maximum distance of a skipped pose of the dense plan to the sparse plan
+    double sparse_plan_max_deviation = 0.05;
+    //! Maximum heading change in radians between two poses of the sparse plan
+    double sparse_plan_max_angle = 0.35;
+    //! Maximum distance between two poses of the sparse plan
+    double sparse_plan_max_segment_length = 2.0;
+    //! The priority queue used by the wave front propagation, see mesh_map::createVertexQueue()
+    std::string queue_type = "meap";
+    //! Repair the previous wave front after cost changes instead of recomputing it, if the seed did not change
+    bool incremental_replanning = false;
+    //! Maximum ratio of the previously propagated vertices which may be affected by cost changes to repair them
+    double max_repair_ratio = 0.25;
+    //! The eikonal solver of the propagation, fast_marching or the multi-threaded fast_iterative method
+    std::string propagation_method = "fast_marching";
+    //! The number of threads of the fast iterative method, 0 uses all hardware threads
+    int propagation_threads = 0;
+    //! The triangle update scheme, law_of_cosines, signed_area or kimmel_sethian, see mesh_map::EikonalScheme
+    std::string update_scheme = "law_of_cosines";
+    //! The floating point precision of the triangle update, float or double
+    std::string update_precision = "double";
+    //! Compute the vector field only within this distance around the path, 0 computes it at all propagated vertices
+    double path_corridor_width = 0.0;
+    //! Restrict the propagation to a corridor around a route on the coarse graph of the map
+    bool hierarchical_planning = false;
+    //! The voxel size of the coarse graph
+    double coarse_cell_size = 2.0;
+    //! The distance along the coarse graph up to which nodes next to the coarse route belong to the corridor
+    double corridor_width = 4.0;
+    //! Memory budget in MiB of the propagations kept for previous goals, 0 keeps the latest propagation only
+    int goal_cache_size = 0;
   } config_;
 
+  /**
+   * @brief Wave front propagation of a previous goal in the goal cache. It holds the same buffers and properties as
+   *        the members of the active propagation, which are swapped with it in constant time.
+   */
+  struct CachedPropagation
+  {
+    CachedPropagation();
+
+    //! approximate number of allocated bytes
+    size_t memoryUsage() const;
+
+    lvr2::DenseVertexMap<float> direction;
+    mesh_map::StampedVertexMap<float> distances;
+    mesh_map::StampedVertexMap<lvr2::VertexHandle> predecessors;
+    mesh_map::StampedVertexMap<lvr2::FaceHandle> cutting_faces;
+    mesh_map::StampedVertexMap<uint8_t> fixed;
+    mesh_map::VectorField::Ptr vector_field;
+    bool vector_field_complete;
+    bool valid;
+    uint64_t revision;
+    lvr2::OptionalFaceHandle seed_face;
+    mesh_map::Vector seed_position;
+    float radius;
+    double cost_limit;
+  };
+
+  /**
+   * @brief Swaps the active propagation with the given cached one
+   */
+  void swapPropagation(CachedPropagation& cached);
+
+  //! propagations of previous goals, the most recently used first
+  std::list<CachedPropagation> goal_cache_;
+
   //! theta angles to the source of the wave front propagation
   lvr2::DenseVertexMap<float> direction_;
 
-  //! predecessors while wave propagation
-  lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors_;
+  //! distances of the latest wave front propagation, persistent across queries and reset by generation
+  mesh_map::StampedVertexMap<float> distances_;
+
+  //! predecessors while wave propagation, only vertices with a predecessor are contained
+  mesh_map::StampedVertexMap<lvr2::VertexHandle> predecessors_;
 
   //! the face which is cut by the computed line to the source
-  lvr2::DenseVertexMap<lvr2::FaceHandle> cutting_faces_;
+  mesh_map::StampedVertexMap<lvr2::FaceHandle> cutting_faces_;
+
+  //! vertices with a fixed distance during the wave front propagation
+  mesh_map::StampedVertexMap<uint8_t> fixed_;
+
+  //! the current vector field containing vectors pointing to the seed, immutable once published to the map
+  mesh_map::VectorField::Ptr vector_field_;
 
-  //! stores the current vector map containing vectors pointing to the seed
-  lvr2::DenseVertexMap<mesh_map::Vector> vector_map_;
+  //! whether vector_field_ contains the vectors of all propagated vertices, not only of a path corridor
+  bool vector_field_complete_;
 
-  //! potential field / scalar distance field to the seed
+  //! potential field / scalar distance field to the seed, exported from distances_ after each query
   lvr2::DenseVertexMap<float> potential_;
+
+  //! vertices whose potential changed during the latest query and has to be exported
+  std::vector<lvr2::VertexHandle> potential_updates_;
+
+  //! region of the current repair, the values are the RepairState of each vertex
+  mesh_map::StampedVertexMap<uint8_t> repair_region_;
+
+  //! vertices which have been popped from the queue during the current repair
+  mesh_map::StampedVertexMap<uint8_t> settled_;
+
+  //! whether distances_ holds a complete propagation which can be repaired
+  bool propagation_valid_;
+
+  //! cost revision of the map for which distances_ has been computed
+  uint64_t propagation_revision_;
+
+  //! seed face and position of the latest propagation
+  lvr2::OptionalFaceHandle seed_face_;
+  mesh_map::Vector seed_position_;
+
+  //! distance up to which the latest propagation expanded the wave front
+  float propagation_radius_;
+
+  //! cost limit used by the latest propagation
+  double propagation_cost_limit_;
+
+  //! vertices of the corridor of the current hierarchical query, indexed by the vertex index
+  std::vector<uint8_t> corridor_;
+
+  //! whether the current propagation is restricted to corridor_
+  bool corridor_active_;
+
+  //! triangle update selected by update_scheme and update_precision
+  mesh_map::EikonalKernel eikonal_kernel_;
+
+  //! parallel eikonal solver, created on the first fast iterative propagation
+  std::unique_ptr<mesh_map::FastIterativeMethod> fast_iterative_method_;
+
+  //! distances of the vertices inside the vector field corridor to the predecessor chains of the path
+  mesh_map::StampedVertexMap<float> path_corridor_;
+
+  //! back tracked path of the latest plan, reused across queries to keep its storage
+  mesh_map::MeshPath dense_path_;
+
+  //! points of the dense path selected for the sparse plan
+  mesh_map::MeshPath sparse_path_;
 };
 
 }  // namespace cvp_mesh_planner
@@ -37,21 +37,49 @@
 
 #include <lvr2/geometry/Handles.hpp>
 #include <lvr2/util/Meap.hpp>
+#include <mesh_map/instrumentation.h>
+#include <mesh_map/vertex_queue.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iterator>
+#include <utility>
 #include <mesh_map/util.h>
 #include <pluginlib/class_list_macros.hpp>
 
 #include "cvp_mesh_planner/cvp_mesh_planner.h"
 //#define DEBUG
-//#define USE_UPDATE_WITH_S
-//#define USE_UPDATE_FMM
 
 PLUGINLIB_EXPORT_CLASS(cvp_mesh_planner::CVPMeshPlanner, mbf_mesh_core::MeshPlanner);
 
 namespace cvp_mesh_planner
 {
+//! relative distance improvement for which a vertex fixed by a previous propagation is reopened during a repair
+static const float REPAIR_EPSILON = 1e-4;
+
+//! states of the vertices in the region of a repair
+enum RepairState : uint8_t
+{
+  AFFECTED = 1,
+  BOUNDARY = 2
+};
+
 CVPMeshPlanner::CVPMeshPlanner()
+  : distances_(std::numeric_limits<float>::infinity())
+  , predecessors_(lvr2::VertexHandle(0))
+  , cutting_faces_(lvr2::FaceHandle(0))
+  , fixed_(false)
+  , vector_field_(std::make_shared<mesh_map::VectorField>())
+  , vector_field_complete_(false)
+  , repair_region_(0)
+  , settled_(false)
+  , propagation_valid_(false)
+  , propagation_revision_(0)
+  , propagation_radius_(std::numeric_limits<float>::infinity())
+  , propagation_cost_limit_(0)
+  , corridor_active_(false)
+  , path_corridor_(std::numeric_limits<float>::infinity())
 {
 }
 
@@ -59,15 +87,34 @@ CVPMeshPlanner::~CVPMeshPlanner()
 {
 }
 
+CVPMeshPlanner::CachedPropagation::CachedPropagation()
+  : distances(std::numeric_limits<float>::infinity())
+  , predecessors(lvr2::VertexHandle(0))
+  , cutting_faces(lvr2::FaceHandle(0))
+  , fixed(false)
+  , vector_field(std::make_shared<mesh_map::VectorField>())
+  , vector_field_complete(false)
+  , valid(false)
+  , revision(0)
+  , radius(std::numeric_limits<float>::infinity())
+  , cost_limit(0)
+{
+}
+
+size_t CVPMeshPlanner::CachedPropagation::memoryUsage() const
+{
+  return direction.numValues() * sizeof(boost::optional<float>) + distances.memoryUsage() +
+         predecessors.memoryUsage() + cutting_faces.memoryUsage() + fixed.memoryUsage() +
+         vector_field->vectors.numValues() * sizeof(boost::optional<mesh_map::Vector>);
+}
+
 uint32_t CVPMeshPlanner::makePlan(const geometry_msgs::msg::PoseStamped& start,
                             const geometry_msgs::msg::PoseStamped& goal,
                             double tolerance, 
                             std::vector<geometry_msgs::msg::PoseStamped>& plan, double& cost,
                             std::string& message)
 {
-  const auto mesh = mesh_map_->mesh();
-  std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>> path;
-
+  MESH_MAP_SCOPED_TIMER("cvp_mesh_planner.make_plan");
   // mesh_map->combineVertexCosts(); // TODO should be outside the planner
 
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "start wave front propagation.");
@@ -75,53 +122,74 @@ uint32_t CVPMeshPlanner::makePlan(const geometry_msgs::msg::PoseStamped& start,
   mesh_map::Vector goal_vec = mesh_map::toVector(goal.pose.position);
   mesh_map::Vector start_vec = mesh_map::toVector(start.pose.position);
 
-  const uint32_t outcome = waveFrontPropagation(goal_vec, start_vec, path, message);
+  // the wave is seeded at the goal, the back tracking from the start yields the path in the order of the plan
+  const uint32_t outcome = waveFrontPropagation(goal_vec, start_vec, dense_path_, message);
 
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "finished wave front propagation.");
 
-  path.reverse();
-
   std_msgs::msg::Header header;
   header.stamp = node_->now();
   header.frame_id = mesh_map_->mapFrame();
 
-  cost = 0;
-  float dir_length;
-  if (!cancel_planning_ && !path.empty())
-  {
-    mesh_map::Vector vec = path.front().first;
-    lvr2::FaceHandle fH = path.front().second;
-    path.pop_front();
-
-    const auto& face_normals = mesh_map_->faceNormals();
-    for (auto& next : path)
+  // each pose faces the next point of the path, the last point is replaced by the goal pose
+  const auto& face_normals = mesh_map_->faceNormals();
+  const auto computePoses = [&](const mesh_map::MeshPath& path, std::vector<geometry_msgs::msg::PoseStamped>& poses) {
+    double length = 0;
+    poses.reserve(path.size());
+    for (size_t i = 0; i + 1 < path.size(); i++)
     {
+      float dir_length;
       geometry_msgs::msg::PoseStamped pose;
       pose.header = header;
-      pose.pose = mesh_map::calculatePoseFromPosition(vec, next.first, face_normals[fH], dir_length);
-      cost += dir_length;
-      vec = next.first;
-      fH = next.second;
-      plan.push_back(pose);
+      pose.pose = mesh_map::calculatePoseFromPosition(path[i].first, path[i + 1].first,
+                                                      face_normals[path[i].second], dir_length);
+      length += dir_length;
+      poses.push_back(pose);
     }
-
     geometry_msgs::msg::PoseStamped pose;
     pose.header = header;
     pose.pose = goal.pose;
-    plan.push_back(pose);
+    poses.push_back(pose);
+    return length;
+  };
+
+  cost = 0;
+  sparse_path_.clear();
+  std::vector<geometry_msgs::msg::PoseStamped> dense_plan, sparse_plan;
+  if (!cancel_planning_ && !dense_path_.empty())
+  {
+    const auto selected = mesh_map::simplifyPath(dense_path_, config_.sparse_plan_max_deviation,
+                                                 config_.sparse_plan_max_angle, config_.sparse_plan_max_segment_length);
+    sparse_path_.reserve(selected.size());
+    for (const size_t i : selected)
+    {
+      sparse_path_.push_back(dense_path_[i]);
+    }
+    cost = computePoses(dense_path_, dense_plan);
+    computePoses(sparse_path_, sparse_plan);
   }
 
-  nav_msgs::msg::Path path_msg;
-  path_msg.poses = plan;
-  path_msg.header = header;
+  // the plans of concurrent queries are returned to the caller only
+  if (!context_costs_)
+  {
+    nav_msgs::msg::Path path_msg;
+    path_msg.header = header;
+    path_msg.poses = dense_plan;
+    path_pub_->publish(path_msg);
+    path_msg.poses = sparse_plan;
+    sparse_path_pub_->publish(path_msg);
+    mesh_map_->publishVertexCosts(potential_, "Potential", header.stamp);
+  }
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Path length: " << cost << "m, " << dense_plan.size() << " dense and "
+                                          << sparse_plan.size() << " sparse poses.");
 
-  path_pub_->publish(path_msg);
-  mesh_map_->publishVertexCosts(potential_, "Potential", header.stamp);
-  RCLCPP_INFO_STREAM(node_->get_logger(), "Path length: " << cost << "m");
+  const bool sparse = config_.plan_output == "sparse";
+  plan.insert(plan.end(), std::make_move_iterator(sparse ? sparse_plan.begin() : dense_plan.begin()),
+              std::make_move_iterator(sparse ? sparse_plan.end() : dense_plan.end()));
 
-  if (config_.publish_vector_field)
+  if (config_.publish_vector_field && !context_costs_)
   {
-    mesh_map_->publishVectorField("vector_field", vector_map_, config_.publish_face_vectors);
+    mesh_map_->publishVectorField("vector_field", vector_field_->vectors, config_.publish_face_vectors);
   }
 
   return outcome;
@@ -161,10 +229,170 @@ bool CVPMeshPlanner::initialize(const std::string& plugin_name, const std::share
     descriptor.floating_point_range.push_back(range);
     config_.step_width = node->declare_parameter(name_ + ".step_width", config_.step_width);
   }
+  { // plan output param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The plan returned to the caller: dense with one pose per step width, or sparse with "
+                             "the poses which describe the shape of the path. Both are published.";
+    config_.plan_output = node->declare_parameter(name_ + ".plan_output", config_.plan_output, descriptor);
+    if (config_.plan_output != "dense" && config_.plan_output != "sparse")
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown plan output \"" << config_.plan_output << "\"!");
+      return false;
+    }
+  }
+  { // sparse plan max deviation param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The maximum distance in meters of a skipped pose of the dense plan to the sparse plan.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.sparse_plan_max_deviation =
+        node->declare_parameter(name_ + ".sparse_plan_max_deviation", config_.sparse_plan_max_deviation, descriptor);
+  }
+  { // sparse plan max angle param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The maximum heading change in radians between two poses of the sparse plan.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = M_PI;
+    descriptor.floating_point_range.push_back(range);
+    config_.sparse_plan_max_angle =
+        node->declare_parameter(name_ + ".sparse_plan_max_angle", config_.sparse_plan_max_angle, descriptor);
+  }
+  { // sparse plan max segment length param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The maximum distance in meters between two poses of the sparse plan.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.sparse_plan_max_segment_length = node->declare_parameter(
+        name_ + ".sparse_plan_max_segment_length", config_.sparse_plan_max_segment_length, descriptor);
+  }
+  { // queue type param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The priority queue used by the wave front propagation: meap, quaternary_heap or radix_heap.";
+    config_.queue_type = node->declare_parameter(name_ + ".queue_type", config_.queue_type, descriptor);
+    if (!mesh_map::isValidVertexQueueType(config_.queue_type))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown queue type \"" << config_.queue_type << "\"!");
+      return false;
+    }
+  }
+  { // incremental replanning param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Repairs the previous wave front locally after cost changes instead of recomputing it, "
+                             "as long as the seed (the path goal) stays the same.";
+    config_.incremental_replanning =
+        node->declare_parameter(name_ + ".incremental_replanning", config_.incremental_replanning, descriptor);
+  }
+  { // max repair ratio param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The maximum ratio of the previously propagated vertices which may be affected by cost "
+                             "changes, above it the wave front is recomputed from scratch.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.max_repair_ratio = node->declare_parameter(name_ + ".max_repair_ratio", config_.max_repair_ratio, descriptor);
+  }
+  { // propagation method param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The eikonal solver of the wave front propagation: fast_marching, or the multi-threaded "
+                             "fast_iterative method for large maps. A repair always uses fast marching.";
+    config_.propagation_method =
+        node->declare_parameter(name_ + ".propagation_method", config_.propagation_method, descriptor);
+    if (config_.propagation_method != "fast_marching" && config_.propagation_method != "fast_iterative")
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown propagation method \"" << config_.propagation_method << "\"!");
+      return false;
+    }
+  }
+  { // propagation threads param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The number of threads of the fast iterative method, 0 uses all hardware threads.";
+    descriptor.read_only = true;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.propagation_threads =
+        node->declare_parameter(name_ + ".propagation_threads", config_.propagation_threads, descriptor);
+  }
+  { // update scheme param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The triangle update of the wave front propagation: law_of_cosines, signed_area or "
+                             "kimmel_sethian.";
+    config_.update_scheme = node->declare_parameter(name_ + ".update_scheme", config_.update_scheme, descriptor);
+  }
+  { // update precision param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The floating point precision in which the triangle update is computed: float or double.";
+    config_.update_precision =
+        node->declare_parameter(name_ + ".update_precision", config_.update_precision, descriptor);
+    if (!eikonal_kernel_.parse(config_.update_scheme, config_.update_precision))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown update scheme \"" << config_.update_scheme
+                                               << "\" or precision \"" << config_.update_precision << "\"!");
+      return false;
+    }
+  }
+  { // path corridor width param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Computes the vector field only at the vertices within this distance in meters along the "
+                             "mesh around the path, 0 computes it at all propagated vertices. The controller can "
+                             "only follow the field inside the corridor.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.path_corridor_width =
+        node->declare_parameter(name_ + ".path_corridor_width", config_.path_corridor_width, descriptor);
+  }
+  { // hierarchical planning param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Plans a route on the coarse graph of the map first and restricts the wave front "
+                             "propagation to a corridor around it.";
+    config_.hierarchical_planning =
+        node->declare_parameter(name_ + ".hierarchical_planning", config_.hierarchical_planning, descriptor);
+  }
+  { // coarse cell size param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The voxel size in meters, which clusters the vertices into the nodes of the coarse graph.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 20.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.coarse_cell_size = node->declare_parameter(name_ + ".coarse_cell_size", config_.coarse_cell_size, descriptor);
+  }
+  { // corridor width param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The distance in meters along the coarse graph up to which nodes next to the coarse route "
+                             "belong to the corridor.";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.corridor_width = node->declare_parameter(name_ + ".corridor_width", config_.corridor_width, descriptor);
+  }
+
+  { // goal cache size param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Memory budget in MiB for the wave fronts of previous goals. A plan to a cached goal with "
+                             "unchanged costs is answered by back tracking alone, 0 keeps only the latest wave front.";
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 65536;
+    descriptor.integer_range.push_back(range);
+    config_.goal_cache_size = node->declare_parameter(name_ + ".goal_cache_size", config_.goal_cache_size, descriptor);
+  }
 
   path_pub_ = node->create_publisher<nav_msgs::msg::Path>("~/path", rclcpp::QoS(1).transient_local());
+  sparse_path_pub_ = node->create_publisher<nav_msgs::msg::Path>("~/sparse_path", rclcpp::QoS(1).transient_local());
   const auto mesh = mesh_map_->mesh();
   direction_ = lvr2::DenseVertexMap<float>(mesh->nextVertexIndex(), 0);
+  potential_ = lvr2::DenseVertexMap<float>(mesh->nextVertexIndex(), std::numeric_limits<float>::infinity());
   // TODO check all map dependencies! (loaded layers etc...)
 
   reconfiguration_callback_handle_ = node_->add_on_set_parameters_callback(std::bind(
@@ -173,6 +401,24 @@ bool CVPMeshPlanner::initialize(const std::string& plugin_name, const std::share
   return true;
 }
 
+mbf_mesh_core::MeshPlanner::Ptr CVPMeshPlanner::createContext(const mesh_map::CostSnapshot::ConstPtr& costs)
+{
+  // the parameters and publishers stay with this instance, the context only copies the configuration
+  auto context = std::make_shared<CVPMeshPlanner>();
+  context->mesh_map_ = mesh_map_;
+  context->context_costs_ = costs;
+  context->name_ = name_;
+  context->node_ = node_;
+  context->map_frame_ = map_frame_;
+  context->config_ = config_;
+  // the queries are planned in parallel already, and there are no cost changes to repair within one snapshot
+  context->config_.propagation_threads = 1;
+  context->config_.incremental_replanning = false;
+  context->eikonal_kernel_ = eikonal_kernel_;
+  context->direction_ = lvr2::DenseVertexMap<float>(mesh_map_->mesh()->nextVertexIndex(), 0);
+  return context;
+}
+
 rcl_interfaces::msg::SetParametersResult CVPMeshPlanner::reconfigureCallback(std::vector<rclcpp::Parameter> parameters)
 {
   rcl_interfaces::msg::SetParametersResult result;
@@ -182,6 +428,65 @@ rcl_interfaces::msg::SetParametersResult CVPMeshPlanner::reconfigureCallback(std
       config_.cost_limit = parameter.as_double();
     } else if (parameter.get_name() == name_ + ".step_width") {
       config_.step_width = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".plan_output") {
+      if (parameter.as_string() != "dense" && parameter.as_string() != "sparse") {
+        result.successful = false;
+        result.reason = "Unknown plan output \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.plan_output = parameter.as_string();
+    } else if (parameter.get_name() == name_ + ".sparse_plan_max_deviation") {
+      config_.sparse_plan_max_deviation = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".sparse_plan_max_angle") {
+      config_.sparse_plan_max_angle = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".sparse_plan_max_segment_length") {
+      config_.sparse_plan_max_segment_length = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".queue_type") {
+      if (!mesh_map::isValidVertexQueueType(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown queue type \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.queue_type = parameter.as_string();
+    } else if (parameter.get_name() == name_ + ".incremental_replanning") {
+      config_.incremental_replanning = parameter.as_bool();
+    } else if (parameter.get_name() == name_ + ".max_repair_ratio") {
+      config_.max_repair_ratio = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".propagation_method") {
+      if (parameter.as_string() != "fast_marching" && parameter.as_string() != "fast_iterative") {
+        result.successful = false;
+        result.reason = "Unknown propagation method \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.propagation_method = parameter.as_string();
+    } else if (parameter.get_name() == name_ + ".update_scheme" ||
+               parameter.get_name() == name_ + ".update_precision") {
+      const bool is_scheme = parameter.get_name() == name_ + ".update_scheme";
+      const std::string scheme = is_scheme ? parameter.as_string() : config_.update_scheme;
+      const std::string precision = is_scheme ? config_.update_precision : parameter.as_string();
+      if (!eikonal_kernel_.parse(scheme, precision)) {
+        result.successful = false;
+        result.reason = "Unknown update scheme \"" + scheme + "\" or precision \"" + precision + "\"";
+        return result;
+      }
+      config_.update_scheme = scheme;
+      config_.update_precision = precision;
+      // the previous wave fronts have been computed with another update and cannot be repaired
+      propagation_valid_ = false;
+      goal_cache_.clear();
+    } else if (parameter.get_name() == name_ + ".path_corridor_width") {
+      config_.path_corridor_width = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".hierarchical_planning") {
+      config_.hierarchical_planning = parameter.as_bool();
+    } else if (parameter.get_name() == name_ + ".coarse_cell_size") {
+      config_.coarse_cell_size = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".corridor_width") {
+      config_.corridor_width = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".goal_cache_size") {
+      config_.goal_cache_size = parameter.as_int();
+      if (config_.goal_cache_size == 0) {
+        goal_cache_.clear();
+      }
     }
   }
 
@@ -191,464 +496,554 @@ rcl_interfaces::msg::SetParametersResult CVPMeshPlanner::reconfigureCallback(std
 
 void CVPMeshPlanner::computeVectorMap()
 {
-  const auto mesh = mesh_map_->mesh();
-  const auto& face_normals = mesh_map_->faceNormals();
-  const auto& vertex_normals = mesh_map_->vertexNormals();
-
-  for (auto v3 : mesh->vertices())
+  // only vertices which got a predecessor during the latest propagation are contained
+  for (auto v3 : predecessors_)
   {
-    // if(vertex_costs[v3] > config.cost_limit || !predecessors.containsKey(v3))
-    // continue;
-
-    const lvr2::VertexHandle& v1 = predecessors_[v3];
-
-    // if predecessor is pointing to it self, continue with the next vertex.
-    if (v1 == v3)
-      continue;
+    computeVector(v3);
+  }
+  vector_field_complete_ = true;
+  shareVectorField();
+}
 
-    // get the cut face
-    const auto& optFh = cutting_faces_.get(v3);
-    // if no cut face, continue with the next vertex
-    if (!optFh)
-      continue;
+size_t CVPMeshPlanner::computePathVectorMap(const std::array<lvr2::VertexHandle, 3>& goal_vertices)
+{
+  const auto topology = mesh_map_->topology();
+  const auto& edge_weights = mesh_map_->edgeDistances();
+  const float width = config_.path_corridor_width;
+
+  // the predecessor chains of the goal face approximate the path, which follows the steepest descent to the seed
+  path_corridor_.reset(topology->numVertexSlots());
+  const auto pq = mesh_map::createVertexQueue(config_.queue_type, topology->numVertexSlots());
+  for (const auto& goal_vertex : goal_vertices)
+  {
+    lvr2::VertexHandle vH = goal_vertex;
+    while (distances_.containsKey(vH) && !path_corridor_.containsKey(vH))
+    {
+      path_corridor_.insert(vH, 0);
+      pq->insert(vH, 0);
+      if (!predecessors_.containsKey(vH) || predecessors_[vH] == vH)
+        break;
+      vH = predecessors_[vH];
+    }
+  }
 
-    const lvr2::FaceHandle& fH = optFh.get();
+  // grow the corridor along the mesh edges, only vertices of the latest propagation have a vector
+  while (!pq->isEmpty())
+  {
+    const lvr2::VertexHandle vH = pq->popMin();
+    const float distance = path_corridor_[vH];
+    const auto neighbours = topology->neighboursOfVertex(vH);
+    const auto edges = topology->edgesOfVertex(vH);
+    for (size_t i = 0; i < neighbours.size(); i++)
+    {
+      const lvr2::VertexHandle& nH = neighbours[i];
+      const float neighbour_distance = distance + edge_weights[edges[i]];
+      if (neighbour_distance <= width && distances_.containsKey(nH) && neighbour_distance < path_corridor_[nH])
+      {
+        path_corridor_.insert(nH, neighbour_distance);
+        pq->insert(nH, neighbour_distance);
+      }
+    }
+  }
 
-    const auto& vec3 = mesh->getVertexPosition(v3);
-    const auto& vec1 = mesh->getVertexPosition(v1);
+  for (auto vH : path_corridor_)
+  {
+    computeVector(vH);
+  }
+  vector_field_complete_ = false;
+  shareVectorField();
+  return path_corridor_.numValues();
+}
 
-    // compute the direction vector and rotate it by theta, which is stored in
-    // the direction vertex map
-    const auto dirVec = (vec1 - vec3).rotated(vertex_normals[v3], direction_[v3]);
-    // store the normalized rotated vector in the vector map
-    vector_map_.insert(v3, dirVec.normalized());
+void CVPMeshPlanner::detachVectorField(const bool keep)
+{
+  if (!keep)
+  {
+    vector_field_ = std::make_shared<mesh_map::VectorField>();
+    vector_field_complete_ = false;
+  }
+  else if (vector_field_.use_count() > 1)
+  {
+    // the published field might still be followed by the controller
+    vector_field_ = std::make_shared<mesh_map::VectorField>(*vector_field_);
   }
-  mesh_map_->setVectorMap(vector_map_);
 }
 
-uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
-                                              std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path,
-                                              std::string& message)
+void CVPMeshPlanner::shareVectorField()
 {
-  return waveFrontPropagation(start, goal, mesh_map_->edgeDistances(), mesh_map_->vertexCosts(), path, message,
-                              potential_, predecessors_);
+  if (!context_costs_)
+  {
+    mesh_map_->setVectorField(vector_field_);
+  }
 }
 
-inline bool CVPMeshPlanner::waveFrontUpdateWithS(lvr2::DenseVertexMap<float>& distances,
-                                                   const lvr2::DenseEdgeMap<float>& edge_weights,
-                                                   const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
-                                                   const lvr2::VertexHandle& v3)
+void CVPMeshPlanner::computeVector(const lvr2::VertexHandle& v3)
 {
   const auto mesh = mesh_map_->mesh();
+  const auto& vertex_normals = mesh_map_->vertexNormals();
 
-  const double u1 = distances[v1];
-  const double u2 = distances[v2];
-  const double u3 = distances[v3];
-
-  const lvr2::OptionalEdgeHandle e12h = mesh->getEdgeBetween(v1, v2);
-  const double c = edge_weights[e12h.unwrap()];
-  const double c_sq = c * c;
+  if (!predecessors_.containsKey(v3))
+    return;
 
-  const lvr2::OptionalEdgeHandle e13h = mesh->getEdgeBetween(v1, v3);
-  const double b = edge_weights[e13h.unwrap()];
-  const double b_sq = b * b;
+  const lvr2::VertexHandle& v1 = predecessors_[v3];
 
-  const lvr2::OptionalEdgeHandle e23h = mesh->getEdgeBetween(v2, v3);
-  const double a = edge_weights[e23h.unwrap()];
-  const double a_sq = a * a;
+  // if predecessor is pointing to it self, continue with the next vertex.
+  if (v1 == v3)
+    return;
 
-  const double u1_sq = u1 * u1;
-  const double u2_sq = u2 * u2;
+  // if no cut face, continue with the next vertex
+  if (!cutting_faces_.containsKey(v3))
+    return;
 
-  const double A = sqrt(std::max<double>((-u1 + u2 + c) * (u1 - u2 + c) * (u1 + u2 - c) * (u1 + u2 + c), 0));
-  const double B = sqrt(std::max<double>((-a + b + c) * (a - b + c) * (a + b - c) * (a + b + c), 0));
-  const double sx = (c_sq + u1_sq - u2_sq) / (2 * c);
-  const double sy = -A / (2 * c);
-  const double p = (-a_sq + b_sq + c_sq) / (2 * c);
-  const double hc = B / (2 * c);
-  const double dy = hc - sy;
-  // const double dy = (A + B) / (2 * c);
-  // const double dx = (u2_sq - u1_sq + b_sq - a_sq) / (2*c);
-  const double dx = p - sx;
+  const auto& vec3 = mesh->getVertexPosition(v3);
+  const auto& vec1 = mesh->getVertexPosition(v1);
 
-  const double u3tmp_sq = dx * dx + dy * dy;
-  double u3tmp = sqrt(u3tmp_sq);
+  // compute the direction vector and rotate it by theta, which is stored in
+  // the direction vertex map
+  const auto dirVec = (vec1 - vec3).rotated(vertex_normals[v3], direction_[v3]);
+  // store the normalized rotated vector in the vector map
+  vector_field_->vectors.insert(v3, dirVec.normalized());
+}
 
-  if (u3tmp < u3)
+uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& start, const mesh_map::Vector& goal,
+                                              mesh_map::MeshPath& path, std::string& message)
+{
+  // the snapshot keeps the costs consistent during the propagation, while the layers keep updating the map
+  const auto costs = context_costs_ ? context_costs_ : mesh_map_->costSnapshot();
+  if (config_.goal_cache_size > 0)
+  {
+    selectCachedPropagation(start);
+  }
+  // a propagation which already covers the robot's position is reused as it is, without a corridor
+  bool covered = false;
+  if (config_.hierarchical_planning && config_.goal_cache_size > 0)
   {
-    if (distances[v1] < distances[v2])
+    mesh_map::Vector seed = start;
+    mesh_map::Vector robot = goal;
+    const lvr2::OptionalFaceHandle seed_opt = mesh_map_->getContainingFace(seed, 0.4);
+    const lvr2::OptionalFaceHandle robot_opt = mesh_map_->getContainingFace(robot, 0.4);
+    covered = seed_opt && robot_opt &&
+              propagationCovers(seed, seed_opt.unwrap(), mesh_map_->topology()->verticesOfFace(robot_opt.unwrap()),
+                                costs->revision);
+  }
+  corridor_active_ = config_.hierarchical_planning && !covered && computeCorridor(start, goal, costs->vertex_costs);
+  uint32_t outcome = waveFrontPropagation(start, goal, mesh_map_->edgeDistances(), costs->vertex_costs,
+                                          costs->revision, path, message, distances_, predecessors_);
+  if (corridor_active_)
+  {
+    // the propagation did not cover the whole reachable region, it can not be repaired by the next query
+    corridor_active_ = false;
+    propagation_valid_ = false;
+    if (outcome == mbf_msgs::action::GetPath::Result::NO_PATH_FOUND)
     {
-      const double S = sy * p - sx * hc;
-      const double t1cos = (u3tmp_sq + b_sq - u1_sq) / (2 * u3tmp * b);
-      if (S <= 0 && std::fabs(t1cos) <= 1)
-      {
-        const double theta = acos(t1cos);
-        predecessors_[v3] = v1;
-        direction_[v3] = static_cast<float>(theta);
-        distances[v3] = static_cast<float>(u3tmp);
-        const lvr2::FaceHandle fh = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fh);
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v1, fh, theta, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        return true;
-      }
-      else
-      {
-        u3tmp = u1 + b;
-        if (u3tmp < u3)
-        {
-          predecessors_[v3] = v1;
-          direction_[v3] = 0;
-          distances[v3] = u3tmp;
-          const lvr2::FaceHandle fh = mesh->getFaceBetween(v1, v2, v3).unwrap();
-          cutting_faces_.insert(v3, fh);
-#ifdef DEBUG
-          mesh_map->publishDebugVector(v3, v1, fh, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                       "dir_vec" + std::to_string(v3.idx()));
-#endif
-          return true;
-        }
-        return false;
-      }
+      RCLCPP_WARN_STREAM(node_->get_logger(), "No path has been found inside the corridor of the coarse route, "
+                                              "planning on the whole mesh.");
+      outcome = waveFrontPropagation(start, goal, mesh_map_->edgeDistances(), costs->vertex_costs, costs->revision,
+                                     path, message, distances_, predecessors_);
     }
-    else
+  }
+
+  // export the vertices touched by the latest propagation or repair, vertices which are not contained anymore read as
+  // infinite distance. Contexts of concurrent queries do not publish the potential.
+  if (!context_costs_)
+  {
+    const auto& distances = distances_;
+    for (auto vH : potential_updates_)
     {
-      const double S = sx * hc - hc * c + sy * c - sy * p;
-      const double t2cos = (a_sq + u3tmp_sq - u2_sq) / (2 * a * u3tmp);
-      if (S <= 0 && std::fabs(t2cos) <= 1)
-      {
-        const lvr2::FaceHandle fh = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        const double theta = -acos(t2cos);
-        direction_[v3] = static_cast<float>(theta);
-        distances[v3] = static_cast<float>(u3tmp);
-        predecessors_[v3] = v2;
-        cutting_faces_.insert(v3, fh);
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v2, fh, theta, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        return true;
-      }
-      else
-      {
-        u3tmp = u2 + a;
-        if (u3tmp < u3)
-        {
-          direction_[v3] = 0;
-          distances[v3] = u3tmp;
-          predecessors_[v3] = v2;
-          const lvr2::FaceHandle fh = mesh->getFaceBetween(v1, v2, v3).unwrap();
-          cutting_faces_.insert(v3, fh);
-#ifdef DEBUG
-          mesh_map->publishDebugVector(v3, v2, fh, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                       "dir_vec" + std::to_string(v3.idx()));
-#endif
-          return true;
-        }
-        return false;
-      }
+      potential_[vH] = distances[vH];
     }
   }
-  return false;
+  potential_updates_.clear();
+  return outcome;
 }
 
-inline bool CVPMeshPlanner::waveFrontUpdate(lvr2::DenseVertexMap<float>& distances,
-                                              const lvr2::DenseEdgeMap<float>& edge_weights,
-                                              const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
-                                              const lvr2::VertexHandle& v3)
+bool CVPMeshPlanner::computeCorridor(const mesh_map::Vector& start, const mesh_map::Vector& goal,
+                                     const lvr2::DenseVertexMap<float>& costs)
 {
-  const auto mesh = mesh_map_->mesh();
+  const auto t_start = std::chrono::steady_clock::now();
+  const auto graph = mesh_map_->coarseGraph(config_.coarse_cell_size);
+  const lvr2::OptionalFaceHandle start_opt = mesh_map_->getContainingFace(start, 0.4);
+  const lvr2::OptionalFaceHandle goal_opt = mesh_map_->getContainingFace(goal, 0.4);
+  if (!graph || !start_opt || !goal_opt)
+  {
+    return false;
+  }
 
-  const double u1 = distances[v1];
-  const double u2 = distances[v2];
-  const double u3 = distances[v3];
+  const auto topology = mesh_map_->topology();
+  const auto& start_vertices = topology->verticesOfFace(start_opt.unwrap());
+  const auto& goal_vertices = topology->verticesOfFace(goal_opt.unwrap());
+  const uint32_t start_node = graph->nodeOf(start_vertices[0]);
+  const uint32_t goal_node = graph->nodeOf(goal_vertices[0]);
 
-  const lvr2::OptionalEdgeHandle e12h = mesh->getEdgeBetween(v1, v2);
-  const double c = edge_weights[e12h.unwrap()];
-  const double c_sq = c * c;
+  std::vector<uint8_t> blocked;
+  graph->blockedNodes(costs, config_.cost_limit, blocked);
+  std::vector<uint32_t> route;
+  if (!graph->shortestPath(start_node, goal_node, blocked, route))
+  {
+    RCLCPP_INFO_STREAM(node_->get_logger(), "No route has been found on the coarse graph, planning on the whole mesh.");
+    return false;
+  }
 
-  const lvr2::OptionalEdgeHandle e13h = mesh->getEdgeBetween(v1, v3);
-  const double b = edge_weights[e13h.unwrap()];
-  const double b_sq = b * b;
+  std::vector<uint8_t> nodes;
+  graph->corridor(route, config_.corridor_width, nodes);
+  for (const auto& vertices : { start_vertices, goal_vertices })
+  {
+    for (const auto& vH : vertices)
+    {
+      const uint32_t node = graph->nodeOf(vH);
+      if (node != mesh_map::CoarseGraph::INVALID_NODE)
+      {
+        nodes[node] = true;
+      }
+    }
+  }
 
-  const lvr2::OptionalEdgeHandle e23h = mesh->getEdgeBetween(v2, v3);
-  const double a = edge_weights[e23h.unwrap()];
-  const double a_sq = a * a;
+  corridor_.assign(mesh_map_->mesh()->nextVertexIndex(), false);
+  size_t num_corridor_vertices = 0;
+  for (size_t node = 0; node < nodes.size(); node++)
+  {
+    if (!nodes[node])
+    {
+      continue;
+    }
+    for (const auto& vH : graph->verticesOfNode(node))
+    {
+      corridor_[vH.idx()] = true;
+      num_corridor_vertices++;
+    }
+  }
 
-  const double u1_sq = u1 * u1;
-  const double u2_sq = u2 * u2;
+  RCLCPP_INFO_STREAM(node_->get_logger(), "The coarse route passes " << route.size() << " of " << graph->numNodes()
+      << " nodes, its corridor contains " << num_corridor_vertices << " vertices (computed in "
+      << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_start).count()
+      << " us).");
+  return true;
+}
 
-  const double sx = (c_sq + u1_sq - u2_sq) / (2 * c);
-  const double sy = -sqrt(std::max(u1_sq - sx*sx, 0.0));
+size_t CVPMeshPlanner::fastIterativePropagation(const lvr2::FaceHandle& start_face,
+                                                const std::array<lvr2::VertexHandle, 3>& goal_vertices,
+                                                const lvr2::DenseEdgeMap<float>& edge_weights,
+                                                const lvr2::DenseVertexMap<float>& costs,
+                                                mesh_map::StampedVertexMap<float>& distances, float& goal_dist)
+{
+  if (!fast_iterative_method_)
+  {
+    fast_iterative_method_ = std::make_unique<mesh_map::FastIterativeMethod>(config_.propagation_threads);
+  }
+  auto& fim = *fast_iterative_method_;
+  const auto topology = mesh_map_->topology();
+  const auto& invalid = mesh_map_->invalid;
+  const auto inf = std::numeric_limits<float>::infinity();
 
-  const double p = (b_sq + c_sq -a_sq) / (2 * c);
-  const double hc = sqrt(std::max(b_sq - p*p, 0.0));
+  std::vector<std::pair<lvr2::VertexHandle, float>> seeds;
+  for (const auto& vH : topology->verticesOfFace(start_face))
+  {
+    seeds.emplace_back(vH, distances[vH]);
+  }
+  const std::vector<lvr2::VertexHandle> targets(goal_vertices.begin(), goal_vertices.end());
 
-  const double dy = hc - sy;
-  const double dx = p - sx;
+  const auto accessible = [&](const lvr2::VertexHandle& vH) {
+    return !invalid[vH] && costs[vH] <= config_.cost_limit && (!corridor_active_ || corridor_[vH.idx()]);
+  };
+  // all faces around a vertex are updated in one batch of the eikonal kernel
+  const mesh_map::EikonalEdgeUpdate update{ edge_weights, eikonal_kernel_ };
 
-  const double u3tmp_sq = dx * dx + dy * dy;
-  double u3tmp = sqrt(u3tmp_sq);
+  const auto t_start = std::chrono::steady_clock::now();
+  const size_t iterations = fim.solve(*topology, seeds, inf, targets, config_.goal_dist_offset, accessible, update);
+  const auto t_solved = std::chrono::steady_clock::now();
 
-  if (!std::isfinite(u3tmp))
+  // the update of the final face of each vertex reproduces its distance and provides the predecessor, the direction
+  // and the cutting face
+  for (const auto& vH : fim.reached())
   {
-    RCLCPP_ERROR_STREAM(node_->get_logger(), "u3 tmp is not finite!");
+    distances.insert(vH, fim.distance(vH));
+    fixed_.insert(vH, true);
   }
-  if (u3tmp < u3)
+  for (const auto& vH : fim.reached())
   {
-    const double t0a = (a_sq + b_sq - c_sq) / (2 * a * b);
-    const double t1a = (u3tmp_sq + b_sq - u1_sq) / (2 * u3tmp * b);
-    const double t2a = (a_sq + u3tmp_sq - u2_sq) / (2 * a * u3tmp);
+    const uint32_t face = fim.face(vH);
+    if (face == mesh_map::FastIterativeMethod::NO_FACE)
+      continue;
 
-    // corner case: side b + u1 ~= u3
-    if (std::fabs(t1a) > 1)
-    {
-      u3tmp = u1 + b;
-      if (u3tmp < u3)
-      {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v1;
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v1, fH, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        distances[v3] = static_cast<float>(u3tmp);
-        direction_[v3] = 0;
-        return true;
-      }
-      return false;
-    }
-    // corner case: side a + u2 ~= u3
-    else if (std::fabs(t2a) > 1)
+    const lvr2::FaceHandle fH(face);
+    const auto& vertices = topology->verticesOfFace(fH);
+    const size_t corner = vertices[0] == vH ? 0 : vertices[1] == vH ? 1 : 2;
+    const float distance = distances[vH];
+    distances[vH] = inf;
+    if (!waveFrontUpdate(distances, edge_weights, *topology, fH, vertices[(corner + 1) % 3],
+                         vertices[(corner + 2) % 3], vH))
     {
-      u3tmp = u2 + a;
-      if (u3tmp < u3)
-      {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v2;
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v2, fH, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        distances[v3] = static_cast<float>(u3tmp);
-        direction_[v3] = 0;
-        return true;
-      }
-      return false;
+      distances[vH] = distance;
     }
+  }
 
-    const double theta0 = acos(t0a);
-    const double theta1 = acos(t1a);
-    const double theta2 = acos(t2a);
+  goal_dist = inf;
+  if (std::all_of(goal_vertices.begin(), goal_vertices.end(),
+                  [&fim](const lvr2::VertexHandle& vH) { return std::isfinite(fim.distance(vH)); }))
+  {
+    goal_dist = std::max({ fim.distance(goal_vertices[0]), fim.distance(goal_vertices[1]),
+                           fim.distance(goal_vertices[2]) }) + config_.goal_dist_offset;
+  }
 
-#ifdef DEBUG
-    if (!std::isfinite(theta0 + theta1 + theta2))
-    {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "------------------");
-      if (std::isnan(theta0))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta0 is NaN!");
-      if (std::isnan(theta1))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta1 is NaN!");
-      if (std::isnan(theta2))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta2 is NaN!");
-      if (std::isinf(theta2))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta2 is inf!");
-      if (std::isinf(theta2))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta2 is inf!");
-      if (std::isinf(theta2))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Theta2 is inf!");
-      if (std::isnan(t1a))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "t1a is NaN!");
-      if (std::isnan(t2a))
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "t2a is NaN!");
-      if (std::fabs(t2a) > 1)
-      {
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "|t2a| is > 1: " << t2a);
-        RCLCPP_INFO_STREAM(node_->get_logger(), "a: " << a << ", u3: " << u3tmp << ", u2: " << u2 << ", a+u2: " << a + u2);
-      }
-      if (std::fabs(t1a) > 1)
-      {
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "|t1a| is > 1: " << t1a);
-        RCLCPP_INFO_STREAM(node_->get_logger(), "b: " << b << ", u3: " << u3tmp << ", u1: " << u1 << ", b+u1: " << b + u1);
-      }
-    }
-#endif
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Fast iterative method: " << iterations << " iterations on "
+      << fim.numThreads() << " threads reached " << fim.reached().size() << " vertices in "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(t_solved - t_start).count() << " ms, deriving the "
+      << "predecessors took " << std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - t_solved).count() << " ms.");
+  return fim.reached().size();
+}
 
-    if (theta1 < theta0 && theta2 < theta0)
-    {
-      auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-      cutting_faces_.insert(v3, fH);
-      distances[v3] = static_cast<float>(u3tmp);
-      if (theta1 < theta2)
-      {
-        predecessors_[v3] = v1;
-        direction_[v3] = theta1;
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v1, fH, theta1, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-      }
-      else
-      {
-        predecessors_[v3] = v2;
-        direction_[v3] = -theta2;
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v2, fH, -theta2, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-      }
-      return true;
-    }
-    else if (theta1 < theta2)
-    {
-      u3tmp = u1 + b;
-      if (u3tmp < u3)
-      {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v1;
-        distances[v3] = static_cast<float>(u3tmp);
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v1, fH, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        direction_[v3] = 0;
-        return true;
-      }
+bool CVPMeshPlanner::seedMatches(const mesh_map::Vector& seed, const lvr2::FaceHandle& seed_face) const
+{
+  return seed_face_ && seed_face_.unwrap() == seed_face && seed_position_.distance2(seed) <= 1e-6 &&
+         propagation_cost_limit_ == config_.cost_limit;
+}
+
+bool CVPMeshPlanner::propagationCovers(const mesh_map::Vector& seed, const lvr2::FaceHandle& seed_face,
+                                       const std::array<lvr2::VertexHandle, 3>& goal_vertices,
+                                       const uint64_t cost_revision) const
+{
+  if (!propagation_valid_ || propagation_revision_ != cost_revision || !seedMatches(seed, seed_face))
+    return false;
+
+  for (const auto& vH : goal_vertices)
+  {
+    if (!fixed_[vH] || !std::isfinite(distances_[vH]) || distances_[vH] + config_.goal_dist_offset > propagation_radius_)
       return false;
-    }
-    else
+  }
+  return true;
+}
+
+void CVPMeshPlanner::swapPropagation(CachedPropagation& cached)
+{
+  std::swap(direction_, cached.direction);
+  std::swap(distances_, cached.distances);
+  std::swap(predecessors_, cached.predecessors);
+  std::swap(cutting_faces_, cached.cutting_faces);
+  std::swap(fixed_, cached.fixed);
+  std::swap(vector_field_, cached.vector_field);
+  std::swap(vector_field_complete_, cached.vector_field_complete);
+  std::swap(propagation_valid_, cached.valid);
+  std::swap(propagation_revision_, cached.revision);
+  std::swap(seed_face_, cached.seed_face);
+  std::swap(seed_position_, cached.seed_position);
+  std::swap(propagation_radius_, cached.radius);
+  std::swap(propagation_cost_limit_, cached.cost_limit);
+}
+
+void CVPMeshPlanner::selectCachedPropagation(const mesh_map::Vector& seed)
+{
+  mesh_map::Vector seed_position = seed;
+  const lvr2::OptionalFaceHandle seed_opt = mesh_map_->getContainingFace(seed_position, 0.4);
+  if (!seed_opt || seedMatches(seed_position, seed_opt.unwrap()))
+    return;
+
+  const lvr2::FaceHandle seed_face = seed_opt.unwrap();
+  auto cached = std::find_if(goal_cache_.begin(), goal_cache_.end(), [&](const CachedPropagation& entry) {
+    return entry.seed_face && entry.seed_face.unwrap() == seed_face &&
+           entry.seed_position.distance2(seed_position) <= 1e-6 && entry.cost_limit == config_.cost_limit;
+  });
+
+  // the potential of the vertices of the previous field is reset, the one of the selected field is exported
+  potential_updates_.insert(potential_updates_.end(), distances_.begin(), distances_.end());
+  if (cached != goal_cache_.end())
+  {
+    // the previously active propagation takes the place of the selected one and becomes the most recently used
+    swapPropagation(*cached);
+    goal_cache_.splice(goal_cache_.begin(), goal_cache_, cached);
+    if (!goal_cache_.front().valid)
     {
-      u3tmp = u2 + a;
-      if (u3tmp < u3)
-      {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v2;
-        distances[v3] = static_cast<float>(u3tmp);
-#ifdef DEBUG
-        mesh_map->publishDebugVector(v3, v2, fH, 0, mesh_map::color(0.9, 0.9, 0.2),
-                                     "dir_vec" + std::to_string(v3.idx()));
-#endif
-        direction_[v3] = 0;
-        return true;
-      }
-      return false;
+      goal_cache_.pop_front();
     }
+    potential_updates_.insert(potential_updates_.end(), distances_.begin(), distances_.end());
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Selected the cached wave front of the goal, " << goal_cache_.size()
+                                            << " other goals are cached.");
+  }
+  else if (propagation_valid_)
+  {
+    goal_cache_.emplace_front();
+    swapPropagation(goal_cache_.front());
+    direction_ = lvr2::DenseVertexMap<float>(mesh_map_->mesh()->nextVertexIndex(), 0);
   }
-  return false;
-}
 
+  // evict the least recently used propagations beyond the memory budget
+  const size_t budget = static_cast<size_t>(config_.goal_cache_size) * 1024 * 1024;
+  size_t memory = 0;
+  for (auto entry = goal_cache_.begin(); entry != goal_cache_.end();)
+  {
+    memory += entry->memoryUsage();
+    entry = memory > budget ? goal_cache_.erase(entry) : std::next(entry);
+  }
+}
 
-inline bool CVPMeshPlanner::waveFrontUpdateFMM(
-    lvr2::DenseVertexMap<float> &distances,
-    const lvr2::DenseEdgeMap<float> &edge_weights,
-    const lvr2::VertexHandle &v1tmp,
-    const lvr2::VertexHandle &v2tmp,
-    const lvr2::VertexHandle &v3)
+bool CVPMeshPlanner::prepareRepair(const mesh_map::Vector& start, const lvr2::FaceHandle& start_face,
+                                   const std::array<lvr2::VertexHandle, 3>& goal_vertices, mesh_map::VertexQueue& pq,
+                                   std::vector<lvr2::VertexHandle>& repaired)
 {
   const auto mesh = mesh_map_->mesh();
+  const auto topology = mesh_map_->topology();
+  const auto& fixed = fixed_;
+  const auto& distances = distances_;
 
-  bool v1_smaller = distances[v1tmp] < distances[v2tmp];
-  const lvr2::VertexHandle v1 = v1_smaller ? v1tmp : v2tmp;
-  const lvr2::VertexHandle v2 = v1_smaller ? v2tmp : v1tmp;
+  // the previous propagation has to be complete and seeded at the same position with the same cost limit
+  if (!propagation_valid_ || !seedMatches(start, start_face))
+    return false;
 
-  const double u1 = distances[v1];
-  const double u2 = distances[v2];
-  const double u3 = distances[v3];
+  // the robot has to be inside the region the previous propagation expanded to
+  float max_goal_distance = 0;
+  for (const auto& vH : goal_vertices)
+  {
+    if (!fixed[vH] || !std::isfinite(distances[vH]))
+      return false;
+    max_goal_distance = std::max(max_goal_distance, distances[vH]);
+  }
+  if (max_goal_distance + config_.goal_dist_offset > propagation_radius_)
+    return false;
 
-  const lvr2::OptionalEdgeHandle e12h = mesh->getEdgeBetween(v1, v2);
-  const double c = edge_weights[e12h.unwrap()];
-  const double c_sq = c * c;
+  std::vector<lvr2::VertexHandle> changed;
+  if (!mesh_map_->changedVerticesSince(propagation_revision_, changed))
+  {
+    RCLCPP_INFO_STREAM(node_->get_logger(), "The cost changes since the latest propagation are unknown, "
+                                            "recomputing the wave front.");
+    return false;
+  }
 
-  const lvr2::OptionalEdgeHandle e13h = mesh->getEdgeBetween(v1, v3);
-  const double b = edge_weights[e13h.unwrap()];
-  const double b_sq = b * b;
+  const size_t num_vertices = mesh->nextVertexIndex();
+  const auto seed_vertices = topology->verticesOfFace(start_face);
+  repair_region_.reset(num_vertices);
 
-  const lvr2::OptionalEdgeHandle e23h = mesh->getEdgeBetween(v2, v3);
-  const double a = edge_weights[e23h.unwrap()];
-  const double a_sq = a * a;
+  // Collect the changed vertices which have been reached by the previous propagation or are adjacent to it. Vertices
+  // above the cost limit have not been reached, but might be passable now.
+  std::vector<lvr2::VertexHandle> stack;
+  for (const auto& vH : changed)
+  {
+    if (repair_region_.containsKey(vH) || !topology->isValid(vH))
+      continue;
 
-  const double delta_u = u2 - u1;
-  const double cos_theta = (a_sq + b_sq - c_sq) / (2 * a * b);
+    bool reached = distances.containsKey(vH);
+    for (const auto& neighbour : topology->neighboursOfVertex(vH))
+    {
+      reached = reached || distances.containsKey(neighbour);
+    }
+    if (!reached)
+      continue;
 
-  const double k0 = a_sq + b_sq - 2 * a * b * cos_theta;
-  const double k1 = 2 * b * delta_u * (a * cos_theta - b);
-  const double k2 = b_sq * (delta_u * delta_u - a_sq * (1 - cos_theta * cos_theta));
+    if (vH == seed_vertices[0] || vH == seed_vertices[1] || vH == seed_vertices[2])
+    {
+      RCLCPP_INFO_STREAM(node_->get_logger(), "The costs at the seed changed, recomputing the wave front.");
+      return false;
+    }
+    repair_region_.insert(vH, AFFECTED);
+    stack.push_back(vH);
+  }
 
-  double t;
-  const double r = k1 * k1 - 4 * k0 * k2;
-  if(r < 0)
+  // All vertices whose distance has been derived from an affected vertex are affected as well. The distance of a
+  // vertex has been computed in its cutting face, thus it depends on the other two vertices of that face.
+  const size_t max_affected = static_cast<size_t>(config_.max_repair_ratio * distances.numValues());
+  size_t num_affected = stack.size();
+  while (!stack.empty())
   {
-    t = -k1 / (2 * k0);
+    const lvr2::VertexHandle vH = stack.back();
+    stack.pop_back();
+    repaired.push_back(vH);
+
+    for (const auto& neighbour : topology->neighboursOfVertex(vH))
+    {
+      if (repair_region_.containsKey(neighbour) || !predecessors_.containsKey(neighbour) ||
+          !cutting_faces_.containsKey(neighbour))
+        continue;
+
+      const auto& cut_vertices = topology->verticesOfFace(cutting_faces_[neighbour]);
+      if (cut_vertices[0] == vH || cut_vertices[1] == vH || cut_vertices[2] == vH)
+      {
+        repair_region_.insert(neighbour, AFFECTED);
+        stack.push_back(neighbour);
+        num_affected++;
+      }
+    }
+
+    if (num_affected > max_affected)
+    {
+      RCLCPP_INFO_STREAM(node_->get_logger(), "More than " << max_affected << " vertices are affected by "
+                                              << changed.size() << " cost changes, recomputing the wave front.");
+      return false;
+    }
   }
-  else
+
+  // invalidate the affected region
+  detachVectorField(true);
+  for (const auto& vH : repaired)
   {
-    t = (-k1 + sqrt(r)) / (2 * k0);
+    distances_.erase(vH);
+    predecessors_.erase(vH);
+    cutting_faces_.erase(vH);
+    fixed_.erase(vH);
+    vector_field_->vectors.erase(vH);
   }
 
-  const double e = b * (t - delta_u) / t;
-
-  if(delta_u < t && (e < a / cos_theta) && (e > a * cos_theta))
+  // the fixed vertices around the invalidated region propagate the wave front into it again
+  size_t num_boundary = 0;
+  for (const auto& vH : repaired)
   {
-    const double u3_tmp = u1 + t;
-    if(u3_tmp < u3)
+    for (const auto& neighbour : topology->neighboursOfVertex(vH))
     {
-      auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-      cutting_faces_.insert(v3, fH);
-      predecessors_[v3] = v1;
-      distances[v3] = static_cast<float>(u3_tmp);
-      const double theta = acos(cos_theta);
-      const double phi = asin((e * sin(theta)) / sqrt(a_sq * e * e - 2 * a * cos_theta));
-      direction_[v3] = theta + phi - M_PI_2;
-      return true;
+      if (repair_region_.containsKey(neighbour) || !fixed[neighbour])
+        continue;
+      repair_region_.insert(neighbour, BOUNDARY);
+      pq.insert(neighbour, distances[neighbour]);
+      num_boundary++;
     }
   }
-  else {
-    const double u1t = u1 + b;
-    const double u2t = u2 + a;
 
-    if (u1t < u2t) {
-      if (u1t < u3) {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v1;
-        distances[v3] = static_cast<float>(u1t);
-        direction_[v3] = 0;
-        return true;
-      }
-    } else {
-      if (u2t < u3) {
-        auto fH = mesh->getFaceBetween(v1, v2, v3).unwrap();
-        cutting_faces_.insert(v3, fH);
-        predecessors_[v3] = v2;
-        distances[v3] = static_cast<float>(u2t);
-        direction_[v3] = 0;
-        return true;
-      }
-    }
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Repairing the wave front for " << changed.size() << " changed vertices, "
+                                          << repaired.size() << " vertices are affected, " << num_boundary
+                                          << " boundary vertices.");
+  return true;
+}
+
+inline bool CVPMeshPlanner::waveFrontUpdate(mesh_map::StampedVertexMap<float>& distances,
+                                              const lvr2::DenseEdgeMap<float>& edge_weights,
+                                              const mesh_map::MeshTopology& topology, const lvr2::FaceHandle& fh,
+                                              const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
+                                              const lvr2::VertexHandle& v3)
+{
+  const float c = edge_weights[topology.edgeBetween(v1, v2).unwrap()];
+  const float b = edge_weights[topology.edgeBetween(v1, v3).unwrap()];
+  const float a = edge_weights[topology.edgeBetween(v2, v3).unwrap()];
+
+  mesh_map::EikonalResult update;
+  if (!eikonal_kernel_.update(distances[v1], distances[v2], distances[v3], a, b, c, update))
+  {
+    return false;
   }
 
-return false;
+  const lvr2::VertexHandle& predecessor = update.from_v1 ? v1 : v2;
+  cutting_faces_.insert(v3, fh);
+  predecessors_[v3] = predecessor;
+  distances[v3] = update.distance;
+  direction_[v3] = update.direction;
+#ifdef DEBUG
+  mesh_map->publishDebugVector(v3, predecessor, fh, update.direction, mesh_map::color(0.9, 0.9, 0.2),
+                               "dir_vec" + std::to_string(v3.idx()));
+#endif
+  return true;
 }
 
 uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_start,
                                                 const mesh_map::Vector& original_goal,
                                                 const lvr2::DenseEdgeMap<float>& edge_weights,
                                                 const lvr2::DenseVertexMap<float>& costs,
-                                                std::list<std::pair<mesh_map::Vector, lvr2::FaceHandle>>& path,
+                                                const uint64_t cost_revision,
+                                                mesh_map::MeshPath& path,
                                                 std::string& message,
-                                                lvr2::DenseVertexMap<float>& distances,
-                                                lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
+                                                mesh_map::StampedVertexMap<float>& distances,
+                                                mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors)
 {
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "Init wave front propagation.");
 
   const auto mesh = mesh_map_->mesh();
-  const auto& vertex_costs = mesh_map_->vertexCosts();
+  const auto topology = mesh_map_->topology();
+  const auto& vertex_costs = costs;
   auto& invalid = mesh_map_->invalid;
 
   mesh_map_->publishDebugPoint(original_start, mesh_map::color(0, 1, 0), "start_point");
@@ -684,36 +1079,9 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
   mesh_map_->publishDebugFace(goal_face, mesh_map::color(0, 1, 0), "goal_face");
 
   path.clear();
-  distances.clear();
-  predecessors.clear();
-
-  lvr2::DenseVertexMap<bool> fixed(mesh->nextVertexIndex(), false);
-
-  // clear vector field map
-  vector_map_.clear();
 
-  RCLCPP_DEBUG_STREAM(node_->get_logger(), "Init distances.");
-  // initialize distances with infinity
-  // initialize predecessor of each vertex with itself
-  for (auto const& vH : mesh->vertices())
-  {
-    distances.insert(vH, std::numeric_limits<float>::infinity());
-    predecessors.insert(vH, vH);
-  }
-
-  lvr2::Meap<lvr2::VertexHandle, float> pq;
-  // Set start distance to zero
-  // add start vertex to priority queue
-  for (auto vH : mesh->getVerticesOfFace(start_face))
-  {
-    const mesh_map::Vector diff = start - mesh->getVertexPosition(vH);
-    const float dist = diff.length();
-    distances[vH] = dist;
-    vector_map_.insert(vH, diff);
-    cutting_faces_.insert(vH, start_face);
-    fixed[vH] = true;
-    pq.insert(vH, dist);
-  }
+  const size_t num_vertices = mesh->nextVertexIndex();
+  // costs changing while propagating are repaired by the next query
 
   std::array<lvr2::VertexHandle, 3> goal_vertices = mesh->getVerticesOfFace(goal_face);
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "The goal is at (" << goal.x << ", " << goal.y << ", " << goal.z << ") at the face ("
@@ -723,26 +1091,132 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
   mesh_map_->publishDebugPoint(mesh->getVertexPosition(goal_vertices[1]), mesh_map::color(0, 0, 1), "goal_face_v2");
   mesh_map_->publishDebugPoint(mesh->getVertexPosition(goal_vertices[2]), mesh_map::color(0, 0, 1), "goal_face_v3");
 
+  const auto pq = mesh_map::createVertexQueue(config_.queue_type, mesh->nextVertexIndex());
+  auto& fixed = fixed_;
   float goal_dist = std::numeric_limits<float>::infinity();
 
+  // vertices which have been invalidated or recomputed by an incremental repair
+  std::vector<lvr2::VertexHandle> repaired;
+  // a cached propagation of the goal which covers the robot's position with the current costs is back tracked as it is
+  const bool reuse = config_.goal_cache_size > 0 && !corridor_active_ &&
+                     propagationCovers(start, start_face, goal_vertices, cost_revision);
+  // a corridor restricted query starts from scratch, the repair would have to expand the previous region
+  const bool repair = !reuse && !corridor_active_ && config_.incremental_replanning &&
+                      prepareRepair(start, start_face, goal_vertices, *pq, repaired);
+  if (reuse)
+  {
+    goal_dist = propagation_radius_;
+    RCLCPP_INFO_STREAM(node_->get_logger(), "The wave front of the goal covers the robot's position, back tracking "
+                                            "the cached field.");
+  }
+  else if (repair)
+  {
+    // the repair expands the wave front as far as the previous propagation did
+    goal_dist = propagation_radius_;
+    settled_.reset(num_vertices);
+  }
+  else
+  {
+    repaired.clear();
+    pq->clear();
+
+    RCLCPP_DEBUG_STREAM(node_->get_logger(), "Init distances.");
+    // the vector field is rebuilt from scratch, reset the exported potential at the vertices touched by the previous
+    // query only
+    detachVectorField(false);
+    for (auto vH : distances)
+    {
+      potential_updates_.push_back(vH);
+    }
+
+    // Starting a new generation resets the buffers in constant time: vertices which have not been written during this
+    // query read as infinite distance, without predecessor and cutting face, and not fixed.
+    distances.reset(num_vertices);
+    predecessors.reset(num_vertices);
+    cutting_faces_.reset(num_vertices);
+    fixed_.reset(num_vertices);
+
+    // Set start distance to zero
+    // add start vertex to priority queue
+    for (auto vH : mesh->getVerticesOfFace(start_face))
+    {
+      const mesh_map::Vector diff = start - mesh->getVertexPosition(vH);
+      const float dist = diff.length();
+      distances[vH] = dist;
+      vector_field_->vectors.insert(vH, diff);
+      cutting_faces_.insert(vH, start_face);
+      fixed[vH] = true;
+      pq->insert(vH, dist);
+    }
+  }
+
+  // While repairing, a vertex which has been fixed by the previous propagation is reopened, if the repaired region
+  // provides a significantly shorter distance to it, e.g. because an obstacle disappeared.
+  auto reopen = [&](const lvr2::FaceHandle& fh, const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
+                    const lvr2::VertexHandle& v3) {
+    // seed vertices have no predecessor and are never reopened
+    if (settled_.containsKey(v3) || !predecessors_.containsKey(v3) || costs[v3] > config_.cost_limit)
+      return;
+
+    const float distance = distances[v3];
+    const float direction = direction_[v3];
+    const lvr2::VertexHandle predecessor = predecessors_[v3];
+    const bool has_cutting_face = cutting_faces_.containsKey(v3);
+    const lvr2::FaceHandle cutting_face = has_cutting_face ? cutting_faces_[v3] : fh;
+
+    if (!waveFrontUpdate(distances, edge_weights, *topology, fh, v1, v2, v3))
+      return;
+
+    if (distances[v3] < distance * (1 - REPAIR_EPSILON))
+    {
+      fixed[v3] = false;
+      pq->insert(v3, distances[v3]);
+      repaired.push_back(v3);
+      return;
+    }
+
+    // negligible improvements, e.g. by rounding, would reopen the whole region, restore the previous state
+    distances[v3] = distance;
+    direction_[v3] = direction;
+    predecessors_[v3] = predecessor;
+    if (has_cutting_face)
+      cutting_faces_[v3] = cutting_face;
+    else
+      cutting_faces_.erase(v3);
+  };
+
+  // vertices above the cost limit or, in a hierarchical query, outside the corridor are not entered
+  auto accessible = [&](const lvr2::VertexHandle& vH) {
+    return vertex_costs[vH] <= config_.cost_limit && (!corridor_active_ || corridor_[vH.idx()]);
+  };
+
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "Start wavefront propagation...");
 
   size_t fixed_cnt = 0;
   size_t fixed_set_cnt = 0;
   const auto t_wavefront_start = std::chrono::steady_clock::now();
-  const auto initialization_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_wavefront_start - t_initialization_start);
+  const auto initialization_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(t_wavefront_start - t_initialization_start);
 
-  while (!pq.isEmpty() && !cancel_planning_)
+  if (!reuse && !repair && config_.propagation_method == "fast_iterative")
   {
-    lvr2::VertexHandle current_vh = pq.popMin().key();
+    // the parallel solver replaces the queue which has been seeded for the sequential propagation
+    pq->clear();
+    fixed_set_cnt = fastIterativePropagation(start_face, goal_vertices, edge_weights, costs, distances, goal_dist);
+  }
+
+  while (!pq->isEmpty() && !cancel_planning_)
+  {
+    lvr2::VertexHandle current_vh = pq->popMin();
 
     fixed[current_vh] = true;
     fixed_set_cnt++;
+    if (repair)
+      settled_.insert(current_vh, true);
 
     if (distances[current_vh] > goal_dist)
       continue;
 
-    if (vertex_costs[current_vh] > config_.cost_limit)
+    if (!accessible(current_vh))
       continue;
 
     if (invalid[current_vh])
@@ -758,131 +1232,196 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
       }
     }
 
-    try
+    // the topology snapshot provides the incident faces without walking the half-edge mesh,
+    // broken vertices have already been marked as invalid when the snapshot was built.
+    for (const lvr2::FaceHandle& fh : topology->facesOfVertex(current_vh))
     {
-      std::vector<lvr2::FaceHandle> faces;
-      mesh->getFacesOfVertex(current_vh, faces);
+      if (!topology->containsFace(fh))
+        continue;
 
-      for (auto fh : faces)
-      {
-        const auto vertices = mesh->getVerticesOfFace(fh);
-        const lvr2::VertexHandle& a = vertices[0];
-        const lvr2::VertexHandle& b = vertices[1];
-        const lvr2::VertexHandle& c = vertices[2];
+      const auto& vertices = topology->verticesOfFace(fh);
+      const lvr2::VertexHandle& a = vertices[0];
+      const lvr2::VertexHandle& b = vertices[1];
+      const lvr2::VertexHandle& c = vertices[2];
 
-        if (invalid[a] || invalid[b] || invalid[c])
-          continue;
+      if (invalid[a] || invalid[b] || invalid[c])
+        continue;
 
-        // We are looking for a face where exactly
-        // one vertex is not in the fixed set
-        if (fixed[a] && fixed[b] && fixed[c])
-        {
-          // All distance values of the face are already fixed
+      // We are looking for a face where exactly
+      // one vertex is not in the fixed set
+      if (fixed[a] && fixed[b] && fixed[c])
+      {
+        // All distance values of the face are already fixed
 #ifdef DEBUG
-          mesh_map->publishDebugFace(fh, mesh_map::color(1, 0, 0), "fmm_fixed_" + std::to_string(fixed_cnt++));
+        mesh_map->publishDebugFace(fh, mesh_map::color(1, 0, 0), "fmm_fixed_" + std::to_string(fixed_cnt++));
 #endif
+        if (repair)
+        {
+          // keep the cyclic order of the vertices, which the update steps rely on
+          if (c != current_vh)
+            reopen(fh, a, b, c);
+          if (b != current_vh)
+            reopen(fh, c, a, b);
+          if (a != current_vh)
+            reopen(fh, b, c, a);
+        }
+        continue;
+      }
+      else if (fixed[a] && fixed[b] && !fixed[c])
+      {
+        // c is free
+        // Skip vertices above the cost limit or outside the corridor
+        if (!accessible(c))
+        {
           continue;
         }
-        else if (fixed[a] && fixed[b] && !fixed[c])
+        if (waveFrontUpdate(distances, edge_weights, *topology, fh, a, b, c))
         {
-          // c is free
-          // Skip vertices above the cost limit
-          if (costs[c] > config_.cost_limit)
-          {
-            continue;
-          }
-#ifdef USE_UPDATE_WITH_S
-          if (waveFrontUpdateWithS(distances, edge_weights, a, b, c))
-#elif defined USE_UPDATE_FMM
-          if (waveFrontUpdateFMM(distances, edge_weights, a, b, c))
-#else
-          if (waveFrontUpdate(distances, edge_weights, a, b, c))
-#endif
-          {
-            pq.insert(c, distances[c]);
+          pq->insert(c, distances[c]);
+          if (repair)
+            repaired.push_back(c);
 #ifdef DEBUG
-            mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
-            sleep(2);
+          mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
+          sleep(2);
 #endif
-          }
         }
-        else if (fixed[a] && !fixed[b] && fixed[c])
+      }
+      else if (fixed[a] && !fixed[b] && fixed[c])
+      {
+        // b is free
+        // Skip vertices above the cost limit or outside the corridor
+        if (!accessible(b))
         {
-          // b is free
-          // Skip vertices above the cost limit
-          if (costs[b] > config_.cost_limit)
-          {
-            continue;
-          }
-#ifdef USE_UPDATE_WITH_S
-          if (waveFrontUpdateWithS(distances, edge_weights, c, a, b))
-#elif defined USE_UPDATE_FMM
-          if (waveFrontUpdateFMM(distances, edge_weights, c, a, b))
-#else
-          if (waveFrontUpdate(distances, edge_weights, c, a, b))
-#endif
-          {
-            pq.insert(b, distances[b]);
-#ifdef DEBUG
-            mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
-            sleep(2);
-#endif
-          }
+          continue;
         }
-        else if (!fixed[a] && fixed[b] && fixed[c])
+        if (waveFrontUpdate(distances, edge_weights, *topology, fh, c, a, b))
         {
-          // a if free
-          // Skip vertices above the cost limit
-          if (costs[a] > config_.cost_limit)
-          {
-            continue;
-          }
-#ifdef USE_UPDATE_WITH_S
-          if (waveFrontUpdateWithS(distances, edge_weights, b, c, a))
-#elif defined USE_UPDATE_FMM
-          if (waveFrontUpdateFMM(distances, edge_weights, b, c, a))
-#else
-          if (waveFrontUpdate(distances, edge_weights, b, c, a))
-#endif
-          {
-            pq.insert(a, distances[a]);
+          pq->insert(b, distances[b]);
+          if (repair)
+            repaired.push_back(b);
 #ifdef DEBUG
-            mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
-            sleep(2);
+          mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
+          sleep(2);
 #endif
-          }
         }
-        else
+      }
+      else if (!fixed[a] && fixed[b] && fixed[c])
+      {
+        // a if free
+        // Skip vertices above the cost limit or outside the corridor
+        if (!accessible(a))
         {
-          // two free vertices -> skip that face
           continue;
         }
+        if (waveFrontUpdate(distances, edge_weights, *topology, fh, b, c, a))
+        {
+          pq->insert(a, distances[a]);
+          if (repair)
+            repaired.push_back(a);
+#ifdef DEBUG
+          mesh_map->publishDebugFace(fh, mesh_map::color(0, 1, 1), "fmm_update");
+          sleep(2);
+#endif
+        }
+      }
+      else
+      {
+        // two free vertices -> skip that face
+        continue;
       }
-    }
-    catch (lvr2::PanicException exception)
-    {
-      invalid.insert(current_vh, true);
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Found invalid vertex!");
-      continue;
-    }
-    catch (lvr2::VertexLoopException exception)
-    {
-      invalid.insert(current_vh, true);
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Found invalid vertex!");
-      continue;
     }
   }
 
+  if (repair)
+    potential_updates_.insert(potential_updates_.end(), repaired.begin(), repaired.end());
+  else if (!reuse)
+    potential_updates_.insert(potential_updates_.end(), distances.begin(), distances.end());
+
   if (cancel_planning_)
   {
+    // a partial propagation can not be repaired
+    propagation_valid_ = false;
     RCLCPP_WARN_STREAM(node_->get_logger(), "Wave front propagation has been canceled!");
     return mbf_msgs::action::GetPath::Result::CANCELED;
   }
+
+  if (repair)
+  {
+    // the repair might have moved the robot's position out of the expanded region
+    for (const auto& vH : goal_vertices)
+    {
+      if (!fixed[vH] || distances[vH] + config_.goal_dist_offset > goal_dist)
+      {
+        RCLCPP_INFO_STREAM(node_->get_logger(), "The repaired wave front does not cover the robot's position anymore, "
+                                                "recomputing it.");
+        propagation_valid_ = false;
+        return waveFrontPropagation(original_start, original_goal, edge_weights, costs, cost_revision, path, message,
+                                    distances, predecessors);
+      }
+    }
+  }
+
+  propagation_valid_ = true;
+  propagation_revision_ = cost_revision;
+  seed_face_ = lvr2::OptionalFaceHandle(start_face);
+  seed_position_ = start;
+  propagation_radius_ = goal_dist;
+  propagation_cost_limit_ = config_.cost_limit;
+
   const auto t_wavefront_end = std::chrono::steady_clock::now();
   const auto wavefront_propagation_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_wavefront_end - t_wavefront_start);
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "Finished wave front propagation.");
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "Computing the vector map...");
-  computeVectorMap();
+  bool full_vector_field = config_.path_corridor_width <= 0;
+  if (reuse && full_vector_field && vector_field_complete_)
+  {
+    // the field might have been cached while another field has been published
+    shareVectorField();
+  }
+  else if (reuse)
+  {
+    // the published field stays immutable, the vectors for the new path are added to a copy
+    detachVectorField(true);
+    if (full_vector_field)
+    {
+      computeVectorMap();
+    }
+    else
+    {
+      const size_t num_vectors = computePathVectorMap(goal_vertices);
+      RCLCPP_INFO_STREAM(node_->get_logger(), "Computed the vector field at " << num_vectors << " of "
+                                                << distances.numValues() << " propagated vertices along the path.");
+    }
+  }
+  else if (!full_vector_field)
+  {
+    if (repair)
+    {
+      // vectors outside the new corridor are kept only if they did not change
+      for (const auto& vH : repaired)
+      {
+        vector_field_->vectors.erase(vH);
+      }
+    }
+    const size_t num_vectors = computePathVectorMap(goal_vertices);
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Computed the vector field at " << num_vectors << " of "
+                                              << distances.numValues() << " propagated vertices along the path.");
+  }
+  else if (repair)
+  {
+    // only the vector field of the repaired region changed
+    for (const auto& vH : repaired)
+    {
+      vector_field_->vectors.erase(vH);
+      computeVector(vH);
+    }
+    shareVectorField();
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Repaired the wave front at " << repaired.size() << " vertices.");
+  }
+  else
+  {
+    computeVectorMap();
+  }
 
   const auto t_vector_field_end = std::chrono::steady_clock::now();
   const auto vector_field_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_vector_field_end - t_wavefront_end);
@@ -891,7 +1430,7 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
   bool predecessor_for_at_least_one_goal_vertex_exists = false;
   for (auto goal_vertex : goal_vertices)
   {
-    if (goal_vertex != predecessors[goal_vertex])
+    if (predecessors.containsKey(goal_vertex))
     {
       predecessor_for_at_least_one_goal_vertex_exists = true;
       break;
@@ -907,9 +1446,18 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
 
   RCLCPP_DEBUG_STREAM(node_->get_logger(), "Start vector field back tracking!");
 
+  // the back tracking advances by one step width per point, the distance of the goal bounds the length of the path
+  float goal_distance = 0;
+  for (const auto& vH : goal_vertices)
+  {
+    if (distances.containsKey(vH) && std::isfinite(distances[vH]))
+      goal_distance = std::max(goal_distance, distances[vH]);
+  }
+  path.reserve(static_cast<size_t>(goal_distance / config_.step_width) + 2);
+
   lvr2::FaceHandle current_face = goal_face;
   mesh_map::Vector current_pos = goal;
-  path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(current_pos, current_face));
+  path.emplace_back(current_pos, current_face);
 
   // move from the goal position towards the start position
   while (current_pos.distance2(start) > config_.step_width && !cancel_planning_)
@@ -918,9 +1466,21 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
     // updates the current face if necessary
     try
     {
-      if (mesh_map_->meshAhead(current_pos, current_face, config_.step_width))
+      if (mesh_map_->meshAhead(current_pos, current_face, config_.step_width, *vector_field_))
       {
-        path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(current_pos, current_face));
+        path.emplace_back(current_pos, current_face);
+      }
+      else if (!full_vector_field)
+      {
+        // the back tracking left the corridor, complete the vector field and start over
+        RCLCPP_INFO_STREAM(node_->get_logger(), "The back tracking left the vector field corridor, computing the "
+                                                "vector field at all propagated vertices.");
+        full_vector_field = true;
+        computeVectorMap();
+        current_face = goal_face;
+        current_pos = goal;
+        path.clear();
+        path.emplace_back(current_pos, current_face);
       }
       else
       {
@@ -936,17 +1496,30 @@ uint32_t CVPMeshPlanner::waveFrontPropagation(const mesh_map::Vector& original_s
       return mbf_msgs::action::GetPath::Result::NO_PATH_FOUND;
     }
   }
-  path.push_front(std::pair<mesh_map::Vector, lvr2::FaceHandle>(start, start_face));
+  path.emplace_back(start, start_face);
 
   const auto t_path_backtracking = std::chrono::steady_clock::now();
   const auto path_backtracking_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_path_backtracking - t_vector_field_end);
 
   RCLCPP_INFO_STREAM(node_->get_logger(), "Processed " << fixed_set_cnt << " vertices in the fixed set.");
-  RCLCPP_INFO_STREAM(node_->get_logger(), "Initialization duration (ms): " << initialization_duration_ms.count());
+  const auto& queue_stats = pq->statistics();
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Vertex queue \"" << config_.queue_type << "\": " << queue_stats.inserts
+                                            << " inserts, " << queue_stats.pops << " pops, " << queue_stats.stale
+                                            << " stale entries, max size " << queue_stats.max_size);
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Initialization duration (us): " << initialization_duration_us.count());
   RCLCPP_INFO_STREAM(node_->get_logger(), "Execution time wavefront propagation (ms): "<< wavefront_propagation_duration_ms.count());
   RCLCPP_INFO_STREAM(node_->get_logger(), "Vector field post computation (ms): " << vector_field_duration_ms.count());
   RCLCPP_INFO_STREAM(node_->get_logger(), "Path backtracking duration (ms): " << path_backtracking_duration_ms.count());
 
+  MESH_MAP_DURATION("cvp_mesh_planner.initialization", t_wavefront_start - t_initialization_start);
+  MESH_MAP_DURATION("cvp_mesh_planner.wave_front_propagation", t_wavefront_end - t_wavefront_start);
+  MESH_MAP_DURATION("cvp_mesh_planner.vector_field", t_vector_field_end - t_wavefront_end);
+  MESH_MAP_DURATION("cvp_mesh_planner.path_backtracking", t_path_backtracking - t_vector_field_end);
+  MESH_MAP_COUNT("cvp_mesh_planner.vertices_settled", fixed_set_cnt);
+  MESH_MAP_COUNT("cvp_mesh_planner.queue_inserts", queue_stats.inserts);
+  MESH_MAP_COUNT("cvp_mesh_planner.queue_pops", queue_stats.pops);
+  MESH_MAP_COUNT("cvp_mesh_planner.queue_stale", queue_stats.stale);
+
   if (cancel_planning_)
   {
     RCLCPP_WARN_STREAM(node_->get_logger(), "Wave front propagation has been canceled!");
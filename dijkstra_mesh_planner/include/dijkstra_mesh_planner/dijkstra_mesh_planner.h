@@ -41,6 +41,8 @@
 #include <mbf_mesh_core/mesh_planner.h>
 #include <mbf_msgs/action/get_path.hpp>
 #include <mesh_map/mesh_map.h>
+#include <mesh_map/stamped_vertex_map.h>
+#include <mesh_map/vertex_queue.h>
 #include <nav_msgs/msg/path.hpp>
 
 namespace dijkstra_mesh_planner
@@ -111,7 +113,7 @@ public:
    *
    * @return vector field of the plan
    */
-  lvr2::DenseVertexMap<mesh_map::Vector> getVectorMap();
+  mesh_map::VectorField::ConstPtr getVectorField();
 
 protected:
   /**
@@ -143,8 +145,28 @@ protected:
    */
   uint32_t dijkstra(const mesh_map::Vector& start, const mesh_map::Vector& goal,
                     const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
-                    std::list<lvr2::VertexHandle>& path, lvr2::DenseVertexMap<float>& distances,
-                    lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors);
+                    std::list<lvr2::VertexHandle>& path, mesh_map::StampedVertexMap<float>& distances,
+                    mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors);
+
+  /**
+   * @brief runs a bidirectional dijkstra search, which meets in the middle between start and goal. Afterwards the
+   * distances and predecessors are completed within the goal_dist_offset area around the goal, so that the vector field
+   * covers that area, too.
+   *
+   * @param start_vertex[in] the vertex at which the forward search starts, i.e. the seed of the distance field
+   * @param goal_vertex[in] the vertex at which the backward search starts
+   * @param edge_weights[in] edge distances of the map
+   * @param costs[in] vertex costs of the map
+   * @param distances[in,out] per vertex distances to the start vertex, reset for the current query
+   * @param predecessors[in,out] predecessor map, reset for the current query
+   * @param fixed_set_cnt[out] number of popped vertices
+   * @param queue_stats[out] accumulated statistics of the used vertex queues
+   */
+  void bidirectionalDijkstra(const lvr2::VertexHandle& start_vertex, const lvr2::VertexHandle& goal_vertex,
+                             const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::DenseVertexMap<float>& costs,
+                             mesh_map::StampedVertexMap<float>& distances,
+                             mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors, size_t& fixed_set_cnt,
+                             mesh_map::VertexQueueStatistics& queue_stats);
 
   /**
    * @brief calculates the vector field based on the current predecessors map and stores it to the vector_map field of this class
@@ -184,16 +206,27 @@ private:
     double goal_dist_offset = 0.3;
     // defines the vertex cost limit with which it can be accessed
     double cost_limit = 1.0;
+    // priority queue used by the propagation, see mesh_map::createVertexQueue()
+    std::string queue_type = "meap";
+    // search strategy: "dijkstra", "astar" or "bidirectional"
+    std::string search_mode = "dijkstra";
   } config_;
 
-  // predecessors while wave propagation
-  lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors_;
-  // the face which is cut by line to the source
-  lvr2::DenseVertexMap<lvr2::FaceHandle> cutting_faces_;
-  // stores the current vector map containing vectors pointing to the source
-  // (path goal)
-  lvr2::DenseVertexMap<mesh_map::Vector> vector_map_;
-  // potential field or distance values to the source (path goal)
+  // distances of the latest propagation, persistent across queries and reset by generation
+  mesh_map::StampedVertexMap<float> distances_;
+  // predecessors while wave propagation, only vertices with a predecessor are contained
+  mesh_map::StampedVertexMap<lvr2::VertexHandle> predecessors_;
+  // vertices which have been popped from the queue
+  mesh_map::StampedVertexMap<uint8_t> fixed_;
+  // buffers of the backward search and the goal area completion in bidirectional mode
+  mesh_map::StampedVertexMap<float> backward_distances_;
+  mesh_map::StampedVertexMap<lvr2::VertexHandle> backward_predecessors_;
+  mesh_map::StampedVertexMap<uint8_t> backward_fixed_;
+  mesh_map::StampedVertexMap<uint8_t> completion_fixed_;
+  // the current vector field containing vectors pointing to the source
+  // (path goal), immutable once published to the map
+  mesh_map::VectorField::Ptr vector_field_;
+  // potential field or distance values to the source (path goal), exported from distances_ after each query
   lvr2::DenseVertexMap<float> potential_;
 };
 
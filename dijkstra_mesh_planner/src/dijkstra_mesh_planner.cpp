@@ -36,8 +36,11 @@
  */
 
 #include <chrono>
+#include <cmath>
 #include <dijkstra_mesh_planner/dijkstra_mesh_planner.h>
 #include <lvr2/util/Meap.hpp>
+#include <mesh_map/instrumentation.h>
+#include <mesh_map/vertex_queue.h>
 #include <mbf_msgs/action/get_path.hpp>
 #include <mesh_map/util.h>
 #include <pluginlib/class_list_macros.hpp>
@@ -48,7 +51,22 @@ PLUGINLIB_EXPORT_CLASS(dijkstra_mesh_planner::DijkstraMeshPlanner, mbf_mesh_core
 namespace dijkstra_mesh_planner
 {
 
-DijkstraMeshPlanner::DijkstraMeshPlanner() {}
+static bool isValidSearchMode(const std::string& mode)
+{
+  return mode == "dijkstra" || mode == "astar" || mode == "bidirectional";
+}
+
+DijkstraMeshPlanner::DijkstraMeshPlanner()
+  : distances_(std::numeric_limits<float>::infinity())
+  , predecessors_(lvr2::VertexHandle(0))
+  , fixed_(false)
+  , backward_distances_(std::numeric_limits<float>::infinity())
+  , backward_predecessors_(lvr2::VertexHandle(0))
+  , backward_fixed_(false)
+  , completion_fixed_(false)
+  , vector_field_(std::make_shared<mesh_map::VectorField>())
+{
+}
 
 DijkstraMeshPlanner::~DijkstraMeshPlanner() {}
 
@@ -56,6 +74,7 @@ uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::msg::PoseStamped& st
                             double tolerance, std::vector<geometry_msgs::msg::PoseStamped>& plan, double& cost,
                             std::string& message)
 {
+  MESH_MAP_SCOPED_TIMER("dijkstra_mesh_planner.make_plan");
   const auto mesh = mesh_map_->mesh();
 
   std::list<lvr2::VertexHandle> path;
@@ -114,7 +133,7 @@ uint32_t DijkstraMeshPlanner::makePlan(const geometry_msgs::msg::PoseStamped& st
 
   if (config_.publish_vector_field)
   {
-    mesh_map_->publishVectorField("vector_field", vector_map_, config_.publish_face_vectors);
+    mesh_map_->publishVectorField("vector_field", vector_field_->vectors, config_.publish_face_vectors);
   }
 
   return outcome;
@@ -145,9 +164,30 @@ bool DijkstraMeshPlanner::initialize(const std::string& plugin_name, const std::
     descriptor.floating_point_range.push_back(range);
     config_.cost_limit =  node->declare_parameter(name_ + ".cost_limit", config_.cost_limit);
   }
+  { // queue type param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The priority queue used by the Dijkstra propagation: meap, quaternary_heap or radix_heap.";
+    config_.queue_type = node->declare_parameter(name_ + ".queue_type", config_.queue_type, descriptor);
+    if (!mesh_map::isValidVertexQueueType(config_.queue_type))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown queue type \"" << config_.queue_type << "\"!");
+      return false;
+    }
+  }
+  { // search mode param
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The search strategy: dijkstra, astar (euclidean heuristic) or bidirectional.";
+    config_.search_mode = node->declare_parameter(name_ + ".search_mode", config_.search_mode, descriptor);
+    if (!isValidSearchMode(config_.search_mode))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown search mode \"" << config_.search_mode << "\"!");
+      return false;
+    }
+  }
 
   path_pub_ = node_->create_publisher<nav_msgs::msg::Path>("~/path", rclcpp::QoS(1).transient_local());
   const auto mesh = mesh_map_->mesh();
+  potential_ = lvr2::DenseVertexMap<float>(mesh->nextVertexIndex(), std::numeric_limits<float>::infinity());
 
   reconfiguration_callback_handle_ = node_->add_on_set_parameters_callback(std::bind(
       &DijkstraMeshPlanner::reconfigureCallback, this, std::placeholders::_1));
@@ -155,9 +195,9 @@ bool DijkstraMeshPlanner::initialize(const std::string& plugin_name, const std::
   return true;
 }
 
-lvr2::DenseVertexMap<mesh_map::Vector> DijkstraMeshPlanner::getVectorMap()
+mesh_map::VectorField::ConstPtr DijkstraMeshPlanner::getVectorField()
 {
-  return vector_map_;
+  return vector_field_;
 }
 
 rcl_interfaces::msg::SetParametersResult DijkstraMeshPlanner::reconfigureCallback(std::vector<rclcpp::Parameter> parameters)
@@ -167,6 +207,20 @@ rcl_interfaces::msg::SetParametersResult DijkstraMeshPlanner::reconfigureCallbac
     if (parameter.get_name() == name_ + ".cost_limit") {
       config_.cost_limit = parameter.as_double();
       RCLCPP_INFO_STREAM(node_->get_logger(), "New height diff layer config through dynamic reconfigure.");
+    } else if (parameter.get_name() == name_ + ".queue_type") {
+      if (!mesh_map::isValidVertexQueueType(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown queue type \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.queue_type = parameter.as_string();
+    } else if (parameter.get_name() == name_ + ".search_mode") {
+      if (!isValidSearchMode(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown search mode \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.search_mode = parameter.as_string();
     }
   }
   result.successful = true;
@@ -177,7 +231,8 @@ void DijkstraMeshPlanner::computeVectorMap()
 {
   const auto mesh = mesh_map_->mesh();
 
-  for (auto v3 : mesh->vertices())
+  // only vertices which got a predecessor during the latest propagation are contained
+  for (auto v3 : predecessors_)
   {
     const lvr2::VertexHandle& v1 = predecessors_[v3];
     // if predecessor is pointing to it self, continue with the next vertex.
@@ -190,28 +245,47 @@ void DijkstraMeshPlanner::computeVectorMap()
     // compute the direction vector and store it in the direction vertex map
     const auto dirVec = vec1 - vec3;
     // store the normalized rotated vector in the vector map
-    vector_map_.insert(v3, dirVec.normalized());
+    vector_field_->vectors.insert(v3, dirVec.normalized());
   }
-  mesh_map_->setVectorMap(vector_map_);
+  mesh_map_->setVectorField(vector_field_);
 }
 
 uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& start, const mesh_map::Vector& goal,
                                        std::list<lvr2::VertexHandle>& path)
 {
-  return dijkstra(start, goal, mesh_map_->edgeDistances(), mesh_map_->vertexCosts(), path, potential_, predecessors_);
+  // the published vector field is shared with the controller, the new one is built from scratch
+  vector_field_ = std::make_shared<mesh_map::VectorField>();
+
+  // reset the exported potential at the vertices touched by the previous query only
+  for (auto vH : distances_)
+  {
+    potential_[vH] = std::numeric_limits<float>::infinity();
+  }
+
+  // the snapshot keeps the costs consistent during the search, while the layers keep updating the map
+  const auto costs = mesh_map_->costSnapshot();
+  const uint32_t outcome =
+      dijkstra(start, goal, mesh_map_->edgeDistances(), costs->vertex_costs, path, distances_, predecessors_);
+
+  for (auto vH : distances_)
+  {
+    potential_[vH] = distances_[vH];
+  }
+  return outcome;
 }
 
 uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, const mesh_map::Vector& original_goal,
                                        const lvr2::DenseEdgeMap<float>& edge_weights,
                                        const lvr2::DenseVertexMap<float>& costs, std::list<lvr2::VertexHandle>& path,
-                                       lvr2::DenseVertexMap<float>& distances,
-                                       lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors)
+                                       mesh_map::StampedVertexMap<float>& distances,
+                                       mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors)
 {
   RCLCPP_INFO_STREAM(node_->get_logger(), "Init wave front propagation.");
   const auto t_initialization_start = std::chrono::steady_clock::now();
 
   const auto mesh = mesh_map_->mesh();
-  const auto& vertex_costs = mesh_map_->vertexCosts();
+  const auto topology = mesh_map_->topology();
+  const auto& vertex_costs = costs;
 
   auto& invalid = mesh_map_->invalid;
 
@@ -233,105 +307,98 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   const auto& goal_vertex = goal_opt.unwrap();
 
   path.clear();
-  distances.clear();
-  predecessors.clear();
+  // Starting a new generation resets the buffers in constant time: vertices which have not been written during this
+  // query read as infinite distance, without predecessor and not fixed.
+  distances.reset(mesh->nextVertexIndex());
+  predecessors.reset(mesh->nextVertexIndex());
 
   if (goal_vertex == start_vertex)
   {
     return mbf_msgs::action::GetPath::Result::SUCCESS;
   }
 
-  lvr2::DenseVertexMap<bool> fixed(mesh->nextVertexIndex(), false);
-
-  // clear vector field map
-  vector_map_.clear();
-
   const auto t_start = std::chrono::steady_clock::now();
 
-  // initialize distances with infinity
-  // initialize predecessor of each vertex with itself
-  for (auto const& vH : mesh->vertices())
-  {
-    distances.insert(vH, std::numeric_limits<float>::infinity());
-    predecessors.insert(vH, vH);
-  }
-
-  lvr2::Meap<lvr2::VertexHandle, float> pq;
-
-  // Set start distance to zero
-  // add start vertex to priority queue
-  distances[start_vertex] = 0;
-  pq.insert(start_vertex, 0);
-
-  float goal_dist = std::numeric_limits<float>::infinity();
-
-  RCLCPP_INFO_STREAM(node_->get_logger(), "Start Dijkstra");
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Start Dijkstra in \"" << config_.search_mode << "\" mode");
   const auto t_propagation_start = std::chrono::steady_clock::now();
-  const auto initialization_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_propagation_start - t_initialization_start);
+  const auto initialization_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(t_propagation_start - t_initialization_start);
 
   size_t fixed_set_cnt = 0;
+  mesh_map::VertexQueueStatistics queue_stats;
 
-  while (!pq.isEmpty() && !cancel_planning_)
+  if (config_.search_mode == "bidirectional")
   {
-    lvr2::VertexHandle current_vh = pq.popMin().key();
-    fixed[current_vh] = true;
-    fixed_set_cnt++;
-
-    if (current_vh == goal_vertex)
+    bidirectionalDijkstra(start_vertex, goal_vertex, edge_weights, costs, distances, predecessors, fixed_set_cnt,
+                          queue_stats);
+  }
+  else
+  {
+    const bool use_heuristic = config_.search_mode == "astar";
+    const mesh_map::Vector& goal_position = mesh->getVertexPosition(goal_vertex);
+
+    // The euclidean distance to the goal is a consistent heuristic as long as the edge weights are not smaller than the
+    // edge lengths, which holds for the edge distances of the map.
+    auto heuristic = [&](const lvr2::VertexHandle& vH) {
+      return use_heuristic ? mesh->getVertexPosition(vH).distance(goal_position) : 0.0f;
+    };
+
+    fixed_.reset(mesh->nextVertexIndex());
+    auto& fixed = fixed_;
+    const auto pq = mesh_map::createVertexQueue(config_.queue_type, mesh->nextVertexIndex());
+
+    // Set start distance to zero
+    // add start vertex to priority queue
+    distances[start_vertex] = 0;
+    pq->insert(start_vertex, heuristic(start_vertex));
+
+    float goal_dist = std::numeric_limits<float>::infinity();
+    // A* pops the vertices ordered by distance plus heuristic. All vertices within goal_dist_offset around the goal
+    // have been popped, once the smallest key exceeds the goal distance plus twice the offset.
+    float stop_key = std::numeric_limits<float>::infinity();
+
+    while (!pq->isEmpty() && !cancel_planning_)
     {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "The Dijkstra Mesh Planner reached the goal.");
-      goal_dist = distances[current_vh] + config_.goal_dist_offset;
-    }
+      lvr2::VertexHandle current_vh = pq->popMin();
+      fixed[current_vh] = true;
+      fixed_set_cnt++;
 
-    if (distances[current_vh] > goal_dist)
-      continue;
+      if (current_vh == goal_vertex)
+      {
+        RCLCPP_INFO_STREAM(node_->get_logger(), "The Dijkstra Mesh Planner reached the goal.");
+        goal_dist = distances[current_vh] + config_.goal_dist_offset;
+        stop_key = goal_dist + config_.goal_dist_offset;
+      }
 
-    if (vertex_costs[current_vh] > config_.cost_limit)
-      continue;
+      if (use_heuristic && distances[current_vh] + heuristic(current_vh) > stop_key)
+        break;
 
-    std::vector<lvr2::EdgeHandle> edges;
-    try
-    {
-      mesh->getEdgesOfVertex(current_vh, edges);
-    }
-    catch (lvr2::PanicException exception)
-    {
-      invalid.insert(current_vh, true);
-      continue;
-    }
-    catch (lvr2::VertexLoopException exception)
-    {
-      invalid.insert(current_vh, true);
-      continue;
-    }
-    for (auto eH : edges)
-    {
-      try
+      if (distances[current_vh] > goal_dist)
+        continue;
+
+      if (vertex_costs[current_vh] > config_.cost_limit)
+        continue;
+
+      // broken vertices have been marked invalid while building the topology snapshot
+      const auto edges = topology->edgesOfVertex(current_vh);
+      const auto neighbours = topology->neighboursOfVertex(current_vh);
+      for (size_t i = 0; i < edges.size(); i++)
       {
-        std::array<lvr2::VertexHandle, 2> vertices = mesh->getVerticesOfEdge(eH);
-        auto vH = vertices[0] == current_vh ? vertices[1] : vertices[0];
+        const lvr2::VertexHandle& vH = neighbours[i];
         if (fixed[vH])
           continue;
         if (invalid[vH])
           continue;
 
-        float tmp_cost = distances[current_vh] + edge_weights[eH];
+        float tmp_cost = distances[current_vh] + edge_weights[edges[i]];
         if (tmp_cost < distances[vH])
         {
           distances[vH] = tmp_cost;
-          pq.insert(vH, tmp_cost);
+          pq->insert(vH, tmp_cost + heuristic(vH));
           predecessors[vH] = current_vh;
         }
       }
-      catch (lvr2::PanicException exception)
-      {
-        continue;
-      }
-      catch (lvr2::VertexLoopException exception)
-      {
-        continue;
-      }
     }
+    queue_stats = pq->statistics();
   }
 
   if (cancel_planning_)
@@ -342,7 +409,7 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
 
   RCLCPP_INFO_STREAM(node_->get_logger(), "The Dijkstra Mesh Planner finished the propagation.");
 
-  if (goal_vertex == predecessors[goal_vertex])
+  if (!predecessors.containsKey(goal_vertex))
   {
     RCLCPP_WARN(node_->get_logger(), "Predecessor of the goal is not set! No path found!");
     return mbf_msgs::action::GetPath::Result::NO_PATH_FOUND;
@@ -376,13 +443,196 @@ uint32_t DijkstraMeshPlanner::dijkstra(const mesh_map::Vector& original_start, c
   const auto path_backtracking_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_path_backtracking - t_propagation_end);
 
   RCLCPP_INFO_STREAM(node_->get_logger(), "Processed " << fixed_set_cnt << " vertices in the fixed set.");
-  RCLCPP_INFO_STREAM(node_->get_logger(), "Initialization duration (ms): " << initialization_duration_ms.count());
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Vertex queue \"" << config_.queue_type << "\": " << queue_stats.inserts
+                                          << " inserts, " << queue_stats.pops << " pops, " << queue_stats.stale
+                                          << " stale entries, max size " << queue_stats.max_size);
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Initialization duration (us): " << initialization_duration_us.count());
   RCLCPP_INFO_STREAM(node_->get_logger(), "Execution time wavefront propagation (ms): " << propagation_duration_ms.count());
   RCLCPP_INFO_STREAM(node_->get_logger(), "Path backtracking duration (ms): " << path_backtracking_duration_ms.count());
 
+  MESH_MAP_DURATION("dijkstra_mesh_planner.initialization", t_propagation_start - t_initialization_start);
+  MESH_MAP_DURATION("dijkstra_mesh_planner.propagation", t_propagation_end - t_propagation_start);
+  MESH_MAP_DURATION("dijkstra_mesh_planner.path_backtracking", t_path_backtracking - t_propagation_end);
+  MESH_MAP_COUNT("dijkstra_mesh_planner.vertices_settled", fixed_set_cnt);
+  MESH_MAP_COUNT("dijkstra_mesh_planner.queue_inserts", queue_stats.inserts);
+  MESH_MAP_COUNT("dijkstra_mesh_planner.queue_pops", queue_stats.pops);
+  MESH_MAP_COUNT("dijkstra_mesh_planner.queue_stale", queue_stats.stale);
+
   RCLCPP_INFO_STREAM(node_->get_logger(), "Successfully finished Dijkstra back tracking!");
   return mbf_msgs::action::GetPath::Result::SUCCESS;
 }
 
+void DijkstraMeshPlanner::bidirectionalDijkstra(const lvr2::VertexHandle& start_vertex,
+                                                const lvr2::VertexHandle& goal_vertex,
+                                                const lvr2::DenseEdgeMap<float>& edge_weights,
+                                                const lvr2::DenseVertexMap<float>& costs,
+                                                mesh_map::StampedVertexMap<float>& distances,
+                                                mesh_map::StampedVertexMap<lvr2::VertexHandle>& predecessors,
+                                                size_t& fixed_set_cnt, mesh_map::VertexQueueStatistics& queue_stats)
+{
+  const auto mesh = mesh_map_->mesh();
+  const auto topology = mesh_map_->topology();
+  const auto& vertex_costs = costs;
+  const auto& invalid = mesh_map_->invalid;
+  const size_t num_vertices = mesh->nextVertexIndex();
+  const float inf = std::numeric_limits<float>::infinity();
+  const float offset = config_.goal_dist_offset;
+
+  // the forward search from the start writes directly into distances and predecessors
+  fixed_.reset(num_vertices);
+  backward_distances_.reset(num_vertices);
+  backward_predecessors_.reset(num_vertices);
+  backward_fixed_.reset(num_vertices);
+  auto& forward_fixed = fixed_;
+  auto& backward_distances = backward_distances_;
+  auto& backward_predecessors = backward_predecessors_;
+  auto& backward_fixed = backward_fixed_;
+  // vertices settled by the backward search in the order of their distance to the goal
+  std::vector<lvr2::VertexHandle> backward_settled;
+
+  const auto forward_pq = mesh_map::createVertexQueue(config_.queue_type, num_vertices);
+  const auto backward_pq = mesh_map::createVertexQueue(config_.queue_type, num_vertices);
+
+  distances[start_vertex] = 0;
+  forward_pq->insert(start_vertex, 0);
+  backward_distances[goal_vertex] = 0;
+  backward_pq->insert(goal_vertex, 0);
+
+  // length of the shortest path found so far and the vertex at which both searches met
+  float best_dist = inf;
+  lvr2::OptionalVertexHandle meeting_vertex;
+
+  // pops and expands the minimum of one search and checks whether it meets the other search
+  auto expand = [&](mesh_map::VertexQueue& pq, mesh_map::StampedVertexMap<float>& dist,
+                    mesh_map::StampedVertexMap<lvr2::VertexHandle>& pred, mesh_map::StampedVertexMap<uint8_t>& fixed,
+                    const mesh_map::StampedVertexMap<float>& other_dist) {
+    const lvr2::VertexHandle current_vh = pq.popMin();
+    fixed[current_vh] = true;
+    fixed_set_cnt++;
+
+    if (vertex_costs[current_vh] > config_.cost_limit)
+      return current_vh;
+
+    const auto edges = topology->edgesOfVertex(current_vh);
+    const auto neighbours = topology->neighboursOfVertex(current_vh);
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+      const lvr2::VertexHandle& vH = neighbours[i];
+      if (fixed[vH] || invalid[vH])
+        continue;
+
+      float tmp_cost = dist[current_vh] + edge_weights[edges[i]];
+      if (tmp_cost < dist[vH])
+      {
+        dist[vH] = tmp_cost;
+        pq.insert(vH, tmp_cost);
+        pred[vH] = current_vh;
+      }
+
+      // vertices above the cost limit are not expanded, a path can only pass them as start or goal
+      const bool passable = vertex_costs[vH] <= config_.cost_limit || vH == start_vertex || vH == goal_vertex;
+      if (passable && dist[vH] + other_dist[vH] < best_dist)
+      {
+        best_dist = dist[vH] + other_dist[vH];
+        meeting_vertex = lvr2::OptionalVertexHandle(vH);
+      }
+    }
+    return current_vh;
+  };
+
+  // expand the search with the smaller radius, the shortest path has been found once both radii cover its length
+  float forward_radius = 0;
+  float backward_radius = 0;
+  while ((!forward_pq->isEmpty() || !backward_pq->isEmpty()) && !cancel_planning_ &&
+         forward_radius + backward_radius < best_dist)
+  {
+    if (backward_pq->isEmpty() || (!forward_pq->isEmpty() && forward_radius <= backward_radius))
+    {
+      forward_radius = distances[expand(*forward_pq, distances, predecessors, forward_fixed, backward_distances)];
+    }
+    else
+    {
+      backward_settled.push_back(
+          expand(*backward_pq, backward_distances, backward_predecessors, backward_fixed, distances));
+      backward_radius = backward_distances[backward_settled.back()];
+    }
+  }
+
+  // the backward search has to cover the goal_dist_offset area around the goal
+  while (!backward_pq->isEmpty() && !cancel_planning_ && backward_radius <= offset)
+  {
+    backward_settled.push_back(
+        expand(*backward_pq, backward_distances, backward_predecessors, backward_fixed, distances));
+    backward_radius = backward_distances[backward_settled.back()];
+  }
+
+  queue_stats.inserts = forward_pq->statistics().inserts + backward_pq->statistics().inserts;
+  queue_stats.pops = forward_pq->statistics().pops + backward_pq->statistics().pops;
+  queue_stats.stale = forward_pq->statistics().stale + backward_pq->statistics().stale;
+  queue_stats.max_size = forward_pq->statistics().max_size + backward_pq->statistics().max_size;
+
+  if (!meeting_vertex || cancel_planning_)
+    return;
+
+  // reverse the backward predecessors along the path, so that the predecessors lead from the goal to the start again
+  lvr2::VertexHandle vH = meeting_vertex.unwrap();
+  const float meeting_dist = distances[vH] + backward_distances[vH];
+  while (vH != goal_vertex)
+  {
+    const lvr2::VertexHandle next = backward_predecessors[vH];
+    distances[next] = meeting_dist - backward_distances[next];
+    predecessors[next] = vH;
+    vH = next;
+  }
+
+  // Complete the forward distances in the goal_dist_offset area around the goal, to provide a full vector field there.
+  // The completion is seeded with all forward distances known in that area and does not leave it.
+  auto in_goal_area = [&](const lvr2::VertexHandle& vH) {
+    return backward_fixed[vH] && backward_distances[vH] <= offset;
+  };
+
+  const auto completion_pq = mesh_map::createVertexQueue(config_.queue_type, num_vertices);
+  completion_fixed_.reset(num_vertices);
+  auto& completion_fixed = completion_fixed_;
+  for (const auto& vH : backward_settled)
+  {
+    if (in_goal_area(vH) && std::isfinite(distances[vH]))
+    {
+      completion_pq->insert(vH, distances[vH]);
+    }
+  }
+
+  while (!completion_pq->isEmpty() && !cancel_planning_)
+  {
+    const lvr2::VertexHandle current_vh = completion_pq->popMin();
+    completion_fixed[current_vh] = true;
+    fixed_set_cnt++;
+
+    if (vertex_costs[current_vh] > config_.cost_limit)
+      continue;
+
+    const auto edges = topology->edgesOfVertex(current_vh);
+    const auto neighbours = topology->neighboursOfVertex(current_vh);
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+      const lvr2::VertexHandle& vH = neighbours[i];
+      if (completion_fixed[vH] || invalid[vH] || !in_goal_area(vH))
+        continue;
+
+      float tmp_cost = distances[current_vh] + edge_weights[edges[i]];
+      if (tmp_cost < distances[vH])
+      {
+        distances[vH] = tmp_cost;
+        completion_pq->insert(vH, tmp_cost);
+        predecessors[vH] = current_vh;
+      }
+    }
+  }
+
+  queue_stats.inserts += completion_pq->statistics().inserts;
+  queue_stats.pops += completion_pq->statistics().pops;
+  queue_stats.stale += completion_pq->statistics().stale;
+}
+
 } /* namespace dijkstra_mesh_planner */
 
@@ -87,6 +87,19 @@ public:
    */
   virtual bool initialize(const std::string& name, const std::shared_ptr<mesh_map::MeshMap>& mesh_map_ptr, const rclcpp::Node::SharedPtr& node) = 0;
 
+  /**
+   * @brief Creates a planning context for concurrent queries, e.g. to plan the routes of a fleet. The context plans
+   *        with the current configuration of this planner against the given costs, but keeps its own per-query state
+   *        and neither publishes its plans nor hands its vector fields over to the controller. Contexts plan in
+   *        parallel to each other and to this planner, each context one query at a time.
+   * @param costs The cost snapshot which all queries of the context are planned against
+   * @return The context, or an empty pointer if the planner does not support concurrent queries
+   */
+  virtual Ptr createContext(const mesh_map::CostSnapshot::ConstPtr& costs)
+  {
+    return Ptr();
+  }
+
 protected:
   MeshPlanner() {};
 };
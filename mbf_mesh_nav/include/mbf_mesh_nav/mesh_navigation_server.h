@@ -46,8 +46,10 @@
 #include "mesh_planner_execution.h"
 #include "mesh_recovery_execution.h"
 
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <mbf_msgs/srv/check_path.hpp>
 #include <mbf_msgs/srv/check_pose.hpp>
+#include <mesh_navigation_msgs/srv/plan_paths.hpp>
 #include <std_srvs/srv/empty.hpp>
 #include <rclcpp/rclcpp.hpp>
 
@@ -183,6 +185,25 @@ private:
    */
   void callServiceCheckPathCost(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<mbf_msgs::srv::CheckPath::Request> request, std::shared_ptr<mbf_msgs::srv::CheckPath::Response> response);
 
+  /**
+   * @brief Transforms the poses into the map frame and evaluates the costs of the footprint at each pose in one batch
+   * @param poses The poses to check
+   * @param footprint_radius Radius of the footprint to check
+   * @param max_dist Maximum distance of a pose or footprint sample to the mesh surface
+   * @param results The footprint cost at each pose
+   * @return false if the poses could not be transformed into the map frame
+   */
+  bool queryPoseCosts(const std::vector<geometry_msgs::msg::PoseStamped>& poses, const float footprint_radius,
+                      const float max_dist, std::vector<mesh_map::PoseCost>& results);
+
+  /**
+   * @brief Callback method for the plan_paths service. The pairs are planned in parallel by concurrent contexts of the
+   * requested planner against one snapshot of the costs, the pairs with the same goal by the same context.
+   * @param request Request object, see the mesh_navigation_msgs/srv/PlanPaths service definition file.
+   * @param response Response object, see the mesh_navigation_msgs/srv/PlanPaths service definition file.
+   */
+  void callServicePlanPaths(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<mesh_navigation_msgs::srv::PlanPaths::Request> request, std::shared_ptr<mesh_navigation_msgs::srv::PlanPaths::Response> response);
+
   /**
    * @brief Callback method for the make_plan service
    * @param request Empty request object.
@@ -190,6 +211,11 @@ private:
    */
   void callServiceClearMesh(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<std_srvs::srv::Empty::Request> request, std::shared_ptr<std_srvs::srv::Empty::Response> response);
 
+  /**
+   * @brief Publishes the histograms of all timers and counters of the navigation stack recorded since the start
+   */
+  void publishMetrics();
+
   //! plugin class loader for recovery behaviors plugins
   pluginlib::ClassLoader<mbf_mesh_core::MeshRecovery> recovery_plugin_loader_;
   pluginlib::ClassLoader<mbf_simple_core::SimpleRecovery> simple_recovery_plugin_loader_;
@@ -214,6 +240,21 @@ private:
   //! Service Server for the check_path_cost service
   rclcpp::Service<mbf_msgs::srv::CheckPath>::SharedPtr check_path_cost_srv_;
 
+  //! Service Server for the plan_paths service
+  rclcpp::Service<mesh_navigation_msgs::srv::PlanPaths>::SharedPtr plan_paths_srv_;
+
+  //! radius of the robot footprint used by the cost check services
+  double footprint_radius_;
+
+  //! maximum distance of the poses checked by the cost check services to the mesh surface
+  double max_surface_dist_;
+
+  //! publishes the aggregated metrics as diagnostic status per timer and counter
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr metrics_pub_;
+
+  //! triggers publishMetrics()
+  rclcpp::TimerBase::SharedPtr metrics_timer_;
+
   //! Start/stop meshs mutex; concurrent calls to start can lead to segfault
   std::mutex check_meshs_mutex_;
 };
@@ -63,10 +63,11 @@ uint32_t MeshControllerExecution::computeVelocityCmd(const geometry_msgs::msg::P
   // responsibility to the planner itself
   if (lock_mesh_)
   {
-    // TODO
-    // boost::lock_guard<mesh::Mesh::mutex_t> lock(*(mesh_ptr_->getMutex()));
-    // return controller_->computeVelocityCommands(robot_pose, robot_velocity,
-    // vel_cmd, message);
+    // the costs are only locked exclusively while the changed values are written, not while layers compute them
+    const auto lock = mesh_ptr_->sharedLock();
+    // pins the snapshot of the locked costs, so that a controller reading costSnapshot() does not lock them again
+    mesh_ptr_->costSnapshot(lock);
+    return controller_->computeVelocityCommands(robot_pose, robot_velocity, vel_cmd, message);
   }
   return controller_->computeVelocityCommands(robot_pose, robot_velocity, vel_cmd, message);
 }
@@ -38,14 +38,56 @@
 #include "mbf_mesh_nav/mesh_navigation_server.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
 
 #include <geometry_msgs/msg/pose_array.hpp>
+#include <mbf_msgs/action/get_path.hpp>
+#include <mbf_utility/navigation_utility.h>
+#include <mesh_map/instrumentation.h>
 #include <mesh_map/mesh_map.h>
 #include <nav_msgs/msg/path.hpp>
 #include <rclcpp/logging.hpp>
 
 namespace {
+//! the layer costs are normalized to [0, 1], the footprint costs are scaled to fit the integer costs of the services
+const float COST_SCALE = 100.0;
+
+//! Converts the state of a footprint cost query to the state of the check services, which share the same values
+uint8_t toCheckState(const mesh_map::PoseCost::State state)
+{
+  switch (state)
+  {
+    case mesh_map::PoseCost::FREE:
+      return mbf_msgs::srv::CheckPose::Response::FREE;
+    case mesh_map::PoseCost::LETHAL:
+      return mbf_msgs::srv::CheckPose::Response::LETHAL;
+    case mesh_map::PoseCost::UNKNOWN:
+      return mbf_msgs::srv::CheckPose::Response::UNKNOWN;
+    default:
+      return mbf_msgs::srv::CheckPose::Response::OUTSIDE;
+  }
+}
+
+//! Applies the cost multipliers of the check services, which are ignored if zero, and scales the cost
+template <typename RequestT>
+uint32_t toCheckCost(const mesh_map::PoseCost& result, const RequestT& request)
+{
+  float cost = result.cost;
+  if (request.lethal_cost_mult > 0)
+    cost += request.lethal_cost_mult * result.num_lethal;
+  if (request.unknown_cost_mult > 0)
+    cost += request.unknown_cost_mult * result.num_unknown;
+  return static_cast<uint32_t>(std::round(cost * COST_SCALE));
+}
+
 //! Helper function, intended for formatting available plugin types.
 //! Returns a string like this: [el1, el2, el3, ..., eln]
 std::string stringVectorToString(const std::vector<std::string>& vec) 
@@ -144,8 +186,66 @@ MeshNavigationServer::MeshNavigationServer(const TFPtr& tf_listener_ptr, const r
       node_->create_service<mbf_msgs::srv::CheckPose>("~/check_pose_cost", std::bind(&MeshNavigationServer::callServiceCheckPoseCost, this, _1, _2, _3));
   check_path_cost_srv_ =
       node_->create_service<mbf_msgs::srv::CheckPath>("~/check_path_cost", std::bind(&MeshNavigationServer::callServiceCheckPathCost, this, _1, _2, _3));
+  plan_paths_srv_ =
+      node_->create_service<mesh_navigation_msgs::srv::PlanPaths>("~/plan_paths", std::bind(&MeshNavigationServer::callServicePlanPaths, this, _1, _2, _3));
   clear_mesh_srv_ = node_->create_service<std_srvs::srv::Empty>("~/clear_mesh", std::bind(&MeshNavigationServer::callServiceClearMesh, this, _1, _2, _3));
 
+  auto footprint_radius_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  footprint_radius_desc.name = "footprint_radius";
+  footprint_radius_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  footprint_radius_desc.description = "Radius of the robot footprint, which is sampled by the check_pose_cost and "
+                                      "check_path_cost services.";
+  footprint_radius_ = node_->declare_parameter(footprint_radius_desc.name, 0.3, footprint_radius_desc);
+
+  auto max_surface_dist_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  max_surface_dist_desc.name = "max_surface_dist";
+  max_surface_dist_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  max_surface_dist_desc.description = "Maximum distance of a pose or footprint sample checked by the check_pose_cost "
+                                      "and check_path_cost services to the mesh surface.";
+  max_surface_dist_ = node_->declare_parameter(max_surface_dist_desc.name, 0.4, max_surface_dist_desc);
+
+  auto metrics_enabled_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  metrics_enabled_desc.name = "metrics.enabled";
+  metrics_enabled_desc.type = rclcpp::ParameterType::PARAMETER_BOOL;
+  metrics_enabled_desc.description = "Records the timers and counters of the map, the planners and the controllers, "
+                                     "and publishes their histograms on the metrics topic.";
+  metrics_enabled_desc.read_only = true;
+  const bool metrics_enabled = node_->declare_parameter(metrics_enabled_desc.name, false, metrics_enabled_desc);
+
+  auto metrics_publish_rate_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  metrics_publish_rate_desc.name = "metrics.publish_rate";
+  metrics_publish_rate_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  metrics_publish_rate_desc.description = "Rate in Hz at which the metrics are published.";
+  metrics_publish_rate_desc.read_only = true;
+  const double metrics_publish_rate =
+      node_->declare_parameter(metrics_publish_rate_desc.name, 1.0, metrics_publish_rate_desc);
+
+  auto metrics_trace_file_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  metrics_trace_file_desc.name = "metrics.trace_file";
+  metrics_trace_file_desc.type = rclcpp::ParameterType::PARAMETER_STRING;
+  metrics_trace_file_desc.description = "If set, the timers and counters are also written as trace events in the "
+                                        "Chrome JSON trace format to this file, which can be opened with Perfetto.";
+  metrics_trace_file_desc.read_only = true;
+  const std::string metrics_trace_file =
+      node_->declare_parameter(metrics_trace_file_desc.name, std::string(), metrics_trace_file_desc);
+
+  // enabled before the map is read, to time the map loading as well
+  auto& instrumentation = mesh_map::Instrumentation::instance();
+  instrumentation.setEnabled(metrics_enabled);
+  if (metrics_enabled)
+  {
+    if (!metrics_trace_file.empty() && !instrumentation.startTrace(metrics_trace_file))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not open the trace file \"" << metrics_trace_file << "\"!");
+    }
+    metrics_pub_ = node_->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("~/metrics", 1);
+    if (metrics_publish_rate > 0)
+    {
+      metrics_timer_ = node_->create_wall_timer(std::chrono::duration<double>(1.0 / metrics_publish_rate),
+                                                std::bind(&MeshNavigationServer::publishMetrics, this));
+    }
+  }
+
   RCLCPP_INFO_STREAM(node_->get_logger(), "Reading map file...");
   mesh_ptr_->readMap();
 
@@ -310,16 +410,272 @@ void MeshNavigationServer::stop()
 
 MeshNavigationServer::~MeshNavigationServer()
 {
+  // completes the trace file, if there is one
+  mesh_map::Instrumentation::instance().stopTrace();
+}
+
+bool MeshNavigationServer::queryPoseCosts(const std::vector<geometry_msgs::msg::PoseStamped>& poses,
+                                          const float footprint_radius, const float max_dist,
+                                          std::vector<mesh_map::PoseCost>& results)
+{
+  const std::string& map_frame = mesh_ptr_->mapFrame();
+  std::vector<mesh_map::Vector> positions;
+  positions.reserve(poses.size());
+  geometry_msgs::msg::PoseStamped map_pose;
+  for (const auto& pose : poses)
+  {
+    if (pose.header.frame_id.empty() || pose.header.frame_id == map_frame)
+    {
+      positions.push_back(mesh_map::toVector(pose.pose.position));
+    }
+    else if (mbf_utility::transformPose(node_, *tf_listener_ptr_, map_frame, robot_info_->getTfTimeout(), pose, map_pose))
+    {
+      positions.push_back(mesh_map::toVector(map_pose.pose.position));
+    }
+    else
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not transform the pose from \"" << pose.header.frame_id
+                                                   << "\" to the map frame \"" << map_frame << "\"!");
+      return false;
+    }
+  }
+  mesh_ptr_->queryCosts(positions, footprint_radius, max_dist, results);
+  return true;
 }
 
 void MeshNavigationServer::callServiceCheckPoseCost(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<mbf_msgs::srv::CheckPose::Request> request, std::shared_ptr<mbf_msgs::srv::CheckPose::Response> response)
 {
-  // TODO implement
+  geometry_msgs::msg::PoseStamped pose = request->pose;
+  if (request->current_pose && !robot_info_->getRobotPose(pose))
+  {
+    RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not get the current robot pose!");
+    response->state = mbf_msgs::srv::CheckPose::Response::UNKNOWN;
+    return;
+  }
+
+  // meshes have no inscribed area, thus the inscribed cost multiplier is not used
+  std::vector<mesh_map::PoseCost> results;
+  if (!queryPoseCosts({ pose }, footprint_radius_ + request->safety_dist, max_surface_dist_, results))
+  {
+    response->state = mbf_msgs::srv::CheckPose::Response::UNKNOWN;
+    return;
+  }
+  response->state = toCheckState(results.front().state);
+  response->cost = toCheckCost(results.front(), *request);
 }
 
 void MeshNavigationServer::callServiceCheckPathCost(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<mbf_msgs::srv::CheckPath::Request> request, std::shared_ptr<mbf_msgs::srv::CheckPath::Response> response)
 {
-  // TODO implement
+  const auto& path = request->path.poses;
+  response->state = mbf_msgs::srv::CheckPath::Response::FREE;
+  response->cost = 0;
+  response->last_checked = 0;
+  if (path.empty())
+  {
+    return;
+  }
+
+  // the poses are checked in one batch, the skipped ones are not evaluated at all
+  std::vector<geometry_msgs::msg::PoseStamped> poses;
+  std::vector<uint32_t> indices;
+  for (size_t i = 0; i < path.size(); i += request->skip_poses + 1)
+  {
+    geometry_msgs::msg::PoseStamped pose = path[i];
+    if (pose.header.frame_id.empty())
+    {
+      pose.header = request->path.header;
+    }
+    poses.push_back(pose);
+    indices.push_back(i);
+  }
+
+  const float footprint_radius = request->path_cells_only ? 0.0 : footprint_radius_ + request->safety_dist;
+  std::vector<mesh_map::PoseCost> results;
+  if (!queryPoseCosts(poses, footprint_radius, max_surface_dist_, results))
+  {
+    response->state = mbf_msgs::srv::CheckPath::Response::UNKNOWN;
+    return;
+  }
+
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const uint8_t state = toCheckState(results[i].state);
+    response->state = std::max(response->state, state);
+    response->cost += toCheckCost(results[i], *request);
+    response->last_checked = indices[i];
+    if (request->return_on > 0 && state >= request->return_on)
+    {
+      break;
+    }
+  }
+}
+
+void MeshNavigationServer::callServicePlanPaths(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<mesh_navigation_msgs::srv::PlanPaths::Request> request, std::shared_ptr<mesh_navigation_msgs::srv::PlanPaths::Response> response)
+{
+  MESH_MAP_SCOPED_TIMER("mbf_mesh_nav.plan_paths");
+  typedef mbf_msgs::action::GetPath::Result GetPathResult;
+  const size_t num_paths = request->starts.size();
+  response->outcomes.assign(num_paths, GetPathResult::INTERNAL_ERROR);
+  response->messages.assign(num_paths, std::string());
+  response->paths.resize(num_paths);
+  response->costs.assign(num_paths, 0);
+  const auto fail = [&](const uint32_t outcome, const std::string& message) {
+    RCLCPP_ERROR_STREAM(node_->get_logger(), "plan_paths: " << message);
+    response->outcomes.assign(num_paths, outcome);
+    response->messages.assign(num_paths, message);
+  };
+
+  if (request->goals.size() != num_paths)
+  {
+    fail(GetPathResult::INVALID_GOAL, "The number of goals does not match the number of starts!");
+    return;
+  }
+
+  const auto& planner_names = planner_plugin_manager_.getLoadedNames();
+  const std::string planner_name =
+      request->planner.empty() && !planner_names.empty() ? planner_names.front() : request->planner;
+  if (!planner_plugin_manager_.hasPlugin(planner_name))
+  {
+    fail(GetPathResult::INVALID_PLUGIN, "No planner loaded with the name \"" + planner_name + "\"!");
+    return;
+  }
+  const auto planner =
+      std::dynamic_pointer_cast<mbf_mesh_core::MeshPlanner>(planner_plugin_manager_.getPlugin(planner_name));
+
+  // all contexts plan against the same costs, the layers keep updating the map meanwhile
+  const auto costs = mesh_ptr_->costSnapshot();
+  response->cost_revision = costs->revision;
+  std::vector<mbf_mesh_core::MeshPlanner::Ptr> contexts;
+  if (const auto context = planner ? planner->createContext(costs) : mbf_mesh_core::MeshPlanner::Ptr())
+  {
+    contexts.push_back(context);
+  }
+  else
+  {
+    fail(GetPathResult::INVALID_PLUGIN, "The planner \"" + planner_name + "\" does not support concurrent queries!");
+    return;
+  }
+
+  const std::string& map_frame = mesh_ptr_->mapFrame();
+  const auto toMapFrame = [&](geometry_msgs::msg::PoseStamped& pose) {
+    if (pose.header.frame_id.empty() || pose.header.frame_id == map_frame)
+    {
+      pose.header.frame_id = map_frame;
+      return true;
+    }
+    geometry_msgs::msg::PoseStamped map_pose;
+    if (!mbf_utility::transformPose(node_, *tf_listener_ptr_, map_frame, robot_info_->getTfTimeout(), pose, map_pose))
+    {
+      return false;
+    }
+    pose = map_pose;
+    return true;
+  };
+
+  // the pairs with the same goal are planned one after another, the context can reuse the wave front of the goal then
+  std::vector<geometry_msgs::msg::PoseStamped> starts = request->starts;
+  std::vector<geometry_msgs::msg::PoseStamped> goals = request->goals;
+  std::vector<std::vector<size_t>> groups;
+  std::map<std::array<double, 3>, size_t> group_of_goal;
+  for (size_t i = 0; i < num_paths; i++)
+  {
+    if (!toMapFrame(starts[i]) || !toMapFrame(goals[i]))
+    {
+      response->outcomes[i] = GetPathResult::TF_ERROR;
+      response->messages[i] = "Could not transform the start or goal pose to the map frame \"" + map_frame + "\"!";
+      continue;
+    }
+    const auto& position = goals[i].pose.position;
+    const auto group = group_of_goal.emplace(std::array<double, 3>{ position.x, position.y, position.z }, groups.size());
+    if (group.second)
+    {
+      groups.emplace_back();
+    }
+    groups[group.first->second].push_back(i);
+  }
+
+  const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t num_threads =
+      std::min(groups.size(), request->concurrency > 0 ? static_cast<size_t>(request->concurrency) : hardware_threads);
+  while (contexts.size() < num_threads)
+  {
+    contexts.push_back(planner->createContext(costs));
+  }
+
+  std::atomic<size_t> next(0);
+  auto worker = [&](const mbf_mesh_core::MeshPlanner::Ptr& context) {
+    for (size_t g = next++; g < groups.size(); g = next++)
+    {
+      for (const size_t i : groups[g])
+      {
+        std::vector<geometry_msgs::msg::PoseStamped> plan;
+        double cost = 0;
+        try
+        {
+          response->outcomes[i] = context->makePlan(starts[i], goals[i], 0, plan, cost, response->messages[i]);
+        }
+        catch (const std::exception& exception)
+        {
+          response->outcomes[i] = GetPathResult::INTERNAL_ERROR;
+          response->messages[i] = exception.what();
+        }
+        response->paths[i].header.frame_id = map_frame;
+        response->paths[i].header.stamp = node_->now();
+        response->paths[i].poses = std::move(plan);
+        response->costs[i] = cost;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; i++)
+  {
+    workers.emplace_back(worker, contexts[i]);
+  }
+  worker(contexts.front());
+  for (auto& thread : workers)
+  {
+    thread.join();
+  }
+
+  const size_t num_succeeded = std::count(response->outcomes.begin(), response->outcomes.end(), GetPathResult::SUCCESS);
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Planned " << num_succeeded << " of " << num_paths << " paths to "
+                                          << groups.size() << " goals on " << num_threads << " threads.");
+}
+
+void MeshNavigationServer::publishMetrics()
+{
+  auto toString = [](const double value) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << value;
+    return stream.str();
+  };
+  auto keyValue = [](const std::string& key, const std::string& value) {
+    diagnostic_msgs::msg::KeyValue key_value;
+    key_value.key = key;
+    key_value.value = value;
+    return key_value;
+  };
+
+  diagnostic_msgs::msg::DiagnosticArray metrics;
+  metrics.header.stamp = node_->now();
+  for (const auto& summary : mesh_map::Instrumentation::instance().summaries())
+  {
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = summary.name;
+    status.hardware_id = node_->get_fully_qualified_name();
+    status.message = summary.unit.empty() ? "counter" : "timer [" + summary.unit + "]";
+    status.values.push_back(keyValue("count", std::to_string(summary.count)));
+    status.values.push_back(keyValue("mean", toString(summary.mean())));
+    status.values.push_back(keyValue("min", std::to_string(summary.min)));
+    status.values.push_back(keyValue("p50", toString(summary.percentile(0.5))));
+    status.values.push_back(keyValue("p90", toString(summary.percentile(0.9))));
+    status.values.push_back(keyValue("p99", toString(summary.percentile(0.99))));
+    status.values.push_back(keyValue("max", std::to_string(summary.max)));
+    metrics.status.push_back(status);
+  }
+  metrics_pub_->publish(metrics);
 }
 
 void MeshNavigationServer::callServiceClearMesh(std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<std_srvs::srv::Empty::Request> request, std::shared_ptr<std_srvs::srv::Empty::Response> response)
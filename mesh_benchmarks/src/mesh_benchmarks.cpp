@@ -0,0 +1,623 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <geometry_msgs/msg/pose_stamped.hpp>
+#include <geometry_msgs/msg/twist_stamped.hpp>
+#include <lvr2/algorithm/GeometryAlgorithms.hpp>
+#include <lvr2/algorithm/NormalAlgorithms.hpp>
+#include <lvr2/io/deprecated/hdf5/MeshIO.hpp>
+#include <lvr2/types/MeshBuffer.hpp>
+#include <mbf_mesh_core/mesh_controller.h>
+#include <mbf_mesh_core/mesh_planner.h>
+#include <mbf_msgs/action/get_path.hpp>
+#include <mesh_map/mesh_map.h>
+#include <mesh_map/mesh_topology.h>
+#include <pluginlib/class_loader.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <tf2_ros/buffer.h>
+
+namespace fs = std::filesystem;
+
+using HDF5MeshIO = lvr2::Hdf5Build<lvr2::hdf5features::MeshIO>;
+
+namespace
+{
+
+//! a mesh part of a map file the benchmarks run on
+struct ReferenceMesh
+{
+  std::string name;
+  std::string file;
+  std::string part;
+};
+
+//! a start and goal position given as fractions of the x-y bounding box of the mesh
+struct PlanPair
+{
+  std::string name;
+  std::array<float, 2> start;
+  std::array<float, 2> goal;
+};
+
+//! a planner plugin and the parameters which distinguish the benchmarked configuration
+struct PlannerConfig
+{
+  std::string name;
+  std::string type;
+  std::vector<std::pair<std::string, std::string>> parameters;
+};
+
+//! the layer stack of the benchmark maps, i.e. all layers of mesh_layers which do not need sensor input
+const std::vector<std::pair<std::string, std::string>> LAYERS = {
+  { "border", "mesh_layers/BorderLayer" },       { "height_diff", "mesh_layers/HeightDiffLayer" },
+  { "roughness", "mesh_layers/RoughnessLayer" }, { "steepness", "mesh_layers/SteepnessLayer" },
+  { "ridge", "mesh_layers/RidgeLayer" },         { "inflation", "mesh_layers/InflationLayer" },
+};
+
+const std::vector<PlannerConfig> PLANNERS = {
+  { "cvp", "cvp_mesh_planner/CVPMeshPlanner", {} },
+  { "cvp_fim", "cvp_mesh_planner/CVPMeshPlanner", { { "propagation_method", "fast_iterative" } } },
+  { "dijkstra", "dijkstra_mesh_planner/DijkstraMeshPlanner", {} },
+};
+
+//! the first pair has to pass the gap of the wall of the synthetic terrain, the second one crosses the whole map
+const std::vector<PlanPair> PLAN_PAIRS = {
+  { "around_wall", { 0.2f, 0.3f }, { 0.8f, 0.3f } },
+  { "diagonal", { 0.1f, 0.9f }, { 0.9f, 0.1f } },
+};
+
+const std::string CONTROLLER_TYPE = "mesh_controller/MeshController";
+const float SYNTHETIC_RESOLUTION = 0.1;
+
+//! directory for the synthetic meshes and the working files, the input files of real meshes are never written
+fs::path data_dir = fs::temp_directory_path() / "mesh_benchmarks";
+
+/**
+ * @brief Writes a wavy terrain of cells x cells squares to a map file. A steep wall across 70% of the terrain forces
+ *        the planners to take a detour through the remaining gap.
+ */
+void writeTerrain(const fs::path& file, const std::string& part, const size_t cells)
+{
+  const size_t row = cells + 1;
+  const float length = cells * SYNTHETIC_RESOLUTION;
+  lvr2::floatArr vertices(new float[3 * row * row]);
+  for (size_t y = 0; y < row; y++)
+  {
+    for (size_t x = 0; x < row; x++)
+    {
+      const float px = x * SYNTHETIC_RESOLUTION, py = y * SYNTHETIC_RESOLUTION;
+      const bool wall = std::abs(px - 0.5f * length) < 0.05f * length && py < 0.7f * length;
+      float* vertex = vertices.get() + 3 * (y * row + x);
+      vertex[0] = px;
+      vertex[1] = py;
+      vertex[2] = 0.2f * std::sin(0.7f * px) * std::cos(0.5f * py) + (wall ? 0.8f : 0.0f);
+    }
+  }
+
+  lvr2::indexArray faces(new unsigned int[6 * cells * cells]);
+  unsigned int* face = faces.get();
+  for (size_t y = 0; y < cells; y++)
+  {
+    for (size_t x = 0; x < cells; x++)
+    {
+      const unsigned int v = y * row + x;
+      const unsigned int up = v + row;
+      const unsigned int corners[6] = { v, v + 1, up + 1, v, up + 1, up };
+      face = std::copy(corners, corners + 6, face);
+    }
+  }
+
+  auto buffer = std::make_shared<lvr2::MeshBuffer>();
+  buffer->setVertices(vertices, row * row);
+  buffer->setFaceIndices(faces, 2 * cells * cells);
+
+  fs::remove(file);
+  HDF5MeshIO hdf5_mesh_io;
+  hdf5_mesh_io.open(file.string());
+  hdf5_mesh_io.setMeshName(part);
+  hdf5_mesh_io.save(part, buffer);
+}
+
+fs::path workingFile(const ReferenceMesh& mesh)
+{
+  return data_dir / (mesh.name + "_working.h5");
+}
+
+/**
+ * @brief Node options of a benchmark map, the node is never spun and does not offer parameter services
+ */
+rclcpp::NodeOptions mapOptions(const ReferenceMesh& mesh, const bool mmap_loading)
+{
+  std::vector<std::string> layer_names;
+  rclcpp::NodeOptions options;
+  options.start_parameter_services(false);
+  options.start_parameter_event_publisher(false);
+  options.append_parameter_override("mesh_map.mesh_file", mesh.file);
+  options.append_parameter_override("mesh_map.mesh_part", mesh.part);
+  options.append_parameter_override("mesh_map.mesh_working_file", workingFile(mesh).string());
+  options.append_parameter_override("mesh_map.mesh_working_part", mesh.part);
+  options.append_parameter_override("mesh_map.mmap_loading", mmap_loading);
+  for (const auto& layer : LAYERS)
+  {
+    layer_names.push_back(layer.first);
+    options.append_parameter_override("mesh_map." + layer.first + ".type", layer.second);
+  }
+  options.append_parameter_override("mesh_map.layers", layer_names);
+  for (const auto& planner : PLANNERS)
+  {
+    for (const auto& parameter : planner.parameters)
+    {
+      options.append_parameter_override(planner.name + "." + parameter.first, parameter.second);
+    }
+  }
+  return options;
+}
+
+/**
+ * @brief A loaded map and the plugins planning on it, shared by all benchmarks of one reference mesh
+ */
+struct MapContext
+{
+  rclcpp::Node::SharedPtr node;
+  std::shared_ptr<tf2_ros::Buffer> tf_buffer;
+  std::shared_ptr<mesh_map::MeshMap> mesh_map;
+
+  std::map<std::string, mbf_mesh_core::MeshPlanner::Ptr> planners;
+  mbf_mesh_core::MeshController::Ptr controller;
+
+  //! creates a map for the given mesh, readMap() has not been called yet
+  MapContext(const ReferenceMesh& mesh, const bool mmap_loading = false)
+  {
+    node = std::make_shared<rclcpp::Node>("mesh_benchmark", mapOptions(mesh, mmap_loading));
+    tf_buffer = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+    mesh_map = std::make_shared<mesh_map::MeshMap>(*tf_buffer, node);
+  }
+
+  geometry_msgs::msg::PoseStamped pose(const mesh_map::Vector& position) const
+  {
+    geometry_msgs::msg::PoseStamped pose;
+    pose.header.frame_id = mesh_map->mapFrame();
+    pose.header.stamp = node->now();
+    pose.pose.position.x = position.x;
+    pose.pose.position.y = position.y;
+    pose.pose.position.z = position.z;
+    pose.pose.orientation.w = 1;
+    return pose;
+  }
+
+  //! the mesh vertex closest to the given fractions of the x-y bounding box, which keeps real meshes usable as well
+  geometry_msgs::msg::PoseStamped poseAt(const std::array<float, 2>& fraction) const
+  {
+    const auto mesh = mesh_map->mesh();
+    mesh_map::Vector min(INFINITY, INFINITY, INFINITY), max(-INFINITY, -INFINITY, -INFINITY);
+    for (const auto vH : mesh->vertices())
+    {
+      const auto& p = mesh->getVertexPosition(vH);
+      min = mesh_map::Vector(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+      max = mesh_map::Vector(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    const float x = min.x + fraction[0] * (max.x - min.x);
+    const float y = min.y + fraction[1] * (max.y - min.y);
+
+    mesh_map::Vector closest;
+    float closest_distance = INFINITY;
+    for (const auto vH : mesh->vertices())
+    {
+      const auto& p = mesh->getVertexPosition(vH);
+      const float distance = (p.x - x) * (p.x - x) + (p.y - y) * (p.y - y);
+      if (distance < closest_distance && !mesh_map->invalid[vH])
+      {
+        closest_distance = distance;
+        closest = p;
+      }
+    }
+    return pose(closest);
+  }
+};
+
+std::vector<ReferenceMesh> reference_meshes;
+std::map<std::string, std::shared_ptr<MapContext>> map_contexts;
+std::unique_ptr<pluginlib::ClassLoader<mbf_mesh_core::MeshPlanner>> planner_loader;
+std::unique_ptr<pluginlib::ClassLoader<mbf_mesh_core::MeshController>> controller_loader;
+
+/**
+ * @brief Returns the loaded map of the mesh with the planners and the controller, it is loaded once on first use
+ */
+std::shared_ptr<MapContext> mapContext(const ReferenceMesh& mesh)
+{
+  auto& context = map_contexts[mesh.name];
+  if (context)
+  {
+    return context;
+  }
+
+  context = std::make_shared<MapContext>(mesh);
+  if (!context->mesh_map->readMap())
+  {
+    throw std::runtime_error("Could not load the map of \"" + mesh.name + "\"");
+  }
+  for (const auto& config : PLANNERS)
+  {
+    auto planner = planner_loader->createSharedInstance(config.type);
+    if (!planner->initialize(config.name, context->mesh_map, context->node))
+    {
+      throw std::runtime_error("Could not initialize the planner \"" + config.name + "\"");
+    }
+    context->planners[config.name] = planner;
+  }
+  context->controller = controller_loader->createSharedInstance(CONTROLLER_TYPE);
+  if (!context->controller->initialize("controller", context->tf_buffer, context->mesh_map, context->node))
+  {
+    throw std::runtime_error("Could not initialize the controller");
+  }
+  return context;
+}
+
+void setMeshCounters(benchmark::State& state, mesh_map::MeshMap& map)
+{
+  state.counters["vertices"] = map.mesh()->numVertices();
+  state.counters["faces"] = map.mesh()->numFaces();
+}
+
+//! readMap() of a newly imported mesh, which also writes the working file
+void readMapImport(benchmark::State& state, const ReferenceMesh& mesh)
+{
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    map_contexts.erase(mesh.name);
+    fs::remove(workingFile(mesh));
+    auto context = std::make_unique<MapContext>(mesh);
+    state.ResumeTiming();
+
+    if (!context->mesh_map->readMap())
+    {
+      state.SkipWithError("readMap failed");
+      break;
+    }
+
+    state.PauseTiming();
+    setMeshCounters(state, *context->mesh_map);
+    // the destructor waits for the pending writes to the working file
+    context.reset();
+    state.ResumeTiming();
+  }
+}
+
+//! readMap() from an existing working file, which reuses the attributes stored in it
+void readMapWorkingFile(benchmark::State& state, const ReferenceMesh& mesh, const bool mmap_loading)
+{
+  // the map file is not opened twice, the first load creates the working file
+  map_contexts.erase(mesh.name);
+  if (!fs::exists(workingFile(mesh)))
+  {
+    MapContext(mesh).mesh_map->readMap();
+  }
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto context = std::make_unique<MapContext>(mesh, mmap_loading);
+    state.ResumeTiming();
+
+    if (!context->mesh_map->readMap())
+    {
+      state.SkipWithError("readMap failed");
+      break;
+    }
+
+    state.PauseTiming();
+    setMeshCounters(state, *context->mesh_map);
+    context.reset();
+    state.ResumeTiming();
+  }
+}
+
+//! the phases of readMap() which are recomputed whenever the working file does not store their results
+void readMapPhase(benchmark::State& state, const ReferenceMesh& mesh, const std::string& phase)
+{
+  const auto context = mapContext(mesh);
+  auto& map = *context->mesh_map;
+  const auto& hem = *map.mesh();
+  for (auto _ : state)
+  {
+    if (phase == "topology")
+    {
+      mesh_map::MeshTopology topology(hem);
+      benchmark::DoNotOptimize(topology.numBrokenVertices());
+    }
+    else if (phase == "face_normals")
+    {
+      auto face_normals = lvr2::calcFaceNormals(hem);
+      benchmark::DoNotOptimize(face_normals.numValues());
+    }
+    else if (phase == "vertex_normals")
+    {
+      auto vertex_normals = lvr2::calcVertexNormals(hem, context->mesh_map->faceNormals());
+      benchmark::DoNotOptimize(vertex_normals.numValues());
+    }
+    else if (phase == "edge_distances")
+    {
+      auto edge_distances = lvr2::calcVertexDistances(hem);
+      benchmark::DoNotOptimize(edge_distances.numValues());
+    }
+  }
+  setMeshCounters(state, map);
+}
+
+void computeLayer(benchmark::State& state, const ReferenceMesh& mesh, const std::string& layer_name)
+{
+  const auto context = mapContext(mesh);
+  const auto layer = context->mesh_map->layer(layer_name);
+  for (auto _ : state)
+  {
+    if (!layer->computeLayer())
+    {
+      state.SkipWithError("computeLayer failed");
+      break;
+    }
+  }
+  state.counters["lethals"] = layer->lethals().size();
+  setMeshCounters(state, *context->mesh_map);
+}
+
+//! propagates a change of the layer through the layer stack and the combined costs
+void layerChanged(benchmark::State& state, const ReferenceMesh& mesh, const std::string& layer_name)
+{
+  const auto context = mapContext(mesh);
+  for (auto _ : state)
+  {
+    context->mesh_map->layerChanged(layer_name);
+  }
+  setMeshCounters(state, *context->mesh_map);
+}
+
+void combineVertexCosts(benchmark::State& state, const ReferenceMesh& mesh)
+{
+  const auto context = mapContext(mesh);
+  const auto stamp = context->node->now();
+  for (auto _ : state)
+  {
+    context->mesh_map->combineVertexCosts(stamp);
+  }
+  setMeshCounters(state, *context->mesh_map);
+}
+
+void makePlan(benchmark::State& state, const ReferenceMesh& mesh, const std::string& planner_name,
+              const PlanPair& pair)
+{
+  const auto context = mapContext(mesh);
+  const auto planner = context->planners.at(planner_name);
+  const auto start = context->poseAt(pair.start);
+  const auto goal = context->poseAt(pair.goal);
+
+  std::vector<geometry_msgs::msg::PoseStamped> plan;
+  double cost = 0;
+  std::string message;
+  for (auto _ : state)
+  {
+    plan.clear();
+    const uint32_t outcome = planner->makePlan(start, goal, 0.1, plan, cost, message);
+    if (outcome != mbf_msgs::action::GetPath::Result::SUCCESS)
+    {
+      state.SkipWithError(("makePlan failed: " + message).c_str());
+      break;
+    }
+  }
+  state.counters["poses"] = plan.size();
+  state.counters["cost"] = cost;
+  setMeshCounters(state, *context->mesh_map);
+}
+
+//! follows a CVP plan by evaluating the vector field at every 10th pose of it
+void computeVelocityCommands(benchmark::State& state, const ReferenceMesh& mesh, const PlanPair& pair)
+{
+  const auto context = mapContext(mesh);
+  std::vector<geometry_msgs::msg::PoseStamped> plan;
+  double cost = 0;
+  std::string message;
+  if (context->planners.at("cvp")->makePlan(context->poseAt(pair.start), context->poseAt(pair.goal), 0.1, plan, cost,
+                                             message) != mbf_msgs::action::GetPath::Result::SUCCESS ||
+      !context->controller->setPlan(plan))
+  {
+    state.SkipWithError(("No plan to follow: " + message).c_str());
+    return;
+  }
+
+  geometry_msgs::msg::TwistStamped velocity, cmd_vel;
+  size_t index = 0;
+  for (auto _ : state)
+  {
+    context->controller->computeVelocityCommands(plan[index], velocity, cmd_vel, message);
+    index = (index + 10) % plan.size();
+  }
+  state.counters["poses"] = plan.size();
+}
+
+/**
+ * @brief Parses and removes the options of the benchmark suite, the remaining ones are passed to Google Benchmark
+ *        --mesh=<file>,<part>[,<name>]   adds a real reference mesh, can be given multiple times
+ *        --synthetic_sizes=<n>,...       edge lengths in cells of the synthetic terrains, empty to disable them
+ *        --data_dir=<directory>          directory of the synthetic meshes and the working files
+ */
+bool parseArguments(int& argc, char** argv, std::vector<size_t>& synthetic_sizes)
+{
+  auto split = [](const std::string& value) {
+    std::vector<std::string> tokens;
+    std::stringstream stream(value);
+    std::string token;
+    while (std::getline(stream, token, ','))
+    {
+      tokens.push_back(token);
+    }
+    return tokens;
+  };
+
+  int remaining = 1;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    const auto value = argument.substr(argument.find('=') + 1);
+    if (argument.rfind("--mesh=", 0) == 0)
+    {
+      const auto tokens = split(value);
+      if (tokens.size() < 2)
+      {
+        std::cerr << "Expected --mesh=<file>,<part>[,<name>], got \"" << argument << "\"" << std::endl;
+        return false;
+      }
+      const std::string name = tokens.size() > 2 ? tokens[2] : fs::path(tokens[0]).stem().string();
+      reference_meshes.push_back({ name, fs::absolute(tokens[0]).string(), tokens[1] });
+    }
+    else if (argument.rfind("--synthetic_sizes=", 0) == 0)
+    {
+      synthetic_sizes.clear();
+      for (const auto& token : split(value))
+      {
+        synthetic_sizes.push_back(std::stoul(token));
+      }
+    }
+    else if (argument.rfind("--data_dir=", 0) == 0)
+    {
+      data_dir = value;
+    }
+    else
+    {
+      argv[remaining++] = argv[i];
+    }
+  }
+  argc = remaining;
+  return true;
+}
+
+void registerBenchmarks(const ReferenceMesh& mesh)
+{
+  auto add = [](const std::string& name, auto&& function, auto&&... args) {
+    return benchmark::RegisterBenchmark(name.c_str(), function, args...)->Unit(benchmark::kMillisecond)->UseRealTime();
+  };
+
+  add("readMap/import/" + mesh.name, &readMapImport, mesh);
+  add("readMap/working_file/" + mesh.name, &readMapWorkingFile, mesh, false);
+  add("readMap/mmap/" + mesh.name, &readMapWorkingFile, mesh, true);
+  for (const std::string phase : { "topology", "face_normals", "vertex_normals", "edge_distances" })
+  {
+    add("readMap/" + phase + "/" + mesh.name, &readMapPhase, mesh, phase);
+  }
+  for (const auto& layer : LAYERS)
+  {
+    add("computeLayer/" + layer.first + "/" + mesh.name, &computeLayer, mesh, layer.first);
+  }
+  for (const auto& layer : LAYERS)
+  {
+    add("layerChanged/" + layer.first + "/" + mesh.name, &layerChanged, mesh, layer.first);
+  }
+  add("combineVertexCosts/" + mesh.name, &combineVertexCosts, mesh);
+  for (const auto& pair : PLAN_PAIRS)
+  {
+    for (const auto& planner : PLANNERS)
+    {
+      add("makePlan/" + planner.name + "/" + mesh.name + "/" + pair.name, &makePlan, mesh, planner.name, pair);
+    }
+    add("computeVelocityCommands/" + mesh.name + "/" + pair.name, &computeVelocityCommands, mesh, pair);
+  }
+}
+
+}  // namespace
+
+/**
+ * Runs the benchmarks in-process without spinning a node. Use --benchmark_format=json or --benchmark_out=<file> for
+ * machine-readable results, e.g. to compare two versions with the compare.py tool of Google Benchmark.
+ */
+int main(int argc, char** argv)
+{
+  std::vector<size_t> synthetic_sizes = { 64, 192, 512 };
+  if (!parseArguments(argc, argv, synthetic_sizes))
+  {
+    return 1;
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+
+  rclcpp::init(0, nullptr);
+  rclcpp::get_logger("rclcpp").set_level(rclcpp::Logger::Level::Warn);
+  fs::create_directories(data_dir);
+
+  std::vector<ReferenceMesh> meshes;
+  for (const size_t cells : synthetic_sizes)
+  {
+    const std::string name = "terrain_" + std::to_string(cells);
+    const fs::path file = data_dir / (name + ".h5");
+    writeTerrain(file, "terrain", cells);
+    meshes.push_back({ name, file.string(), "terrain" });
+  }
+  meshes.insert(meshes.end(), reference_meshes.begin(), reference_meshes.end());
+
+  planner_loader =
+      std::make_unique<pluginlib::ClassLoader<mbf_mesh_core::MeshPlanner>>("mbf_mesh_core", "mbf_mesh_core::MeshPlanner");
+  controller_loader = std::make_unique<pluginlib::ClassLoader<mbf_mesh_core::MeshController>>(
+      "mbf_mesh_core", "mbf_mesh_core::MeshController");
+  for (const auto& mesh : meshes)
+  {
+    registerBenchmarks(mesh);
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  // the plugins have to be destroyed before their class loaders
+  map_contexts.clear();
+  planner_loader.reset();
+  controller_loader.reset();
+  rclcpp::shutdown();
+  return 0;
+}
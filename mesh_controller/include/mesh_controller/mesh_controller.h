@@ -150,6 +150,40 @@ public:
       const mesh_map::Normal& mesh_normal,
       const float& mesh_cost);
 
+  /**
+   * Samples linear and angular velocity commands, rolls each of them out on the mesh surface over the rollout horizon
+   * and selects the one with the best score. The candidates are evaluated in the order of their distance to the given
+   * naive command, which is evaluated first, until the rollout time budget is spent.
+   * @param face          the face of the robot position
+   * @param naive         the linear and angular velocity of naiveControl()
+   * @param velocity      the current velocity of the robot
+   * @param velocities    the selected linear and angular velocity
+   * @return              false if all evaluated candidates run into lethal vertices or off the map
+   */
+  bool predictiveControl(
+      const lvr2::FaceHandle& face,
+      const std::array<float, 2>& naive,
+      const geometry_msgs::msg::Twist& velocity,
+      std::array<float, 2>& velocities);
+
+  /**
+   * Rolls out a constant velocity command from the robot pose by integrating it along the mesh surface. The score
+   * rewards the progress along the vector field and penalizes the heading error to the field, the costs of the visited
+   * positions and the change of the angular velocity.
+   * @param costs         the cost snapshot to look up the costs of the visited positions
+   * @param face          the face of the robot position
+   * @param linear        the linear velocity of the command
+   * @param angular       the angular velocity of the command
+   * @param current_angular the current angular velocity of the robot
+   * @return              the score, higher is better, or negative infinity if the rollout is not feasible
+   */
+  float rolloutScore(
+      const mesh_map::CostSnapshot& costs,
+      lvr2::FaceHandle face,
+      const float linear,
+      const float angular,
+      const float current_angular);
+
   /**
    * @brief reconfigure callback function which is called if a dynamic reconfiguration were triggered.
    */
@@ -177,8 +211,8 @@ private:
   //! The triangle on which the robot is located
   lvr2::OptionalFaceHandle current_face_;
 
-  //! The vector field to the goal.
-  lvr2::DenseVertexMap<mesh_map::Vector> vector_map_;
+  //! The vector field to the goal, shared with the planner
+  mesh_map::VectorField::ConstPtr vector_field_;
 
   //! publishes the angle between the robots orientation and the goal vector field for debug purposes
   rclcpp::Publisher<example_interfaces::msg::Float32>::SharedPtr angle_pub_;
@@ -186,6 +220,9 @@ private:
   //! flag to handle cancel requests
   std::atomic_bool cancel_requested_;
 
+  //! linear and angular velocities of the candidates of the predictive control, reused across control cycles
+  std::vector<std::array<float, 2>> candidates_;
+
   // handle of callback for changing parameters dynamically
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr reconfiguration_callback_handle_;
 
@@ -198,6 +235,26 @@ private:
     double max_angle = 20.0;
     double max_search_radius = 0.4;
     double max_search_distance = 0.4;
+    //! naive follows the vector field at the robot position, predictive rolls out sampled commands
+    std::string control_mode = "naive";
+    //! the duration in seconds over which the candidates are rolled out
+    double rollout_horizon = 1.5;
+    //! the number of integration steps of a rollout
+    int rollout_steps = 10;
+    //! the number of sampled linear velocities
+    int linear_samples = 5;
+    //! the number of sampled angular velocities
+    int angular_samples = 11;
+    //! the time in milliseconds per control cycle after which no further candidates are rolled out
+    double rollout_time_budget = 5.0;
+    //! weight of the progress along the vector field
+    double progress_weight = 1.0;
+    //! weight of the mean heading error to the vector field
+    double heading_weight = 1.0;
+    //! weight of the mean cost of the visited positions
+    double cost_weight = 1.0;
+    //! weight of the change of the angular velocity
+    double smoothness_weight = 0.1;
   } config_;
 };
 
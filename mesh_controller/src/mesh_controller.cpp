@@ -35,10 +35,16 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
 #include <lvr2/geometry/HalfEdgeMesh.hpp>
 #include <lvr2/util/Meap.hpp>
 #include <mbf_msgs/action/exe_path.hpp>
 #include <mesh_controller/mesh_controller.h>
+#include <mesh_map/instrumentation.h>
 #include <mesh_map/util.h>
 #include <pluginlib/class_list_macros.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
@@ -69,6 +75,7 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::msg::PoseS
                                                  geometry_msgs::msg::TwistStamped& cmd_vel,
                                                  std::string& message) 
 {
+  MESH_MAP_SCOPED_TIMER("mesh_controller.compute_velocity_commands");
   const auto mesh = map_ptr_->mesh();
 
   robot_pos_ = poseToPositionVector(pose);
@@ -147,7 +154,7 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::msg::PoseS
   std::array<lvr2::VertexHandle, 3> handles = mesh->getVerticesOfFace(face);
 
   // update to which position of the plan the robot is closest
-  const auto& opt_dir = map_ptr_->directionAtPosition(vector_map_, handles, bary_coords);
+  const auto& opt_dir = map_ptr_->directionAtPosition(vector_field_->vectors, handles, bary_coords);
   if (!opt_dir)
   {
     DEBUG_CALL(map_ptr_->publishDebugFace(face, mesh_map::color(0.3, 0.4, 0), "no_directions");)
@@ -162,6 +169,22 @@ uint32_t MeshController::computeVelocityCommands(const geometry_msgs::msg::PoseS
   cmd_vel.twist.angular.z = std::min(config_.max_ang_velocity, velocities[1] * config_.ang_vel_factor);
   cmd_vel.header.stamp = node_->now();
 
+  if (config_.control_mode == "predictive")
+  {
+    const std::array<float, 2> naive = { static_cast<float>(cmd_vel.twist.linear.x),
+                                         static_cast<float>(cmd_vel.twist.angular.z) };
+    if (!predictiveControl(face, naive, velocity.twist, velocities))
+    {
+      cmd_vel.twist.linear.x = 0;
+      cmd_vel.twist.angular.z = 0;
+      message = "All rolled out velocity commands run into lethal vertices or off the map";
+      RCLCPP_WARN_STREAM(node_->get_logger(), message);
+      return mbf_msgs::action::ExePath::Result::NO_VALID_CMD;
+    }
+    cmd_vel.twist.linear.x = velocities[0];
+    cmd_vel.twist.angular.z = velocities[1];
+  }
+
   if (cancel_requested_)
   {
     return mbf_msgs::action::ExePath::Result::CANCELED;
@@ -178,8 +201,14 @@ bool MeshController::isGoalReached(double dist_tolerance, double angle_tolerance
 
 bool MeshController::setPlan(const std::vector<geometry_msgs::msg::PoseStamped>& plan)
 {
-  // copy vector field // TODO just use vector field without copying
-  vector_map_ = map_ptr_->getVectorMap();
+  // keep the vector field of the plan, it is immutable and shared with the planner
+  vector_field_ = map_ptr_->vectorField();
+  if (!vector_field_)
+  {
+    RCLCPP_ERROR_STREAM(node_->get_logger(), "No vector field has been published for the given plan!");
+    return false;
+  }
+  RCLCPP_DEBUG_STREAM(node_->get_logger(), "Following vector field version " << vector_field_->version);
   DEBUG_CALL(map_ptr_->publishDebugPoint(poseToPositionVector(plan.front()), mesh_map::color(0, 1, 0), "plan_start");)
   DEBUG_CALL(map_ptr_->publishDebugPoint(poseToPositionVector(plan.back()), mesh_map::color(1, 0, 0), "plan_goal");)
   current_plan_ = plan;
@@ -241,6 +270,155 @@ std::array<float, 2> MeshController::naiveControl(
   return { linear_velocity, angular_velocity };
 }
 
+bool MeshController::predictiveControl(
+    const lvr2::FaceHandle& face,
+    const std::array<float, 2>& naive,
+    const geometry_msgs::msg::Twist& velocity,
+    std::array<float, 2>& velocities)
+{
+  MESH_MAP_SCOPED_TIMER("mesh_controller.predictive_control");
+  const auto t_start = std::chrono::steady_clock::now();
+  const auto budget = std::chrono::duration<double, std::milli>(config_.rollout_time_budget);
+
+  // the linear velocity fades down within the arrival fading distance of the goal
+  float max_linear = config_.max_lin_velocity;
+  if (config_.arrival_fading > 0)
+  {
+    max_linear *= std::min(1.0f, static_cast<float>((goal_pos_ - robot_pos_).length() / config_.arrival_fading));
+  }
+  const float max_angular = config_.max_ang_velocity;
+
+  // the naive command first, then the sampled commands closest to it, the budget cuts off the ones which differ most
+  candidates_.clear();
+  candidates_.push_back({ std::min(naive[0], max_linear), naive[1] });
+  const int linear_samples = std::max(1, config_.linear_samples);
+  const int angular_samples = std::max(1, config_.angular_samples);
+  for (int i = 0; i < linear_samples; i++)
+  {
+    const float linear = linear_samples > 1 ? max_linear * i / (linear_samples - 1) : max_linear;
+    for (int j = 0; j < angular_samples; j++)
+    {
+      const float angular = angular_samples > 1 ? max_angular * (2.0f * j / (angular_samples - 1) - 1) : 0;
+      candidates_.push_back({ linear, angular });
+    }
+  }
+  const auto distance = [&](const std::array<float, 2>& candidate) {
+    const float linear = max_linear > 0 ? (candidate[0] - naive[0]) / max_linear : 0;
+    const float angular = max_angular > 0 ? (candidate[1] - naive[1]) / max_angular : 0;
+    return linear * linear + angular * angular;
+  };
+  std::stable_sort(candidates_.begin() + 1, candidates_.end(),
+                   [&](const std::array<float, 2>& a, const std::array<float, 2>& b) {
+                     return distance(a) < distance(b);
+                   });
+
+  // the costs are copied at most once per cost revision and shared with the planners, the execution pins the snapshot
+  // before it calls the controller with the costs locked, thus this does not lock them a second time
+  const auto costs = map_ptr_->costSnapshot();
+  float best_score = -std::numeric_limits<float>::infinity();
+  size_t num_evaluated = 0;
+  for (const auto& candidate : candidates_)
+  {
+    if (num_evaluated > 0 && std::chrono::steady_clock::now() - t_start > budget)
+      break;
+
+    const float score = rolloutScore(*costs, face, candidate[0], candidate[1], velocity.angular.z);
+    num_evaluated++;
+    if (score > best_score)
+    {
+      best_score = score;
+      velocities = candidate;
+    }
+  }
+  MESH_MAP_COUNT("mesh_controller.rollouts", num_evaluated);
+  RCLCPP_DEBUG_STREAM(node_->get_logger(), "Rolled out " << num_evaluated << " of " << candidates_.size()
+                                              << " candidates, the best score is " << best_score);
+  return std::isfinite(best_score);
+}
+
+float MeshController::rolloutScore(
+    const mesh_map::CostSnapshot& costs,
+    lvr2::FaceHandle face,
+    const float linear,
+    const float angular,
+    const float current_angular)
+{
+  const auto mesh = map_ptr_->mesh();
+  const auto& face_normals = map_ptr_->faceNormals();
+  const float dt = config_.rollout_horizon / std::max(1, config_.rollout_steps);
+  const float step_length = linear * dt;
+
+  mesh_map::Vector position = robot_pos_;
+  mesh_map::Vector heading = robot_dir_;
+  float progress = 0;
+  float heading_error = 0;
+  float cost = 0;
+  int num_steps = 0;
+  for (int i = 0; i < config_.rollout_steps; i++)
+  {
+    // turn within the tangent plane of the current face and move ahead on the surface
+    const mesh_map::Normal& normal = face_normals[face];
+    const mesh_map::Vector tangent = heading - mesh_map::Vector(normal) * normal.dot(heading);
+    heading = tangent.rotated(normal, angular * dt).normalized();
+    const mesh_map::Vector step = heading * step_length;
+    position += step;
+
+    std::array<mesh_map::Vector, 3> vertices = mesh->getVertexPositionsOfFace(face);
+    std::array<float, 3> bary_coords;
+    float dist_to_surface;
+    if (!mesh_map::projectedBarycentricCoords(position, vertices, bary_coords, dist_to_surface) ||
+        dist_to_surface >= config_.max_search_distance)
+    {
+      auto search_res_opt = map_ptr_->searchNeighbourFaces(position, face, config_.max_search_radius,
+                                                           config_.max_search_distance);
+      if (!search_res_opt)
+      {
+        // the rollout leaves the map
+        return -std::numeric_limits<float>::infinity();
+      }
+      face = std::get<0>(*search_res_opt);
+      vertices = std::get<1>(*search_res_opt);
+      bary_coords = std::get<2>(*search_res_opt);
+    }
+    position = mesh_map::linearCombineBarycentricCoords(vertices, bary_coords);
+
+    const std::array<lvr2::VertexHandle, 3> handles = mesh->getVerticesOfFace(face);
+    const float position_cost = map_ptr_->costAtPosition(costs.vertex_costs, handles, bary_coords);
+    if (!std::isfinite(position_cost))
+    {
+      // the rollout runs into a lethal vertex
+      return -std::numeric_limits<float>::infinity();
+    }
+    const auto& opt_dir = map_ptr_->directionAtPosition(vector_field_->vectors, handles, bary_coords);
+    if (!opt_dir)
+    {
+      // the rollout leaves the vector field, it is scored up to here
+      break;
+    }
+    const mesh_map::Vector mesh_dir = opt_dir.get().normalized();
+    progress += mesh_dir.dot(step);
+    heading_error += acos(std::max(-1.0f, std::min(1.0f, mesh_dir.dot(heading))));
+    cost += position_cost;
+    num_steps++;
+
+    // the goal is reached within the horizon
+    if (position.distance2(goal_pos_) <= step_length * step_length)
+      break;
+  }
+  if (num_steps == 0)
+  {
+    return -std::numeric_limits<float>::infinity();
+  }
+
+  const float max_progress = std::max(1e-3, config_.max_lin_velocity * config_.rollout_horizon);
+  const float angular_change = config_.max_ang_velocity > 0 ?
+      std::abs(angular - current_angular) / config_.max_ang_velocity : 0;
+  return config_.progress_weight * progress / max_progress -
+         config_.heading_weight * heading_error / (num_steps * M_PI) -
+         config_.cost_weight * cost / num_steps -
+         config_.smoothness_weight * angular_change;
+}
+
 rcl_interfaces::msg::SetParametersResult MeshController::reconfigureCallback(std::vector<rclcpp::Parameter> parameters)
 {
   rcl_interfaces::msg::SetParametersResult result;
@@ -262,6 +440,31 @@ rcl_interfaces::msg::SetParametersResult MeshController::reconfigureCallback(std
       config_.max_search_radius = parameter.as_double();
     } else if (parameter.get_name() == name_ + ".max_search_distance") {
       config_.max_search_distance = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".control_mode") {
+      if (parameter.as_string() != "naive" && parameter.as_string() != "predictive") {
+        result.successful = false;
+        result.reason = "Unknown control mode \"" + parameter.as_string() + "\", use naive or predictive.";
+        return result;
+      }
+      config_.control_mode = parameter.as_string();
+    } else if (parameter.get_name() == name_ + ".rollout_horizon") {
+      config_.rollout_horizon = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".rollout_steps") {
+      config_.rollout_steps = parameter.as_int();
+    } else if (parameter.get_name() == name_ + ".linear_samples") {
+      config_.linear_samples = parameter.as_int();
+    } else if (parameter.get_name() == name_ + ".angular_samples") {
+      config_.angular_samples = parameter.as_int();
+    } else if (parameter.get_name() == name_ + ".rollout_time_budget") {
+      config_.rollout_time_budget = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".progress_weight") {
+      config_.progress_weight = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".heading_weight") {
+      config_.heading_weight = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".cost_weight") {
+      config_.cost_weight = parameter.as_double();
+    } else if (parameter.get_name() == name_ + ".smoothness_weight") {
+      config_.smoothness_weight = parameter.as_double();
     }
   }
 
@@ -353,6 +556,103 @@ bool MeshController::initialize(const std::string& plugin_name,
     config_.max_search_distance = node->declare_parameter(name_ + ".max_search_distance", config_.max_search_distance);
   }
 
+  { // control_mode
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The control mode: naive follows the vector field at the robot position, predictive rolls "
+                             "out sampled velocity commands along the surface and selects the best one.";
+    config_.control_mode = node->declare_parameter(name_ + ".control_mode", config_.control_mode, descriptor);
+    if (config_.control_mode != "naive" && config_.control_mode != "predictive")
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown control mode \"" << config_.control_mode << "\"!");
+      return false;
+    }
+  }
+  { // rollout_horizon
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The duration in seconds over which the candidate commands of the predictive "
+                             "control are rolled out";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 10.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.rollout_horizon = node->declare_parameter(name_ + ".rollout_horizon", config_.rollout_horizon, descriptor);
+  }
+  { // rollout_steps
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The number of integration steps of a rollout along the mesh surface";
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 1;
+    range.to_value = 100;
+    descriptor.integer_range.push_back(range);
+    config_.rollout_steps = node->declare_parameter(name_ + ".rollout_steps", config_.rollout_steps, descriptor);
+  }
+  { // linear_samples
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The number of sampled linear velocities of the predictive control";
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 1;
+    range.to_value = 50;
+    descriptor.integer_range.push_back(range);
+    config_.linear_samples = node->declare_parameter(name_ + ".linear_samples", config_.linear_samples, descriptor);
+  }
+  { // angular_samples
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The number of sampled angular velocities of the predictive control";
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 1;
+    range.to_value = 100;
+    descriptor.integer_range.push_back(range);
+    config_.angular_samples = node->declare_parameter(name_ + ".angular_samples", config_.angular_samples, descriptor);
+  }
+  { // rollout_time_budget
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The time in milliseconds per control cycle after which the predictive control "
+                             "stops rolling out further candidates";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.rollout_time_budget =
+        node->declare_parameter(name_ + ".rollout_time_budget", config_.rollout_time_budget, descriptor);
+  }
+  { // progress_weight
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Weight of the progress along the vector field in the score of a rollout";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.progress_weight = node->declare_parameter(name_ + ".progress_weight", config_.progress_weight, descriptor);
+  }
+  { // heading_weight
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Weight of the mean heading error to the vector field in the score of a rollout";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.heading_weight = node->declare_parameter(name_ + ".heading_weight", config_.heading_weight, descriptor);
+  }
+  { // cost_weight
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Weight of the mean cost of the visited positions in the score of a rollout";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.cost_weight = node->declare_parameter(name_ + ".cost_weight", config_.cost_weight, descriptor);
+  }
+  { // smoothness_weight
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Weight of the change of the angular velocity in the score of a rollout";
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 100.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.smoothness_weight =
+        node->declare_parameter(name_ + ".smoothness_weight", config_.smoothness_weight, descriptor);
+  }
+
   reconfiguration_callback_handle_ = node_->add_on_set_parameters_callback(std::bind(
       &MeshController::reconfigureCallback, this, std::placeholders::_1));
 
@@ -72,6 +72,13 @@ class BorderLayer : public mesh_map::AbstractLayer
     return std::numeric_limits<float>::infinity();
   }
 
+  /**
+   * @brief delivers the parameters the costs of this layer depend on
+   *
+   * @return parameter signature
+   */
+  virtual std::string parameterSignature() override;
+
   /**
    * @brief delivers the threshold above which vertices are marked lethal
    *
@@ -118,6 +125,14 @@ class BorderLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal) override {};
 
+  /**
+   * @brief The costs do not depend on the lethal vertices of the preceding layers
+   */
+  virtual bool dependsOnLethals() override
+  {
+    return false;
+  }
+
   /**
    * @brief initializes this layer plugin
    *
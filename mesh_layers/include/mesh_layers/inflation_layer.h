@@ -38,7 +38,13 @@
 #ifndef MESH_MAP__INFLATION_LAYER_H
 #define MESH_MAP__INFLATION_LAYER_H
 
+#include <vector>
+
 #include <mesh_map/abstract_layer.h>
+#include <mesh_map/eikonal_update.h>
+#include <mesh_map/fast_iterative_method.h>
+#include <mesh_map/stamped_vertex_map.h>
+#include <mesh_map/vertex_queue.h>
 #include <rclcpp/rclcpp.hpp>
 
 namespace mesh_layers
@@ -74,6 +80,13 @@ class InflationLayer : public mesh_map::AbstractLayer
     return 0;
   }
 
+  /**
+   * @brief delivers the parameters the costs of this layer depend on
+   *
+   * @return parameter signature
+   */
+  virtual std::string parameterSignature() override;
+
   /**
    * @brief delivers the threshold above which vertices are marked lethal
    *
@@ -94,9 +107,6 @@ class InflationLayer : public mesh_map::AbstractLayer
   void lethalCostInflation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius,
                            const float inscribed_radius, const float inscribed_value, const float lethal_value);
 
-  inline float computeUpdateSethianMethod(const float& d1, const float& d2, const float& a, const float& b,
-                                          const float& dot, const float& F);
-
   /**
    * @brief updates the wavefront
    *
@@ -104,6 +114,7 @@ class InflationLayer : public mesh_map::AbstractLayer
    * @param predecessors current predecessors of vertices visited during the wave front propagation
    * @param max_distance max distance of propagation
    * @param edge_weights weights of the edges
+   * @param topology topology snapshot of the mesh
    * @param fh current face
    * @param normal normal of the current face
    * @param v1 first vertex of the current face
@@ -114,8 +125,9 @@ class InflationLayer : public mesh_map::AbstractLayer
    */
   inline bool waveFrontUpdate(lvr2::DenseVertexMap<float>& distances,
                               lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors, const float& max_distance,
-                              const lvr2::DenseEdgeMap<float>& edge_weights, const lvr2::FaceHandle& fh,
-                              const lvr2::BaseVector<float>& normal, const lvr2::VertexHandle& v1,
+                              const lvr2::DenseEdgeMap<float>& edge_weights, const mesh_map::MeshTopology& topology,
+                              const lvr2::FaceHandle& fh, const lvr2::BaseVector<float>& normal,
+                              const lvr2::VertexHandle& v1,
                               const lvr2::VertexHandle& v2, const lvr2::VertexHandle& v3);
 
   /**
@@ -139,6 +151,42 @@ class InflationLayer : public mesh_map::AbstractLayer
   void waveCostInflation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius,
                          const float inscribed_radius, const float inscribed_value, const float lethal_value);
 
+  /**
+   * @brief repairs the inflation around changed lethal vertices. All vertices within the inflation radius of the
+   * changed vertices are reset and the wave front is propagated again from the lethal vertices inside and the
+   * vertices bordering this region. Vertices farther away can not reach a value within the inflation radius from the
+   * changed vertices, thus their riskiness is kept.
+   *
+   * @param changed_lethals added and removed lethal vertices, lethal_vertices_ has to be updated already
+   * @param inflation_radius radius of inflation
+   */
+  void repairCostInflation(const std::set<lvr2::VertexHandle>& changed_lethals, const float inflation_radius);
+
+  /**
+   * @brief propagates the wave front from the queued vertices into the free vertices, see RegionState
+   *
+   * @param pq queue containing the start vertices of the propagation
+   * @param inflation_radius radius of inflation
+   */
+  void waveFrontPropagation(mesh_map::VertexQueue& pq, const float inflation_radius);
+
+  /**
+   * @brief propagates the wave front from the lethal vertices with the multi-threaded fast iterative method. The
+   * repulsive vectors and predecessors are derived afterwards with the sequential update in the order of the distances.
+   *
+   * @param lethals set of current lethal vertices, they have to be fixed with a distance of zero
+   * @param inflation_radius radius of inflation
+   */
+  void fastIterativePropagation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius);
+
+  /**
+   * @brief assigns the faded distances to the riskiness of the given vertices and records the changed ones
+   *
+   * @param vertices vertices to update
+   */
+  template <typename VertexRange>
+  void updateRiskiness(const VertexRange& vertices);
+
   /**
    * @brief returns repulsive vector at a given position inside a face
    *
@@ -212,6 +260,25 @@ class InflationLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal);
 
+  /**
+   * @brief delivers the vertices whose riskiness changed with the last inflation
+   *
+   * @param[out] vertices the changed vertices
+   *
+   * @return true if the changes are known; false if the costs changed by a reconfiguration
+   */
+  virtual bool lastChangedVertices(std::vector<lvr2::VertexHandle>& vertices) override;
+
+  /**
+   * @brief the inflation is computed around the lethal vertices of the previous layers
+   *
+   * @return true
+   */
+  virtual bool dependsOnLethals() override
+  {
+    return true;
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -234,8 +301,31 @@ class InflationLayer : public mesh_map::AbstractLayer
 
   lvr2::DenseVertexMap<float> distances_;
 
+  lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors_;
+
+  //! state of the vertices during the wave front propagation, only free vertices are assigned new distances
+  enum RegionState : uint8_t
+  {
+    OUTSIDE = 0,   //!< not part of the propagation, the distance is kept
+    BOUNDARY = 1,  //!< borders the repaired region, the kept distance is propagated into the region
+    FIXED = 2,     //!< inside the propagation region, the distance is final
+    FREE = 3       //!< inside the propagation region, the distance is not final yet
+  };
+
+  mesh_map::StampedVertexMap<uint8_t> region_state_;
+
+  std::vector<lvr2::VertexHandle> changed_vertices_;
+
+  bool changed_vertices_known_ = false;
+
   std::set<lvr2::VertexHandle> lethal_vertices_;
 
+  //! triangle update selected by the update_scheme and update_precision parameters
+  mesh_map::EikonalKernel eikonal_kernel_{ mesh_map::EikonalScheme::KIMMEL_SETHIAN, mesh_map::EikonalPrecision::FLOAT };
+
+  //! parallel eikonal solver, created on the first fast iterative inflation
+  std::unique_ptr<mesh_map::FastIterativeMethod> fast_iterative_method_;
+
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
   struct {
     double inscribed_radius = 0.25;
@@ -245,6 +335,12 @@ class InflationLayer : public mesh_map::AbstractLayer
     double inscribed_value = 1.0;
     int min_contour_size = 3;
     bool repulsive_field = true;
+    std::string queue_type = "meap";
+    bool incremental_update = false;
+    std::string propagation_method = "fast_marching";
+    int propagation_threads = 0;
+    std::string update_scheme = "kimmel_sethian";
+    std::string update_precision = "float";
   } config_;
 };
 
@@ -0,0 +1,213 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__OBSTACLE_LAYER_H
+#define MESH_MAP__OBSTACLE_LAYER_H
+
+#include <mutex>
+#include <vector>
+
+#include <mesh_map/abstract_layer.h>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace mesh_layers
+{
+/**
+ * @brief Costmap layer which marks dynamic obstacles observed in point clouds. The points are projected onto the
+ * surface below them using the face BVH of the map. Points within the obstacle height band mark the vertices around
+ * their projection as lethal, points on the surface clear them. Marked vertices which have not been observed again
+ * within the obstacle timeout are cleared as well. The observations are buffered and applied at the update rate with a
+ * single notifyChange(), which only reports the changed vertices.
+ */
+class ObstacleLayer : public mesh_map::AbstractLayer
+{
+  /**
+   * @brief the observations are not persisted, thus there is nothing to read from the map file
+   *
+   * @return false
+   */
+  virtual bool readLayer() override;
+
+  /**
+   * @brief the observations are not persisted, thus there is nothing to write to the map file
+   *
+   * @return true
+   */
+  virtual bool writeLayer() override;
+
+  /**
+   * @brief delivers the default layer value
+   *
+   * @return default value used for this layer
+   */
+  virtual float defaultValue() override
+  {
+    return 0;
+  }
+
+  /**
+   * @brief delivers the threshold above which vertices are marked lethal
+   *
+   * @return lethal threshold
+   */
+  virtual float threshold() override;
+
+  /**
+   * @brief clears all observations
+   *
+   * @return true
+   */
+  virtual bool computeLayer() override;
+
+  /**
+   * @brief deliver the current costmap
+   *
+   * @return calculated costmap
+   */
+  virtual lvr2::VertexMap<float>& costs() override;
+
+  /**
+   * @brief deliver set containing all vertices marked as lethal
+   *
+   * @return lethal vertices
+   */
+  virtual std::set<lvr2::VertexHandle>& lethals() override
+  {
+    return lethal_vertices_;
+  }
+
+  /**
+   * @brief the obstacles do not depend on the lethal vertices of other layers
+   */
+  virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
+                            std::set<lvr2::VertexHandle>& removed_lethal) override {};
+
+  /**
+   * @brief The costs do not depend on the lethal vertices of the preceding layers
+   */
+  virtual bool dependsOnLethals() override
+  {
+    return false;
+  }
+
+  /**
+   * @brief delivers the vertices which have been marked or cleared with the last update
+   *
+   * @param[out] vertices the changed vertices
+   *
+   * @return true if the changes are known; false after the layer has been reset
+   */
+  virtual bool lastChangedVertices(std::vector<lvr2::VertexHandle>& vertices) override;
+
+  /**
+   * @brief initializes this layer plugin
+   *
+   * @return true if initialization was successfull; else false
+   */
+  virtual bool initialize() override;
+
+  /**
+   * @brief transforms the cloud into the map frame and buffers its points for the next update
+   */
+  void cloudCallback(const sensor_msgs::msg::PointCloud2::SharedPtr msg);
+
+  /**
+   * @brief applies the buffered observations and notifies the map if vertices have been marked or cleared
+   */
+  void updateObstacles();
+
+  /**
+   * @brief collects the vertices within the radius around the given surface points
+   *
+   * @param points surface points
+   * @param radius search radius
+   * @param[out] vertices the found vertices, which can contain duplicates
+   */
+  void verticesAround(const std::vector<mesh_map::Vector>& points, const float radius,
+                      std::vector<lvr2::VertexHandle>& vertices);
+
+  /**
+   * @brief sets the obstacle state of the vertex and records it as changed if the state changed
+   */
+  void setObstacle(const lvr2::VertexHandle& vH, const bool obstacle);
+
+  /**
+   * @brief callback for incoming param changes
+   */
+  rcl_interfaces::msg::SetParametersResult reconfigureCallback(std::vector<rclcpp::Parameter> parameters);
+
+  lvr2::DenseVertexMap<float> obstacle_costs_;
+
+  //! time the vertex has been marked last, only valid for lethal vertices
+  lvr2::DenseVertexMap<double> last_marked_;
+
+  std::set<lvr2::VertexHandle> lethal_vertices_;
+
+  std::vector<lvr2::VertexHandle> changed_vertices_;
+
+  bool changed_vertices_known_ = false;
+
+  //! points of the received clouds in the map frame, which have not been applied yet
+  std::vector<mesh_map::Vector> pending_points_;
+  std::mutex pending_mtx_;
+
+  //! buffers of the update, kept to avoid allocations
+  std::vector<mesh_map::Vector> points_, origins_, directions_, marks_, clears_;
+  std::vector<mesh_map::FaceBVH::RayHit> hits_;
+  std::vector<uint32_t> offsets_;
+  std::vector<lvr2::VertexHandle> vertices_;
+
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_sub_;
+  rclcpp::TimerBase::SharedPtr update_timer_;
+
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
+  struct {
+    std::string cloud_topic = "obstacle_points";
+    double update_rate = 5.0;
+    double min_obstacle_height = 0.05;
+    double max_obstacle_height = 2.0;
+    double marking_radius = 0.1;
+    double clearing_radius = 0.1;
+    double obstacle_timeout = 5.0;
+    double factor = 1.0;
+  } config_;
+};
+
+} /* namespace mesh_layers */
+
+#endif  // MESH_MAP__OBSTACLE_LAYER_H
@@ -63,6 +63,13 @@ class RoughnessLayer : public mesh_map::AbstractLayer
    */
   virtual bool writeLayer() override;
 
+  /**
+   * @brief delivers the parameters the costs of this layer depend on
+   *
+   * @return parameter signature
+   */
+  virtual std::string parameterSignature() override;
+
   /**
    * @brief delivers the threshold above which vertices are marked lethal
    *
@@ -119,6 +126,14 @@ class RoughnessLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal) override {};
 
+  /**
+   * @brief The costs do not depend on the lethal vertices of the preceding layers
+   */
+  virtual bool dependsOnLethals() override
+  {
+    return false;
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -141,6 +156,8 @@ class RoughnessLayer : public mesh_map::AbstractLayer
     double threshold = 0.3;
     double radius = 0.3;
     double factor = 1.0;
+    int threads = 1;
+    std::string neighborhood_strategy = "topology";
   } config_;
 };
 
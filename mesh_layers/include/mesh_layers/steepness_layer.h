@@ -118,6 +118,14 @@ class SteepnessLayer : public mesh_map::AbstractLayer
    */
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal, std::set<lvr2::VertexHandle>& removed_lethal) override {};
 
+  /**
+   * @brief The costs do not depend on the lethal vertices of the preceding layers
+   */
+  virtual bool dependsOnLethals() override
+  {
+    return false;
+  }
+
   /**
    * @brief initializes this layer plugin
    *
@@ -139,6 +147,7 @@ class SteepnessLayer : public mesh_map::AbstractLayer
   struct {
     double threshold = 0.3;
     double factor = 1.0;
+    int threads = 1;
   } config_;
 
 };
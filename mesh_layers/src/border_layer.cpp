@@ -37,7 +37,6 @@
 
 #include "mesh_layers/border_layer.h"
 
-#include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
 #include <pluginlib/class_list_macros.hpp>
 
@@ -93,6 +92,11 @@ bool BorderLayer::writeLayer()
   }
 }
 
+std::string BorderLayer::parameterSignature()
+{
+  return "border_cost=" + std::to_string(config_.border_cost);
+}
+
 float BorderLayer::threshold()
 {
   return config_.threshold;
@@ -100,7 +104,14 @@ float BorderLayer::threshold()
 
 bool BorderLayer::computeLayer()
 {
-  border_costs_ = lvr2::calcBorderCosts(*(map_ptr_->mesh()), config_.border_cost);
+  const auto mesh = map_ptr_->mesh();
+  const auto boundary = map_ptr_->boundary();
+  border_costs_.clear();
+  border_costs_.reserve(mesh->nextVertexIndex());
+  for (auto vH : mesh->vertices())
+  {
+    border_costs_.insert(vH, boundary && boundary->isBoundaryVertex(vH) ? config_.border_cost : 0);
+  }
   return computeLethals();
 }
 
@@ -37,8 +37,12 @@
 
 #include "mesh_layers/height_diff_layer.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
+#include <mesh_map/vertex_kernels.h>
 #include <pluginlib/class_list_macros.hpp>
 
 PLUGINLIB_EXPORT_CLASS(mesh_layers::HeightDiffLayer, mesh_map::AbstractLayer)
@@ -92,6 +96,11 @@ bool HeightDiffLayer::writeLayer()
   }
 }
 
+std::string HeightDiffLayer::parameterSignature()
+{
+  return "radius=" + std::to_string(config_.radius) + ";neighborhood_strategy=" + config_.neighborhood_strategy;
+}
+
 float HeightDiffLayer::threshold()
 {
   return config_.threshold;
@@ -100,7 +109,33 @@ float HeightDiffLayer::threshold()
 bool HeightDiffLayer::computeLayer()
 {
   auto mesh = map_ptr_->mesh();
-  height_diff_ = lvr2::calcVertexHeightDifferences(*mesh, config_.radius);
+
+  const size_t num_threads = mesh_map::resolveThreadCount(config_.threads);
+  const float radius = config_.radius;
+  // the neighbourhoods are shared with the other layers using the same strategy and radius
+  std::vector<mesh_map::LocalNeighborhood> neighborhoods(
+      num_threads, map_ptr_->localNeighborhood(config_.neighborhood_strategy, radius, num_threads));
+
+  // height difference between the lowest and the highest vertex in the neighbourhood, as
+  // lvr2::calcVertexHeightDifferences
+  height_diff_ = mesh_map::denseVertexMap<float>(*mesh, 0);
+  mesh_map::parallelForEachVertex(mesh->nextVertexIndex(), num_threads, [&](const size_t thread, const lvr2::VertexHandle& vH) {
+    if (!mesh->containsVertex(vH))
+    {
+      return;
+    }
+
+    float min_height = std::numeric_limits<float>::max();
+    float max_height = std::numeric_limits<float>::lowest();
+    neighborhoods[thread].visit(vH, radius, [&](const lvr2::VertexHandle& vertex) {
+      const float height = mesh->getVertexPosition(vertex).z;
+      min_height = std::min(min_height, height);
+      max_height = std::max(max_height, height);
+    });
+
+    height_diff_[vH] = max_height - min_height;
+  });
+
   return computeLethals();
 }
 
@@ -115,6 +150,7 @@ rcl_interfaces::msg::SetParametersResult HeightDiffLayer::reconfigureCallback(st
   result.successful = true;
 
   bool recompute_lethals = false;
+  bool recompute_layer = false;
   for (auto parameter : parameters) {
     if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threshold") {
       config_.threshold = parameter.as_double();
@@ -124,10 +160,25 @@ rcl_interfaces::msg::SetParametersResult HeightDiffLayer::reconfigureCallback(st
       recompute_lethals = true;
     } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor") {
       config_.factor = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads") {
+      config_.threads = parameter.as_int();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy") {
+      if (!mesh_map::isValidNeighborhoodStrategy(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown neighborhood strategy \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.neighborhood_strategy = parameter.as_string();
+      recompute_layer = true;
     }
   }
 
-  if (recompute_lethals) {
+  if (recompute_layer) {
+    // the height differences themselves depend on the neighbourhoods, the lethals are recomputed with them
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Recompute layer and notify change from " << layer_name_ << " due to cfg change.");
+    computeLayer();
+    notifyChange();
+  } else if (recompute_lethals) {
     RCLCPP_INFO_STREAM(node_->get_logger(), "Recompute lethals and notify change from " << layer_name_ << " due to cfg change.");
     computeLethals();
     notifyChange();
@@ -169,6 +220,27 @@ bool HeightDiffLayer::initialize()
     descriptor.floating_point_range.push_back(range);
     config_.factor = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor", config_.factor, descriptor);
   }
+  { // threads
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Number of threads used to compute the layer, 0 uses the number of hardware threads.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.threads = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads", config_.threads, descriptor);
+  }
+  { // neighborhood_strategy
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "How the local neighbourhood is found: 'topology' walks the mesh, 'radius' queries the k-d tree.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.neighborhood_strategy = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy", config_.neighborhood_strategy, descriptor);
+    if (!mesh_map::isValidNeighborhoodStrategy(config_.neighborhood_strategy))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown neighborhood strategy \"" << config_.neighborhood_strategy << "\"!");
+      return false;
+    }
+  }
   dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(
       &HeightDiffLayer::reconfigureCallback, this, std::placeholders::_1));
   return true;
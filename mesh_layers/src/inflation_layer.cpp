@@ -37,8 +37,11 @@
 
 #include "mesh_layers/inflation_layer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <queue>
 #include <lvr2/util/Meap.hpp>
+#include <mesh_map/vertex_queue.h>
 #include <pluginlib/class_list_macros.hpp>
 #include <mesh_map/util.h>
 
@@ -81,6 +84,14 @@ bool InflationLayer::writeLayer()
   }
 }
 
+std::string InflationLayer::parameterSignature()
+{
+  return "inscribed_radius=" + std::to_string(config_.inscribed_radius) +
+         ";inflation_radius=" + std::to_string(config_.inflation_radius) +
+         ";inscribed_value=" + std::to_string(config_.inscribed_value) +
+         ";lethal_value=" + std::to_string(config_.lethal_value);
+}
+
 float InflationLayer::threshold()
 {
   return std::numeric_limits<float>::quiet_NaN();
@@ -89,11 +100,26 @@ float InflationLayer::threshold()
 void InflationLayer::updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
                                   std::set<lvr2::VertexHandle>& removed_lethal)
 {
-  lethal_vertices_ = added_lethal;
+  // the mesh map passes the changes of the lethal vertices of the preceding layers
+  lethal_vertices_.insert(added_lethal.begin(), added_lethal.end());
+  for (const auto& vH : removed_lethal)
+  {
+    lethal_vertices_.erase(vH);
+  }
 
   RCLCPP_INFO_STREAM(node_->get_logger(), "Update lethal for inflation layer.");
-  waveCostInflation(lethal_vertices_, config_.inflation_radius, config_.inscribed_radius, config_.inscribed_value,
-                    std::numeric_limits<float>::infinity());
+  const auto mesh = map_ptr_->mesh();
+  if (config_.incremental_update && mesh && distances_.numValues() == mesh->nextVertexIndex())
+  {
+    std::set<lvr2::VertexHandle> changed_lethals(added_lethal);
+    changed_lethals.insert(removed_lethal.begin(), removed_lethal.end());
+    repairCostInflation(changed_lethals, config_.inflation_radius);
+  }
+  else
+  {
+    waveCostInflation(lethal_vertices_, config_.inflation_radius, config_.inscribed_radius, config_.inscribed_value,
+                      std::numeric_limits<float>::infinity());
+  }
 
   /*lethalCostInflation(lethal_vertices_, config_.inflation_radius,
                       config_.inscribed_radius, config_.inscribed_value,
@@ -103,62 +129,20 @@ void InflationLayer::updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
 */
 }
 
-inline float InflationLayer::computeUpdateSethianMethod(const float& d1, const float& d2, const float& a,
-                                                        const float& b, const float& dot, const float& F)
+bool InflationLayer::lastChangedVertices(std::vector<lvr2::VertexHandle>& vertices)
 {
-  float t = std::numeric_limits<float>::infinity();
-  float r_cos_angle = dot;
-  float r_sin_angle = sqrt(1 - dot * dot);
-
-  float u = d2 - d1;  // T(B) - T(A)
-
-  float f2 = a * a + b * b - 2 * a * b * r_cos_angle;
-  float f1 = b * u * (a * r_cos_angle - b);
-  float f0 = b * b * (u * u - F * F * a * a * r_sin_angle);
-
-  float delta = f1 * f1 - f0 * f2;
-
-  if (delta >= 0)
-  {
-    if (std::fabs(f2) > mesh_layers::EPSILON)
-    {
-      t = (-f1 - sqrt(delta)) / f2;
-      if (t < u || b * (t - u) / t < a * r_cos_angle || a / r_cos_angle < b * (t - u) / 2)
-      {
-        t = (-f1 + sqrt(delta)) / f2;
-      }
-      else
-      {
-        if (f1 != 0)
-        {
-          t = -f0 / f1;
-        }
-        else
-        {
-          t = -std::numeric_limits<float>::infinity();
-        }
-      }
-    }
-  }
-  else
-  {
-    t = -std::numeric_limits<float>::infinity();
-  }
+  if (!changed_vertices_known_)
+    return false;
 
-  if (u < t && a * r_cos_angle < b * (t - u) / t && b * (t - u) / t < a / r_cos_angle)
-  {
-    return t + d1;
-  }
-  else
-  {
-    return std::min(b * F + d1, a * F + d2);
-  }
+  vertices = changed_vertices_;
+  return true;
 }
 
 inline bool InflationLayer::waveFrontUpdate(lvr2::DenseVertexMap<float>& distances_,
                                             lvr2::DenseVertexMap<lvr2::VertexHandle>& predecessors,
                                             const float& max_distance, const lvr2::DenseEdgeMap<float>& edge_weights,
-                                            const lvr2::FaceHandle& fh, const lvr2::BaseVector<float>& normal,
+                                            const mesh_map::MeshTopology& topology, const lvr2::FaceHandle& fh,
+                                            const lvr2::BaseVector<float>& normal,
                                             const lvr2::VertexHandle& v1h, const lvr2::VertexHandle& v2h,
                                             const lvr2::VertexHandle& v3h)
 {
@@ -171,23 +155,14 @@ inline bool InflationLayer::waveFrontUpdate(lvr2::DenseVertexMap<float>& distanc
   if (u3 == 0)
     return false;
 
-  const lvr2::OptionalEdgeHandle e12h = mesh->getEdgeBetween(v1h, v2h);
-  const float c = edge_weights[e12h.unwrap()];
-  const float c_sq = c * c;
+  const float c = edge_weights[topology.edgeBetween(v1h, v2h).unwrap()];
+  const float b = edge_weights[topology.edgeBetween(v1h, v3h).unwrap()];
+  const float a = edge_weights[topology.edgeBetween(v2h, v3h).unwrap()];
 
-  const lvr2::OptionalEdgeHandle e13h = mesh->getEdgeBetween(v1h, v3h);
-  const float b = edge_weights[e13h.unwrap()];
-  const float b_sq = b * b;
-
-  const lvr2::OptionalEdgeHandle e23h = mesh->getEdgeBetween(v2h, v3h);
-  const float a = edge_weights[e23h.unwrap()];
-  const float a_sq = a * a;
-
-  float dot = (a_sq + b_sq - c_sq) / (2 * a * b);
-  float u3tmp = computeUpdateSethianMethod(u1, u2, a, b, dot, 1.0);
-
-  if (!std::isfinite(u3tmp))
+  mesh_map::EikonalResult update;
+  if (!eikonal_kernel_.update(u1, u2, std::numeric_limits<float>::infinity(), a, b, c, update))
     return false;
+  const float u3tmp = update.distance;
 
   const float d31 = u3tmp - u1;
   const float d32 = u3tmp - u2;
@@ -199,11 +174,19 @@ inline bool InflationLayer::waveFrontUpdate(lvr2::DenseVertexMap<float>& distanc
     const auto& v3 = mesh->getVertexPosition(v3h);
     const auto& dir = ((v3 - v2) + (v3 - v1)).normalized();
     const auto& face_normals = map_ptr_->faceNormals();
-    cutting_faces_.insert(v1h, fh);
-    cutting_faces_.insert(v2h, fh);
+    // lethal vertices outside of a repaired region keep their vectors
+    const auto& region_state = region_state_;
+    if (region_state[v1h] >= FIXED)
+    {
+      cutting_faces_.insert(v1h, fh);
+      vector_map_[v1h] = (vector_map_[v1h] + dir).normalized();
+    }
+    if (region_state[v2h] >= FIXED)
+    {
+      cutting_faces_.insert(v2h, fh);
+      vector_map_[v2h] = (vector_map_[v2h] + dir).normalized();
+    }
     cutting_faces_.insert(v3h, fh);
-    vector_map_[v1h] = (vector_map_[v1h] + dir).normalized();
-    vector_map_[v2h] = (vector_map_[v2h] + dir).normalized();
     //vector_map_[v3h] = (vector_map_[v1h] * d31 + vector_map[v2h] * d32).normalized();
     vector_map_[v3h] = (vector_map_[v3h] + dir).normalized();
   }
@@ -266,161 +249,305 @@ void InflationLayer::waveCostInflation(const std::set<lvr2::VertexHandle>& letha
     RCLCPP_INFO_STREAM(node_->get_logger(), "inflation radius:" << inflation_radius);
     RCLCPP_INFO_STREAM(node_->get_logger(), "Init wave inflation.");
 
-    lvr2::DenseVertexMap<bool> seen(mesh->nextVertexIndex(), false);
     distances_ = lvr2::DenseVertexMap<float>(mesh->nextVertexIndex(), std::numeric_limits<float>::infinity());
-    lvr2::DenseVertexMap<lvr2::VertexHandle> predecessors;
-    predecessors.reserve(mesh->nextVertexIndex());
+    predecessors_ = lvr2::DenseVertexMap<lvr2::VertexHandle>();
+    predecessors_.reserve(mesh->nextVertexIndex());
 
     vector_map_ = lvr2::DenseVertexMap<lvr2::BaseVector<float>>(mesh->nextVertexIndex(), lvr2::BaseVector<float>());
 
     direction_ = lvr2::DenseVertexMap<float>();
 
-    const auto& edge_distances = map_ptr_->edgeDistances();
-    const auto& face_normals = map_ptr_->faceNormals();
-
-    lvr2::DenseVertexMap<bool> fixed(mesh->nextVertexIndex(), false);
-
     // initialize distances with infinity
     // initialize predecessor of each vertex with itself
+    // all vertices are free
+    region_state_.reset(mesh->nextVertexIndex());
     for (auto const& vH : mesh->vertices())
     {
-      predecessors.insert(vH, vH);
+      predecessors_.insert(vH, vH);
+      region_state_.insert(vH, FREE);
     }
 
-    lvr2::Meap<lvr2::VertexHandle, float> pq;
+    const auto pq = mesh_map::createVertexQueue(config_.queue_type, mesh->nextVertexIndex());
     // Set start distance to zero
     // add start vertex to priority queue
     for (auto vH : lethals)
     {
       distances_[vH] = 0;
-      fixed[vH] = true;
-      pq.insert(vH, 0);
+      region_state_.insert(vH, FIXED);
+      pq->insert(vH, 0);
     }
 
     RCLCPP_INFO_STREAM(node_->get_logger(), "Start inflation wave front propagation");
+    if (config_.propagation_method == "fast_iterative")
+    {
+      fastIterativePropagation(lethals, inflation_radius);
+    }
+    else
+    {
+      waveFrontPropagation(*pq, inflation_radius);
+    }
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Finished inflation wave front propagation.");
 
-    while (!pq.isEmpty())
+    updateRiskiness(mesh->vertices());
+
+    map_ptr_->publishVectorField("inflation", vector_map_, distances_,
+                                std::bind(&InflationLayer::fading, this, std::placeholders::_1));
+  }
+  else
+  {
+    RCLCPP_ERROR_STREAM(node_->get_logger(), "Cannot init wave inflation: mesh_ptr points to null");
+  }
+}
+
+void InflationLayer::repairCostInflation(const std::set<lvr2::VertexHandle>& changed_lethals,
+                                         const float inflation_radius)
+{
+  const auto mesh = map_ptr_->mesh();
+  const auto topology = map_ptr_->topology();
+
+  // The euclidean distance is a lower bound of the geodesic distance, thus all vertices whose distance to a changed
+  // vertex is within the inflation radius are found by a radius search.
+  std::vector<mesh_map::Vector> positions;
+  positions.reserve(changed_lethals.size());
+  for (const auto& vH : changed_lethals)
+  {
+    positions.push_back(mesh->getVertexPosition(vH));
+  }
+  std::vector<uint32_t> offsets;
+  std::vector<lvr2::VertexHandle> region;
+  map_ptr_->radiusSearch(positions, inflation_radius, offsets, region);
+  // the changed lethals are part of the region even without k-d tree
+  region.insert(region.end(), changed_lethals.begin(), changed_lethals.end());
+
+  const auto pq = mesh_map::createVertexQueue(config_.queue_type, mesh->nextVertexIndex());
+
+  // reset the region, the radius searches may overlap
+  region_state_.reset(mesh->nextVertexIndex());
+  std::vector<lvr2::VertexHandle> repaired;
+  repaired.reserve(region.size());
+  for (const auto& vH : region)
+  {
+    if (region_state_.containsKey(vH))
+      continue;
+
+    predecessors_.insert(vH, vH);
+    vector_map_.insert(vH, lvr2::BaseVector<float>());
+    if (lethal_vertices_.count(vH))
     {
-      lvr2::VertexHandle current_vh = pq.popMin().key();
+      distances_[vH] = 0;
+      region_state_.insert(vH, FIXED);
+      pq->insert(vH, 0);
+    }
+    else
+    {
+      distances_[vH] = std::numeric_limits<float>::infinity();
+      region_state_.insert(vH, FREE);
+    }
+    repaired.push_back(vH);
+  }
 
-      if (current_vh.idx() >= map_ptr_->mesh()->nextVertexIndex())
+  // the vertices bordering the region propagate their kept distances into it
+  size_t boundary_size = 0;
+  for (const auto& vH : repaired)
+  {
+    for (const lvr2::VertexHandle& nh : topology->neighboursOfVertex(vH))
+    {
+      if (!region_state_.containsKey(nh) && std::isfinite(distances_[nh]))
       {
-        continue;
+        region_state_.insert(nh, BOUNDARY);
+        pq->insert(nh, distances_[nh]);
+        boundary_size++;
       }
+    }
+  }
 
-      if (map_ptr_->invalid[current_vh])
-        continue;
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Repair inflation around " << changed_lethals.size()
+                                          << " changed lethal vertices, " << repaired.size() << " vertices in region, "
+                                          << boundary_size << " boundary vertices.");
+  waveFrontPropagation(*pq, inflation_radius);
 
-      // check if already fixed
-      // if(fixed[current_vh]) continue;
-      fixed[current_vh] = true;
+  updateRiskiness(repaired);
 
-      std::vector<lvr2::VertexHandle> neighbours;
-      try
-      {
-        mesh->getNeighboursOfVertex(current_vh, neighbours);
-      }
-      catch (lvr2::PanicException exception)
-      {
-        map_ptr_->invalid.insert(current_vh, true);
-        continue;
-      }
-      catch (lvr2::VertexLoopException exception)
-      {
-        map_ptr_->invalid.insert(current_vh, true);
-        continue;
-      }
+  map_ptr_->publishVectorField("inflation", vector_map_, distances_,
+                              std::bind(&InflationLayer::fading, this, std::placeholders::_1));
+}
+
+void InflationLayer::fastIterativePropagation(const std::set<lvr2::VertexHandle>& lethals, const float inflation_radius)
+{
+  if (!fast_iterative_method_)
+  {
+    fast_iterative_method_ = std::make_unique<mesh_map::FastIterativeMethod>(config_.propagation_threads);
+  }
+  auto& fim = *fast_iterative_method_;
+  const auto topology = map_ptr_->topology();
+  const auto& edge_distances = map_ptr_->edgeDistances();
+  const auto& face_normals = map_ptr_->faceNormals();
+  const auto& invalid = map_ptr_->invalid;
 
-      for (auto nh : neighbours)
+  std::vector<std::pair<lvr2::VertexHandle, float>> seeds;
+  seeds.reserve(lethals.size());
+  for (const auto& vH : lethals)
+  {
+    seeds.emplace_back(vH, 0.0f);
+  }
+
+  const auto accessible = [&invalid](const lvr2::VertexHandle& vH) { return !invalid[vH]; };
+  const mesh_map::EikonalEdgeUpdate update{ edge_distances, eikonal_kernel_ };
+
+  const auto t_start = std::chrono::steady_clock::now();
+  const size_t iterations = fim.solve(*topology, seeds, inflation_radius, {}, 0, accessible, update);
+
+  // the repulsive vector of a vertex combines the vectors of its predecessors, thus the vertices are processed in the
+  // order of their distances, the update of their final face reproduces the distance
+  std::vector<lvr2::VertexHandle> vertices(fim.reached());
+  std::sort(vertices.begin(), vertices.end(), [&fim](const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2) {
+    return fim.distance(v1) < fim.distance(v2);
+  });
+  for (const auto& vH : vertices)
+  {
+    distances_[vH] = fim.distance(vH);
+    region_state_.insert(vH, FIXED);
+  }
+  for (const auto& vH : vertices)
+  {
+    const uint32_t face = fim.face(vH);
+    if (face == mesh_map::FastIterativeMethod::NO_FACE)
+      continue;
+
+    const lvr2::FaceHandle fH(face);
+    const auto& face_vertices = topology->verticesOfFace(fH);
+    const size_t corner = face_vertices[0] == vH ? 0 : face_vertices[1] == vH ? 1 : 2;
+    const float distance = distances_[vH];
+    distances_[vH] = std::numeric_limits<float>::infinity();
+    waveFrontUpdate(distances_, predecessors_, inflation_radius, edge_distances, *topology, fH, face_normals[fH],
+                    face_vertices[(corner + 1) % 3], face_vertices[(corner + 2) % 3], vH);
+    distances_[vH] = distance;
+  }
+
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Fast iterative method: " << iterations << " iterations on "
+      << fim.numThreads() << " threads reached " << vertices.size() << " vertices in "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start).count()
+      << " ms.");
+}
+
+void InflationLayer::waveFrontPropagation(mesh_map::VertexQueue& pq, const float inflation_radius)
+{
+  const auto topology = map_ptr_->topology();
+  const auto& edge_distances = map_ptr_->edgeDistances();
+  const auto& face_normals = map_ptr_->faceNormals();
+
+  // boundary and outside vertices are fixed as well
+  const auto& region_state = region_state_;
+  const auto fixed = [&region_state](const lvr2::VertexHandle& vH) { return region_state[vH] != FREE; };
+
+  while (!pq.isEmpty())
+  {
+    lvr2::VertexHandle current_vh = pq.popMin();
+
+    if (current_vh.idx() >= map_ptr_->mesh()->nextVertexIndex())
+    {
+      continue;
+    }
+
+    if (map_ptr_->invalid[current_vh])
+      continue;
+
+    // check if already fixed
+    // if(fixed[current_vh]) continue;
+    if (region_state[current_vh] == FREE)
+    {
+      region_state_.insert(current_vh, FIXED);
+    }
+
+    // broken vertices have been marked invalid while building the topology snapshot
+    for (const lvr2::VertexHandle& nh : topology->neighboursOfVertex(current_vh))
+    {
+      for (const lvr2::FaceHandle& fh : topology->facesOfVertex(nh))
       {
-        std::vector<lvr2::FaceHandle> faces;
-        try
-        {
-          mesh->getFacesOfVertex(nh, faces);
-        }
-        catch (lvr2::PanicException exception)
-        {
-          map_ptr_->invalid.insert(nh, true);
+        if (!topology->containsFace(fh))
           continue;
-        }
 
-        for (auto fh : faces)
-        {
-          const auto vertices = mesh->getVerticesOfFace(fh);
-          const lvr2::VertexHandle& a = vertices[0];
-          const lvr2::VertexHandle& b = vertices[1];
-          const lvr2::VertexHandle& c = vertices[2];
+        const auto& vertices = topology->verticesOfFace(fh);
+        const lvr2::VertexHandle& a = vertices[0];
+        const lvr2::VertexHandle& b = vertices[1];
+        const lvr2::VertexHandle& c = vertices[2];
 
-          try
+        try
+        {
+          if (fixed(a) && fixed(b) && fixed(c))
           {
-            if (fixed[a] && fixed[b] && fixed[c])
-            {
-              // RCLCPP_INFO_STREAM(node_->get_logger(), "All fixed!");
-              continue;
-            }
-            else if (fixed[a] && fixed[b] && !fixed[c])
-            {
-              // c is free
-              if (waveFrontUpdate(distances_, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], a, b,
-                                  c))
-              {
-                pq.insert(c, distances_[c]);
-              }
-              // if(pq.containsKey(c)) pq.updateValue(c, distances[c]);
-            }
-            else if (fixed[a] && !fixed[b] && fixed[c])
-            {
-              // b is free
-              if (waveFrontUpdate(distances_, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], c, a,
-                                  b))
-              {
-                pq.insert(b, distances_[b]);
-              }
-              // if(pq.containsKey(b)) pq.updateValue(b, distances[b]);
-            }
-            else if (!fixed[a] && fixed[b] && fixed[c])
+            // RCLCPP_INFO_STREAM(node_->get_logger(), "All fixed!");
+            continue;
+          }
+          else if (fixed(a) && fixed(b) && !fixed(c))
+          {
+            // c is free
+            if (waveFrontUpdate(distances_, predecessors_, inflation_radius, edge_distances, *topology, fh,
+                                face_normals[fh], a, b, c))
             {
-              // a if free
-              if (waveFrontUpdate(distances_, predecessors, inflation_radius, edge_distances, fh, face_normals[fh], b, c,
-                                  a))
-              {
-                pq.insert(a, distances_[a]);
-              }
-              // if(pq.containsKey(a)) pq.updateValue(a, distances[a]);
+              pq.insert(c, distances_[c]);
             }
-            else
+            // if(pq.containsKey(c)) pq.updateValue(c, distances[c]);
+          }
+          else if (fixed(a) && !fixed(b) && fixed(c))
+          {
+            // b is free
+            if (waveFrontUpdate(distances_, predecessors_, inflation_radius, edge_distances, *topology, fh,
+                                face_normals[fh], c, a, b))
             {
-              // two free vertices -> skip that face
-              // RCLCPP_INFO_STREAM(node_->get_logger(), "two vertices are free.");
-              continue;
+              pq.insert(b, distances_[b]);
             }
+            // if(pq.containsKey(b)) pq.updateValue(b, distances[b]);
           }
-          catch (lvr2::PanicException exception)
+          else if (!fixed(a) && fixed(b) && fixed(c))
           {
-            map_ptr_->invalid.insert(nh, true);
+            // a if free
+            if (waveFrontUpdate(distances_, predecessors_, inflation_radius, edge_distances, *topology, fh,
+                                face_normals[fh], b, c, a))
+            {
+              pq.insert(a, distances_[a]);
+            }
+            // if(pq.containsKey(a)) pq.updateValue(a, distances[a]);
           }
-          catch (lvr2::VertexLoopException exception)
+          else
           {
-            map_ptr_->invalid.insert(nh, true);
+            // two free vertices -> skip that face
+            // RCLCPP_INFO_STREAM(node_->get_logger(), "two vertices are free.");
+            continue;
           }
         }
+        catch (lvr2::PanicException exception)
+        {
+          map_ptr_->invalid.insert(nh, true);
+        }
+        catch (lvr2::VertexLoopException exception)
+        {
+          map_ptr_->invalid.insert(nh, true);
+        }
       }
     }
+  }
 
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Finished inflation wave front propagation.");
+  const auto& queue_stats = pq.statistics();
+  RCLCPP_INFO_STREAM(node_->get_logger(), "Vertex queue \"" << config_.queue_type << "\": " << queue_stats.inserts
+                                          << " inserts, " << queue_stats.pops << " pops, " << queue_stats.stale
+                                          << " stale entries, max size " << queue_stats.max_size);
+}
 
-    for (auto vH : mesh->vertices())
+template <typename VertexRange>
+void InflationLayer::updateRiskiness(const VertexRange& vertices)
+{
+  changed_vertices_.clear();
+  for (const auto& vH : vertices)
+  {
+    const float riskiness = fading(distances_[vH]);
+    if (!riskiness_.containsKey(vH) || riskiness_[vH] != riskiness)
     {
-      riskiness_.insert(vH, fading(distances_[vH]));
+      riskiness_.insert(vH, riskiness);
+      changed_vertices_.push_back(vH);
     }
-
-    map_ptr_->publishVectorField("inflation", vector_map_, distances_,
-                                std::bind(&InflationLayer::fading, this, std::placeholders::_1));
-  }
-  else
-  {
-    RCLCPP_ERROR_STREAM(node_->get_logger(), "Cannot init wave inflation: mesh_ptr points to null");
   }
+  changed_vertices_known_ = true;
 }
 
 lvr2::BaseVector<float> InflationLayer::vectorAt(const std::array<lvr2::VertexHandle, 3>& vertices,
@@ -658,12 +785,45 @@ rcl_interfaces::msg::SetParametersResult InflationLayer::reconfigureCallback(std
       config_.min_contour_size = parameter.as_int();
     } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".repulsive_field") {
       config_.repulsive_field = parameter.as_bool();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".queue_type") {
+      if (!mesh_map::isValidVertexQueueType(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown queue type \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.queue_type = parameter.as_string();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".incremental_update") {
+      config_.incremental_update = parameter.as_bool();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".propagation_method") {
+      if (parameter.as_string() != "fast_marching" && parameter.as_string() != "fast_iterative") {
+        result.successful = false;
+        result.reason = "Unknown propagation method \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.propagation_method = parameter.as_string();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_scheme" ||
+               parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_precision") {
+      const bool is_scheme = parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_scheme";
+      const std::string scheme = is_scheme ? parameter.as_string() : config_.update_scheme;
+      const std::string precision = is_scheme ? config_.update_precision : parameter.as_string();
+      if (!eikonal_kernel_.parse(scheme, precision)) {
+        result.successful = false;
+        result.reason = "Unknown update scheme \"" + scheme + "\" or precision \"" + precision + "\"";
+        return result;
+      }
+      config_.update_scheme = scheme;
+      config_.update_precision = precision;
     }
   }
 
   if (has_inflation_radius_changed){
     waveCostInflation(lethal_vertices_, config_.inflation_radius, config_.inscribed_radius, config_.inscribed_value, std::numeric_limits<float>::infinity());
   }
+  else if (has_vector_field_parameter_changed)
+  {
+    // the fading changed for all vertices
+    changed_vertices_known_ = false;
+  }
 
   if (has_vector_field_parameter_changed)
   {
@@ -747,6 +907,62 @@ bool InflationLayer::initialize()
     descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
     config_.repulsive_field = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".repulsive_field", config_.repulsive_field, descriptor);
   }
+  { // queue_type
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The priority queue used by the wave inflation: meap, quaternary_heap or radix_heap.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.queue_type = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".queue_type", config_.queue_type, descriptor);
+    if (!mesh_map::isValidVertexQueueType(config_.queue_type))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown queue type \"" << config_.queue_type << "\"!");
+      return false;
+    }
+  }
+  { // propagation_method
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The eikonal solver of the wave inflation: fast_marching, or the multi-threaded fast_iterative method for large maps. A repair always uses fast marching.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.propagation_method = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".propagation_method", config_.propagation_method, descriptor);
+    if (config_.propagation_method != "fast_marching" && config_.propagation_method != "fast_iterative")
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown propagation method \"" << config_.propagation_method << "\"!");
+      return false;
+    }
+  }
+  { // update_scheme
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The triangle update of the wave inflation: kimmel_sethian, law_of_cosines or signed_area.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.update_scheme = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_scheme", config_.update_scheme, descriptor);
+  }
+  { // update_precision
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The floating point precision in which the triangle update is computed: float or double.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.update_precision = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_precision", config_.update_precision, descriptor);
+    if (!eikonal_kernel_.parse(config_.update_scheme, config_.update_precision))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown update scheme \"" << config_.update_scheme << "\" or precision \"" << config_.update_precision << "\"!");
+      return false;
+    }
+  }
+  { // propagation_threads
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The number of threads of the fast iterative method, 0 uses all hardware threads.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+    descriptor.read_only = true;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.propagation_threads = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".propagation_threads", config_.propagation_threads, descriptor);
+  }
+  { // incremental_update
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Repair the inflation only around changed lethal vertices instead of inflating the whole mesh again.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+    config_.incremental_update = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".incremental_update", config_.incremental_update, descriptor);
+  }
   dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(&InflationLayer::reconfigureCallback, this, std::placeholders::_1));
   return true;
 }
@@ -0,0 +1,347 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include "mesh_layers/obstacle_layer.h"
+
+#include <functional>
+
+#include <pluginlib/class_list_macros.hpp>
+#include <tf2/LinearMath/Transform.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+
+PLUGINLIB_EXPORT_CLASS(mesh_layers::ObstacleLayer, mesh_map::AbstractLayer)
+
+namespace mesh_layers
+{
+//! cost of vertices occupied by an obstacle, free vertices have the default value
+static const float OBSTACLE_COST = 1.0;
+
+bool ObstacleLayer::readLayer()
+{
+  return false;
+}
+
+bool ObstacleLayer::writeLayer()
+{
+  return true;
+}
+
+float ObstacleLayer::threshold()
+{
+  return 0.5 * OBSTACLE_COST;
+}
+
+bool ObstacleLayer::computeLayer()
+{
+  const size_t num_slots = map_ptr_->mesh()->nextVertexIndex();
+  obstacle_costs_ = lvr2::DenseVertexMap<float>(num_slots, defaultValue());
+  last_marked_ = lvr2::DenseVertexMap<double>(num_slots, 0);
+  lethal_vertices_.clear();
+  changed_vertices_.clear();
+  changed_vertices_known_ = false;
+  return true;
+}
+
+lvr2::VertexMap<float>& ObstacleLayer::costs()
+{
+  return obstacle_costs_;
+}
+
+bool ObstacleLayer::lastChangedVertices(std::vector<lvr2::VertexHandle>& vertices)
+{
+  vertices = changed_vertices_;
+  return changed_vertices_known_;
+}
+
+void ObstacleLayer::cloudCallback(const sensor_msgs::msg::PointCloud2::SharedPtr msg)
+{
+  geometry_msgs::msg::TransformStamped transform_msg;
+  try
+  {
+    transform_msg = map_ptr_->tfBuffer().lookupTransform(map_ptr_->mapFrame(), msg->header.frame_id,
+                                                         rclcpp::Time(msg->header.stamp));
+  }
+  catch (const tf2::TransformException& ex)
+  {
+    RCLCPP_WARN_STREAM_THROTTLE(node_->get_logger(), *node_->get_clock(), 5000,
+                                "'" << layer_name_ << "': Dropping point cloud, " << ex.what());
+    return;
+  }
+  tf2::Transform transform;
+  tf2::fromMsg(transform_msg.transform, transform);
+
+  std::vector<mesh_map::Vector> points;
+  points.reserve(msg->width * msg->height);
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(*msg, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(*msg, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(*msg, "z");
+  for (; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z)
+  {
+    if (!std::isfinite(*iter_x) || !std::isfinite(*iter_y) || !std::isfinite(*iter_z))
+    {
+      continue;
+    }
+    const tf2::Vector3 point = transform * tf2::Vector3(*iter_x, *iter_y, *iter_z);
+    points.emplace_back(point.x(), point.y(), point.z());
+  }
+
+  std::lock_guard<std::mutex> lock(pending_mtx_);
+  pending_points_.insert(pending_points_.end(), points.begin(), points.end());
+}
+
+void ObstacleLayer::verticesAround(const std::vector<mesh_map::Vector>& points, const float radius,
+                                   std::vector<lvr2::VertexHandle>& vertices)
+{
+  vertices.clear();
+  if (!points.empty())
+  {
+    map_ptr_->radiusSearch(points, radius, offsets_, vertices);
+  }
+}
+
+void ObstacleLayer::setObstacle(const lvr2::VertexHandle& vH, const bool obstacle)
+{
+  if (obstacle ? !lethal_vertices_.insert(vH).second : lethal_vertices_.erase(vH) == 0)
+  {
+    return;
+  }
+  obstacle_costs_[vH] = obstacle ? OBSTACLE_COST : defaultValue();
+  changed_vertices_.push_back(vH);
+}
+
+void ObstacleLayer::updateObstacles()
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_mtx_);
+    points_.swap(pending_points_);
+    pending_points_.clear();
+  }
+
+  const auto bvh = map_ptr_->faceBVH();
+  if (!bvh || obstacle_costs_.numValues() == 0)
+  {
+    points_.clear();
+    return;
+  }
+
+  changed_vertices_.clear();
+  const double now = node_->now().seconds();
+  const float min_height = config_.min_obstacle_height;
+  const mesh_map::Vector down(0, 0, -1);
+
+  // the rays start slightly above the points, thus points below the surface due to sensor noise hit it as well. The
+  // first face below a point is the floor it belongs to, also on multi-level structures.
+  origins_.clear();
+  for (const auto& point : points_)
+  {
+    origins_.push_back(point - down * min_height);
+  }
+  directions_.assign(origins_.size(), down);
+  bvh->intersectRays(origins_, directions_, config_.max_obstacle_height + min_height, hits_);
+
+  marks_.clear();
+  clears_.clear();
+  for (size_t i = 0; i < hits_.size(); i++)
+  {
+    if (hits_[i].face)
+    {
+      const float height = hits_[i].distance - min_height;
+      (height < min_height ? clears_ : marks_).push_back(origins_[i] + down * hits_[i].distance);
+    }
+  }
+  points_.clear();
+
+  verticesAround(marks_, config_.marking_radius, vertices_);
+  for (const auto& vH : vertices_)
+  {
+    setObstacle(vH, true);
+    last_marked_[vH] = now;
+  }
+
+  // vertices marked by this update are kept, the obstacle may stand on the observed free surface around them
+  verticesAround(clears_, config_.clearing_radius, vertices_);
+  for (const auto& vH : vertices_)
+  {
+    if (last_marked_[vH] != now)
+    {
+      setObstacle(vH, false);
+    }
+  }
+
+  vertices_.clear();
+  for (const auto& vH : lethal_vertices_)
+  {
+    if (now - last_marked_[vH] > config_.obstacle_timeout)
+    {
+      vertices_.push_back(vH);
+    }
+  }
+  for (const auto& vH : vertices_)
+  {
+    setObstacle(vH, false);
+  }
+
+  if (!changed_vertices_.empty())
+  {
+    RCLCPP_DEBUG_STREAM(node_->get_logger(), "'" << layer_name_ << "': " << changed_vertices_.size()
+                                                << " vertices changed, " << lethal_vertices_.size()
+                                                << " are occupied.");
+    changed_vertices_known_ = true;
+    notifyChange();
+  }
+}
+
+rcl_interfaces::msg::SetParametersResult ObstacleLayer::reconfigureCallback(std::vector<rclcpp::Parameter> parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+
+  // the new values apply to the following observations, the current obstacles are kept
+  for (auto parameter : parameters)
+  {
+    if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".min_obstacle_height") {
+      config_.min_obstacle_height = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".max_obstacle_height") {
+      config_.max_obstacle_height = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".marking_radius") {
+      config_.marking_radius = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".clearing_radius") {
+      config_.clearing_radius = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".obstacle_timeout") {
+      config_.obstacle_timeout = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor") {
+      config_.factor = parameter.as_double();
+    }
+  }
+
+  return result;
+}
+
+bool ObstacleLayer::initialize()
+{
+  { // cloud topic
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "The point cloud topic the obstacles are observed in.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    descriptor.read_only = true;
+    config_.cloud_topic = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".cloud_topic", config_.cloud_topic, descriptor);
+  }
+  { // update rate
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Rate in Hz at which the buffered observations are applied to the layer.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    descriptor.read_only = true;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 50.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.update_rate = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".update_rate", config_.update_rate, descriptor);
+  }
+  { // min obstacle height
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Points closer to the surface below them are ground observations, which clear obstacles.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.min_obstacle_height = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".min_obstacle_height", config_.min_obstacle_height, descriptor);
+  }
+  { // max obstacle height
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Points farther above the surface below them are ignored, e.g. ceilings.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 10.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.max_obstacle_height = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".max_obstacle_height", config_.max_obstacle_height, descriptor);
+  }
+  { // marking radius
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Radius around the projected obstacle points in which vertices are marked as lethal.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.01;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.marking_radius = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".marking_radius", config_.marking_radius, descriptor);
+  }
+  { // clearing radius
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Radius around the ground points in which marked vertices are cleared.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.01;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.clearing_radius = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".clearing_radius", config_.clearing_radius, descriptor);
+  }
+  { // obstacle timeout
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Time in seconds after which marked vertices which have not been observed again are cleared.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.1;
+    range.to_value = 600.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.obstacle_timeout = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".obstacle_timeout", config_.obstacle_timeout, descriptor);
+  }
+  { // factor
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Using this factor to weight this layer.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    rcl_interfaces::msg::FloatingPointRange range;
+    range.from_value = 0.0;
+    range.to_value = 1.0;
+    descriptor.floating_point_range.push_back(range);
+    config_.factor = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor", config_.factor, descriptor);
+  }
+  dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(
+      &ObstacleLayer::reconfigureCallback, this, std::placeholders::_1));
+
+  computeLayer();
+  cloud_sub_ = node_->create_subscription<sensor_msgs::msg::PointCloud2>(
+      config_.cloud_topic, rclcpp::SensorDataQoS(),
+      std::bind(&ObstacleLayer::cloudCallback, this, std::placeholders::_1));
+  update_timer_ = node_->create_wall_timer(std::chrono::duration<double>(1.0 / config_.update_rate),
+                                           std::bind(&ObstacleLayer::updateObstacles, this));
+  return true;
+}
+
+} /* namespace mesh_layers */
@@ -40,6 +40,7 @@
 #include <lvr2/geometry/BaseVector.hpp>
 #include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
+#include <mesh_map/vertex_kernels.h>
 #include <pluginlib/class_list_macros.hpp>
 #include <math.h>
 
@@ -90,6 +91,11 @@ bool RidgeLayer::computeLethals()
   return true;
 }
 
+std::string RidgeLayer::parameterSignature()
+{
+  return "radius=" + std::to_string(config_.radius) + ";neighborhood_strategy=" + config_.neighborhood_strategy;
+}
+
 float RidgeLayer::threshold()
 {
   return config_.threshold;
@@ -99,86 +105,37 @@ bool RidgeLayer::computeLayer()
 {
   RCLCPP_INFO_STREAM(node_->get_logger(), "Computing ridge...");
 
-  lvr2::DenseFaceMap<mesh_map::Normal> face_normals;
-
   const auto mesh = map_ptr_->mesh();
-  auto mesh_io = map_ptr_->meshIO();
-  auto face_normals_opt = mesh_io->getDenseAttributeMap<lvr2::DenseFaceMap<mesh_map::Normal>>("face_normals");
-
-  if (face_normals_opt)
-  {
-    face_normals = face_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << face_normals.numValues() << " face normals in map file.");
-  }
-  else
-  {
-    RCLCPP_INFO_STREAM(node_->get_logger(), "No face normals found in the given map file, computing them...");
-    face_normals = lvr2::calcFaceNormals(*mesh);
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Computed " << face_normals.numValues() << " face normals.");
-    if (mesh_io->addDenseAttributeMap(face_normals, "face_normals"))
-    {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved face normals to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save face normals to map file!");
-      return false;
-    }
-  }
-
-  lvr2::DenseVertexMap<mesh_map::Normal> vertex_normals;
-  auto vertex_normals_opt = mesh_io->getDenseAttributeMap<lvr2::DenseVertexMap<mesh_map::Normal>>("vertex_normals");
-
-  if (vertex_normals_opt)
-  {
-    vertex_normals = vertex_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << vertex_normals.numValues() << " vertex normals in map file!");
-  }
-  else
-  {
-    RCLCPP_INFO_STREAM(node_->get_logger(), "No vertex normals found in the given map file, computing them...");
-    vertex_normals = lvr2::calcVertexNormals(*mesh, face_normals);
-    if (mesh_io->addDenseAttributeMap(vertex_normals, "vertex_normals"))
-    {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved vertex normals to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save vertex normals to map file!");
-      return false;
-    }
-  }
+  // the normals are provided by the mesh map, the map file must not be accessed while computing the layer
+  const auto& vertex_normals = map_ptr_->vertexNormals();
 
-  ridge_.reserve(mesh->nextVertexIndex());
+  const size_t num_threads = mesh_map::resolveThreadCount(config_.threads);
+  const float radius = config_.radius;
+  // the neighbourhoods are shared with the other layers using the same strategy and radius
+  std::vector<mesh_map::LocalNeighborhood> neighborhoods(
+      num_threads, map_ptr_->localNeighborhood(config_.neighborhood_strategy, radius, num_threads));
 
-  for (size_t i = 0; i < mesh->nextVertexIndex(); i++)
-  {
-    auto vH = lvr2::VertexHandle(i);
+  ridge_ = lvr2::DenseVertexMap<float>(mesh->nextVertexIndex(), config_.threshold + 0.1);
+  mesh_map::parallelForEachVertex(mesh->nextVertexIndex(), num_threads, [&](const size_t thread, const lvr2::VertexHandle& vH) {
     if (!mesh->containsVertex(vH))
     {
-      ridge_.insert(vH, config_.threshold + 0.1);
-      continue;
+      return;
     }
 
-    std::set<lvr2::VertexHandle> invalid;
-
     float value = 0.0;
     int num_neighbours = 0;
     lvr2::BaseVector<float> reference = mesh->getVertexPosition(vH) + vertex_normals[vH];
-    visitLocalVertexNeighborhood(*mesh, invalid, vH, config_.radius, [&](auto vertex) {
+    neighborhoods[thread].visit(vH, radius, [&](const lvr2::VertexHandle& vertex) {
       lvr2::BaseVector<float> current_point = mesh->getVertexPosition(vertex) + vertex_normals[vertex];
       value += (current_point - reference).length();
       num_neighbours++;
     });
 
-    if (num_neighbours == 0)
+    if (num_neighbours > 0)
     {
-      ridge_.insert(vH, config_.threshold + 0.1);
-      continue;
+      ridge_[vH] = value / num_neighbours;
     }
-
-    ridge_.insert(vH, value / num_neighbours);
-  }
+  });
 
   return computeLethals();
 }
@@ -204,6 +161,16 @@ rcl_interfaces::msg::SetParametersResult RidgeLayer::reconfigureCallback(std::ve
       has_radius_changed = true;
     } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor") {
       config_.factor = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads") {
+      config_.threads = parameter.as_int();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy") {
+      if (!mesh_map::isValidNeighborhoodStrategy(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown neighborhood strategy \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.neighborhood_strategy = parameter.as_string();
+      has_radius_changed = true;
     }
   }
 
@@ -250,6 +217,27 @@ bool RidgeLayer::initialize()
     descriptor.floating_point_range.push_back(range);
     config_.factor = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor", config_.factor, descriptor);
   }
+  { // threads
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Number of threads used to compute the layer, 0 uses the number of hardware threads.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.threads = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads", config_.threads, descriptor);
+  }
+  { // neighborhood_strategy
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "How the local neighbourhood is found: 'topology' walks the mesh, 'radius' queries the k-d tree.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.neighborhood_strategy = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy", config_.neighborhood_strategy, descriptor);
+    if (!mesh_map::isValidNeighborhoodStrategy(config_.neighborhood_strategy))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown neighborhood strategy \"" << config_.neighborhood_strategy << "\"!");
+      return false;
+    }
+  }
   dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(
       &RidgeLayer::reconfigureCallback, this, std::placeholders::_1));
   return true;
@@ -37,8 +37,12 @@
 
 #include "mesh_layers/roughness_layer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
+#include <mesh_map/vertex_kernels.h>
 #include <pluginlib/class_list_macros.hpp>
 
 PLUGINLIB_EXPORT_CLASS(mesh_layers::RoughnessLayer, mesh_map::AbstractLayer)
@@ -83,61 +87,46 @@ bool RoughnessLayer::computeLethals()
   return true;
 }
 
+std::string RoughnessLayer::parameterSignature() {
+  return "radius=" + std::to_string(config_.radius) +
+         ";neighborhood_strategy=" + config_.neighborhood_strategy;
+}
+
 float RoughnessLayer::threshold() { return config_.threshold; }
 
 bool RoughnessLayer::computeLayer() {
   RCLCPP_INFO_STREAM(node_->get_logger(), "Computing roughness...");
 
-  lvr2::DenseFaceMap<mesh_map::Normal> face_normals;
-
   const auto mesh = map_ptr_->mesh();
-  auto mesh_io = map_ptr_->meshIO();
-
-  auto face_normals_opt =
-      mesh_io->getDenseAttributeMap<lvr2::DenseFaceMap<mesh_map::Normal>>(
-          "face_normals");
-
-  if (face_normals_opt) {
-    face_normals = face_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << face_normals.numValues()
-                             << " face normals in map file.");
-  } else {
-    RCLCPP_INFO_STREAM(node_->get_logger(), 
-        "No face normals found in the given map file, computing them...");
-    face_normals = lvr2::calcFaceNormals(*mesh);
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Computed " << face_normals.numValues()
-                                << " face normals.");
-    if (mesh_io->addDenseAttributeMap(face_normals, "face_normals")) {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved face normals to map file.");
-    } else {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save face normals to map file!");
-      return false;
-    }
-  }
-
-  lvr2::DenseVertexMap<mesh_map::Normal> vertex_normals;
-  auto vertex_normals_opt =
-      mesh_io->getDenseAttributeMap<lvr2::DenseVertexMap<mesh_map::Normal>>(
-          "vertex_normals");
-
-  if (vertex_normals_opt) {
-    vertex_normals = vertex_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << vertex_normals.numValues()
-                             << " vertex normals in map file!");
-  } else {
-    RCLCPP_INFO_STREAM(node_->get_logger(), 
-        "No vertex normals found in the given map file, computing them...");
-    vertex_normals = lvr2::calcVertexNormals(*mesh, face_normals);
-    if (mesh_io->addDenseAttributeMap(vertex_normals, "vertex_normals")) {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved vertex normals to map file.");
-    } else {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save vertex normals to map file!");
-      return false;
-    }
-  }
-
-  roughness_ =
-      lvr2::calcVertexRoughness(*mesh, config_.radius, vertex_normals);
+  // the normals are provided by the mesh map, the map file must not be accessed while computing the layer
+  const auto& vertex_normals = map_ptr_->vertexNormals();
+
+  const size_t num_threads = mesh_map::resolveThreadCount(config_.threads);
+  const float radius = config_.radius;
+  // the neighbourhoods are shared with the other layers using the same strategy and radius
+  std::vector<mesh_map::LocalNeighborhood> neighborhoods(
+      num_threads, map_ptr_->localNeighborhood(config_.neighborhood_strategy, radius, num_threads));
+
+  // mean angle between the vertex normal and the normals in its neighbourhood, as lvr2::calcVertexRoughness
+  roughness_ = mesh_map::denseVertexMap<float>(*mesh, 0);
+  mesh_map::parallelForEachVertex(
+      mesh->nextVertexIndex(), num_threads,
+      [&](const size_t thread, const lvr2::VertexHandle &vH) {
+        if (!mesh->containsVertex(vH)) {
+          return;
+        }
+
+        const auto &normal = vertex_normals[vH];
+        double sum = 0.0;
+        size_t count = 0;
+        neighborhoods[thread].visit(vH, radius, [&](const lvr2::VertexHandle &vertex) {
+          const float cosine = normal.dot(vertex_normals[vertex]);
+          sum += std::acos(std::max(-1.0f, std::min(1.0f, cosine)));
+          count++;
+        });
+
+        roughness_[vH] = count > 0 ? sum / count : 0;
+      });
 
   return computeLethals();
 }
@@ -150,6 +139,7 @@ rcl_interfaces::msg::SetParametersResult RoughnessLayer::reconfigureCallback(std
   result.successful = true;
 
   bool has_threshold_changed = false;
+  bool has_strategy_changed = false;
   for (auto parameter : parameters) {
     if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threshold") {
       config_.threshold = parameter.as_double();
@@ -158,10 +148,25 @@ rcl_interfaces::msg::SetParametersResult RoughnessLayer::reconfigureCallback(std
       config_.radius = parameter.as_double();
     } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor") {
       config_.factor = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads") {
+      config_.threads = parameter.as_int();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy") {
+      if (!mesh_map::isValidNeighborhoodStrategy(parameter.as_string())) {
+        result.successful = false;
+        result.reason = "Unknown neighborhood strategy \"" + parameter.as_string() + "\"";
+        return result;
+      }
+      config_.neighborhood_strategy = parameter.as_string();
+      has_strategy_changed = true;
     }
   }
 
-  if (has_threshold_changed) {
+  if (has_strategy_changed) {
+    // the roughness itself depends on the neighbourhoods, the lethals are recomputed with it
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Recompute layer and notify change from " << layer_name_ << " due to cfg change.");
+    computeLayer();
+    notifyChange();
+  } else if (has_threshold_changed) {
     RCLCPP_INFO_STREAM(node_->get_logger(), "Recompute lethals and notify change from " << layer_name_ << " due to cfg change.");
     computeLethals();
     notifyChange();
@@ -201,6 +206,27 @@ bool RoughnessLayer::initialize() {
     descriptor.floating_point_range.push_back(range);
     config_.factor = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor", config_.factor, descriptor);
   }
+  { // threads
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Number of threads used to compute the layer, 0 uses the number of hardware threads.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.threads = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads", config_.threads, descriptor);
+  }
+  { // neighborhood_strategy
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "How the local neighbourhood is found: 'topology' walks the mesh, 'radius' queries the k-d tree.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+    config_.neighborhood_strategy = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".neighborhood_strategy", config_.neighborhood_strategy, descriptor);
+    if (!mesh_map::isValidNeighborhoodStrategy(config_.neighborhood_strategy))
+    {
+      RCLCPP_ERROR_STREAM(node_->get_logger(), "Unknown neighborhood strategy \"" << config_.neighborhood_strategy << "\"!");
+      return false;
+    }
+  }
   dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(
       &RoughnessLayer::reconfigureCallback, this, std::placeholders::_1));
   return true;
@@ -39,6 +39,7 @@
 
 #include <lvr2/algorithm/GeometryAlgorithms.hpp>
 #include <lvr2/algorithm/NormalAlgorithms.hpp>
+#include <mesh_map/vertex_kernels.h>
 #include <pluginlib/class_list_macros.hpp>
 #include <math.h>
 
@@ -98,68 +99,18 @@ bool SteepnessLayer::computeLayer()
 {
   RCLCPP_INFO_STREAM(node_->get_logger(), "Computing steepness...");
 
-  lvr2::DenseFaceMap<mesh_map::Normal> face_normals;
-
   const auto mesh = map_ptr_->mesh();
-  auto mesh_io = map_ptr_->meshIO();
-  auto face_normals_opt = mesh_io->getDenseAttributeMap<lvr2::DenseFaceMap<mesh_map::Normal>>("face_normals");
+  // the normals are provided by the mesh map, the map file must not be accessed while computing the layer
+  const auto& vertex_normals = map_ptr_->vertexNormals();
 
-  if (face_normals_opt)
-  {
-    face_normals = face_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << face_normals.numValues() << " face normals in map file.");
-  }
-  else
-  {
-    RCLCPP_INFO_STREAM(node_->get_logger(), "No face normals found in the given map file, computing them...");
-    face_normals = lvr2::calcFaceNormals(*mesh);
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Computed " << face_normals.numValues() << " face normals.");
-    if (mesh_io->addDenseAttributeMap(face_normals, "face_normals"))
-    {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved face normals to map file.");
-    }
-    else
+  steepness_ = mesh_map::denseVertexMap<float>(*mesh, 0);
+  mesh_map::parallelForEachVertex(mesh->nextVertexIndex(), mesh_map::resolveThreadCount(config_.threads),
+                                  [&](const size_t thread, const lvr2::VertexHandle& vH) {
+    if (mesh->containsVertex(vH))
     {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save face normals to map file!");
-      return false;
+      steepness_[vH] = acos(vertex_normals[vH].z);
     }
-  }
-
-  lvr2::DenseVertexMap<mesh_map::Normal> vertex_normals;
-  auto vertex_normals_opt = mesh_io->getDenseAttributeMap<lvr2::DenseVertexMap<mesh_map::Normal>>("vertex_normals");
-
-  if (vertex_normals_opt)
-  {
-    vertex_normals = vertex_normals_opt.get();
-    RCLCPP_INFO_STREAM(node_->get_logger(), "Found " << vertex_normals.numValues() << " vertex normals in map file!");
-  }
-  else
-  {
-    RCLCPP_INFO_STREAM(node_->get_logger(), "No vertex normals found in the given map file, computing them...");
-    vertex_normals = lvr2::calcVertexNormals(*mesh, face_normals);
-    if (mesh_io->addDenseAttributeMap(vertex_normals, "vertex_normals"))
-    {
-      RCLCPP_INFO_STREAM(node_->get_logger(), "Saved vertex normals to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not save vertex normals to map file!");
-      return false;
-    }
-  }
-
-  steepness_.reserve(mesh->nextVertexIndex());
-
-  for (size_t i = 0; i < mesh->nextVertexIndex(); i++)
-  {
-    auto vH = lvr2::VertexHandle(i);
-    if (!mesh->containsVertex(vH))
-    {
-      continue;
-    }
-
-    steepness_.insert(vH, acos(vertex_normals[vH].z));
-  }
+  });
 
   return computeLethals();
 }
@@ -181,6 +132,8 @@ rcl_interfaces::msg::SetParametersResult SteepnessLayer::reconfigureCallback(std
       has_threshold_changed = true;
     } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor") {
       config_.factor = parameter.as_double();
+    } else if (parameter.get_name() == mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads") {
+      config_.threads = parameter.as_int();
     }
   }
 
@@ -215,6 +168,16 @@ bool SteepnessLayer::initialize()
     descriptor.floating_point_range.push_back(range);
     config_.factor = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".factor", config_.factor, descriptor);
   }
+  { // threads
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.description = "Number of threads used to compute the layer, 0 uses the number of hardware threads.";
+    descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+    rcl_interfaces::msg::IntegerRange range;
+    range.from_value = 0;
+    range.to_value = 256;
+    descriptor.integer_range.push_back(range);
+    config_.threads = node_->declare_parameter(mesh_map::MeshMap::MESH_MAP_NAMESPACE + "." + layer_name_ + ".threads", config_.threads, descriptor);
+  }
   dyn_params_handler_ = node_->add_on_set_parameters_callback(std::bind(
       &SteepnessLayer::reconfigureCallback, this, std::placeholders::_1));
   return true;
@@ -37,6 +37,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include <boost/optional.hpp>
 #include <lvr2/io/AttributeMeshIOBase.hpp>
@@ -116,6 +117,41 @@ public:
   virtual void updateLethal(std::set<lvr2::VertexHandle>& added_lethal,
                             std::set<lvr2::VertexHandle>& removed_lethal) = 0;
 
+  /**
+   * @brief Delivers the vertices whose costs changed with the last update of the layer, e.g. by updateLethal(). The
+   * mesh map uses them to update the combined costs only where they changed.
+   * @param[out] vertices The changed vertices.
+   * @return true, if the layer tracks its changes and the vertices are complete. Default is false, i.e. all costs are
+   * considered to be changed.
+   */
+  virtual bool lastChangedVertices(std::vector<lvr2::VertexHandle>& vertices)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Describes the parameters the layer costs are computed with, e.g. "radius=0.3". The mesh map stores the
+   * signature with the layer in the map file when the layer is written, and only lets readLayer() use the stored costs
+   * if the signature is unchanged. Parameters which only affect the lethal vertices, e.g. the threshold, do not need
+   * to be part of it, since the lethals are computed from the costs after reading them.
+   * @return the parameter signature, the default is an empty string for layers without such parameters.
+   */
+  virtual std::string parameterSignature()
+  {
+    return "";
+  }
+
+  /**
+   * @brief Defines whether the layer costs depend on the "lethal" obstacles of the previously processed layers.
+   * Layers which do not depend on them, i.e. which ignore updateLethal(), can return false to not receive lethal
+   * updates anymore and to be computed concurrently to other layers.
+   * @return true, if the layer uses the lethal vertices passed to updateLethal(). Default is true.
+   */
+  virtual bool dependsOnLethals()
+  {
+    return true;
+  }
+
   /**
    * @brief Optional method if the layer computes vectors. Computes a vector within a triangle using barycentric coordinates.
    * @param vertices The three triangle vertices.
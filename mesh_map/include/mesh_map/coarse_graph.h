@@ -0,0 +1,183 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__COARSE_GRAPH_H
+#define MESH_MAP__COARSE_GRAPH_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/BaseMesh.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+#include "mesh_topology.h"
+
+namespace mesh_map
+{
+
+/**
+ * @brief Coarse level of the navigation mesh for hierarchical planning.
+ *
+ * The vertices are clustered by a voxel grid. Each node of the graph is a connected set of vertices inside one voxel,
+ * thus surfaces above each other, e.g. a bridge and the ground below, form separate nodes. Two nodes are connected
+ * if a mesh edge connects their vertices. A route on the coarse graph settles a few nodes per voxel instead of all
+ * vertices and is used to restrict the fine planning to a corridor around it.
+ */
+class CoarseGraph
+{
+public:
+  typedef std::shared_ptr<const CoarseGraph> ConstPtr;
+
+  //! node of vertices which are not part of the graph, e.g. deleted or broken vertices
+  static constexpr uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Clusters the vertices of the mesh
+   * @param mesh The mesh providing the vertex positions
+   * @param topology The topology snapshot of the mesh
+   * @param cell_size The edge length of the voxels
+   */
+  CoarseGraph(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const MeshTopology& topology,
+              const float cell_size);
+
+  /**
+   * @brief Restores a graph written by serialize()
+   * @param data The serialized graph
+   * @param size The size of the data in bytes
+   * @param mesh_hash The content hash of the current mesh, see meshContentHash()
+   * @return The graph, or an empty pointer if the data is not a valid graph of the current mesh
+   */
+  static ConstPtr deserialize(const unsigned char* data, const size_t size, const uint64_t mesh_hash);
+
+  /**
+   * @brief Writes the graph into a flat byte buffer
+   * @param mesh_hash The content hash of the clustered mesh, which is checked by deserialize()
+   * @param[out] data The serialized graph
+   */
+  void serialize(const uint64_t mesh_hash, std::vector<unsigned char>& data) const;
+
+  /**
+   * @brief Returns the node of the vertex, or INVALID_NODE
+   */
+  uint32_t nodeOf(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < vertex_nodes_.size() ? vertex_nodes_[vH.idx()] : INVALID_NODE;
+  }
+
+  /**
+   * @brief Returns the vertices clustered into the node
+   */
+  HandleRange<lvr2::VertexHandle> verticesOfNode(const uint32_t node) const
+  {
+    return HandleRange<lvr2::VertexHandle>(node_vertices_.data() + node_offsets_[node],
+                                           node_vertices_.data() + node_offsets_[node + 1]);
+  }
+
+  /**
+   * @brief Marks the nodes which are blocked, i.e. more than half of their vertices exceeds the cost limit
+   * @param costs The vertex costs
+   * @param cost_limit The cost limit of the planner
+   * @param[out] blocked One flag per node
+   */
+  void blockedNodes(const lvr2::DenseVertexMap<float>& costs, const float cost_limit,
+                    std::vector<uint8_t>& blocked) const;
+
+  /**
+   * @brief Searches the shortest route between two nodes with A* on the centroid distances
+   * @param start The start node
+   * @param goal The goal node
+   * @param blocked Nodes which must not be entered, see blockedNodes()
+   * @param[out] path The nodes of the route from start to goal
+   * @return true if a route has been found
+   */
+  bool shortestPath(const uint32_t start, const uint32_t goal, const std::vector<uint8_t>& blocked,
+                    std::vector<uint32_t>& path) const;
+
+  /**
+   * @brief Collects the nodes which are reachable within the given distance from the route along the graph
+   * @param path The nodes of the route
+   * @param width The maximum distance of the corridor nodes to the route
+   * @param[out] corridor One flag per node
+   */
+  void corridor(const std::vector<uint32_t>& path, const float width, std::vector<uint8_t>& corridor) const;
+
+  //! edge length of the voxels
+  float cellSize() const
+  {
+    return cell_size_;
+  }
+
+  //! number of nodes
+  size_t numNodes() const
+  {
+    return positions_.size();
+  }
+
+  //! number of vertex slots of the clustered mesh
+  size_t numVertexSlots() const
+  {
+    return vertex_nodes_.size();
+  }
+
+private:
+  CoarseGraph() = default;
+
+  float cell_size_ = 0;
+
+  //! node of each vertex slot
+  std::vector<uint32_t> vertex_nodes_;
+
+  //! CSR offsets into node_vertices_, size numNodes() + 1
+  std::vector<uint32_t> node_offsets_;
+  std::vector<lvr2::VertexHandle> node_vertices_;
+
+  //! centroid of the vertices of each node
+  std::vector<lvr2::BaseVector<float>> positions_;
+
+  //! CSR offsets into edge_targets_ and edge_lengths_, size numNodes() + 1
+  std::vector<uint32_t> edge_offsets_;
+  std::vector<uint32_t> edge_targets_;
+  std::vector<float> edge_lengths_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__COARSE_GRAPH_H
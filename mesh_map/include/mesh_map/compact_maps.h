@@ -0,0 +1,425 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__COMPACT_MAPS_H
+#define MESH_MAP__COMPACT_MAPS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Costs of all vertex slots, stored as floats or quantized to 8 or 16 bit codes.
+ *
+ * The quantized codes cover the range of the finite costs with a per-array offset and step, the highest code stands
+ * for infinite costs. Thus, a 16 bit array of a layer with costs between 0 and 1 has an error of less than 1e-5 and
+ * takes half of the memory, an 8 bit array an error of less than 2e-3 and takes a quarter.
+ */
+class CostArray
+{
+public:
+  /**
+   * @param bits The number of bits per cost, 8, 16 or 32 for floats
+   */
+  explicit CostArray(const int bits = 32) : bits_(bits), offset_(0), step_(1), max_cost_(0)
+  {
+    if (bits != 8 && bits != 16 && bits != 32)
+    {
+      throw std::invalid_argument("Unsupported number of bits per cost, use 8, 16 or 32");
+    }
+  }
+
+  int bits() const
+  {
+    return bits_;
+  }
+
+  size_t size() const
+  {
+    return bits_ == 8 ? codes8_.size() : bits_ == 16 ? codes16_.size() : floats_.size();
+  }
+
+  //! quantization step, the decoded costs differ by up to half of it from the stored ones
+  float step() const
+  {
+    return bits_ == 32 ? 0 : step_;
+  }
+
+  /**
+   * @brief Replaces the costs, the quantization range is fitted to the finite costs. Non-finite costs are stored as
+   *        infinity.
+   */
+  void assign(std::vector<float>&& costs)
+  {
+    if (bits_ == 32)
+    {
+      floats_ = std::move(costs);
+      return;
+    }
+
+    float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::lowest();
+    for (const float cost : costs)
+    {
+      if (std::isfinite(cost))
+      {
+        min = std::min(min, cost);
+        max = std::max(max, cost);
+      }
+    }
+    if (min > max)
+    {
+      min = max = 0;
+    }
+    offset_ = min;
+    step_ = max > min ? (max - min) / (maxCode() - 1) : 1;
+    max_cost_ = max;
+
+    if (bits_ == 8)
+    {
+      encodeAll(costs, codes8_);
+    }
+    else
+    {
+      encodeAll(costs, codes16_);
+    }
+  }
+
+  /**
+   * @brief Sets the cost of a single vertex slot
+   * @return false if the cost is outside of the quantization range, it is stored clamped to the range then and the
+   *         array has to be assigned again to represent it
+   */
+  bool set(const size_t i, const float cost)
+  {
+    if (bits_ == 32)
+    {
+      floats_[i] = cost;
+      return true;
+    }
+    // constant costs have no range to quantize, every other cost needs a new assignment
+    const bool in_range = !std::isfinite(cost) ||
+                          (max_cost_ > offset_ ? cost >= offset_ - 0.5 * step_ && cost <= max_cost_ + 0.5 * step_
+                                               : cost == offset_);
+    if (bits_ == 8)
+    {
+      codes8_[i] = encode<uint8_t>(cost);
+    }
+    else
+    {
+      codes16_[i] = encode<uint16_t>(cost);
+    }
+    return in_range;
+  }
+
+  float operator[](const size_t i) const
+  {
+    return bits_ == 8 ? decode(codes8_[i]) : bits_ == 16 ? decode(codes16_[i]) : floats_[i];
+  }
+
+  /**
+   * @brief Adds the weighted costs to the given array, out[i] += factor * cost[i] for all slots
+   */
+  void addTo(float* const out, const float factor) const
+  {
+    if (bits_ == 8)
+    {
+      addCodesTo(codes8_, out, factor);
+    }
+    else if (bits_ == 16)
+    {
+      addCodesTo(codes16_, out, factor);
+    }
+    else
+    {
+      const float* const costs = floats_.data();
+      for (size_t i = 0; i < floats_.size(); i++)
+      {
+        out[i] += factor * costs[i];
+      }
+    }
+  }
+
+  size_t memoryUsage() const
+  {
+    return codes8_.capacity() + codes16_.capacity() * sizeof(uint16_t) + floats_.capacity() * sizeof(float);
+  }
+
+private:
+  uint32_t maxCode() const
+  {
+    return (uint32_t(1) << bits_) - 1;
+  }
+
+  template <typename CodeT>
+  CodeT encode(const float cost) const
+  {
+    if (!std::isfinite(cost))
+    {
+      return maxCode();
+    }
+    const float code = std::round((cost - offset_) / step_);
+    return static_cast<CodeT>(std::min(std::max(code, 0.0f), static_cast<float>(maxCode() - 1)));
+  }
+
+  template <typename CodeT>
+  float decode(const CodeT code) const
+  {
+    return code == maxCode() ? std::numeric_limits<float>::infinity() : offset_ + code * step_;
+  }
+
+  template <typename CodeT>
+  void encodeAll(const std::vector<float>& costs, std::vector<CodeT>& codes) const
+  {
+    codes.resize(costs.size());
+    for (size_t i = 0; i < costs.size(); i++)
+    {
+      codes[i] = encode<CodeT>(costs[i]);
+    }
+  }
+
+  template <typename CodeT>
+  void addCodesTo(const std::vector<CodeT>& codes, float* const out, const float factor) const
+  {
+    const CodeT max_code = maxCode();
+    const float offset = factor * offset_, step = factor * step_;
+    const float infinity = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < codes.size(); i++)
+    {
+      out[i] += codes[i] == max_code ? infinity : offset + codes[i] * step;
+    }
+  }
+
+  int bits_;
+  float offset_;
+  float step_;
+  float max_cost_;
+  std::vector<float> floats_;
+  std::vector<uint8_t> codes8_;
+  std::vector<uint16_t> codes16_;
+};
+
+/**
+ * @brief Encodes a unit vector with an octahedral projection into two 16 bit components, the angular error is below
+ *        0.01 degrees. The code is never zero, which is used to mark missing vectors.
+ */
+inline uint32_t encodeOctahedral(const lvr2::BaseVector<float>& vec)
+{
+  const float norm = std::fabs(vec.x) + std::fabs(vec.y) + std::fabs(vec.z);
+  float u = norm > 0 ? vec.x / norm : 0;
+  float v = norm > 0 ? vec.y / norm : 0;
+  if (vec.z < 0)
+  {
+    // fold the lower hemisphere over the diagonals
+    const float fu = (1 - std::fabs(v)) * (u >= 0 ? 1 : -1);
+    const float fv = (1 - std::fabs(u)) * (v >= 0 ? 1 : -1);
+    u = fu;
+    v = fv;
+  }
+  const auto quantize = [](const float value) {
+    return static_cast<uint32_t>(std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f) + 32768);
+  };
+  return (quantize(u) << 16) | quantize(v);
+}
+
+/**
+ * @brief Decodes a unit vector encoded by encodeOctahedral()
+ */
+inline lvr2::BaseVector<float> decodeOctahedral(const uint32_t code)
+{
+  float u = (static_cast<float>(code >> 16) - 32768) / 32767.0f;
+  float v = (static_cast<float>(code & 0xFFFF) - 32768) / 32767.0f;
+  const float z = 1 - std::fabs(u) - std::fabs(v);
+  if (z < 0)
+  {
+    const float fu = (1 - std::fabs(v)) * (u >= 0 ? 1 : -1);
+    const float fv = (1 - std::fabs(u)) * (v >= 0 ? 1 : -1);
+    u = fu;
+    v = fv;
+  }
+  return lvr2::BaseVector<float>(u, v, z).normalized();
+}
+
+/**
+ * @brief Unit vectors of the vertex slots, octahedral encoded in 4 instead of 12 bytes per vertex plus the optional
+ *        flag of a lvr2::DenseVertexMap. Non-unit vectors are stored normalized.
+ */
+class CompactVectorMap
+{
+public:
+  explicit CompactVectorMap(const size_t num_slots = 0) : codes_(num_slots, 0), size_(0)
+  {
+  }
+
+  //! number of stored vectors
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool containsKey(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < codes_.size() && codes_[vH.idx()] != 0;
+  }
+
+  void insert(const lvr2::VertexHandle& vH, const lvr2::BaseVector<float>& vec)
+  {
+    if (vH.idx() >= codes_.size())
+    {
+      codes_.resize(vH.idx() + 1, 0);
+    }
+    size_ += codes_[vH.idx()] == 0;
+    codes_[vH.idx()] = encodeOctahedral(vec);
+  }
+
+  void erase(const lvr2::VertexHandle& vH)
+  {
+    if (containsKey(vH))
+    {
+      codes_[vH.idx()] = 0;
+      size_--;
+    }
+  }
+
+  boost::optional<lvr2::BaseVector<float>> get(const lvr2::VertexHandle& vH) const
+  {
+    if (!containsKey(vH))
+    {
+      return boost::none;
+    }
+    return decodeOctahedral(codes_[vH.idx()]);
+  }
+
+  size_t memoryUsage() const
+  {
+    return codes_.capacity() * sizeof(uint32_t);
+  }
+
+private:
+  std::vector<uint32_t> codes_;
+  size_t size_;
+};
+
+/**
+ * @brief Boolean flag of each vertex slot stored as one bit, e.g. the invalid vertices of the map. The flags are set
+ *        atomically, thus several threads can mark different vertices concurrently.
+ */
+class VertexFlags
+{
+public:
+  explicit VertexFlags(const size_t num_slots = 0)
+    : num_slots_(num_slots), words_(new std::atomic<uint64_t>[(num_slots + 63) / 64])
+  {
+    for (size_t i = 0; i < numWords(); i++)
+    {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  size_t numSlots() const
+  {
+    return num_slots_;
+  }
+
+  //! false for vertex slots beyond numSlots()
+  bool operator[](const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < num_slots_ && (words_[vH.idx() / 64].load(std::memory_order_relaxed) >> (vH.idx() % 64)) & 1;
+  }
+
+  /**
+   * @brief Sets or clears the flag of the vertex, the interface matches lvr2::DenseVertexMap<bool>
+   * @throws std::out_of_range if the vertex slot is beyond numSlots()
+   */
+  void insert(const lvr2::VertexHandle& vH, const bool value)
+  {
+    if (vH.idx() >= num_slots_)
+    {
+      throw std::out_of_range("The vertex is beyond the slots of the vertex flags");
+    }
+    const uint64_t mask = uint64_t(1) << (vH.idx() % 64);
+    if (value)
+    {
+      words_[vH.idx() / 64].fetch_or(mask, std::memory_order_relaxed);
+    }
+    else
+    {
+      words_[vH.idx() / 64].fetch_and(~mask, std::memory_order_relaxed);
+    }
+  }
+
+  //! number of set flags
+  size_t count() const
+  {
+    size_t num_set = 0;
+    for (size_t i = 0; i < numWords(); i++)
+    {
+      num_set += __builtin_popcountll(words_[i].load(std::memory_order_relaxed));
+    }
+    return num_set;
+  }
+
+  size_t memoryUsage() const
+  {
+    return numWords() * sizeof(uint64_t);
+  }
+
+private:
+  size_t numWords() const
+  {
+    return (num_slots_ + 63) / 64;
+  }
+
+  size_t num_slots_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__COMPACT_MAPS_H
@@ -0,0 +1,685 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__EIKONAL_UPDATE_H
+#define MESH_MAP__EIKONAL_UPDATE_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mesh_map
+{
+
+/**
+ * @brief The triangle update schemes of the wave front propagation. Each scheme computes the distance of the third
+ *        vertex of a triangle from the distances of the other two vertices and the lengths, or weights, of the edges.
+ */
+enum class EikonalScheme : uint8_t
+{
+  //! unfolds the virtual point source of the two distances and measures the distance to it, planner default
+  LAW_OF_COSINES,
+  //! like LAW_OF_COSINES, but decides whether the source line cuts the triangle with the sign of its area
+  SIGNED_AREA,
+  //! solves the quadratic equation of a planar wave front by Kimmel and Sethian, inflation layer default
+  KIMMEL_SETHIAN
+};
+
+//! floating point type in which the update is computed, the distances are always stored as float
+enum class EikonalPrecision : uint8_t
+{
+  FLOAT,
+  DOUBLE
+};
+
+/**
+ * @brief Result of a single triangle update of the vertex v3 from the vertices v1 and v2
+ */
+struct EikonalResult
+{
+  //! the new distance of v3
+  float distance;
+  //! whether v1 is the predecessor of v3, otherwise v2 is
+  bool from_v1;
+  //! angle at v3 between the edge to the predecessor and the direction to the source, positive towards v2 if the
+  //! predecessor is v1, negative towards v1 if the predecessor is v2, or zero if the wave arrives along the edge
+  float direction;
+};
+
+namespace eikonal
+{
+
+// The schemes below are written once against the operations of this namespace and instantiated for the scalar types
+// and for the SIMD packs. The comparisons return bool for scalars and a lane mask for packs.
+
+inline float select(const bool mask, const float a, const float b)
+{
+  return mask ? a : b;
+}
+
+inline double select(const bool mask, const double a, const double b)
+{
+  return mask ? a : b;
+}
+
+inline bool select(const bool mask, const bool a, const bool b)
+{
+  return mask ? a : b;
+}
+
+inline bool maskAnd(const bool a, const bool b)
+{
+  return a && b;
+}
+
+inline bool maskOr(const bool a, const bool b)
+{
+  return a || b;
+}
+
+inline bool maskNot(const bool a)
+{
+  return !a;
+}
+
+inline float sqrt(const float x)
+{
+  return std::sqrt(x);
+}
+
+inline double sqrt(const double x)
+{
+  return std::sqrt(x);
+}
+
+inline float abs(const float x)
+{
+  return std::fabs(x);
+}
+
+inline double abs(const double x)
+{
+  return std::fabs(x);
+}
+
+//! minimum implemented with a comparison, which is the same for scalars and packs, also for NaNs
+template <typename V>
+inline V min(const V& a, const V& b)
+{
+  return select(b < a, b, a);
+}
+
+template <typename V>
+inline V max(const V& a, const V& b)
+{
+  return select(a < b, b, a);
+}
+
+#if defined(__SSE2__)
+
+//! four float lanes
+struct Float4
+{
+  static constexpr size_t WIDTH = 4;
+  __m128 v;
+
+  Float4(const __m128 v) : v(v)
+  {
+  }
+
+  Float4(const float x) : v(_mm_set1_ps(x))
+  {
+  }
+
+  static Float4 load(const float* p)
+  {
+    return _mm_loadu_ps(p);
+  }
+
+  void store(float* p) const
+  {
+    _mm_storeu_ps(p, v);
+  }
+};
+
+struct Mask4
+{
+  __m128 v;
+};
+
+inline Float4 operator+(const Float4& a, const Float4& b)
+{
+  return _mm_add_ps(a.v, b.v);
+}
+
+inline Float4 operator-(const Float4& a, const Float4& b)
+{
+  return _mm_sub_ps(a.v, b.v);
+}
+
+inline Float4 operator-(const Float4& a)
+{
+  return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f));
+}
+
+inline Float4 operator*(const Float4& a, const Float4& b)
+{
+  return _mm_mul_ps(a.v, b.v);
+}
+
+inline Float4 operator/(const Float4& a, const Float4& b)
+{
+  return _mm_div_ps(a.v, b.v);
+}
+
+inline Mask4 operator<(const Float4& a, const Float4& b)
+{
+  return { _mm_cmplt_ps(a.v, b.v) };
+}
+
+inline Mask4 operator>(const Float4& a, const Float4& b)
+{
+  return { _mm_cmpgt_ps(a.v, b.v) };
+}
+
+inline Mask4 operator<=(const Float4& a, const Float4& b)
+{
+  return { _mm_cmple_ps(a.v, b.v) };
+}
+
+inline Float4 select(const Mask4& mask, const Float4& a, const Float4& b)
+{
+  return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+
+inline Mask4 select(const Mask4& mask, const Mask4& a, const Mask4& b)
+{
+  return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+inline Mask4 maskAnd(const Mask4& a, const Mask4& b)
+{
+  return { _mm_and_ps(a.v, b.v) };
+}
+
+inline Mask4 maskOr(const Mask4& a, const Mask4& b)
+{
+  return { _mm_or_ps(a.v, b.v) };
+}
+
+inline Mask4 maskNot(const Mask4& a)
+{
+  return { _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))) };
+}
+
+inline Float4 sqrt(const Float4& x)
+{
+  return _mm_sqrt_ps(x.v);
+}
+
+inline Float4 abs(const Float4& x)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), x.v);
+}
+
+//! two double lanes, loaded from and stored to float arrays
+struct Double2
+{
+  static constexpr size_t WIDTH = 2;
+  __m128d v;
+
+  Double2(const __m128d v) : v(v)
+  {
+  }
+
+  Double2(const double x) : v(_mm_set1_pd(x))
+  {
+  }
+
+  static Double2 load(const float* p)
+  {
+    return _mm_set_pd(p[1], p[0]);
+  }
+
+  void store(float* p) const
+  {
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, v);
+    p[0] = static_cast<float>(lanes[0]);
+    p[1] = static_cast<float>(lanes[1]);
+  }
+};
+
+struct Mask2
+{
+  __m128d v;
+};
+
+inline Double2 operator+(const Double2& a, const Double2& b)
+{
+  return _mm_add_pd(a.v, b.v);
+}
+
+inline Double2 operator-(const Double2& a, const Double2& b)
+{
+  return _mm_sub_pd(a.v, b.v);
+}
+
+inline Double2 operator-(const Double2& a)
+{
+  return _mm_xor_pd(a.v, _mm_set1_pd(-0.0));
+}
+
+inline Double2 operator*(const Double2& a, const Double2& b)
+{
+  return _mm_mul_pd(a.v, b.v);
+}
+
+inline Double2 operator/(const Double2& a, const Double2& b)
+{
+  return _mm_div_pd(a.v, b.v);
+}
+
+inline Mask2 operator<(const Double2& a, const Double2& b)
+{
+  return { _mm_cmplt_pd(a.v, b.v) };
+}
+
+inline Mask2 operator>(const Double2& a, const Double2& b)
+{
+  return { _mm_cmpgt_pd(a.v, b.v) };
+}
+
+inline Mask2 operator<=(const Double2& a, const Double2& b)
+{
+  return { _mm_cmple_pd(a.v, b.v) };
+}
+
+inline Double2 select(const Mask2& mask, const Double2& a, const Double2& b)
+{
+  return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v));
+}
+
+inline Mask2 select(const Mask2& mask, const Mask2& a, const Mask2& b)
+{
+  return { _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v)) };
+}
+
+inline Mask2 maskAnd(const Mask2& a, const Mask2& b)
+{
+  return { _mm_and_pd(a.v, b.v) };
+}
+
+inline Mask2 maskOr(const Mask2& a, const Mask2& b)
+{
+  return { _mm_or_pd(a.v, b.v) };
+}
+
+inline Mask2 maskNot(const Mask2& a)
+{
+  return { _mm_xor_pd(a.v, _mm_castsi128_pd(_mm_set1_epi32(-1))) };
+}
+
+inline Double2 sqrt(const Double2& x)
+{
+  return _mm_sqrt_pd(x.v);
+}
+
+inline Double2 abs(const Double2& x)
+{
+  return _mm_andnot_pd(_mm_set1_pd(-0.0), x.v);
+}
+
+//! the widest pack for the precision
+template <typename T>
+struct Pack;
+
+template <>
+struct Pack<float>
+{
+  typedef Float4 type;
+};
+
+template <>
+struct Pack<double>
+{
+  typedef Double2 type;
+};
+
+#endif
+
+/**
+ * @brief Candidate of a triangle update computed for one or several lanes
+ * @tparam V The value type, float, double or a SIMD pack
+ * @tparam M The mask type, bool or a SIMD mask
+ */
+template <typename V, typename M>
+struct Candidate
+{
+  //! the new distance of v3, infinity if the triangle does not provide an update
+  V distance;
+  //! whether the predecessor is v1
+  M from_v1;
+  //! whether the direction to the source is rotated away from the edge to the predecessor
+  M rotated;
+  //! cosine of the direction, if rotated
+  V cos_direction;
+};
+
+template <EikonalScheme S>
+struct Scheme;
+
+template <>
+struct Scheme<EikonalScheme::LAW_OF_COSINES>
+{
+  template <typename V, typename M>
+  static void compute(const V& u1, const V& u2, const V& a, const V& b, const V& c, Candidate<V, M>& result)
+  {
+    const V a_sq = a * a;
+    const V b_sq = b * b;
+    const V c_sq = c * c;
+    const V u1_sq = u1 * u1;
+    const V u2_sq = u2 * u2;
+
+    // position of the virtual source and of v3 in the plane of the unfolded triangle
+    const V sx = (c_sq + u1_sq - u2_sq) / (V(2) * c);
+    const V sy = -sqrt(max(u1_sq - sx * sx, V(0)));
+    const V p = (b_sq + c_sq - a_sq) / (V(2) * c);
+    const V hc = sqrt(max(b_sq - p * p, V(0)));
+
+    const V dy = hc - sy;
+    const V dx = p - sx;
+    const V u3_sq = dx * dx + dy * dy;
+    const V u3 = sqrt(u3_sq);
+
+    // the cosines of the angle at v3 and the angles at v3 between the edges and the line to the source, since the
+    // arc cosine is decreasing, comparing the cosines inversely compares the angles
+    const V t0 = (a_sq + b_sq - c_sq) / (V(2) * a * b);
+    const V t1 = (u3_sq + b_sq - u1_sq) / (V(2) * u3 * b);
+    const V t2 = (a_sq + u3_sq - u2_sq) / (V(2) * a * u3);
+
+    // corner cases: side b + u1 ~= u3 or side a + u2 ~= u3
+    const M corner1 = V(1) < abs(t1);
+    const M corner2 = maskAnd(maskNot(corner1), V(1) < abs(t2));
+    const M cut = maskAnd(maskAnd(maskNot(maskOr(corner1, corner2)), t0 < t1), t0 < t2);
+
+    result.from_v1 = maskOr(corner1, maskAnd(maskNot(corner2), t2 < t1));
+    result.rotated = cut;
+    result.cos_direction = select(result.from_v1, t1, t2);
+    result.distance = select(cut, u3, select(result.from_v1, u1 + b, u2 + a));
+    // no source position without finite distances
+    result.distance = select(u3 < V(std::numeric_limits<float>::infinity()), result.distance,
+                             V(std::numeric_limits<float>::infinity()));
+  }
+};
+
+template <>
+struct Scheme<EikonalScheme::SIGNED_AREA>
+{
+  template <typename V, typename M>
+  static void compute(const V& u1, const V& u2, const V& a, const V& b, const V& c, Candidate<V, M>& result)
+  {
+    const V a_sq = a * a;
+    const V b_sq = b * b;
+    const V c_sq = c * c;
+    const V u1_sq = u1 * u1;
+    const V u2_sq = u2 * u2;
+
+    // heron's formula for the triangle of the source and for the face
+    const V A = sqrt(max((-u1 + u2 + c) * (u1 - u2 + c) * (u1 + u2 - c) * (u1 + u2 + c), V(0)));
+    const V B = sqrt(max((-a + b + c) * (a - b + c) * (a + b - c) * (a + b + c), V(0)));
+    const V sx = (c_sq + u1_sq - u2_sq) / (V(2) * c);
+    const V sy = -A / (V(2) * c);
+    const V p = (-a_sq + b_sq + c_sq) / (V(2) * c);
+    const V hc = B / (V(2) * c);
+    const V dy = hc - sy;
+    const V dx = p - sx;
+    const V u3_sq = dx * dx + dy * dy;
+    const V u3 = sqrt(u3_sq);
+
+    const M from_v1 = u1 < u2;
+    const V S1 = sy * p - sx * hc;
+    const V t1 = (u3_sq + b_sq - u1_sq) / (V(2) * u3 * b);
+    const V S2 = sx * hc - hc * c + sy * c - sy * p;
+    const V t2 = (a_sq + u3_sq - u2_sq) / (V(2) * a * u3);
+    const M cut = select(from_v1, maskAnd(S1 <= V(0), abs(t1) <= V(1)), maskAnd(S2 <= V(0), abs(t2) <= V(1)));
+
+    result.from_v1 = from_v1;
+    result.rotated = cut;
+    result.cos_direction = select(from_v1, t1, t2);
+    result.distance = select(cut, u3, select(from_v1, u1 + b, u2 + a));
+    result.distance = select(u3 < V(std::numeric_limits<float>::infinity()), result.distance,
+                             V(std::numeric_limits<float>::infinity()));
+  }
+};
+
+template <>
+struct Scheme<EikonalScheme::KIMMEL_SETHIAN>
+{
+  template <typename V, typename M>
+  static void compute(const V& u1, const V& u2, const V& a, const V& b, const V& c, Candidate<V, M>& result)
+  {
+    // sort the vertices by their distances, A is the edge opposite to the vertex with the smaller distance
+    const M swap = u2 < u1;
+    const V u_min = select(swap, u2, u1);
+    const V u_max = select(swap, u1, u2);
+    const V A = select(swap, b, a);
+    const V B = select(swap, a, b);
+
+    const V delta_u = u_max - u_min;
+    const V cos_theta = (a * a + b * b - c * c) / (V(2) * a * b);
+
+    const V k0 = A * A + B * B - V(2) * A * B * cos_theta;
+    const V k1 = V(2) * B * delta_u * (A * cos_theta - B);
+    const V k2 = B * B * (delta_u * delta_u - A * A * (V(1) - cos_theta * cos_theta));
+
+    const V r = k1 * k1 - V(4) * k0 * k2;
+    const V t = select(r < V(0), -k1 / (V(2) * k0), (-k1 + sqrt(max(r, V(0)))) / (V(2) * k0));
+
+    // the characteristic has to enter the face through the edge between the two vertices
+    const V e = B * (t - delta_u) / t;
+    const M cut = maskAnd(maskAnd(delta_u < t, e < A / cos_theta), A * cos_theta < e);
+
+    const V along_min = u_min + B;
+    const V along_max = u_max + A;
+    const M from_min = maskOr(cut, along_min < along_max);
+
+    result.from_v1 = select(swap, maskNot(from_min), from_min);
+    result.rotated = cut;
+    // the planar front passes the edge to the predecessor with a slope of t / B
+    result.cos_direction = t / B;
+    result.distance = select(cut, u_min + t, min(along_min, along_max));
+    result.distance = select(result.distance < V(std::numeric_limits<float>::infinity()), result.distance,
+                             V(std::numeric_limits<float>::infinity()));
+  }
+};
+
+}  // namespace eikonal
+
+/**
+ * @brief Updates the distance of v3 of a triangle from the distances of v1 and v2, specialized on the scheme and on
+ *        the precision at compile time
+ *
+ * @tparam S The update scheme
+ * @tparam T float or double, the type in which the update is computed
+ * @param u1 distance of v1
+ * @param u2 distance of v2
+ * @param u3 current distance of v3
+ * @param a weight of the edge between v2 and v3
+ * @param b weight of the edge between v1 and v3
+ * @param c weight of the edge between v1 and v2
+ * @param result the update, only valid if true is returned
+ *
+ * @return true if the update is smaller than u3
+ */
+template <EikonalScheme S, typename T>
+inline bool eikonalUpdate(const float u1, const float u2, const float u3, const float a, const float b,
+                          const float c, EikonalResult& result)
+{
+  eikonal::Candidate<T, bool> candidate;
+  eikonal::Scheme<S>::compute(T(u1), T(u2), T(a), T(b), T(c), candidate);
+  if (!(candidate.distance < u3))
+  {
+    return false;
+  }
+
+  T direction = 0;
+  if (candidate.rotated)
+  {
+    const T cos_direction = std::fmin(std::fmax(candidate.cos_direction, T(-1)), T(1));
+    direction = candidate.from_v1 ? std::acos(cos_direction) : -std::acos(cos_direction);
+  }
+  result = { static_cast<float>(candidate.distance), candidate.from_v1, static_cast<float>(direction) };
+  return static_cast<float>(candidate.distance) < u3;
+}
+
+/**
+ * @brief Computes the distances of v3 for a batch of triangles in SIMD lanes, the remainder with the same scheme in
+ *        scalar arithmetic. Targets without SSE2 compute the whole batch in the scalar loop. The arguments are the arrays of the arguments of eikonalUpdate().
+ *
+ * @param n number of triangles
+ * @param u3 the candidate distances of v3, infinity if a triangle provides none
+ */
+template <EikonalScheme S, typename T>
+inline void eikonalDistances(const size_t n, const float* u1, const float* u2, const float* a, const float* b,
+                             const float* c, float* u3)
+{
+  size_t i = 0;
+#if defined(__SSE2__)
+  typedef typename eikonal::Pack<T>::type P;
+  typedef decltype(P(T(0)) < P(T(0))) M;
+  for (; i + P::WIDTH <= n; i += P::WIDTH)
+  {
+    eikonal::Candidate<P, M> candidate{ P(T(0)), M(), M(), P(T(0)) };
+    eikonal::Scheme<S>::compute(P::load(u1 + i), P::load(u2 + i), P::load(a + i), P::load(b + i), P::load(c + i),
+                                candidate);
+    candidate.distance.store(u3 + i);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    eikonal::Candidate<T, bool> candidate;
+    eikonal::Scheme<S>::compute(T(u1[i]), T(u2[i]), T(a[i]), T(b[i]), T(c[i]), candidate);
+    u3[i] = static_cast<float>(candidate.distance);
+  }
+}
+
+/**
+ * @brief Scheme and precision of the triangle update selected at runtime. The dispatch is a switch on two small enums
+ *        around the inlined specializations, which the branch predictor resolves for the whole propagation.
+ */
+struct EikonalKernel
+{
+  EikonalScheme scheme = EikonalScheme::LAW_OF_COSINES;
+  EikonalPrecision precision = EikonalPrecision::DOUBLE;
+
+  //! see eikonalUpdate()
+  inline bool update(const float u1, const float u2, const float u3, const float a, const float b, const float c,
+                     EikonalResult& result) const
+  {
+    const bool dbl = precision == EikonalPrecision::DOUBLE;
+    switch (scheme)
+    {
+      case EikonalScheme::SIGNED_AREA:
+        return dbl ? eikonalUpdate<EikonalScheme::SIGNED_AREA, double>(u1, u2, u3, a, b, c, result) :
+                     eikonalUpdate<EikonalScheme::SIGNED_AREA, float>(u1, u2, u3, a, b, c, result);
+      case EikonalScheme::KIMMEL_SETHIAN:
+        return dbl ? eikonalUpdate<EikonalScheme::KIMMEL_SETHIAN, double>(u1, u2, u3, a, b, c, result) :
+                     eikonalUpdate<EikonalScheme::KIMMEL_SETHIAN, float>(u1, u2, u3, a, b, c, result);
+      default:
+        return dbl ? eikonalUpdate<EikonalScheme::LAW_OF_COSINES, double>(u1, u2, u3, a, b, c, result) :
+                     eikonalUpdate<EikonalScheme::LAW_OF_COSINES, float>(u1, u2, u3, a, b, c, result);
+    }
+  }
+
+  //! see eikonalDistances()
+  inline void distances(const size_t n, const float* u1, const float* u2, const float* a, const float* b,
+                        const float* c, float* u3) const
+  {
+    const bool dbl = precision == EikonalPrecision::DOUBLE;
+    switch (scheme)
+    {
+      case EikonalScheme::SIGNED_AREA:
+        return dbl ? eikonalDistances<EikonalScheme::SIGNED_AREA, double>(n, u1, u2, a, b, c, u3) :
+                     eikonalDistances<EikonalScheme::SIGNED_AREA, float>(n, u1, u2, a, b, c, u3);
+      case EikonalScheme::KIMMEL_SETHIAN:
+        return dbl ? eikonalDistances<EikonalScheme::KIMMEL_SETHIAN, double>(n, u1, u2, a, b, c, u3) :
+                     eikonalDistances<EikonalScheme::KIMMEL_SETHIAN, float>(n, u1, u2, a, b, c, u3);
+      default:
+        return dbl ? eikonalDistances<EikonalScheme::LAW_OF_COSINES, double>(n, u1, u2, a, b, c, u3) :
+                     eikonalDistances<EikonalScheme::LAW_OF_COSINES, float>(n, u1, u2, a, b, c, u3);
+    }
+  }
+
+  /**
+   * @brief Parses the scheme and precision parameters, "law_of_cosines", "signed_area" or "kimmel_sethian" and
+   *        "float" or "double"
+   * @return false if one of them is unknown, the kernel is not changed in that case
+   */
+  bool parse(const std::string& scheme_name, const std::string& precision_name)
+  {
+    EikonalScheme s;
+    if (scheme_name == "law_of_cosines")
+      s = EikonalScheme::LAW_OF_COSINES;
+    else if (scheme_name == "signed_area")
+      s = EikonalScheme::SIGNED_AREA;
+    else if (scheme_name == "kimmel_sethian")
+      s = EikonalScheme::KIMMEL_SETHIAN;
+    else
+      return false;
+
+    if (precision_name == "float")
+      precision = EikonalPrecision::FLOAT;
+    else if (precision_name == "double")
+      precision = EikonalPrecision::DOUBLE;
+    else
+      return false;
+
+    scheme = s;
+    return true;
+  }
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__EIKONAL_UPDATE_H
@@ -0,0 +1,227 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__FACE_BVH_H
+#define MESH_MAP__FACE_BVH_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <lvr2/geometry/BaseMesh.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Bounding volume hierarchy over the faces of the mesh for ray casting and closest point queries.
+ *
+ * The hierarchy is built top down with the surface area heuristic (SAH) evaluated on binned face centroids, and
+ * stored as a flat array in depth first order, i.e. the first child of an inner node directly follows it. The
+ * triangles of each leaf are stored as structure of arrays in packets of PACKET_SIZE, which are tested against a ray
+ * at once in a branchless loop the compiler vectorizes. Leaves are padded with degenerate triangles which are never
+ * hit.
+ *
+ * The hierarchy is immutable after construction, thus all queries can be called concurrently.
+ */
+class FaceBVH
+{
+public:
+  typedef std::shared_ptr<const FaceBVH> ConstPtr;
+
+  //! number of triangles stored and tested together
+  static constexpr size_t PACKET_SIZE = 4;
+
+  //! result of a ray query
+  struct RayHit
+  {
+    //! the first face hit by the ray, empty if the ray does not hit the mesh
+    lvr2::OptionalFaceHandle face;
+
+    //! distance along the ray in multiples of the ray direction
+    float distance = std::numeric_limits<float>::infinity();
+
+    //! barycentric coordinates of the intersection in the hit face
+    std::array<float, 3> bary_coords = { 0, 0, 0 };
+  };
+
+  //! result of a closest point query
+  struct ClosestPoint
+  {
+    //! the face containing the closest point, empty if no face is within the maximum distance
+    lvr2::OptionalFaceHandle face;
+
+    //! the closest point on the mesh surface
+    lvr2::BaseVector<float> point;
+
+    //! euclidean distance of the query position to the closest point
+    float distance = std::numeric_limits<float>::infinity();
+
+    //! barycentric coordinates of the closest point in the face
+    std::array<float, 3> bary_coords = { 0, 0, 0 };
+  };
+
+  /**
+   * @brief Builds the hierarchy over the given triangles
+   * @param triangles The corner positions of the triangles
+   * @param faces The face handle of each triangle, which is reported by the queries
+   * @param max_leaf_size Maximum number of triangles in a leaf
+   */
+  FaceBVH(const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+          const std::vector<lvr2::FaceHandle>& faces, const size_t max_leaf_size = 4);
+
+  /**
+   * @brief Builds the hierarchy over all faces of the mesh, the barycentric coordinates of the queries refer to the
+   *        vertex order of lvr2::BaseMesh::getVerticesOfFace()
+   * @param mesh The mesh
+   * @param max_leaf_size Maximum number of triangles in a leaf
+   */
+  explicit FaceBVH(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const size_t max_leaf_size = 4);
+
+  /**
+   * @brief Searches the first face hit by the ray
+   * @param origin The ray origin
+   * @param direction The ray direction, which does not need to be normalized
+   * @param max_distance Maximum distance along the ray in multiples of the direction
+   * @param[out] hit The first hit
+   * @return true if the ray hits a face within the maximum distance
+   */
+  bool intersectRay(const lvr2::BaseVector<float>& origin, const lvr2::BaseVector<float>& direction,
+                    const float max_distance, RayHit& hit) const;
+
+  /**
+   * @brief Batched version of intersectRay()
+   * @param origins The ray origins
+   * @param directions The ray directions, one per origin
+   * @param max_distance Maximum distance along the rays in multiples of their directions
+   * @param[out] hits The first hit of each ray
+   */
+  void intersectRays(const std::vector<lvr2::BaseVector<float>>& origins,
+                     const std::vector<lvr2::BaseVector<float>>& directions, const float max_distance,
+                     std::vector<RayHit>& hits) const;
+
+  /**
+   * @brief Searches the closest point on the mesh surface
+   * @param query The query position
+   * @param max_distance Maximum distance of the closest point, which bounds the search
+   * @param[out] result The closest point
+   * @return true if a point within the maximum distance has been found
+   */
+  bool closestPoint(const lvr2::BaseVector<float>& query, const float max_distance, ClosestPoint& result) const;
+
+  /**
+   * @brief Batched version of closestPoint()
+   * @param queries The query positions
+   * @param max_distance Maximum distance of the closest points
+   * @param[out] results The closest point of each query position
+   */
+  void closestPoints(const std::vector<lvr2::BaseVector<float>>& queries, const float max_distance,
+                     std::vector<ClosestPoint>& results) const;
+
+  //! number of faces in the hierarchy
+  size_t numFaces() const
+  {
+    return num_faces_;
+  }
+
+  //! number of nodes in the hierarchy
+  size_t numNodes() const
+  {
+    return nodes_.size();
+  }
+
+  //! approximate memory footprint of the hierarchy in bytes
+  size_t memoryUsage() const;
+
+private:
+  struct Node
+  {
+    float min[3];
+    float max[3];
+    //! leaves: index of the first packet; inner nodes: index of the second child
+    uint32_t offset;
+    //! leaves: number of packets; inner nodes: zero
+    uint32_t count;
+  };
+
+  //! face bounds and centroid used during the build
+  struct BuildRef
+  {
+    float min[3];
+    float max[3];
+    float centroid[3];
+    uint32_t triangle;
+  };
+
+  void build(const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+             const std::vector<lvr2::FaceHandle>& faces, const size_t max_leaf_size);
+
+  /**
+   * @brief Builds the subtree over refs[begin, end) and returns the index of its root node
+   */
+  uint32_t buildNode(std::vector<BuildRef>& refs, const size_t begin, const size_t end, const size_t depth,
+                     const size_t max_leaf_size, const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+                     const std::vector<lvr2::FaceHandle>& faces);
+
+  //! tests the ray against the packets of a leaf and updates the hit if a closer one is found
+  void intersectLeaf(const Node& node, const float origin[3], const float direction[3], RayHit& hit) const;
+
+  //! computes the closest points in the packets of a leaf and updates the result if a closer one is found
+  void closestInLeaf(const Node& node, const lvr2::BaseVector<float>& query, float& best_squared,
+                     ClosestPoint& result) const;
+
+  std::vector<Node> nodes_;
+
+  //! triangles as structure of arrays: first corner and the two edges starting there
+  std::vector<float> v0x_, v0y_, v0z_;
+  std::vector<float> e1x_, e1y_, e1z_;
+  std::vector<float> e2x_, e2y_, e2z_;
+
+  //! face index of each triangle slot, padding slots are invalid
+  std::vector<uint32_t> face_ids_;
+
+  size_t num_faces_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__FACE_BVH_H
@@ -0,0 +1,201 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__FACE_LOCATOR_H
+#define MESH_MAP__FACE_LOCATOR_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <lvr2/geometry/BaseMesh.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+#include "mesh_topology.h"
+
+namespace mesh_map
+{
+
+/**
+ * @brief Result of a point location, the face containing the projection of the query position
+ */
+struct FaceLocation
+{
+  lvr2::FaceHandle face = lvr2::FaceHandle(0);
+
+  //! positions of the face vertices, in the order of MeshTopology::verticesOfFace()
+  std::array<lvr2::BaseVector<float>, 3> vertices;
+
+  //! barycentric coordinates of the projected query position
+  std::array<float, 3> bary_coords;
+
+  //! signed distance of the query position to the face plane
+  float dist = 0;
+};
+
+/**
+ * @brief Point location on the mesh surface.
+ *
+ * The locator combines three strategies, which locate() applies in order:
+ *  - walk(): starts at a hint face and repeatedly crosses the edge opposite to the most negative barycentric
+ *    coordinate, thus it visits the faces on the way to the position only. This is the cheap case for positions close
+ *    to the hint, e.g. the robot position of the previous control cycle.
+ *  - searchAround(): breadth first search over the faces around the hint face within a radius, which also handles
+ *    the holes and boundaries the walk can not cross.
+ *  - searchNearest(): tests the faces around the k nearest vertices, which does not need a hint. In contrast to a
+ *    single nearest vertex, it finds the containing face also if none of its vertices is the nearest one.
+ *
+ * The visited faces are marked with stamps in a buffer which is allocated once and reset in constant time per query.
+ * Thus, a locator is not thread safe, every thread needs its own one.
+ */
+class FaceLocator
+{
+public:
+  typedef std::shared_ptr<FaceLocator> Ptr;
+
+  //! searches the k nearest vertices of a position, e.g. with the k-d tree of the map
+  typedef std::function<size_t(const lvr2::BaseVector<float>&, const size_t, std::vector<lvr2::VertexHandle>&)>
+      NearestVertices;
+
+  /**
+   * @brief Creates a locator for the given mesh
+   * @param mesh The mesh providing the vertex positions
+   * @param topology The topology snapshot of the mesh
+   * @param nearest_vertices The nearest neighbour search used by searchNearest()
+   * @param num_nearest Number of nearest vertices whose faces are tested by searchNearest()
+   */
+  FaceLocator(std::shared_ptr<const lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh, MeshTopology::ConstPtr topology,
+              NearestVertices nearest_vertices, const size_t num_nearest = 8);
+
+  /**
+   * @brief Walks from the start face towards the position
+   * @param pos The query position
+   * @param start The face to start the walk with
+   * @param max_dist Maximum distance of the position to the face plane
+   * @param[out] location The containing face
+   * @return true if the walk reached a face containing the position
+   */
+  bool walk(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& start, const float max_dist,
+            FaceLocation& location);
+
+  /**
+   * @brief Breadth first search over the faces around the start face, a face is expanded if one of its vertices lies
+   *        within the radius around the start face
+   * @param pos The query position
+   * @param start The face to start the search with
+   * @param max_radius The radius around the start face to search in
+   * @param max_dist Maximum distance of the position to the face plane
+   * @param[out] location The containing face
+   * @return true if a face containing the position has been found
+   */
+  bool searchAround(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& start, const float max_radius,
+                    const float max_dist, FaceLocation& location);
+
+  /**
+   * @brief Tests the faces around the nearest vertices of the position and returns the closest containing face
+   * @param pos The query position
+   * @param max_dist Maximum distance of the position to the face plane
+   * @param[out] location The containing face
+   * @return true if a face containing the position has been found
+   */
+  bool searchNearest(const lvr2::BaseVector<float>& pos, const float max_dist, FaceLocation& location);
+
+  /**
+   * @brief Locates the position with walk() and searchAround() from the hint face, and with searchNearest() if that
+   *        fails or no hint is given
+   * @param pos The query position
+   * @param hint The face to start with, e.g. the result of the previous query
+   * @param max_radius The radius around the hint face which is searched by searchAround()
+   * @param max_dist Maximum distance of the position to the face plane
+   * @param[out] location The containing face
+   * @return true if a face containing the position has been found
+   */
+  bool locate(const lvr2::BaseVector<float>& pos, const lvr2::OptionalFaceHandle& hint, const float max_radius,
+              const float max_dist, FaceLocation& location);
+
+  //! number of faces visited by all queries of the locator so far
+  uint64_t numVisitedFaces() const
+  {
+    return num_visited_;
+  }
+
+  //! the topology snapshot the locator walks on
+  const MeshTopology::ConstPtr& topology() const
+  {
+    return topology_;
+  }
+
+private:
+  /**
+   * @brief Projects the position onto the face plane and computes its barycentric coordinates and distance
+   * @return true if the projected position lies inside the face
+   */
+  bool project(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& fH, FaceLocation& location) const;
+
+  //! returns the face sharing the edge opposite to the given corner, if there is one
+  lvr2::OptionalFaceHandle faceAcross(const lvr2::FaceHandle& fH, const size_t corner) const;
+
+  //! starts a new query, all faces read as not visited afterwards
+  void resetVisited();
+
+  //! marks the face as visited, returns false if it has been visited before in the current query
+  bool visit(const lvr2::FaceHandle& fH);
+
+  std::shared_ptr<const lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh_;
+  MeshTopology::ConstPtr topology_;
+  NearestVertices nearest_vertices_;
+  size_t num_nearest_;
+
+  //! query in which each face has been visited last
+  std::vector<uint32_t> visited_;
+  uint32_t query_;
+  uint64_t num_visited_;
+
+  //! queue of the breadth first search
+  std::vector<lvr2::FaceHandle> queue_;
+
+  //! result buffer of the nearest neighbour search
+  std::vector<lvr2::VertexHandle> nearest_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__FACE_LOCATOR_H
@@ -0,0 +1,418 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__FAST_ITERATIVE_METHOD_H
+#define MESH_MAP__FAST_ITERATIVE_METHOD_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+#include "eikonal_update.h"
+#include "mesh_topology.h"
+
+namespace mesh_map
+{
+
+/**
+ * @brief Triangle update of the FastIterativeMethod from the edge weights with an eikonal kernel. The solver computes
+ *        the updates of all faces around a vertex in one batch of the SIMD kernel.
+ */
+struct EikonalEdgeUpdate
+{
+  const lvr2::DenseEdgeMap<float>& edge_weights;
+  EikonalKernel kernel;
+};
+
+/**
+ * @brief Multi-threaded eikonal solver on the mesh, implementing the Fast Iterative Method (FIM) by Jeong and
+ *        Whitaker.
+ *
+ * Instead of settling one vertex after the other in the order of a global priority queue like the fast marching
+ * method, the FIM keeps a list of active vertices, i.e. the wave front, and updates all of them in parallel from the
+ * current values of their neighbours. A vertex whose value did not change anymore leaves the list and activates its
+ * neighbours which it improves. The values converge to the solution of the sequential fast marching within a small
+ * tolerance. Each iteration consists of synchronized phases, which only read the distances of other vertices and
+ * write the slots of the own vertices, thus the result does not depend on the number of threads.
+ *
+ * The triangle update is provided by the caller, e.g. the update of the planner or the inflation layer, and has to be
+ * free of side effects. The solver records the face of the final update of each vertex, which allows the caller to
+ * derive its per vertex data, e.g. predecessors, afterwards with its sequential update.
+ */
+class FastIterativeMethod
+{
+public:
+  //! face of seeds and vertices which have not been reached
+  static constexpr uint32_t NO_FACE = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Starts the worker threads
+   * @param num_threads The number of threads including the calling one, 0 uses the number of hardware threads
+   */
+  explicit FastIterativeMethod(const size_t num_threads = 0);
+
+  ~FastIterativeMethod();
+
+  FastIterativeMethod(const FastIterativeMethod&) = delete;
+  FastIterativeMethod& operator=(const FastIterativeMethod&) = delete;
+
+  /**
+   * @brief Computes the distances from the seeds
+   * @tparam AccessibleT bool(const lvr2::VertexHandle&), vertices which are not accessible are not assigned a distance
+   * @tparam UpdateT float(const lvr2::FaceHandle& fh, const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
+   *         const lvr2::VertexHandle& v3, const float u1, const float u2), returns the distance of v3 computed from
+   *         the distances u1 of v1 and u2 of v2, or infinity. The vertices are passed in the cyclic order of the face.
+   * @param topology The topology snapshot of the mesh
+   * @param seeds The seed vertices and their distances
+   * @param max_distance Vertices beyond this distance are assigned a distance, but do not activate their neighbours
+   * @param targets If all targets have been reached, the propagation stops at the largest target distance plus the
+   *        target offset
+   * @param target_offset See targets
+   * @param accessible Predicate for the vertices which may be entered
+   * @param update The triangle update, or an EikonalEdgeUpdate
+   * @return The number of iterations
+   */
+  template <typename AccessibleT, typename UpdateT>
+  size_t solve(const MeshTopology& topology, const std::vector<std::pair<lvr2::VertexHandle, float>>& seeds,
+               const float max_distance, const std::vector<lvr2::VertexHandle>& targets, const float target_offset,
+               const AccessibleT& accessible, const UpdateT& update);
+
+  //! distance of the vertex computed by the latest solve(), infinity if it has not been reached
+  float distance(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < distances_.size() ? distances_[vH.idx()] : std::numeric_limits<float>::infinity();
+  }
+
+  //! face of the final update of the vertex, NO_FACE for seeds and vertices which have not been reached
+  uint32_t face(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < faces_.size() ? faces_[vH.idx()] : NO_FACE;
+  }
+
+  //! the seeds and all vertices which have been assigned a distance by the latest solve()
+  const std::vector<lvr2::VertexHandle>& reached() const
+  {
+    return reached_;
+  }
+
+  //! number of threads including the calling one
+  size_t numThreads() const
+  {
+    return workers_.size() + 1;
+  }
+
+  //! relative change below which a vertex is considered converged
+  float tolerance = 1e-6;
+
+private:
+  enum VertexFlags : uint8_t
+  {
+    SEED = 1,
+    ACTIVE = 2,
+    REACHED = 4,
+    CONVERGED = 8
+  };
+
+  struct Candidate
+  {
+    lvr2::VertexHandle vertex;
+    float distance;
+    uint32_t face;
+  };
+
+  /**
+   * @brief Runs fn(thread, begin, end) on a contiguous range of [0, size) in each thread and waits for all of them
+   */
+  void parallelFor(const size_t size, const std::function<void(size_t, size_t, size_t)>& fn);
+
+  void workerLoop(const size_t thread);
+
+  /**
+   * @brief Computes the minimum update of the vertex over its faces with two reached vertices
+   */
+  template <typename UpdateT>
+  float solveVertex(const MeshTopology& topology, const lvr2::VertexHandle& vH, const UpdateT& update,
+                    uint32_t& face) const;
+
+  /**
+   * @brief Computes the minimum update of the vertex with the batched eikonal kernel
+   */
+  float solveVertex(const MeshTopology& topology, const lvr2::VertexHandle& vH, const EikonalEdgeUpdate& update,
+                    uint32_t& face) const;
+
+  std::vector<float> distances_;
+  std::vector<uint32_t> faces_;
+  std::vector<uint8_t> flags_;
+  std::vector<lvr2::VertexHandle> reached_;
+
+  std::vector<lvr2::VertexHandle> active_;
+  std::vector<float> next_distances_;
+  std::vector<uint32_t> next_faces_;
+  std::vector<std::vector<Candidate>> candidates_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(size_t, size_t, size_t)>* task_ = nullptr;
+  size_t task_size_ = 0;
+  size_t generation_ = 0;
+  size_t pending_ = 0;
+  bool stop_ = false;
+};
+
+template <typename UpdateT>
+float FastIterativeMethod::solveVertex(const MeshTopology& topology, const lvr2::VertexHandle& vH,
+                                       const UpdateT& update, uint32_t& face) const
+{
+  float best = std::numeric_limits<float>::infinity();
+  face = NO_FACE;
+  for (const lvr2::FaceHandle& fH : topology.facesOfVertex(vH))
+  {
+    if (!topology.containsFace(fH))
+      continue;
+
+    // rotate the face such that the vertex is the third one, keeping the cyclic order
+    const auto& vertices = topology.verticesOfFace(fH);
+    const size_t corner = vertices[0] == vH ? 0 : vertices[1] == vH ? 1 : 2;
+    const lvr2::VertexHandle& v1 = vertices[(corner + 1) % 3];
+    const lvr2::VertexHandle& v2 = vertices[(corner + 2) % 3];
+    const float u1 = distances_[v1.idx()];
+    const float u2 = distances_[v2.idx()];
+    if (u1 == std::numeric_limits<float>::infinity() || u2 == std::numeric_limits<float>::infinity())
+      continue;
+
+    const float u3 = update(fH, v1, v2, vH, u1, u2);
+    if (u3 < best)
+    {
+      best = u3;
+      face = fH.idx();
+    }
+  }
+  return best;
+}
+
+template <typename AccessibleT, typename UpdateT>
+size_t FastIterativeMethod::solve(const MeshTopology& topology,
+                                  const std::vector<std::pair<lvr2::VertexHandle, float>>& seeds,
+                                  const float max_distance, const std::vector<lvr2::VertexHandle>& targets,
+                                  const float target_offset, const AccessibleT& accessible, const UpdateT& update)
+{
+  constexpr float INF = std::numeric_limits<float>::infinity();
+  const size_t num_vertices = topology.numVertexSlots();
+
+  // only the vertices reached by the previous solve have to be reset
+  for (const auto& vH : reached_)
+  {
+    if (vH.idx() < distances_.size())
+    {
+      distances_[vH.idx()] = INF;
+      faces_[vH.idx()] = NO_FACE;
+      flags_[vH.idx()] = 0;
+    }
+  }
+  reached_.clear();
+  active_.clear();
+  if (distances_.size() < num_vertices)
+  {
+    distances_.resize(num_vertices, INF);
+    faces_.resize(num_vertices, NO_FACE);
+    flags_.resize(num_vertices, 0);
+    next_distances_.resize(num_vertices, INF);
+    next_faces_.resize(num_vertices, NO_FACE);
+  }
+
+  for (const auto& seed : seeds)
+  {
+    const lvr2::Index idx = seed.first.idx();
+    if (idx >= num_vertices)
+      continue;
+    if (!(flags_[idx] & REACHED))
+      reached_.push_back(seed.first);
+    distances_[idx] = std::min(distances_[idx], seed.second);
+    flags_[idx] |= SEED | REACHED;
+  }
+  for (const auto& seed : seeds)
+  {
+    if (seed.first.idx() >= num_vertices)
+      continue;
+    for (const auto& nH : topology.neighboursOfVertex(seed.first))
+    {
+      if (!(flags_[nH.idx()] & (SEED | ACTIVE)) && accessible(nH))
+      {
+        flags_[nH.idx()] |= ACTIVE;
+        active_.push_back(nH);
+      }
+    }
+  }
+
+  float limit = max_distance;
+  bool targets_reached = targets.empty();
+  size_t iterations = 0;
+
+  const std::function<void(size_t, size_t, size_t)> update_active = [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+    {
+      const lvr2::Index idx = active_[i].idx();
+      next_distances_[idx] = solveVertex(topology, active_[i], update, next_faces_[idx]);
+    }
+  };
+
+  const std::function<void(size_t, size_t, size_t)> commit_active = [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+    {
+      const lvr2::Index idx = active_[i].idx();
+      const float previous = distances_[idx];
+      const float next = next_distances_[idx];
+      if (next < previous)
+      {
+        distances_[idx] = next;
+        faces_[idx] = next_faces_[idx];
+      }
+      // a vertex without a finite update is waiting for its neighbours
+      if (next != INF && !(next < previous * (1 - tolerance)))
+        flags_[idx] |= CONVERGED;
+    }
+  };
+
+  const std::function<void(size_t, size_t, size_t)> activate_neighbours = [&](size_t thread, size_t begin,
+                                                                               size_t end) {
+    auto& candidates = candidates_[thread];
+    for (size_t i = begin; i < end; i++)
+    {
+      const lvr2::VertexHandle& vH = active_[i];
+      if (!(flags_[vH.idx()] & CONVERGED) || distances_[vH.idx()] > limit)
+        continue;
+
+      for (const auto& nH : topology.neighboursOfVertex(vH))
+      {
+        if ((flags_[nH.idx()] & (SEED | ACTIVE)) || !accessible(nH))
+          continue;
+        uint32_t face;
+        const float distance = solveVertex(topology, nH, update, face);
+        if (distance < distances_[nH.idx()] * (1 - tolerance))
+          candidates.push_back({ nH, distance, face });
+      }
+    }
+  };
+
+  candidates_.resize(numThreads());
+  while (!active_.empty())
+  {
+    iterations++;
+    parallelFor(active_.size(), update_active);
+    parallelFor(active_.size(), commit_active);
+    parallelFor(active_.size(), activate_neighbours);
+
+    // the remaining active vertices and the newly activated ones form the next wave front
+    size_t num_active = 0;
+    for (const auto& vH : active_)
+    {
+      uint8_t& flags = flags_[vH.idx()];
+      if (!(flags & REACHED) && distances_[vH.idx()] != INF)
+      {
+        flags |= REACHED;
+        reached_.push_back(vH);
+      }
+      if (flags & CONVERGED)
+      {
+        flags &= ~(ACTIVE | CONVERGED);
+      }
+      else if (distances_[vH.idx()] != INF)
+      {
+        active_[num_active++] = vH;
+      }
+      else
+      {
+        // not updatable yet, it is activated again by a converged neighbour
+        flags &= ~ACTIVE;
+      }
+    }
+    active_.resize(num_active);
+
+    for (auto& candidates : candidates_)
+    {
+      for (const auto& candidate : candidates)
+      {
+        const lvr2::Index idx = candidate.vertex.idx();
+        if (candidate.distance < distances_[idx])
+        {
+          distances_[idx] = candidate.distance;
+          faces_[idx] = candidate.face;
+        }
+        if (!(flags_[idx] & ACTIVE))
+        {
+          flags_[idx] |= ACTIVE;
+          active_.push_back(candidate.vertex);
+        }
+        if (!(flags_[idx] & REACHED))
+        {
+          flags_[idx] |= REACHED;
+          reached_.push_back(candidate.vertex);
+        }
+      }
+      candidates.clear();
+    }
+
+    if (!targets_reached)
+    {
+      float target_distance = 0;
+      targets_reached = std::all_of(targets.begin(), targets.end(), [&](const lvr2::VertexHandle& vH) {
+        const bool reached = vH.idx() < num_vertices && distances_[vH.idx()] != INF && !(flags_[vH.idx()] & ACTIVE);
+        if (reached)
+          target_distance = std::max(target_distance, distances_[vH.idx()]);
+        return reached;
+      });
+      if (targets_reached)
+        limit = std::min(limit, target_distance + target_offset);
+    }
+  }
+  return iterations;
+}
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__FAST_ITERATIVE_METHOD_H
@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__GEOMETRY_CACHE_H
+#define MESH_MAP__GEOMETRY_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include <lvr2/geometry/Handles.hpp>
+
+#include "mesh_topology.h"
+
+namespace mesh_map
+{
+
+/**
+ * @brief Local neighbourhoods of all vertex slots for one radius in compressed sparse row format. The vertices of each
+ *        neighbourhood are stored in the order in which LocalNeighborhood visits them.
+ */
+class VertexNeighbourhoods
+{
+public:
+  typedef std::shared_ptr<const VertexNeighbourhoods> ConstPtr;
+
+  /**
+   * @param radius The radius of the neighbourhoods
+   * @param offsets The neighbourhood of vertex slot i is vertices[offsets[i]] to vertices[offsets[i + 1] - 1]
+   * @param vertices The vertices of all neighbourhoods
+   */
+  VertexNeighbourhoods(const float radius, std::vector<uint32_t>&& offsets, std::vector<lvr2::VertexHandle>&& vertices)
+    : radius_(radius), offsets_(std::move(offsets)), vertices_(std::move(vertices))
+  {
+    if (offsets_.empty() || offsets_.back() != vertices_.size())
+    {
+      throw std::invalid_argument("The neighbourhood offsets do not match the vertices");
+    }
+  }
+
+  float radius() const
+  {
+    return radius_;
+  }
+
+  size_t numVertexSlots() const
+  {
+    return offsets_.size() - 1;
+  }
+
+  /**
+   * @brief Returns the neighbourhood of the given vertex, which starts with the vertex itself
+   */
+  HandleRange<lvr2::VertexHandle> of(const lvr2::VertexHandle& vH) const
+  {
+    const auto first = offsets_[vH.idx()], last = offsets_[vH.idx() + 1];
+    return HandleRange<lvr2::VertexHandle>(vertices_.data() + first, vertices_.data() + last);
+  }
+
+  size_t memoryUsage() const
+  {
+    return offsets_.capacity() * sizeof(uint32_t) + vertices_.capacity() * sizeof(lvr2::VertexHandle);
+  }
+
+private:
+  float radius_;
+  std::vector<uint32_t> offsets_;
+  std::vector<lvr2::VertexHandle> vertices_;
+};
+
+/**
+ * @brief Thread-safe store of derived geometry attributes of the mesh, e.g. face areas or vertex neighbourhoods, which
+ *        are computed on the first request of their key and shared by all layers afterwards. Requests of a key which is
+ *        being computed wait for the result, requests of other keys are not blocked.
+ */
+class GeometryCache
+{
+public:
+  /**
+   * @brief Returns the attribute of the given key and computes it on the first request
+   * @param key The key of the attribute, e.g. "face_areas"
+   * @param compute Computes the attribute, it may return an empty pointer, which is cached as well
+   * @return The attribute, or an empty pointer if the computation did not provide it
+   * @throws std::logic_error if the key has been stored with a different type
+   */
+  template <typename T>
+  std::shared_ptr<const T> get(const std::string& key, const std::function<std::shared_ptr<const T>()>& compute)
+  {
+    std::shared_ptr<Entry> entry;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto& slot = entries_[key];
+      if (!slot)
+      {
+        slot = std::make_shared<Entry>(typeid(T));
+      }
+      entry = slot;
+    }
+    if (entry->type != std::type_index(typeid(T)))
+    {
+      throw std::logic_error("The geometry attribute '" + key + "' has been stored with a different type");
+    }
+
+    std::lock_guard<std::mutex> lock(entry->mtx);
+    if (!entry->computed)
+    {
+      entry->value = compute();
+      entry->computed = true;
+    }
+    return std::static_pointer_cast<const T>(entry->value);
+  }
+
+  /**
+   * @brief Returns the attribute of the given key if it has been computed, without computing it
+   */
+  template <typename T>
+  std::shared_ptr<const T> find(const std::string& key) const
+  {
+    std::shared_ptr<Entry> entry;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto iter = entries_.find(key);
+      if (iter == entries_.end() || iter->second->type != std::type_index(typeid(T)))
+      {
+        return std::shared_ptr<const T>();
+      }
+      entry = iter->second;
+    }
+    std::lock_guard<std::mutex> lock(entry->mtx);
+    return std::static_pointer_cast<const T>(entry->value);
+  }
+
+  /**
+   * @brief Removes all attributes, e.g. after a new mesh has been loaded. Attributes still held by their users stay
+   *        valid until they are released.
+   */
+  void clear();
+
+  /**
+   * @brief Returns the number of computed attributes, including the ones computed as empty pointers
+   */
+  size_t size() const;
+
+private:
+  struct Entry
+  {
+    explicit Entry(const std::type_info& type) : type(type), computed(false)
+    {
+    }
+
+    std::type_index type;
+    std::mutex mtx;
+    bool computed;
+    std::shared_ptr<const void> value;
+  };
+
+  mutable std::mutex mtx_;
+  std::map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__GEOMETRY_CACHE_H
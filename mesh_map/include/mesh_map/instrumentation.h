@@ -0,0 +1,304 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__INSTRUMENTATION_H
+#define MESH_MAP__INSTRUMENTATION_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Aggregates the values of a metric, e.g. the durations of a timed phase, in power of two buckets.
+ *
+ * Recording is lock-free, thus a histogram can be shared by all threads running the instrumented code.
+ */
+class Histogram
+{
+public:
+  //! bucket 0 counts the value 0, bucket i > 0 counts the values in [2^(i-1), 2^i), the last bucket all larger ones
+  static constexpr size_t NUM_BUCKETS = 48;
+
+  //! aggregated values of a histogram at the time it has been read
+  struct Summary
+  {
+    std::string name;
+    std::string unit;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    std::array<uint64_t, NUM_BUCKETS> buckets{};
+
+    double mean() const
+    {
+      return count ? static_cast<double>(sum) / count : 0.0;
+    }
+
+    /**
+     * @brief Estimates the percentile by interpolating linearly inside the bucket containing it
+     * @param p The percentile in [0, 1]
+     */
+    double percentile(const double p) const;
+  };
+
+  /**
+   * @brief Creates an empty histogram
+   * @param name The name of the metric, e.g. "cvp_mesh_planner.make_plan"
+   * @param unit The unit of the recorded values, "us" for timers and empty for counters
+   */
+  Histogram(const std::string& name, const std::string& unit);
+
+  //! adds a value to the histogram
+  void record(const uint64_t value);
+
+  //! reads the aggregated values, and starts a new aggregation period if reset is true
+  Summary summary(const bool reset = false);
+
+  const std::string& name() const
+  {
+    return name_;
+  }
+
+  const std::string& unit() const
+  {
+    return unit_;
+  }
+
+private:
+  const std::string name_;
+  const std::string unit_;
+
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_;
+};
+
+/**
+ * @brief Process wide registry of the metrics of the navigation stack.
+ *
+ * The instrumentation is disabled by default. In that case a timer or counter costs a single relaxed atomic load,
+ * thus instrumented code can stay in the hot paths. Counters are meant to be accumulated locally and recorded once
+ * per phase, e.g. the number of vertices settled by a wave front propagation.
+ *
+ * If tracing is started, every timer and counter additionally writes a trace event in the Chrome JSON trace format,
+ * which can be opened with Perfetto (ui.perfetto.dev) or chrome://tracing.
+ */
+class Instrumentation
+{
+public:
+  //! the process wide instance
+  static Instrumentation& instance();
+
+  //! true if the timers and counters record values
+  static bool enabled()
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  //! true if the timers and counters write trace events
+  static bool tracing()
+  {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  //! enables or disables recording, the values recorded so far are kept
+  void setEnabled(const bool enabled);
+
+  /**
+   * @brief Returns the histogram of the metric, which is created on first use and lives as long as the process
+   * @param name The name of the metric
+   * @param unit The unit of the recorded values, only used when the histogram is created
+   */
+  Histogram& histogram(const std::string& name, const std::string& unit = "");
+
+  /**
+   * @brief Reads all histograms which recorded at least one value, sorted by name
+   * @param reset Starts a new aggregation period for all histograms
+   */
+  std::vector<Histogram::Summary> summaries(const bool reset = false);
+
+  /**
+   * @brief Starts writing trace events to the given file, a running trace is stopped before
+   * @return true if the file could be opened
+   */
+  bool startTrace(const std::string& file_name);
+
+  //! stops tracing and completes the trace file
+  void stopTrace();
+
+  //! writes a complete event with the given start time and duration
+  void traceDuration(const Histogram& histogram, const std::chrono::steady_clock::time_point& start,
+                     const std::chrono::steady_clock::duration& duration);
+
+  //! writes a counter event with the recorded value
+  void traceCounter(const Histogram& histogram, const uint64_t value);
+
+private:
+  Instrumentation() = default;
+
+  void writeEvent(const std::string& event);
+
+  static std::atomic<bool> enabled_;
+  static std::atomic<bool> tracing_;
+
+  std::mutex histograms_mtx_;
+  std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+
+  std::mutex trace_mtx_;
+  std::ofstream trace_file_;
+  bool first_event_ = true;
+};
+
+/**
+ * @brief Records the time between its construction and destruction in microseconds
+ */
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(Histogram& histogram) : histogram_(Instrumentation::enabled() ? &histogram : nullptr)
+  {
+    if (histogram_)
+    {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  /**
+   * @brief Times into the histogram with the given name. Names which are built at runtime are only looked up if the
+   *        instrumentation is enabled.
+   */
+  explicit ScopedTimer(const std::function<Histogram&()>& histogram)
+    : histogram_(Instrumentation::enabled() ? &histogram() : nullptr)
+  {
+    if (histogram_)
+    {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedTimer()
+  {
+    if (histogram_)
+    {
+      const auto duration = std::chrono::steady_clock::now() - start_;
+      histogram_->record(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+      if (Instrumentation::tracing())
+      {
+        Instrumentation::instance().traceDuration(*histogram_, start_, duration);
+      }
+    }
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  Histogram* histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Records the value of a counter, if the instrumentation is enabled
+ */
+inline void recordCount(Histogram& histogram, const uint64_t value)
+{
+  if (Instrumentation::enabled())
+  {
+    histogram.record(value);
+    if (Instrumentation::tracing())
+    {
+      Instrumentation::instance().traceCounter(histogram, value);
+    }
+  }
+}
+
+/**
+ * @brief Records a duration which has been measured anyway, e.g. for a log line, in microseconds
+ */
+inline void recordDuration(Histogram& histogram, const std::chrono::steady_clock::duration& duration)
+{
+  if (Instrumentation::enabled())
+  {
+    histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+  }
+}
+
+} /* namespace mesh_map */
+
+#define MESH_MAP_INSTRUMENTATION_CONCAT_IMPL(a, b) a##b
+#define MESH_MAP_INSTRUMENTATION_CONCAT(a, b) MESH_MAP_INSTRUMENTATION_CONCAT_IMPL(a, b)
+
+//! times the enclosing scope, the histogram is looked up once per call site
+#define MESH_MAP_SCOPED_TIMER(name)                                                                                   \
+  static mesh_map::Histogram& MESH_MAP_INSTRUMENTATION_CONCAT(mesh_map_timer_histogram_, __LINE__) =                  \
+      mesh_map::Instrumentation::instance().histogram(name, "us");                                                    \
+  mesh_map::ScopedTimer MESH_MAP_INSTRUMENTATION_CONCAT(mesh_map_timer_, __LINE__)(                                   \
+      MESH_MAP_INSTRUMENTATION_CONCAT(mesh_map_timer_histogram_, __LINE__))
+
+//! records the value of a counter, the histogram is looked up once per call site
+#define MESH_MAP_COUNT(name, value)                                                                                   \
+  do                                                                                                                  \
+  {                                                                                                                   \
+    static mesh_map::Histogram& mesh_map_counter_histogram = mesh_map::Instrumentation::instance().histogram(name);   \
+    mesh_map::recordCount(mesh_map_counter_histogram, value);                                                         \
+  } while (false)
+
+//! records a measured duration, the histogram is looked up once per call site
+#define MESH_MAP_DURATION(name, duration)                                                                             \
+  do                                                                                                                  \
+  {                                                                                                                   \
+    static mesh_map::Histogram& mesh_map_duration_histogram =                                                         \
+        mesh_map::Instrumentation::instance().histogram(name, "us");                                                  \
+    mesh_map::recordDuration(mesh_map_duration_histogram, duration);                                                  \
+  } while (false)
+
+#endif  // MESH_MAP__INSTRUMENTATION_H
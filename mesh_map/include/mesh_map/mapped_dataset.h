@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__MAPPED_DATASET_H
+#define MESH_MAP__MAPPED_DATASET_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <lvr2/types/MeshBuffer.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Read-only memory mapping of a two dimensional HDF5 dataset.
+ *
+ * Only datasets with a contiguous layout, without filters and with a native element type can be mapped, since their
+ * elements are stored as one plain array inside the file. The pages are loaded on demand by the kernel and are shared
+ * with the page cache, i.e. mapping the dataset does not copy it onto the heap.
+ */
+class MappedDataset
+{
+public:
+  typedef std::shared_ptr<MappedDataset> Ptr;
+
+  enum ElementType
+  {
+    FLOAT32,
+    UINT32
+  };
+
+  /**
+   * @brief Maps the given dataset of the HDF5 file
+   * @param file Path to the HDF5 file
+   * @param dataset Path to the dataset inside the file, e.g. "meshes/mesh/vertices"
+   * @param type The expected element type of the dataset
+   * @return The mapped dataset, or nullptr, if the dataset does not exist or can not be mapped
+   */
+  static Ptr map(const std::string& file, const std::string& dataset, ElementType type);
+
+  ~MappedDataset();
+
+  MappedDataset(const MappedDataset&) = delete;
+  MappedDataset& operator=(const MappedDataset&) = delete;
+
+  //! pointer to the first element of the dataset
+  const void* data() const
+  {
+    return data_;
+  }
+
+  //! number of rows, e.g. the number of vertices
+  size_t rows() const
+  {
+    return rows_;
+  }
+
+  //! number of columns, e.g. 3 for xyz coordinates
+  size_t cols() const
+  {
+    return cols_;
+  }
+
+private:
+  MappedDataset(void* mapping, size_t mapping_size, const void* data, size_t rows, size_t cols);
+
+  void* mapping_;
+  size_t mapping_size_;
+  const void* data_;
+  size_t rows_;
+  size_t cols_;
+};
+
+/**
+ * @brief Builds a mesh buffer with the vertices and the face indices of the given mesh part without copying them, the
+ * channels are backed by mappings of the datasets in the HDF5 file. The mappings are released with the last channel
+ * referencing them.
+ * @param file Path to the HDF5 file
+ * @param mesh_part The name of the mesh part in the group "meshes"
+ * @return The mesh buffer, or nullptr, if one of the datasets can not be mapped
+ */
+lvr2::MeshBufferPtr mapMeshBuffer(const std::string& file, const std::string& mesh_part);
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__MAPPED_DATASET_H
@@ -0,0 +1,172 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__MESH_BOUNDARY_H
+#define MESH_MAP__MESH_BOUNDARY_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <lvr2/geometry/Handles.hpp>
+
+#include "mesh_topology.h"
+
+namespace mesh_map
+{
+
+/**
+ * @brief Boundary contours of the mesh, i.e. the chains of edges with a single incident face around the holes and
+ *        along the outer border. The edges are classified once from the face incidences of the topology snapshot,
+ *        optionally in parallel, and linked to contours by following the boundary half-edges with a visited bitmap.
+ *        The contours are stored in flat buffers: the vertices of all contours one after another and the offset of
+ *        each contour.
+ */
+class MeshBoundary
+{
+public:
+  typedef std::shared_ptr<const MeshBoundary> ConstPtr;
+
+  /**
+   * @brief Extracts the boundary contours of the mesh
+   * @param topology The topology snapshot of the mesh
+   * @param num_threads The number of threads classifying the edges
+   */
+  explicit MeshBoundary(const MeshTopology& topology, const size_t num_threads = 1);
+
+  /**
+   * @brief Updates the boundary after faces have been added or removed. Only the edges of the given vertices are
+   *        classified again, the contours are linked anew from the stored classification of all edges.
+   * @param topology The topology snapshot of the changed mesh, the handles of the unchanged elements must not change
+   * @param vertices The vertices of the added and removed faces, it might contain duplicates
+   */
+  void update(const MeshTopology& topology, const std::vector<lvr2::VertexHandle>& vertices);
+
+  //! number of contours
+  size_t numContours() const
+  {
+    return contour_offsets_.size() - 1;
+  }
+
+  /**
+   * @brief Returns the vertices of the contour in the order of its boundary half-edges. A closed contour does not
+   *        repeat its first vertex. Contours which end at broken vertices are open.
+   */
+  HandleRange<lvr2::VertexHandle> contour(const size_t i) const
+  {
+    return HandleRange<lvr2::VertexHandle>(contour_vertices_.data() + contour_offsets_[i],
+                                           contour_vertices_.data() + contour_offsets_[i + 1]);
+  }
+
+  //! vertices of all contours, contour i is contourVertices()[contourOffsets()[i]] to [contourOffsets()[i + 1] - 1]
+  const std::vector<lvr2::VertexHandle>& contourVertices() const
+  {
+    return contour_vertices_;
+  }
+
+  //! offsets of the contours in contourVertices(), with one more entry than contours
+  const std::vector<uint32_t>& contourOffsets() const
+  {
+    return contour_offsets_;
+  }
+
+  //! whether the edge has exactly one incident face
+  bool isBoundaryEdge(const lvr2::EdgeHandle& eH) const
+  {
+    return eH.idx() < edge_states_.size() && edge_states_[eH.idx()] != INTERIOR;
+  }
+
+  //! whether the vertex is incident to a boundary edge
+  bool isBoundaryVertex(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < boundary_vertices_.size() && boundary_vertices_[vH.idx()];
+  }
+
+  //! number of boundary edges
+  size_t numBoundaryEdges() const
+  {
+    return num_boundary_edges_;
+  }
+
+  //! approximate number of allocated bytes
+  size_t memoryUsage() const;
+
+private:
+  //! direction of the boundary half-edge of an edge, which runs opposite to the half-edge of its face
+  enum EdgeState : uint8_t
+  {
+    INTERIOR = 0,
+    //! from the first to the second vertex of MeshTopology::verticesOfEdge()
+    FORWARD = 1,
+    //! from the second to the first vertex
+    BACKWARD = 2
+  };
+
+  //! counts the faces of the edge at its first valid vertex
+  static EdgeState classify(const MeshTopology& topology, const lvr2::EdgeHandle& eH);
+
+  //! links the boundary half-edges to contours
+  void link(const MeshTopology& topology);
+
+  const lvr2::VertexHandle& tail(const MeshTopology& topology, const lvr2::EdgeHandle& eH) const
+  {
+    return topology.verticesOfEdge(eH)[edge_states_[eH.idx()] == FORWARD ? 0 : 1];
+  }
+
+  const lvr2::VertexHandle& head(const MeshTopology& topology, const lvr2::EdgeHandle& eH) const
+  {
+    return topology.verticesOfEdge(eH)[edge_states_[eH.idx()] == FORWARD ? 1 : 0];
+  }
+
+  //! EdgeState of each edge slot
+  std::vector<uint8_t> edge_states_;
+
+  //! whether each vertex slot is incident to a boundary edge
+  std::vector<uint8_t> boundary_vertices_;
+
+  //! one bit per edge slot, i.e. per boundary half-edge, set once the half-edge has been linked to a contour
+  std::vector<uint64_t> visited_;
+
+  std::vector<lvr2::VertexHandle> contour_vertices_;
+  std::vector<uint32_t> contour_offsets_;
+  size_t num_boundary_edges_;
+};
+
+} /* namespace mesh_map */
+
+#endif /* MESH_MAP__MESH_BOUNDARY_H */
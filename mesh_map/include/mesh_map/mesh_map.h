@@ -39,7 +39,13 @@
 #define MESH_MAP__MESH_MAP_H
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <geometry_msgs/msg/point.hpp>
@@ -49,8 +55,10 @@
 #include <mesh_msgs/msg/mesh_geometry_stamped.hpp>
 #include <mesh_msgs/msg/mesh_vertex_colors_stamped.hpp>
 #include <mesh_msgs/msg/mesh_vertex_costs_stamped.hpp>
+#include <mesh_msgs/msg/mesh_vertex_costs_sparse_stamped.hpp>
 #include <pluginlib/class_loader.hpp>
 #include <std_msgs/msg/color_rgba.hpp>
+#include <std_msgs/msg/string.hpp>
 #include <tf2_ros/buffer.h>
 #include <visualization_msgs/msg/marker.hpp>
 #include <std_srvs/srv/trigger.hpp>
@@ -59,12 +67,89 @@
 #include <lvr2/io/AttributeMeshIOBase.hpp>
 #include <lvr2/geometry/BaseMesh.hpp>
 
+#include "coarse_graph.h"
+#include "compact_maps.h"
+#include "face_bvh.h"
+#include "face_locator.h"
+#include "geometry_cache.h"
+#include "mesh_boundary.h"
+#include "mesh_tiling.h"
+#include "mesh_topology.h"
 #include "nanoflann.hpp"
 #include "nanoflann_mesh_adaptor.h"
+#include "persistence_queue.h"
+#include "vertex_bitset.h"
+#include "vertex_kernels.h"
 
 
 namespace mesh_map
 {
+/**
+ * @brief Immutable copy of the combined costs and edge weights. Readers keep the snapshot as long as they need a
+ * consistent view, e.g. for a whole planning run, while the layers keep updating the costs of the map.
+ */
+struct CostSnapshot
+{
+  typedef std::shared_ptr<const CostSnapshot> ConstPtr;
+
+  //! cost revision of the copied costs, see MeshMap::costRevision()
+  uint64_t revision;
+
+  //! combined layer costs
+  lvr2::DenseVertexMap<float> vertex_costs;
+
+  //! edge weights
+  lvr2::DenseEdgeMap<float> edge_weights;
+};
+
+/**
+ * @brief Vector field of a plan, which is handed over from the planner to the controller without copying. The field is
+ * immutable once it has been published with MeshMap::setVectorField(), a new plan publishes a new field.
+ */
+struct VectorField
+{
+  typedef std::shared_ptr<VectorField> Ptr;
+  typedef std::shared_ptr<const VectorField> ConstPtr;
+
+  //! increasing version, assigned by MeshMap::setVectorField()
+  uint64_t version = 0;
+
+  //! vectors pointing to the source of the plan
+  lvr2::DenseVertexMap<mesh_map::Vector> vectors;
+};
+
+/**
+ * @brief Cost of the footprint at a single pose, see MeshMap::queryCosts()
+ */
+struct PoseCost
+{
+  //! states ordered by severity
+  enum State : uint8_t
+  {
+    FREE = 0,     //!< all footprint samples are on the mesh and not lethal
+    LETHAL = 1,   //!< at least one footprint sample is lethal
+    UNKNOWN = 2,  //!< at least one footprint sample could not be located on the mesh
+    OUTSIDE = 3   //!< the position itself could not be located on the mesh
+  };
+
+  State state = OUTSIDE;
+
+  //! sum of the costs of the footprint samples which are on the mesh and not lethal
+  float cost = 0;
+
+  //! maximum cost of the footprint samples which are on the mesh and not lethal
+  float max_cost = 0;
+
+  //! number of lethal footprint samples
+  uint32_t num_lethal = 0;
+
+  //! number of footprint samples which could not be located on the mesh
+  uint32_t num_unknown = 0;
+
+  //! the face containing the position
+  lvr2::OptionalFaceHandle face;
+};
+
 class MeshMap : public std::enable_shared_from_this<MeshMap>
 {
 public:
@@ -73,6 +158,11 @@ public:
 
   MeshMap(tf2_ros::Buffer& tf, const rclcpp::Node::SharedPtr& node);
 
+  /**
+   * @brief Runs the pending writes to the working file
+   */
+  ~MeshMap();
+
   /**
    * @brief Reads in the mesh geometry, normals and cost values and publishes all as mesh_msgs
    * @return true f the mesh and its attributes have been load successfully.
@@ -91,6 +181,12 @@ public:
    */
   bool initLayerPlugins();
 
+  /**
+   * @brief Computes the given layers concurrently on up to layer_init_threads threads
+   * @param layer_indices Indices of the layers in loaded_layers, the layers must not depend on lethal vertices
+   */
+  void computeLayersConcurrently(const std::vector<size_t>& layer_indices);
+
   /**
    * @brief Return and optional vertex handle of to the closest vertex to the given position
    * @param pos the search position
@@ -98,6 +194,98 @@ public:
    */
   lvr2::OptionalVertexHandle getNearestVertexHandle(const mesh_map::Vector& pos);
 
+  /**
+   * @brief Searches all vertices within the radius around the given position using the k-d tree. The method can be
+   *        called concurrently.
+   * @param pos the search position
+   * @param radius the search radius
+   * @param[out] vertices the found vertices in no particular order, the buffer is cleared first and can be reused
+   * @return the number of found vertices
+   */
+  size_t radiusSearch(const mesh_map::Vector& pos, const float radius, std::vector<lvr2::VertexHandle>& vertices);
+
+  /**
+   * @brief Batched radius search, the results are stored in compressed sparse row format
+   * @param positions the search positions
+   * @param radius the search radius
+   * @param[out] offsets the results of positions[i] are vertices[offsets[i]] to vertices[offsets[i + 1] - 1]
+   * @param[out] vertices the found vertices of all searches
+   */
+  void radiusSearch(const std::vector<mesh_map::Vector>& positions, const float radius, std::vector<uint32_t>& offsets,
+                    std::vector<lvr2::VertexHandle>& vertices);
+
+  /**
+   * @brief Searches the k nearest vertices of the given position using the k-d tree. The method can be called
+   *        concurrently.
+   * @param pos the search position
+   * @param k the number of neighbours to search
+   * @param[out] vertices the found vertices sorted by distance, the buffer is cleared first and can be reused
+   * @param[out] squared_distances the squared distances of the found vertices
+   * @return the number of found vertices, which is less than k if the mesh has less vertices
+   */
+  size_t knnSearch(const mesh_map::Vector& pos, const size_t k, std::vector<lvr2::VertexHandle>& vertices,
+                   std::vector<float>& squared_distances);
+
+  /**
+   * @brief Batched k nearest neighbour search, the results are stored in compressed sparse row format
+   * @param positions the search positions
+   * @param k the number of neighbours to search for each position
+   * @param[out] offsets the results of positions[i] are vertices[offsets[i]] to vertices[offsets[i + 1] - 1]
+   * @param[out] vertices the found vertices of all searches
+   * @param[out] squared_distances the squared distances of the found vertices
+   */
+  void knnSearch(const std::vector<mesh_map::Vector>& positions, const size_t k, std::vector<uint32_t>& offsets,
+                 std::vector<lvr2::VertexHandle>& vertices, std::vector<float>& squared_distances);
+
+  /**
+   * @brief Creates a local neighbourhood walker for layers which evaluate the neighbourhood of each vertex
+   * @param strategy "topology" walks the mesh, "radius" uses radiusSearch(), see isValidNeighborhoodStrategy()
+   * @return the walker, each thread has to use its own copy
+   */
+  LocalNeighborhood localNeighborhood(const std::string& strategy);
+
+  /**
+   * @brief Creates a local neighbourhood walker which uses the shared neighbourhoods of the given radius, see
+   *        vertexNeighbourhoods(). The walker visits the same vertices as the one of localNeighborhood(strategy).
+   * @param strategy "topology" or "radius", see isValidNeighborhoodStrategy()
+   * @param radius The radius the walker is used with
+   * @param num_threads The number of threads computing the neighbourhoods on first use
+   * @return the walker, each thread has to use its own copy
+   */
+  LocalNeighborhood localNeighborhood(const std::string& strategy, const float radius, const size_t num_threads);
+
+  /**
+   * @brief Returns the neighbourhoods of all vertices for the given strategy and radius, which are computed on first
+   *        use and shared by all layers with the same neighbourhood afterwards.
+   * @param strategy "topology" or "radius", see isValidNeighborhoodStrategy()
+   * @param radius The radius of the neighbourhoods
+   * @param num_threads The number of threads computing the neighbourhoods on first use
+   * @return The neighbourhoods, or an empty pointer if no map has been loaded or they exceed geometry_cache_size
+   */
+  VertexNeighbourhoods::ConstPtr vertexNeighbourhoods(const std::string& strategy, const float radius,
+                                                      const size_t num_threads);
+
+  /**
+   * @brief Returns the area of each face, which is computed on first use
+   * @return The face areas, or an empty pointer if no map has been loaded
+   */
+  std::shared_ptr<const lvr2::DenseFaceMap<float>> faceAreas();
+
+  /**
+   * @brief Returns the boundary contours of the mesh, which are extracted in parallel on first use
+   * @return The boundary, or an empty pointer if no map has been loaded
+   */
+  MeshBoundary::ConstPtr boundary();
+
+  /**
+   * @brief Returns the cache of derived geometry attributes of the current mesh. Layers can store their own
+   *        attributes there to share them, it is cleared when a new mesh is loaded.
+   */
+  GeometryCache& geometryCache()
+  {
+    return geometry_cache;
+  }
+
   /**
    * @brief return true if the given position lies inside the triangle with respect to the given maximum distance.
    * @param pos The query position
@@ -115,6 +303,36 @@ public:
    */
   lvr2::OptionalFaceHandle getContainingFace(Vector& position, const float& max_dist);
 
+  /**
+   * @brief Creates a point locator for the current mesh, which uses the k-d tree of the map for its nearest neighbour
+   *        search. A locator must not be used by several threads concurrently.
+   * @return The locator, or an empty pointer if no map has been loaded
+   */
+  FaceLocator::Ptr createFaceLocator();
+
+  /**
+   * @brief Returns the point locator of the calling thread, which is created on first use and after the mesh changed.
+   *        The point location methods of the map use it, so that each thread allocates its search buffers once.
+   * @return The locator, or an empty pointer if no map has been loaded
+   */
+  FaceLocator::Ptr faceLocator();
+
+  /**
+   * @brief Returns the bounding volume hierarchy over the faces of the mesh, which is built on first use. Layers and the
+   *        controller use it to cast sensor rays onto the map and to project poses onto the surface below them, which
+   *        is not ambiguous on multi-level structures like ramps and bridges in contrast to the vertex k-d tree.
+   * @return The hierarchy, or an empty pointer if no map has been loaded
+   */
+  FaceBVH::ConstPtr faceBVH();
+
+  /**
+   * @brief Returns the coarse graph of the mesh with the given voxel size for hierarchical planning. On first use it is
+   *        loaded from the working file, or built and stored there. A different cell size rebuilds the graph.
+   * @param cell_size The edge length of the voxels clustering the vertices
+   * @return The graph, or an empty pointer if no map has been loaded
+   */
+  CoarseGraph::ConstPtr coarseGraph(const float cell_size);
+
   /**
    * @brief Searches for a triangle which contains the given position with respect to the maximum distance
    * @param position The query position
@@ -136,14 +354,62 @@ public:
   void combineVertexCosts(const rclcpp::Time& map_stamp);
 
   /**
-   * @brief Computes contours
+   * @brief Updates the combined costs of the given vertices and the weights of their incident edges. The layer costs
+   *        of the vertices have to be gathered before. Falls back to combining all costs if the combined costs have
+   *        not been computed yet or the layer factor changed.
+   * @param map_stamp timestamp for published cost data
+   * @param vertices the vertices whose layer costs or lethal state changed, it might contain duplicates
+   */
+  void combineVertexCosts(const rclcpp::Time& map_stamp, const std::vector<lvr2::VertexHandle>& vertices);
+
+  /**
+   * @brief Returns the revision of the combined costs, it is incremented every time the costs are combined
+   */
+  uint64_t costRevision();
+
+  /**
+   * @brief Returns a snapshot of the current combined costs and edge weights. The snapshot is copied at most once per
+   *        cost revision and shared by all readers, holding it does not block cost updates. It must not be called
+   *        while holding sharedLock(), unless the snapshot has been pinned with costSnapshot(costs_lock) under that
+   *        lock, since the costs mutex can not be locked recursively.
+   */
+  CostSnapshot::ConstPtr costSnapshot();
+
+  /**
+   * @brief Returns the snapshot of the combined costs for a caller which already holds sharedLock(). The snapshot stays
+   *        current while the lock is held, thus costSnapshot() returns it without locking the costs again.
+   * @param costs_lock The lock returned by sharedLock()
+   */
+  CostSnapshot::ConstPtr costSnapshot(const std::shared_lock<std::shared_mutex>& costs_lock);
+
+  /**
+   * @brief Locks the combined costs and edge weights for reading. Callers which access vertexCosts(), edgeWeights() or
+   *        costAtPosition() concurrently to layer updates have to hold the lock, cost updates wait until it is
+   *        released. Prefer costSnapshot() for long running reads, but take it through costSnapshot(costs_lock)
+   *        while the lock is held.
+   */
+  std::shared_lock<std::shared_mutex> sharedLock();
+
+  /**
+   * @brief Collects the vertices whose combined costs changed after the given revision, e.g. to repair a potential
+   *        field locally instead of recomputing it.
+   * @param revision The cost revision for which the caller's data has been computed
+   * @param changed The vector is filled with the changed vertices, it might contain duplicates
+   * @return false if the changes are not known for the given revision, because the history has been truncated or all
+   *         costs have changed, e.g. after a new layer factor. The caller has to assume that every vertex changed then.
+   */
+  bool changedVerticesSince(const uint64_t revision, std::vector<lvr2::VertexHandle>& changed);
+
+  /**
+   * @brief Computes contours, i.e. copies the contours of boundary() with more than min_contour_size vertices
    * @param contours the vector to bo filled with contours
    * @param min_contour_size The minimum contour size, i.e. the number of vertices per contour.
    */
   void findContours(std::vector<std::vector<lvr2::VertexHandle>>& contours, int min_contour_size);
 
   /**
-   * @brief Publishes the given vertex map as mesh_msgs/VertexCosts, e.g. to visualize these.
+   * @brief Publishes the given vertex map as mesh_msgs/VertexCosts, e.g. to visualize these. Nothing is published if
+   *        there are no subscribers.
    * @param costs The cost map to publish
    * @param name The name of the cost map
    */
@@ -155,7 +421,7 @@ public:
   void publishVertexColors(const rclcpp::Time& map_stamp);
 
   /**
-   * @brief Publishes all layer costs as mesh_msgs/VertexCosts
+   * @brief Publishes all layer costs and the combined costs as mesh_msgs/VertexCosts, see requestCostPublishing()
    */
   void publishCostLayers(const rclcpp::Time& map_stamp);
 
@@ -196,6 +462,13 @@ public:
    */
   void findLethalByContours(const int& min_contour_size, std::set<lvr2::VertexHandle>& lethals);
 
+  /**
+   * @brief Marks the vertices of all contours with more than min_contour_size vertices as lethal
+   * @param min_contour_size The minimum contour size, i.e. the number of vertices per contour.
+   * @param lethals the set which is filled with contour vertices
+   */
+  void findLethalByContours(const int& min_contour_size, VertexBitset& lethals);
+
   /**
    * @brief Returns the global frame / coordinate system id string
    */
@@ -241,6 +514,30 @@ public:
   float costAtPosition(const std::array<lvr2::VertexHandle, 3>& vertices,
                        const std::array<float, 3>& barycentric_coords);
 
+  /**
+   * Computes the cost value for the given triangle's vertices and barycentric coordinates from a compact cost array
+   * @param costs The costs indexed by the vertex index, e.g. quantized layer costs
+   * @param vertices The triangles vertices
+   * @param barycentric_coords The barycentric coordinates of the query position.
+   * @return A cost value for the given barycentric coordinates, NaN if a vertex is beyond the array
+   */
+  float costAtPosition(const CostArray& costs, const std::array<lvr2::VertexHandle, 3>& vertices,
+                       const std::array<float, 3>& barycentric_coords);
+
+  /**
+   * @brief Evaluates the combined costs of a circular footprint at many positions, e.g. to score candidate paths.
+   *        Each position is located by searching the faces around the face of the previous position first, so the
+   *        consecutive positions of a path do not need a nearest neighbour search. The footprint is sampled on a circle
+   *        in the tangent plane of the containing face. The query reads a cost snapshot, it neither blocks nor is
+   *        blocked by planners and layer updates.
+   * @param positions The query positions in the map frame
+   * @param footprint_radius Radius of the footprint, zero evaluates the positions only
+   * @param max_dist Maximum distance of a position or footprint sample to the mesh surface
+   * @param[out] results The cost of the footprint at each position
+   */
+  void queryCosts(const std::vector<Vector>& positions, const float footprint_radius, const float max_dist,
+                  std::vector<PoseCost>& results);
+
   /**
    * Computes the barycentric coordinates of the ray intersection point for the given ray
    * @param orig The ray origin
@@ -265,12 +562,9 @@ public:
   bool resetLayers();
 
   /**
-   * @brief Returns the stored vector map
+   * @brief Returns the latest published vector field, or an empty pointer if no plan has been published yet
    */
-  const lvr2::DenseVertexMap<mesh_map::Vector>& getVectorMap()
-  {
-    return vector_map;
-  };
+  VectorField::ConstPtr vectorField();
 
   /**
    * @brief Returns the stored mesh
@@ -281,15 +575,27 @@ public:
   }
 
   /**
-   * @brief Returns the mesh-io object
+   * @brief Returns the immutable CSR topology snapshot of the mesh, which is built after the mesh has been loaded.
+   *        Planners and layers can use it instead of the half-edge mesh for adjacency lookups in hot loops.
+   */
+  MeshTopology::ConstPtr topology()
+  {
+    return topology_ptr;
+  }
+
+  /**
+   * @brief Returns the mesh-io object, after the pending writes to the working file have finished. It must not be
+   *        called from a write of the persistence queue. In the tiled loading mode it accesses the mesh part of the
+   *        resident tiles, see accessWorkingPart() for the channels of the full mesh.
    */
   std::shared_ptr<lvr2::AttributeMeshIOBase> meshIO()
   {
+    persistence_queue->flush();
     return mesh_io_ptr;
   }
 
   /**
-   * @brief Returns the stored combined costs
+   * @brief Returns the stored combined costs, see sharedLock()
    */
   const lvr2::DenseVertexMap<float>& vertexCosts()
   {
@@ -304,6 +610,38 @@ public:
     return global_frame;
   }
 
+  /**
+   * @brief Returns the transformation buffer of the map, e.g. for layers which transform sensor data into the map frame
+   */
+  tf2_ros::Buffer& tfBuffer()
+  {
+    return tf_buffer;
+  }
+
+  /**
+   * @brief Returns the tiling of the working mesh, which is only built in the tiled loading mode
+   */
+  MeshTiling::ConstPtr tiling()
+  {
+    return tiling_ptr;
+  }
+
+  /**
+   * @brief Returns the index of each resident vertex in the mesh of the working file, e.g. to read per tile data of the
+   *        full mesh. The list is empty if the whole mesh is resident.
+   */
+  const std::vector<uint32_t>& residentVertexIds()
+  {
+    return resident_vertex_ids;
+  }
+
+  /**
+   * @brief Runs the access with the mesh-io switched to the mesh part of the full working mesh. The per vertex channels
+   *        read there have to be remapped with residentVertexIds() in the tiled loading mode.
+   * @return The result of the access
+   */
+  bool accessWorkingPart(const std::function<bool()>& access);
+
   /**
    * @brief Returns the mesh's triangle normals
    */
@@ -321,7 +659,7 @@ public:
   }
 
   /**
-   * @brief Returns the mesh's edge weights
+   * @brief Returns the mesh's edge weights, see sharedLock()
    */
   const lvr2::DenseEdgeMap<float>& edgeWeights()
   {
@@ -361,9 +699,20 @@ public:
   bool meshAhead(Vector& vec, lvr2::FaceHandle& face, const float& step_width);
 
   /**
-   * @brief Stores the given vector map
+   * Finds the next position by following the given vector field instead of the latest published one, e.g. to back
+   * track the field of a concurrent query which is not published.
+   * @param vec   direction vector from which the next step vector is calculated
+   * @param face  face of the direction vector
+   * @param step_width The step length to go ahead on the mesh surface
+   * @param field The vector field to follow
+   * @return      true if the position has been moved ahead
    */
-  void setVectorMap(lvr2::DenseVertexMap<mesh_map::Vector>& vector_map);
+  bool meshAhead(Vector& vec, lvr2::FaceHandle& face, const float& step_width, const VectorField& field);
+
+  /**
+   * @brief Publishes the given vector field and assigns its version. The field must not be modified afterwards.
+   */
+  void setVectorField(const VectorField::Ptr& vector_field);
 
   /**
    * @brief Publishes a position as marker. Used for debug purposes.
@@ -382,7 +731,7 @@ public:
   void publishDebugFace(const lvr2::FaceHandle& face_handle, const std_msgs::msg::ColorRGBA& color, const std::string& name);
 
   /**
-   * @brief Publishes a vector field as visualisation_msgs/Marker
+   * @brief Publishes a vector field as visualisation_msgs/Marker, see the overload with values
    * @param name The marker's name
    * @param vector_map The vector field to publish
    * @param publish_face_vectors Enables to publish an additional vertex for the triangle's center.
@@ -391,7 +740,9 @@ public:
                           const bool publish_face_vectors = false);
 
   /**
-   * @brief Publishes a vector field as visualisation_msgs/Marker
+   * @brief Publishes a vector field as visualisation_msgs/Marker. The vectors are sampled at the vertices and faces
+   *        of vectorFieldSamples() and copied, the marker is built and published by the vector field thread. Without
+   *        subscribers, the samples are only kept until one joins.
    * @param name The marker's name
    * @param vector_map The vector field to publish
    * @param values The vertex cost values
@@ -404,18 +755,31 @@ public:
                           const bool publish_face_vectors = false);
 
   /**
-   * @brief Publishes the vector field as visualisation_msgs/Marker
+   * @brief Publishes the sum of the vector maps of all layers as visualisation_msgs/Marker, like publishVectorField()
    */
   void publishCombinedVectorField();
 
+  /**
+   * @brief Returns the vertices and faces at which vector fields are visualized, i.e. one per cell of a grid with the
+   *        cell size vector_field_resolution, all of them if it is 0. They are computed on first use.
+   * @return The samples, or an empty pointer if no map has been loaded
+   */
+  struct VectorFieldSamples
+  {
+    std::vector<lvr2::VertexHandle> vertices;
+    std::vector<lvr2::FaceHandle> faces;
+  };
+  std::shared_ptr<const VectorFieldSamples> vectorFieldSamples();
+
   /**
    * @brief returns a shared pointer to the specified layer
    */
   mesh_map::AbstractLayer::Ptr layer(const std::string& layer_name);
 
   /**
-   * @brief calls 'writeLayer' on every active layer. Every layer itself writes its costs 
-   *        to the working file / part to a dataset named after the layer-name.
+   * @brief enqueues a snapshot of the costs of every active layer to be written to the working file / part to a
+   *        dataset named after the layer-name. The writes run on the I/O thread of the persistence queue, the result
+   *        of each write is published on the topic "~/save_map/result".
    *  
    * Example:
    *  - Working file: "my_map.h5"
@@ -423,12 +787,12 @@ public:
    * 
    * A BorderLayer of name 'border' would write the costs to "my_map.h5/my_mesh_part/channels/border"  
    * 
-   * @return Trigger response. If success is false, the message field is 
-   *      beeing filled with all the failed layer names seperated by comma 
+   * @return Trigger response. The message field lists the layers which have been enqueued
    */
   std_srvs::srv::Trigger::Response writeLayers();
 
-  lvr2::DenseVertexMap<bool> invalid;
+  //! vertices which must not be used by the planners, e.g. broken or non-manifold vertices
+  VertexFlags invalid;
 
 protected:
   //! This is an abstract interface to load mesh information from somewhere
@@ -439,6 +803,20 @@ protected:
   std::shared_ptr<lvr2::BaseMesh<Vector>> mesh_ptr;
   std::string hem_impl_;
 
+  //! adjacency snapshot of mesh_ptr
+  MeshTopology::ConstPtr topology_ptr;
+
+  //! face hierarchy of mesh_ptr, built lazily by faceBVH()
+  FaceBVH::ConstPtr face_bvh_ptr;
+  std::mutex face_bvh_mtx;
+
+  //! coarse graph of mesh_ptr, built or loaded lazily by coarseGraph()
+  CoarseGraph::ConstPtr coarse_graph_ptr;
+  std::mutex coarse_graph_mtx;
+
+  //! derived geometry attributes of mesh_ptr, e.g. face areas and vertex neighbourhoods, computed on first request
+  GeometryCache geometry_cache;
+
 private:
   //! plugin class loader for for the layer plugins
   pluginlib::ClassLoader<mesh_map::AbstractLayer> layer_loader;
@@ -451,11 +829,14 @@ private:
   //! The order of layers might become relevant at some point, so we use a vector to preserve the configured order.
   std::vector<std::pair<std::string, mesh_map::AbstractLayer::Ptr>> loaded_layers;
 
-  //! each layer maps to a set of impassable indices
-  std::map<std::string, std::set<lvr2::VertexHandle>> lethal_indices;
+  //! impassable vertices of each layer, in the order of loaded_layers
+  std::vector<VertexBitset> layer_lethals;
+
+  //! combined impassable vertices of the layers up to and including the layer with the same index in loaded_layers
+  std::vector<VertexBitset> prefix_lethals;
 
   //! all impassable vertices
-  std::set<lvr2::VertexHandle> lethals;
+  VertexBitset lethals;
 
   //! global frame / coordinate system id
   std::string global_frame;
@@ -483,6 +864,33 @@ private:
 
   rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr save_service;
 
+  //! compute the layers which do not depend on lethal vertices concurrently
+  bool parallel_layer_init;
+
+  //! number of threads used for the concurrent layer computation, 0 uses the number of hardware threads
+  int layer_init_threads;
+
+  //! maximum size of one cached vertex neighbourhood set in MiB, larger sets are walked by the layers on demand
+  int geometry_cache_size;
+
+  //! map the mesh datasets of the working file instead of copying them while loading
+  bool mmap_loading;
+
+  //! only keep the tiles within tile_radius around tile_center resident
+  bool tiled_loading;
+  double tile_size;
+  double tile_halo;
+  double tile_radius;
+  std::vector<double> tile_center;
+
+  //! tiling of the working mesh and the working mesh index of each resident vertex, see residentVertexIds()
+  MeshTiling::ConstPtr tiling_ptr;
+  std::vector<uint32_t> resident_vertex_ids;
+
+  //! mesh part of the working file holding the map attributes, differs from the working part if only some tiles are
+  //! resident, see residentPart()
+  std::string attribute_part;
+
   // Reconfigurable parameters (see reconfigureCallback method)
   int min_contour_size;
   double layer_factor;
@@ -491,8 +899,54 @@ private:
   //! combined layer costs
   lvr2::DenseVertexMap<float> vertex_costs;
 
-  //! stored vector map to share between planner and controller
-  lvr2::DenseVertexMap<mesh_map::Vector> vector_map;
+  //! costs of each layer in the order of loaded_layers, indexed by the vertex index and stored with cost_storage_bits
+  std::vector<CostArray> layer_cost_arrays;
+
+  //! bits per vertex of the layer cost arrays, 8 or 16 quantize the costs of each layer to its range, 32 keeps floats
+  int cost_storage_bits;
+
+  //! combined layer costs indexed by the vertex index, vertex_costs holds the same values
+  std::vector<float> combined_costs;
+
+  /**
+   * @brief Copies the costs of all vertices of the layer into its cost array
+   * @param index index of the layer in loaded_layers
+   */
+  void gatherLayerCosts(const size_t index);
+
+  /**
+   * @brief Copies the costs of the given vertices of the layer into its cost array
+   * @param index index of the layer in loaded_layers
+   * @param vertices the vertices to copy
+   */
+  void gatherLayerCosts(const size_t index, const std::vector<lvr2::VertexHandle>& vertices);
+
+  /**
+   * @brief Computes the weight of the edge from its distance and the combined costs of its vertices
+   */
+  void updateEdgeWeight(const lvr2::EdgeHandle& eH);
+
+  /**
+   * @brief Compares combined costs, infinite costs compare equal and NaN is never considered a change
+   */
+  static bool costChanged(const float previous, const float current);
+
+  /**
+   * @brief Increments the cost revision and stores the changed vertices in the cost history, cost_mtx has to be locked
+   *        exclusively
+   * @param comparable false if the changes are unknown, which truncates the history
+   * @param changed the vertices with changed combined costs
+   */
+  void recordCostChanges(const bool comparable, std::vector<lvr2::VertexHandle>&& changed);
+
+  //! latest vector field to share between planner and controller
+  VectorField::ConstPtr vector_field;
+
+  //! version of the latest vector field
+  uint64_t vector_field_version;
+
+  //! guards vector_field
+  std::mutex vector_field_mtx;
 
   //! vertex distance for each edge
   lvr2::DenseEdgeMap<float> edge_distances;
@@ -509,6 +963,60 @@ private:
   //! publisher for vertex costs
   rclcpp::Publisher<mesh_msgs::msg::MeshVertexCostsStamped>::SharedPtr vertex_costs_pub;
 
+  //! publisher for the changed vertex costs, if cost_delta_updates is enabled
+  rclcpp::Publisher<mesh_msgs::msg::MeshVertexCostsSparseStamped>::SharedPtr vertex_costs_update_pub;
+
+  //! costs which wait to be published
+  struct PendingCosts
+  {
+    //! publish all costs, otherwise only the costs of the vertices
+    bool full = false;
+    std::vector<lvr2::VertexHandle> vertices;
+    rclcpp::Time stamp;
+  };
+
+  //! pending costs by layer name, or "Combined Costs"
+  std::map<std::string, PendingCosts> pending_costs;
+
+  //! guards pending_costs and cost_subscribers
+  std::mutex pending_costs_mtx;
+
+  //! number of subscribers of vertex_costs_pub at the last publishing
+  size_t cost_subscribers;
+
+  //! maximum rate at which changed costs are published, 0 publishes immediately
+  double cost_publish_rate;
+
+  //! publish the changed vertex costs only
+  bool cost_delta_updates;
+
+  //! publishes the pending costs at cost_publish_rate
+  rclcpp::TimerBase::SharedPtr cost_publish_timer;
+
+  //! checks for subscribers which joined the latched topics, e.g. while nothing has been published
+  rclcpp::TimerBase::SharedPtr subscriber_check_timer;
+
+  /**
+   * @brief Marks costs to be published, merging them with the pending ones. The costs are published immediately if
+   *        cost_publish_rate is 0, otherwise by the publish timer.
+   * @param name the layer name, or "Combined Costs"
+   * @param map_stamp timestamp for the published cost data
+   * @param vertices the changed vertices, nullptr if all costs have to be published
+   */
+  void requestCostPublishing(const std::string& name, const rclcpp::Time& map_stamp,
+                             const std::vector<lvr2::VertexHandle>* vertices);
+
+  /**
+   * @brief Publishes the pending costs, if there are subscribers. Serializing the costs requires that the layers do not
+   *        change them concurrently.
+   */
+  void publishPendingCosts();
+
+  /**
+   * @brief Checks whether vertex_costs_pub got new subscribers since the last publishing, which then need all costs
+   */
+  bool hasNewCostSubscribers();
+
   //! publisher for vertex colors
   rclcpp::Publisher<mesh_msgs::msg::MeshVertexColorsStamped>::SharedPtr vertex_colors_pub;
 
@@ -521,6 +1029,58 @@ private:
   //! publisher for the stored vector field
   rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr vector_field_pub;
 
+  //! cell size in meters of the grid in which one vertex and one face vector are visualized, 0 visualizes all
+  double vector_field_resolution;
+
+  //! sampled vector field which waits to be converted to a marker by the vector field thread
+  struct PendingVectorField
+  {
+    bool pending = false;
+    //! sampled while nobody listened, it is published once a subscriber joins
+    bool deferred = false;
+    rclcpp::Time stamp;
+    //! start and end point of each vector
+    std::vector<Vector> points;
+    //! value of each vector, which is mapped to its color
+    std::vector<float> values;
+  };
+
+  //! pending vector fields by marker name, the buffers are swapped with the ones of the thread to reuse them
+  std::map<std::string, PendingVectorField> pending_vector_fields;
+
+  //! guards pending_vector_fields, vector_field_subscribers, republish_vector_fields and stop_vector_field_thread
+  std::mutex pending_vector_fields_mtx;
+
+  //! number of subscribers of vector_field_pub at the last check
+  size_t vector_field_subscribers;
+
+  //! the vector field thread publishes all markers again, e.g. for new subscribers
+  bool republish_vector_fields;
+
+  //! signals pending vector fields to the vector field thread
+  std::condition_variable pending_vector_fields_cv;
+
+  bool stop_vector_field_thread;
+
+  //! builds and publishes the markers of the pending vector fields
+  std::thread vector_field_thread;
+
+  /**
+   * @brief Main loop of the vector field thread, which reuses one marker per name
+   */
+  void publishPendingVectorFields();
+
+  /**
+   * @brief Checks for subscribers of vector_field_pub
+   */
+  bool hasVectorFieldSubscribers() const;
+
+  /**
+   * @brief Hands the latest vector fields to subscribers which joined since the last check. The topic is latched, but
+   *        only the last marker and none of the ones sampled while nobody listened.
+   */
+  void checkVectorFieldSubscribers();
+
   //! first reconfigure call
   bool first_config;
 
@@ -539,6 +1099,30 @@ private:
   //! layer mutex to handle simultaneous layer changes
   std::mutex layer_mtx;
 
+  //! revision of the combined costs, incremented by combineVertexCosts()
+  uint64_t cost_revision;
+
+  //! the cost changes are known for all revisions starting with this one
+  uint64_t cost_history_begin;
+
+  //! vertices with changed combined costs for the latest revisions
+  std::deque<std::pair<uint64_t, std::vector<lvr2::VertexHandle>>> cost_history;
+
+  //! layer factor of the latest cost combination, a new factor changes all edge weights
+  double combined_layer_factor;
+
+  //! guards the cost revision and history, which are read by the planners
+  std::mutex cost_history_mtx;
+
+  //! readers of vertex_costs and edge_weights share it, cost updates lock it exclusively
+  std::shared_mutex cost_mtx;
+
+  //! latest cost snapshot, taken on demand by costSnapshot()
+  CostSnapshot::ConstPtr cost_snapshot;
+
+  //! guards cost_snapshot
+  std::mutex cost_snapshot_mtx;
+
   //! k-d tree type for 3D with a custom mesh adaptor
   typedef nanoflann::KDTreeSingleIndexAdaptor<
       nanoflann::L2_Simple_Adaptor<float, NanoFlannMeshAdaptor>,
@@ -549,6 +1133,94 @@ private:
 
   //! k-d tree to query mesh vertices in logarithmic time
   std::unique_ptr<KDTree> kd_tree_ptr;
+
+  //! content hash of the mesh, see meshContentHash()
+  uint64_t mesh_hash;
+
+  /**
+   * @brief Loads the k-d tree index from the working file, if it has been stored for the current mesh content
+   * @return true if the index has been loaded; false if it has to be built
+   */
+  bool loadKdTree();
+
+  /**
+   * @brief Serializes the k-d tree index together with the mesh content hash and enqueues it to be stored in the
+   *        working file
+   * @return true if the index has been serialized successfully
+   */
+  bool saveKdTree();
+
+  /**
+   * @brief Loads the tiling of the working mesh from the working file, or builds it, and extracts the resident tiles
+   * @param mesh_buffer The buffer of the working mesh
+   * @param[out] save_tiling true if the tiling has been built and should be stored with saveTiling()
+   * @return The buffer of the resident tiles, or the given buffer if the tiles do not contain any face
+   */
+  lvr2::MeshBufferPtr extractResidentTiles(const lvr2::MeshBufferPtr& mesh_buffer, bool& save_tiling);
+
+  /**
+   * @brief Enqueues the tiling to be stored in the working file
+   */
+  void saveTiling();
+
+  /**
+   * @brief Returns the name of the mesh part holding the attributes of the given resident tiles, it is keyed by the
+   *        tiles and the content of the working mesh, so that the full mesh channels are never overwritten
+   */
+  std::string residentPart(const std::vector<uint32_t>& tiles) const;
+
+  /**
+   * @brief Sets the mesh part the mesh-io reads and writes the map attributes from
+   */
+  void setAttributePart(const std::string& part);
+
+  //! true if the attributes cached in the working file belong to the current mesh content
+  bool cache_valid;
+
+  /**
+   * @brief Reads a string which is stored as uchar channel in the working file
+   * @return true if the channel exists
+   */
+  bool readStringChannel(const std::string& group, const std::string& name, std::string& value);
+
+  /**
+   * @brief Stores a string as uchar channel in the working file
+   * @return true if the channel has been written successfully
+   */
+  bool writeStringChannel(const std::string& group, const std::string& name, const std::string& value);
+
+  /**
+   * @brief Builds the signature a cached layer has to be stored with to be valid: the mesh hash, the parameters of the
+   *        layer and, for layers depending on lethals, a hash of the lethal vertices of the preceding layers
+   * @param layer_plugin the layer
+   * @param preceding_lethals the combined lethal vertices of the layers before the given layer
+   */
+  std::string layerCacheSignature(const AbstractLayer::Ptr& layer_plugin, const VertexBitset& preceding_lethals);
+
+  /**
+   * @brief Reads the layer from the working file if it has been stored with the expected signature
+   * @return true if the layer has been read; false if it has to be computed
+   */
+  bool readCachedLayer(const std::string& layer_name, const AbstractLayer::Ptr& layer_plugin,
+                       const VertexBitset& preceding_lethals);
+
+  //! enqueues a snapshot of the face normals to be stored in the working file
+  void saveFaceNormals();
+
+  //! enqueues a snapshot of the vertex normals to be stored in the working file
+  void saveVertexNormals();
+
+  //! enqueues a snapshot of the edge distances to be stored in the working file
+  void saveEdgeDistances();
+
+  //! enqueues the mesh hash and the uuid to be stored in the working file
+  void saveMapIdentity();
+
+  //! publishes the result of the writes to the working file
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr save_result_pub;
+
+  //! runs the writes to the working file on a dedicated I/O thread
+  std::unique_ptr<PersistenceQueue> persistence_queue;
 };
 
 } /* namespace mesh_map */
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__MESH_TILING_H
+#define MESH_MAP__MESH_TILING_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <lvr2/types/MeshBuffer.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Partition of the faces of a mesh buffer into square tiles of the xy plane.
+ *
+ * A face belongs to every tile its xy bounds overlap after growing them by the halo, thus neighbouring tiles share a
+ * band of faces and a sub mesh extracted from a set of tiles is still connected close to its tile borders. The face
+ * lists are stored in compressed sparse row format and can be serialized into a channel of the working file, so that
+ * the tiles can be extracted from a memory mapped buffer without touching the faces of the other tiles.
+ */
+class MeshTiling
+{
+public:
+  typedef std::shared_ptr<const MeshTiling> ConstPtr;
+
+  /**
+   * @brief Builds the tiling for the given mesh buffer
+   * @param buffer The mesh buffer providing the vertex positions and face indices
+   * @param tile_size The edge length of the tiles
+   * @param halo The distance by which the face bounds are grown before they are assigned to the tiles
+   */
+  MeshTiling(lvr2::MeshBuffer& buffer, const float tile_size, const float halo);
+
+  /**
+   * @brief Restores a tiling written by serialize()
+   * @return The tiling, or an empty pointer if the data is not a valid tiling
+   */
+  static ConstPtr deserialize(const unsigned char* data, const size_t size);
+
+  /**
+   * @brief Writes the tiling into a flat byte buffer
+   */
+  void serialize(std::vector<unsigned char>& data) const;
+
+  /**
+   * @brief Checks whether the tiling has been built with the given parameters for a buffer of the same content
+   */
+  bool matches(lvr2::MeshBuffer& buffer, const float tile_size, const float halo) const;
+
+  /**
+   * @brief Hashes the vertex positions and face indices of the buffer, an edited mesh gets a different hash even if
+   * its vertex and face counts are the same
+   */
+  static uint64_t contentHash(lvr2::MeshBuffer& buffer);
+
+  /**
+   * @brief Returns the tiles which overlap the circle around the given xy position
+   */
+  std::vector<uint32_t> tilesAround(const float x, const float y, const float radius) const;
+
+  /**
+   * @brief Builds a mesh buffer from the faces of the given tiles
+   * @param buffer The mesh buffer the tiling has been built for
+   * @param tiles The tiles to extract
+   * @param[out] vertex_ids The index of each vertex of the new buffer in the given buffer, in ascending order
+   * @return The new mesh buffer, or an empty pointer if the tiles contain no faces
+   */
+  lvr2::MeshBufferPtr extract(lvr2::MeshBuffer& buffer, const std::vector<uint32_t>& tiles,
+                              std::vector<uint32_t>& vertex_ids) const;
+
+  //! content hash of the buffer the tiling has been built for
+  uint64_t contentHash() const
+  {
+    return content_hash_;
+  }
+
+  //! number of tiles
+  size_t numTiles() const
+  {
+    return tile_offsets_.size() - 1;
+  }
+
+  //! number of faces assigned to the tile, including the faces of its halo
+  size_t numFacesOfTile(const uint32_t tile) const
+  {
+    return tile_offsets_[tile + 1] - tile_offsets_[tile];
+  }
+
+private:
+  MeshTiling() = default;
+
+  float min_x_ = 0;
+  float min_y_ = 0;
+  float tile_size_ = 0;
+  float halo_ = 0;
+  uint32_t num_x_ = 0;
+  uint32_t num_y_ = 0;
+  uint64_t num_vertices_ = 0;
+  uint64_t num_faces_ = 0;
+  //! see contentHash()
+  uint64_t content_hash_ = 0;
+
+  //! CSR offsets into tile_faces_, size numTiles() + 1, the tiles are stored row by row
+  std::vector<uint32_t> tile_offsets_;
+  std::vector<uint32_t> tile_faces_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__MESH_TILING_H
@@ -0,0 +1,284 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__MESH_TOPOLOGY_H
+#define MESH_MAP__MESH_TOPOLOGY_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <lvr2/geometry/BaseMesh.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Lightweight view on a contiguous range of handles inside a MeshTopology
+ * @tparam HandleT The handle type, e.g. lvr2::VertexHandle or lvr2::FaceHandle
+ */
+template <typename HandleT>
+class HandleRange
+{
+public:
+  HandleRange(const HandleT* begin, const HandleT* end) : begin_(begin), end_(end)
+  {
+  }
+
+  const HandleT* begin() const
+  {
+    return begin_;
+  }
+
+  const HandleT* end() const
+  {
+    return end_;
+  }
+
+  size_t size() const
+  {
+    return end_ - begin_;
+  }
+
+  bool empty() const
+  {
+    return begin_ == end_;
+  }
+
+  const HandleT& operator[](const size_t i) const
+  {
+    return begin_[i];
+  }
+
+private:
+  const HandleT* begin_;
+  const HandleT* end_;
+};
+
+/**
+ * @brief Immutable snapshot of the mesh topology stored in compressed sparse row (CSR) arrays.
+ *
+ * The half-edge mesh answers adjacency queries by walking the half-edge structure and copying the results into freshly
+ * allocated vectors. The snapshot is built once after the map has been loaded and answers the same queries with a
+ * lookup into flat arrays, which is what the wave front propagation hot loops need. Vertices for which the half-edge
+ * mesh panics, e.g. non-manifold vertices, are flagged as "broken" and have empty adjacency ranges.
+ *
+ * The incident edges of a vertex are stored in the same order as its neighbours, i.e. edgesOfVertex(v)[i] connects v
+ * with neighboursOfVertex(v)[i].
+ */
+class MeshTopology
+{
+public:
+  typedef std::shared_ptr<const MeshTopology> ConstPtr;
+
+  /**
+   * @brief Builds the topology snapshot for the given mesh
+   * @param mesh The half-edge mesh
+   */
+  explicit MeshTopology(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh);
+
+  /**
+   * @brief Returns the neighbour vertices of the given vertex
+   */
+  HandleRange<lvr2::VertexHandle> neighboursOfVertex(const lvr2::VertexHandle& vH) const
+  {
+    const auto first = vertex_offsets_[vH.idx()], last = vertex_offsets_[vH.idx() + 1];
+    return HandleRange<lvr2::VertexHandle>(vertex_neighbours_.data() + first, vertex_neighbours_.data() + last);
+  }
+
+  /**
+   * @brief Returns the incident edges of the given vertex, in the same order as neighboursOfVertex()
+   */
+  HandleRange<lvr2::EdgeHandle> edgesOfVertex(const lvr2::VertexHandle& vH) const
+  {
+    const auto first = vertex_offsets_[vH.idx()], last = vertex_offsets_[vH.idx() + 1];
+    return HandleRange<lvr2::EdgeHandle>(vertex_edges_.data() + first, vertex_edges_.data() + last);
+  }
+
+  /**
+   * @brief Returns the incident faces of the given vertex
+   */
+  HandleRange<lvr2::FaceHandle> facesOfVertex(const lvr2::VertexHandle& vH) const
+  {
+    const auto first = vertex_face_offsets_[vH.idx()], last = vertex_face_offsets_[vH.idx() + 1];
+    return HandleRange<lvr2::FaceHandle>(vertex_faces_.data() + first, vertex_faces_.data() + last);
+  }
+
+  /**
+   * @brief Returns the three vertices of the given face in the order of the half-edge mesh
+   */
+  const std::array<lvr2::VertexHandle, 3>& verticesOfFace(const lvr2::FaceHandle& fH) const
+  {
+    return face_vertices_[fH.idx()];
+  }
+
+  /**
+   * @brief Returns the three edges of the given face. Edge i connects verticesOfFace(f)[i] and
+   *        verticesOfFace(f)[(i + 1) % 3].
+   */
+  const std::array<lvr2::EdgeHandle, 3>& edgesOfFace(const lvr2::FaceHandle& fH) const
+  {
+    return face_edges_[fH.idx()];
+  }
+
+  /**
+   * @brief Returns the two vertices of the given edge
+   */
+  const std::array<lvr2::VertexHandle, 2>& verticesOfEdge(const lvr2::EdgeHandle& eH) const
+  {
+    return edge_vertices_[eH.idx()];
+  }
+
+  /**
+   * @brief Searches the edge connecting the two given vertices, linear in the degree of v1
+   * @return The edge handle, or an empty optional, if the vertices are not connected
+   */
+  lvr2::OptionalEdgeHandle edgeBetween(const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2) const
+  {
+    const auto first = vertex_offsets_[v1.idx()], last = vertex_offsets_[v1.idx() + 1];
+    for (auto i = first; i < last; i++)
+    {
+      if (vertex_neighbours_[i] == v2)
+      {
+        return lvr2::OptionalEdgeHandle(vertex_edges_[i]);
+      }
+    }
+    return lvr2::OptionalEdgeHandle();
+  }
+
+  /**
+   * @brief Returns the edge of the face which is opposite to the given corner index
+   * @param fH The face handle
+   * @param corner Index of the corner vertex in verticesOfFace(fH)
+   */
+  const lvr2::EdgeHandle& oppositeEdge(const lvr2::FaceHandle& fH, const size_t corner) const
+  {
+    return face_edges_[fH.idx()][(corner + 1) % 3];
+  }
+
+  /**
+   * @brief Checks whether the vertex is contained in the mesh and could be processed by the half-edge mesh
+   */
+  bool isValid(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < vertex_state_.size() && vertex_state_[vH.idx()] == VALID;
+  }
+
+  /**
+   * @brief Checks whether the half-edge mesh panicked while building the adjacency of the vertex
+   */
+  bool isBroken(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < vertex_state_.size() && vertex_state_[vH.idx()] == BROKEN;
+  }
+
+  /**
+   * @brief Checks whether the face is contained in the mesh
+   */
+  bool containsFace(const lvr2::FaceHandle& fH) const
+  {
+    return fH.idx() < face_valid_.size() && face_valid_[fH.idx()];
+  }
+
+  /**
+   * @brief Checks whether the edge is contained in the mesh
+   */
+  bool containsEdge(const lvr2::EdgeHandle& eH) const
+  {
+    return eH.idx() < edge_valid_.size() && edge_valid_[eH.idx()];
+  }
+
+  //! number of vertex slots, i.e. mesh.nextVertexIndex() at build time
+  size_t numVertexSlots() const
+  {
+    return vertex_state_.size();
+  }
+
+  //! number of face slots, i.e. mesh.nextFaceIndex() at build time
+  size_t numFaceSlots() const
+  {
+    return face_valid_.size();
+  }
+
+  //! number of edge slots, i.e. mesh.nextEdgeIndex() at build time
+  size_t numEdgeSlots() const
+  {
+    return edge_vertices_.size();
+  }
+
+  //! number of vertices flagged as broken
+  size_t numBrokenVertices() const
+  {
+    return num_broken_;
+  }
+
+  //! approximate memory footprint of the snapshot in bytes
+  size_t memoryUsage() const;
+
+private:
+  enum VertexState : uint8_t
+  {
+    DELETED = 0,
+    VALID = 1,
+    BROKEN = 2
+  };
+
+  //! CSR offsets into vertex_neighbours_ and vertex_edges_, size numVertexSlots() + 1
+  std::vector<uint32_t> vertex_offsets_;
+  std::vector<lvr2::VertexHandle> vertex_neighbours_;
+  std::vector<lvr2::EdgeHandle> vertex_edges_;
+
+  //! CSR offsets into vertex_faces_, size numVertexSlots() + 1
+  std::vector<uint32_t> vertex_face_offsets_;
+  std::vector<lvr2::FaceHandle> vertex_faces_;
+
+  std::vector<std::array<lvr2::VertexHandle, 3>> face_vertices_;
+  std::vector<std::array<lvr2::EdgeHandle, 3>> face_edges_;
+  std::vector<std::array<lvr2::VertexHandle, 2>> edge_vertices_;
+
+  std::vector<uint8_t> vertex_state_;
+  std::vector<bool> face_valid_;
+  std::vector<bool> edge_valid_;
+  size_t num_broken_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__MESH_TOPOLOGY_H
@@ -38,36 +38,130 @@
 #ifndef MESH_MAP__NANOFLANN_MESH_ADAPTOR_H
 #define MESH_MAP__NANOFLANN_MESH_ADAPTOR_H
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include <lvr2/geometry/BaseMesh.hpp>
 #include "nanoflann.hpp"
 
 namespace mesh_map{
+
+/**
+ * @brief nanoflann data set adaptor which keeps the vertex positions of the mesh in a packed xyz buffer. Deleted
+ * vertices are not part of the buffer, thus the point indices of the k-d tree have to be mapped to vertex handles
+ * with vertexHandle(). The buffer has to be updated with update() and the index rebuilt whenever the mesh changes.
+ */
 struct NanoFlannMeshAdaptor
 {
   const std::shared_ptr<lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh;
 
-  /// The constructor that sets the data set source
-  NanoFlannMeshAdaptor(const std::shared_ptr<lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh) : mesh(mesh) { }
-
-  inline lvr2::Index kdtree_get_point_count() const { return mesh->nextVertexIndex(); }
+  /// The constructor that sets the data set source and fills the position buffer
+  NanoFlannMeshAdaptor(const std::shared_ptr<lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh) : mesh(mesh)
+  {
+    update();
+  }
 
-  inline float kdtree_get_pt(const lvr2::Index idx, const size_t dim) const
+  /// Copies the positions of all vertices of the mesh into the packed buffer and computes their bounding box
+  void update()
   {
-    const lvr2::VertexHandle vH(idx);
-    if(mesh->containsVertex(vH))
+    positions.clear();
+    handles.clear();
+    positions.reserve(3 * mesh->numVertices());
+    handles.reserve(mesh->numVertices());
+
+    for (size_t i = 0; i < 3; i++)
+    {
+      bbox_min[i] = std::numeric_limits<float>::max();
+      bbox_max[i] = std::numeric_limits<float>::lowest();
+    }
+
+    for (size_t i = 0; i < mesh->nextVertexIndex(); i++)
     {
-      const lvr2::BaseVector<float>& vertex = mesh->getVertexPosition(vH);
-      if (dim == 0) return vertex.x;
-      else if (dim == 1) return vertex.y;
-      else return vertex.z;
+      const lvr2::VertexHandle vH(i);
+      if (!mesh->containsVertex(vH))
+      {
+        continue;
+      }
+      const lvr2::BaseVector<float> vertex = mesh->getVertexPosition(vH);
+      const float point[3] = { vertex.x, vertex.y, vertex.z };
+      for (size_t dim = 0; dim < 3; dim++)
+      {
+        positions.push_back(point[dim]);
+        bbox_min[dim] = std::min(bbox_min[dim], point[dim]);
+        bbox_max[dim] = std::max(bbox_max[dim], point[dim]);
+      }
+      handles.push_back(vH);
     }
-    return std::nanf("");
   }
 
+  /// Maps a point index of the k-d tree to the vertex handle of the mesh
+  inline lvr2::VertexHandle vertexHandle(const size_t idx) const { return handles[idx]; }
+
+  inline size_t kdtree_get_point_count() const { return handles.size(); }
+
+  inline float kdtree_get_pt(const size_t idx, const size_t dim) const { return positions[3 * idx + dim]; }
+
   template <class BBOX>
-  bool kdtree_get_bbox(BBOX& /*bb*/) const { return false; }
+  bool kdtree_get_bbox(BBOX& bb) const
+  {
+    if (handles.empty())
+    {
+      return false;
+    }
+    for (size_t dim = 0; dim < 3; dim++)
+    {
+      bb[dim].low = bbox_min[dim];
+      bb[dim].high = bbox_max[dim];
+    }
+    return true;
+  }
+
+  //! packed x, y, z coordinates of the vertices in handles
+  std::vector<float> positions;
+
+  //! vertex handle of each point in the buffer
+  std::vector<lvr2::VertexHandle> handles;
+
+  float bbox_min[3];
+  float bbox_max[3];
+}; // end of NanoFlannMeshAdaptor
+
+/**
+ * @brief nanoflann result set which appends the vertices inside a radius to a vertex handle buffer. In contrast to
+ * nanoflann::RadiusResultSet it does not clear the buffer, which allows to collect several searches in one buffer.
+ */
+struct VertexRadiusResultSet
+{
+  //! the squared search radius, as the L2 metric of the k-d tree uses squared distances
+  const float squared_radius;
+
+  const NanoFlannMeshAdaptor& adaptor;
+
+  std::vector<lvr2::VertexHandle>& vertices;
+
+  const size_t begin;
+
+  VertexRadiusResultSet(const float squared_radius, const NanoFlannMeshAdaptor& adaptor,
+                        std::vector<lvr2::VertexHandle>& vertices)
+    : squared_radius(squared_radius), adaptor(adaptor), vertices(vertices), begin(vertices.size()) { }
+
+  inline size_t size() const { return vertices.size() - begin; }
+
+  inline bool full() const { return true; }
+
+  inline bool addPoint(const float dist, const size_t index)
+  {
+    if (dist < squared_radius)
+    {
+      vertices.push_back(adaptor.vertexHandle(index));
+    }
+    return true;
+  }
 
-}; // end of PointCloudAdaptor
+  inline float worstDist() const { return squared_radius; }
+};
 }
 
 #endif /* MESH_MAP__NANOFLANN_MESH_ADAPTOR_H */
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__PATH_SIMPLIFICATION_H
+#define MESH_MAP__PATH_SIMPLIFICATION_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+//! a position on the mesh and the face containing it
+typedef std::pair<lvr2::BaseVector<float>, lvr2::FaceHandle> PathPoint;
+
+//! a path on the mesh, e.g. the back tracking result of a planner, ordered from the start to the goal
+typedef std::vector<PathPoint> MeshPath;
+
+/**
+ * @brief Selects the points of a dense path which describe its shape, e.g. to publish a sparse plan.
+ *
+ * The path is walked greedily from the last selected point. The point before the current one is selected as soon as
+ * the chord from the last selected point to the current one deviates from one of the skipped points by more than the
+ * maximum deviation, the heading turned by more than the maximum angle since the last selected point, or the chord
+ * is longer than the maximum segment length. Thus straight stretches are reduced to a few points, while curves, and
+ * slope changes in 3D, keep their resolution. The first and the last point are always selected.
+ *
+ * @param path The dense path
+ * @param max_deviation Maximum distance of a skipped point to the chord of its selected neighbours
+ * @param max_angle Maximum sum of the absolute turning angles in radians between two selected points
+ * @param max_segment_length Maximum distance between two selected points, unless the dense points are further apart
+ *
+ * @return The ascending indices of the selected points in the path
+ */
+std::vector<size_t> simplifyPath(const MeshPath& path, const float max_deviation, const float max_angle,
+                                 const float max_segment_length);
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__PATH_SIMPLIFICATION_H
@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__PERSISTENCE_QUEUE_H
+#define MESH_MAP__PERSISTENCE_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Runs the writes to the map file on a dedicated I/O thread.
+ *
+ * Every write is identified by a key, e.g. the name of the attribute it stores. A write which is enqueued while an
+ * earlier write with the same key is still pending replaces the earlier one at its position in the queue, thus
+ * repeated saves of the same attribute are coalesced into one. The writes have to operate on snapshots of the data,
+ * since the data may change while the write is pending.
+ *
+ * The map file connection is not thread safe. Other threads accessing the file have to hold the lock returned by
+ * lockFile(), which is held by the I/O thread while a write is running. The lock is recursive, thus functions locking
+ * the file can be called from a write as well.
+ */
+class PersistenceQueue
+{
+public:
+  //! a write, returns true if it has been successful
+  typedef std::function<bool()> Write;
+
+  //! called on the I/O thread after each write with its key and result
+  typedef std::function<void(const std::string& key, bool success)> CompletionCallback;
+
+  /**
+   * @brief Starts the I/O thread
+   * @param callback Called after each write, optional
+   */
+  explicit PersistenceQueue(CompletionCallback callback = nullptr);
+
+  /**
+   * @brief Runs the pending writes and stops the I/O thread
+   */
+  ~PersistenceQueue();
+
+  PersistenceQueue(const PersistenceQueue&) = delete;
+  PersistenceQueue& operator=(const PersistenceQueue&) = delete;
+
+  /**
+   * @brief Enqueues a write, or replaces the pending write with the same key
+   * @param key The key identifying the written data
+   * @param write The write to run on the I/O thread
+   * @return true if the write has been enqueued; false if it replaced a pending write
+   */
+  bool enqueue(const std::string& key, Write write);
+
+  /**
+   * @brief Blocks until all writes enqueued so far have been run
+   */
+  void flush();
+
+  /**
+   * @brief Locks the map file for an access from another thread
+   */
+  std::unique_lock<std::recursive_mutex> lockFile()
+  {
+    return std::unique_lock<std::recursive_mutex>(file_mutex_);
+  }
+
+  //! number of writes which are pending or running
+  size_t pending() const;
+
+private:
+  void run();
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cond_;
+  std::condition_variable idle_cond_;
+
+  //! keys of the pending writes in the order they have been enqueued
+  std::deque<std::string> order_;
+  std::unordered_map<std::string, Write> writes_;
+
+  //! true while the I/O thread runs a write
+  bool busy_;
+  bool stop_;
+
+  std::recursive_mutex file_mutex_;
+  CompletionCallback callback_;
+  std::thread thread_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__PERSISTENCE_QUEUE_H
@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__STAMPED_VERTEX_MAP_H
+#define MESH_MAP__STAMPED_VERTEX_MAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Dense vertex map which can be reset in constant time.
+ *
+ * Every slot carries the generation in which it has been written last. Slots of older generations are treated as
+ * not contained and read as the default value, so reset() only increments the generation instead of touching every
+ * vertex. The keys written in the current generation are recorded, iterating the map visits these keys only, which
+ * keeps the work of a query proportional to the region it actually touched.
+ *
+ * The interface follows the lvr2 attribute maps: the const operator[] returns the default value for keys which are
+ * not contained, the non-const operator[] inserts the default value for them.
+ * @tparam T The value type, flags have to be stored as uint8_t
+ */
+template <typename T>
+class StampedVertexMap
+{
+  static_assert(!std::is_same<T, bool>::value, "std::vector<bool> provides no references, use uint8_t for flags");
+
+public:
+  typedef typename std::vector<lvr2::VertexHandle>::const_iterator const_iterator;
+
+  /**
+   * @brief Creates an empty map
+   * @param default_value The value of keys which have not been written in the current generation
+   */
+  explicit StampedVertexMap(const T& default_value = T()) : default_value_(default_value), generation_(1)
+  {
+  }
+
+  /**
+   * @brief Starts a new generation, afterwards the map is empty
+   * @param num_vertices The number of vertex slots to provide, i.e. mesh->nextVertexIndex()
+   */
+  void reset(const size_t num_vertices)
+  {
+    if (stamps_.size() < num_vertices)
+    {
+      grow(num_vertices);
+    }
+    keys_.clear();
+    if (++generation_ == 0)
+    {
+      // the generation counter wrapped around, old stamps could become valid again
+      std::fill(stamps_.begin(), stamps_.end(), 0);
+      generation_ = 1;
+    }
+  }
+
+  /**
+   * @brief Checks whether the key has been written in the current generation
+   */
+  bool containsKey(const lvr2::VertexHandle& vH) const
+  {
+    return vH.idx() < stamps_.size() && stamps_[vH.idx()] == generation_;
+  }
+
+  /**
+   * @brief Inserts or overwrites the value of the given key
+   */
+  void insert(const lvr2::VertexHandle& vH, const T& value)
+  {
+    (*this)[vH] = value;
+  }
+
+  /**
+   * @brief Returns the value of the given key, or the default value if the key is not contained
+   */
+  const T& operator[](const lvr2::VertexHandle& vH) const
+  {
+    return containsKey(vH) ? values_[vH.idx()] : default_value_;
+  }
+
+  /**
+   * @brief Returns a reference to the value of the given key, the default value is inserted if it is not contained
+   */
+  T& operator[](const lvr2::VertexHandle& vH)
+  {
+    const lvr2::Index idx = vH.idx();
+    if (idx >= stamps_.size())
+    {
+      grow(idx + 1);
+    }
+    if (stamps_[idx] != generation_)
+    {
+      stamps_[idx] = generation_;
+      values_[idx] = default_value_;
+      positions_[idx] = keys_.size();
+      keys_.push_back(vH);
+    }
+    return values_[idx];
+  }
+
+  /**
+   * @brief Removes the key from the current generation in constant time, the last key takes its place in the order of
+   *        the iteration
+   * @return true if the key has been contained
+   */
+  bool erase(const lvr2::VertexHandle& vH)
+  {
+    if (!containsKey(vH))
+    {
+      return false;
+    }
+    const lvr2::Index idx = vH.idx();
+    const lvr2::VertexHandle last = keys_.back();
+    keys_[positions_[idx]] = last;
+    positions_[last.idx()] = positions_[idx];
+    keys_.pop_back();
+    stamps_[idx] = 0;
+    return true;
+  }
+
+  //! number of keys written in the current generation
+  size_t numValues() const
+  {
+    return keys_.size();
+  }
+
+  //! allocated bytes of the buffers
+  size_t memoryUsage() const
+  {
+    return stamps_.capacity() * sizeof(uint32_t) + values_.capacity() * sizeof(T) +
+           positions_.capacity() * sizeof(uint32_t) + keys_.capacity() * sizeof(lvr2::VertexHandle);
+  }
+
+  //! the value of keys which are not contained
+  const T& defaultValue() const
+  {
+    return default_value_;
+  }
+
+  //! iterates the keys written in the current generation in the order of their insertion, unless keys were erased
+  const_iterator begin() const
+  {
+    return keys_.begin();
+  }
+
+  const_iterator end() const
+  {
+    return keys_.end();
+  }
+
+private:
+  void grow(const size_t num_vertices)
+  {
+    stamps_.resize(num_vertices, 0);
+    values_.resize(num_vertices, default_value_);
+    positions_.resize(num_vertices, 0);
+  }
+
+  T default_value_;
+  uint32_t generation_;
+  std::vector<uint32_t> stamps_;
+  std::vector<T> values_;
+  //! position of each contained key in keys_
+  std::vector<uint32_t> positions_;
+  std::vector<lvr2::VertexHandle> keys_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__STAMPED_VERTEX_MAP_H
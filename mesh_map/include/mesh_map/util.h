@@ -38,11 +38,14 @@
 #ifndef MESH_MAP__UTIL_H
 #define MESH_MAP__UTIL_H
 
+#include <cstdint>
+
 #include <geometry_msgs/msg/point.hpp>
 #include <geometry_msgs/msg/pose.hpp>
 #include <geometry_msgs/msg/pose_stamped.hpp>
 #include <lvr2/geometry/Handles.hpp>
 #include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/BaseMesh.hpp>
 #include <lvr2/geometry/BaseVector.hpp>
 #include <lvr2/geometry/Normal.hpp>
 #include <std_msgs/msg/color_rgba.hpp>
@@ -63,6 +66,14 @@ typedef lvr2::BaseVector<float> Vector;
 
 lvr2::MeshBufferPtr extractMeshByName(const aiScene* ascene, std::string name);
 
+/**
+ * @brief Computes a hash of the mesh content, i.e. the vertex positions and the face indices, to detect whether data
+ * cached in the map file belongs to the current mesh. The hash is FNV-1a applied to 32 bit words.
+ * @param mesh The mesh to hash
+ * @return The 64 bit hash value
+ */
+uint64_t meshContentHash(const lvr2::BaseMesh<Vector>& mesh);
+
 /**
  * @brief Function to build std_msgs color instances
  * @param r red, value between 0 and 1
@@ -0,0 +1,285 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#ifndef MESH_MAP__VERTEX_BITSET_H
+#define MESH_MAP__VERTEX_BITSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <lvr2/geometry/Handles.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Set of vertices stored as one bit per vertex slot.
+ *
+ * Compared to a std::set<lvr2::VertexHandle> membership tests and updates are a bit operation without allocations,
+ * the whole set of a mesh with a million vertices takes 128 KiB. The vertices are iterated in ascending index order,
+ * word by word, skipping empty words. update() replaces the content and reports the added and removed vertices, which
+ * is used to propagate lethal vertex changes through the layers.
+ */
+class VertexBitset
+{
+public:
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef lvr2::VertexHandle value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const lvr2::VertexHandle* pointer;
+    typedef lvr2::VertexHandle reference;
+
+    const_iterator(const std::vector<uint64_t>& words, size_t word) : words_(&words), word_(word), bits_(0)
+    {
+      if (word_ < words_->size())
+      {
+        bits_ = (*words_)[word_];
+        skipEmptyWords();
+      }
+    }
+
+    lvr2::VertexHandle operator*() const
+    {
+      return lvr2::VertexHandle(word_ * 64 + __builtin_ctzll(bits_));
+    }
+
+    const_iterator& operator++()
+    {
+      // clear the lowest set bit
+      bits_ &= bits_ - 1;
+      skipEmptyWords();
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+      return word_ == other.word_ && bits_ == other.bits_;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    void skipEmptyWords()
+    {
+      while (bits_ == 0 && ++word_ < words_->size())
+      {
+        bits_ = (*words_)[word_];
+      }
+      if (word_ >= words_->size())
+      {
+        word_ = words_->size();
+        bits_ = 0;
+      }
+    }
+
+    const std::vector<uint64_t>* words_;
+    size_t word_;
+    uint64_t bits_;
+  };
+
+  /**
+   * @brief Creates an empty set
+   * @param num_slots The number of vertex slots, i.e. mesh.nextVertexIndex(), the set grows on demand
+   */
+  explicit VertexBitset(const size_t num_slots = 0) : words_((num_slots + 63) / 64, 0), size_(0)
+  {
+  }
+
+  //! number of vertices in the set
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  //! number of vertex slots which can be stored without growing
+  size_t numSlots() const
+  {
+    return words_.size() * 64;
+  }
+
+  bool contains(const lvr2::VertexHandle& vH) const
+  {
+    const size_t word = vH.idx() / 64;
+    return word < words_.size() && (words_[word] >> (vH.idx() % 64)) & 1;
+  }
+
+  /**
+   * @brief Adds the vertex to the set
+   * @return true if the vertex has not been contained before
+   */
+  bool insert(const lvr2::VertexHandle& vH)
+  {
+    const size_t word = vH.idx() / 64;
+    if (word >= words_.size())
+    {
+      words_.resize(word + 1, 0);
+    }
+    const uint64_t mask = uint64_t(1) << (vH.idx() % 64);
+    if (words_[word] & mask)
+    {
+      return false;
+    }
+    words_[word] |= mask;
+    size_++;
+    return true;
+  }
+
+  /**
+   * @brief Removes the vertex from the set
+   * @return true if the vertex has been contained
+   */
+  bool erase(const lvr2::VertexHandle& vH)
+  {
+    const size_t word = vH.idx() / 64;
+    const uint64_t mask = uint64_t(1) << (vH.idx() % 64);
+    if (word >= words_.size() || !(words_[word] & mask))
+    {
+      return false;
+    }
+    words_[word] &= ~mask;
+    size_--;
+    return true;
+  }
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+    {
+      insert(*first);
+    }
+  }
+
+  //! removes all vertices, keeps the number of slots
+  void clear()
+  {
+    std::fill(words_.begin(), words_.end(), 0);
+    size_ = 0;
+  }
+
+  /**
+   * @brief Replaces the content of the set with the given vertices and reports the difference
+   * @param vertices The new content of the set, e.g. the lethal vertex set of a layer
+   * @param[out] added The vertices which have not been contained before, in ascending order
+   * @param[out] removed The vertices which are not contained anymore, in ascending order
+   */
+  template <typename Range>
+  void update(const Range& vertices, std::vector<lvr2::VertexHandle>& added, std::vector<lvr2::VertexHandle>& removed)
+  {
+    added.clear();
+    removed.clear();
+
+    VertexBitset next(numSlots());
+    for (const auto& vH : vertices)
+    {
+      next.insert(vH);
+    }
+    if (next.words_.size() > words_.size())
+    {
+      words_.resize(next.words_.size(), 0);
+    }
+
+    for (size_t word = 0; word < words_.size(); word++)
+    {
+      uint64_t changed = words_[word] ^ next.words_[word];
+      while (changed)
+      {
+        const lvr2::VertexHandle vH(word * 64 + __builtin_ctzll(changed));
+        (next.words_[word] & (changed & -changed) ? added : removed).push_back(vH);
+        changed &= changed - 1;
+      }
+    }
+
+    words_.swap(next.words_);
+    size_ = next.size_;
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(words_, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(words_, words_.size());
+  }
+
+  bool operator==(const VertexBitset& other) const
+  {
+    if (size_ != other.size_)
+    {
+      return false;
+    }
+    const size_t common = std::min(words_.size(), other.words_.size());
+    return std::equal(words_.begin(), words_.begin() + common, other.words_.begin());
+  }
+
+  //! memory footprint of the bits in bytes
+  size_t memoryUsage() const
+  {
+    return words_.capacity() * sizeof(uint64_t);
+  }
+
+private:
+  std::vector<uint64_t> words_;
+  size_t size_;
+};
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__VERTEX_BITSET_H
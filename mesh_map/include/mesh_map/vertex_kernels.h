@@ -0,0 +1,273 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__VERTEX_KERNELS_H
+#define MESH_MAP__VERTEX_KERNELS_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lvr2/attrmaps/AttrMaps.hpp>
+#include <lvr2/geometry/BaseMesh.hpp>
+#include <lvr2/geometry/BaseVector.hpp>
+#include <lvr2/geometry/Handles.hpp>
+#include <mesh_map/geometry_cache.h>
+#include <mesh_map/mesh_topology.h>
+#include <mesh_map/stamped_vertex_map.h>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Resolves a thread count parameter
+ * @param threads The configured number of threads, values smaller than one select the number of hardware threads
+ * @return The number of threads to use, at least one
+ */
+inline size_t resolveThreadCount(const int threads)
+{
+  if (threads > 0)
+  {
+    return threads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Checks whether the given neighbourhood strategy is supported by LocalNeighborhood: "topology" walks the
+ *        mesh, "radius" queries the k-d tree of the mesh map
+ */
+inline bool isValidNeighborhoodStrategy(const std::string& strategy)
+{
+  return strategy == "topology" || strategy == "radius";
+}
+
+/**
+ * @brief Walks the local neighbourhood of vertices on the topology snapshot, or queries it from a radius search.
+ *
+ * The walker keeps its visited flags, its stack and its search results between the walks, so that a walk does not
+ * allocate. Each thread has to use its own instance.
+ */
+class LocalNeighborhood
+{
+public:
+  //! radius search, e.g. MeshMap::radiusSearch, which fills the buffer with the vertices inside the radius
+  typedef std::function<size_t(const lvr2::BaseVector<float>&, const float, std::vector<lvr2::VertexHandle>&)>
+      RadiusSearch;
+
+  LocalNeighborhood(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const MeshTopology& topology)
+    : mesh_(&mesh), topology_(&topology), visited_(0)
+  {
+  }
+
+  /**
+   * @brief Uses the radius search instead of the topology walk. The search also finds vertices inside the radius
+   *        which are not connected to the center vertex over the radius, e.g. on the other side of a thin wall.
+   */
+  void useRadiusSearch(const RadiusSearch& search)
+  {
+    radius_search_ = search;
+  }
+
+  /**
+   * @brief Uses the precomputed neighbourhoods for walks with their radius, e.g. MeshMap::vertexNeighbourhoods, which
+   *        visit the same vertices in the same order as the walk or the search they have been computed with
+   */
+  void useNeighbourhoods(const VertexNeighbourhoods::ConstPtr& neighbourhoods)
+  {
+    neighbourhoods_ = neighbourhoods;
+  }
+
+  /**
+   * @brief Visits all vertices which are connected to the given vertex over vertices inside the radius around it. The
+   *        visited neighbourhood is the same as the one of lvr2::visitLocalVertexNeighborhood. If a radius search is
+   *        set, all vertices inside the radius are visited in no particular order instead.
+   * @param vH The center vertex, which is visited first
+   * @param radius The radius of the neighbourhood
+   * @param visitor Called with the vertex handle of each visited vertex
+   */
+  template <typename VisitorF>
+  void visit(const lvr2::VertexHandle& vH, const float radius, VisitorF visitor)
+  {
+    if (neighbourhoods_ && neighbourhoods_->radius() == radius)
+    {
+      for (const auto& vertex : neighbourhoods_->of(vH))
+      {
+        visitor(vertex);
+      }
+      return;
+    }
+
+    const lvr2::BaseVector<float> center = mesh_->getVertexPosition(vH);
+    if (radius_search_)
+    {
+      radius_search_(center, radius, stack_);
+      for (const auto& vertex : stack_)
+      {
+        visitor(vertex);
+      }
+      return;
+    }
+
+    visited_.reset(topology_->numVertexSlots());
+    stack_.clear();
+    const float squared_radius = radius * radius;
+
+    stack_.push_back(vH);
+    visited_.insert(vH, 1);
+    while (!stack_.empty())
+    {
+      const lvr2::VertexHandle current = stack_.back();
+      stack_.pop_back();
+      visitor(current);
+
+      for (const auto& neighbour : topology_->neighboursOfVertex(current))
+      {
+        if (!visited_.containsKey(neighbour) &&
+            center.distance2(mesh_->getVertexPosition(neighbour)) < squared_radius)
+        {
+          visited_.insert(neighbour, 1);
+          stack_.push_back(neighbour);
+        }
+      }
+    }
+  }
+
+private:
+  const lvr2::BaseMesh<lvr2::BaseVector<float>>* mesh_;
+  const MeshTopology* topology_;
+  StampedVertexMap<uint8_t> visited_;
+  std::vector<lvr2::VertexHandle> stack_;
+  RadiusSearch radius_search_;
+  VertexNeighbourhoods::ConstPtr neighbourhoods_;
+};
+
+/**
+ * @brief Creates a dense vertex map which contains a value for every vertex of the mesh. Since no key is inserted
+ *        afterwards, the values of different vertices can be written concurrently.
+ * @param mesh The mesh
+ * @param value The initial value
+ */
+template <typename T>
+lvr2::DenseVertexMap<T> denseVertexMap(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const T& value)
+{
+  lvr2::DenseVertexMap<T> map;
+  map.reserve(mesh.nextVertexIndex());
+  for (auto vH : mesh.vertices())
+  {
+    map.insert(vH, value);
+  }
+  return map;
+}
+
+/**
+ * @brief Runs a kernel for every vertex slot, distributed in blocks over the given number of threads. The calling
+ *        thread is one of the threads. An exception thrown by the kernel stops the remaining blocks and is rethrown.
+ * @param num_vertices The number of vertex slots, i.e. mesh.nextVertexIndex()
+ * @param num_threads The number of threads
+ * @param kernel Called with the thread index and the vertex handle, it must only write the values of its vertex and
+ *        the scratch buffers of its thread
+ */
+template <typename KernelF>
+void parallelForEachVertex(const size_t num_vertices, const size_t num_threads, KernelF kernel)
+{
+  const size_t block_size = 1024;
+  if (num_threads <= 1 || num_vertices <= block_size)
+  {
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+      kernel(0, lvr2::VertexHandle(i));
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_block(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex error_mtx;
+
+  auto worker = [&](const size_t thread) {
+    for (size_t begin = next_block.fetch_add(block_size); begin < num_vertices && !failed;
+         begin = next_block.fetch_add(block_size))
+    {
+      const size_t end = std::min(begin + block_size, num_vertices);
+      try
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          kernel(thread, lvr2::VertexHandle(i));
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mtx);
+        if (!error)
+        {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  const size_t num_workers = std::min(num_threads, (num_vertices + block_size - 1) / block_size);
+  std::vector<std::thread> workers;
+  for (size_t thread = 1; thread < num_workers; thread++)
+  {
+    workers.emplace_back(worker, thread);
+  }
+  worker(0);
+  for (auto& thread : workers)
+  {
+    thread.join();
+  }
+
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__VERTEX_KERNELS_H
@@ -0,0 +1,243 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#ifndef MESH_MAP__VERTEX_QUEUE_H
+#define MESH_MAP__VERTEX_QUEUE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lvr2/geometry/Handles.hpp>
+#include <lvr2/util/Meap.hpp>
+
+namespace mesh_map
+{
+
+/**
+ * @brief Counters collected by a VertexQueue, used to compare the queue implementations
+ */
+struct VertexQueueStatistics
+{
+  //! number of insert() calls, including key updates of already queued vertices
+  size_t inserts = 0;
+  //! number of vertices returned by popMin()
+  size_t pops = 0;
+  //! number of outdated entries which have been skipped by lazy deletion
+  size_t stale = 0;
+  //! maximum number of entries stored at the same time
+  size_t max_size = 0;
+};
+
+/**
+ * @brief Priority queue interface for the wave front propagations of the planners and layers.
+ *
+ * The semantics match the usage of lvr2::Meap in the propagation loops: insert() adds a vertex or replaces the key of
+ * an already queued vertex, popMin() removes and returns the vertex with the smallest key.
+ */
+class VertexQueue
+{
+public:
+  typedef std::unique_ptr<VertexQueue> Ptr;
+
+  virtual ~VertexQueue() = default;
+
+  /**
+   * @brief Inserts the vertex or updates its key, if it is already queued
+   */
+  virtual void insert(const lvr2::VertexHandle& vH, const float key) = 0;
+
+  /**
+   * @brief Removes the vertex with the smallest key from the queue and returns it
+   */
+  virtual lvr2::VertexHandle popMin() = 0;
+
+  /**
+   * @brief Returns true if no vertex is queued
+   */
+  virtual bool isEmpty() const = 0;
+
+  /**
+   * @brief Removes all vertices from the queue, the statistics are kept
+   */
+  virtual void clear() = 0;
+
+  /**
+   * @brief Returns the insert / pop counters collected since the construction of the queue
+   */
+  const VertexQueueStatistics& statistics() const
+  {
+    return stats_;
+  }
+
+protected:
+  VertexQueueStatistics stats_;
+};
+
+/**
+ * @brief VertexQueue wrapping lvr2::Meap, the queue which has been used before the queue became configurable
+ */
+class MeapVertexQueue : public VertexQueue
+{
+public:
+  explicit MeapVertexQueue(const size_t num_vertices);
+
+  virtual void insert(const lvr2::VertexHandle& vH, const float key) override;
+
+  virtual lvr2::VertexHandle popMin() override;
+
+  virtual bool isEmpty() const override;
+
+  virtual void clear() override;
+
+private:
+  lvr2::Meap<lvr2::VertexHandle, float> meap_;
+};
+
+/**
+ * @brief Flat 4-ary min heap with lazy deletion.
+ *
+ * Key updates push a new entry instead of moving the existing one. The current key of every queued vertex is stored
+ * in a dense array, entries which do not match it are outdated and are skipped on popMin().
+ */
+class QuaternaryHeapVertexQueue : public VertexQueue
+{
+public:
+  explicit QuaternaryHeapVertexQueue(const size_t num_vertices);
+
+  virtual void insert(const lvr2::VertexHandle& vH, const float key) override;
+
+  virtual lvr2::VertexHandle popMin() override;
+
+  virtual bool isEmpty() const override;
+
+  virtual void clear() override;
+
+private:
+  struct Entry
+  {
+    float key;
+    lvr2::Index idx;
+  };
+
+  void siftUp(size_t pos);
+
+  void siftDown(size_t pos);
+
+  //! the heap entries, including the outdated ones
+  std::vector<Entry> heap_;
+  //! current key of each vertex, only meaningful if the vertex is queued
+  std::vector<float> current_key_;
+  //! whether a vertex is queued
+  std::vector<bool> queued_;
+  //! number of queued vertices
+  size_t size_;
+};
+
+/**
+ * @brief Monotone radix heap with lazy deletion.
+ *
+ * The queue exploits that the wave front distances are non-decreasing: the bit pattern of a non-negative float is
+ * ordered like the value itself, and an entry is stored in the bucket of the highest bit in which its key differs from
+ * the last popped key. Keys smaller than the last popped key violate the monotonicity, they are clamped to the last
+ * popped key and therefore popped next.
+ */
+class RadixHeapVertexQueue : public VertexQueue
+{
+public:
+  explicit RadixHeapVertexQueue(const size_t num_vertices);
+
+  virtual void insert(const lvr2::VertexHandle& vH, const float key) override;
+
+  virtual lvr2::VertexHandle popMin() override;
+
+  virtual bool isEmpty() const override;
+
+  virtual void clear() override;
+
+private:
+  struct Entry
+  {
+    uint32_t key;
+    lvr2::Index idx;
+  };
+
+  static uint32_t toRadixKey(const float key);
+
+  size_t bucketIndex(const uint32_t key) const;
+
+  bool isCurrent(const Entry& entry) const
+  {
+    return queued_[entry.idx] && current_key_[entry.idx] == entry.key;
+  }
+
+  //! moves the entries of the first non-empty bucket to the lower buckets, after bucket 0 ran empty
+  void redistribute();
+
+  //! bucket 0 holds entries equal to last_key_, bucket i entries which differ from it in bit i - 1 at the highest
+  std::array<std::vector<Entry>, 33> buckets_;
+  //! radix key of the last popped entry
+  uint32_t last_key_;
+  //! current radix key of each vertex, only meaningful if the vertex is queued
+  std::vector<uint32_t> current_key_;
+  //! whether a vertex is queued
+  std::vector<bool> queued_;
+  //! number of queued vertices
+  size_t size_;
+  //! number of stored entries, including the outdated ones
+  size_t num_entries_;
+};
+
+/**
+ * @brief Creates a vertex queue of the given type
+ * @param type The queue type: "meap", "quaternary_heap" or "radix_heap"
+ * @param num_vertices The number of vertex slots of the mesh, i.e. mesh->nextVertexIndex()
+ * @return The queue, or a null pointer if the type is unknown
+ */
+VertexQueue::Ptr createVertexQueue(const std::string& type, const size_t num_vertices);
+
+/**
+ * @brief Checks whether the given vertex queue type is supported by createVertexQueue()
+ */
+bool isValidVertexQueueType(const std::string& type);
+
+} /* namespace mesh_map */
+
+#endif  // MESH_MAP__VERTEX_QUEUE_H
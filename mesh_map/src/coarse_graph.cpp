@@ -0,0 +1,367 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include <mesh_map/coarse_graph.h>
+
+namespace mesh_map
+{
+
+//! identifies a serialized coarse graph
+static const uint32_t COARSE_GRAPH_MAGIC = 0x47524743;  // "CGRG"
+
+namespace
+{
+struct CoarseGraphHeader
+{
+  uint32_t magic;
+  float cell_size;
+  uint64_t mesh_hash;
+  uint64_t num_vertex_slots;
+  uint64_t num_nodes;
+  uint64_t num_clustered;
+  uint64_t num_edges;
+};
+
+typedef std::array<int32_t, 3> VoxelKey;
+
+inline VoxelKey voxelKey(const lvr2::BaseVector<float>& p, const float cell_size)
+{
+  return { static_cast<int32_t>(std::floor(p.x / cell_size)), static_cast<int32_t>(std::floor(p.y / cell_size)),
+           static_cast<int32_t>(std::floor(p.z / cell_size)) };
+}
+
+template <typename T>
+inline void write(unsigned char*& dst, const std::vector<T>& values)
+{
+  std::memcpy(dst, values.data(), values.size() * sizeof(T));
+  dst += values.size() * sizeof(T);
+}
+
+template <typename T>
+inline void read(const unsigned char*& src, std::vector<T>& values, const size_t size)
+{
+  values.resize(size);
+  std::memcpy(values.data(), src, size * sizeof(T));
+  src += size * sizeof(T);
+}
+
+typedef std::pair<float, uint32_t> QueueEntry;
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> MinQueue;
+}  // namespace
+
+CoarseGraph::CoarseGraph(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const MeshTopology& topology,
+                         const float cell_size)
+  : cell_size_(cell_size)
+{
+  const size_t num_vertex_slots = topology.numVertexSlots();
+  vertex_nodes_.assign(num_vertex_slots, INVALID_NODE);
+
+  // connected components of the vertices inside each voxel
+  std::vector<lvr2::VertexHandle> queue;
+  std::vector<uint32_t> node_sizes;
+  for (size_t i = 0; i < num_vertex_slots; i++)
+  {
+    const lvr2::VertexHandle seed(i);
+    if (!topology.isValid(seed) || vertex_nodes_[i] != INVALID_NODE)
+    {
+      continue;
+    }
+
+    const uint32_t node = positions_.size();
+    const VoxelKey key = voxelKey(mesh.getVertexPosition(seed), cell_size_);
+    lvr2::BaseVector<float> sum(0, 0, 0);
+    queue.assign(1, seed);
+    vertex_nodes_[i] = node;
+    for (size_t j = 0; j < queue.size(); j++)
+    {
+      const lvr2::VertexHandle vH = queue[j];
+      sum += mesh.getVertexPosition(vH);
+      for (const auto& nH : topology.neighboursOfVertex(vH))
+      {
+        if (topology.isValid(nH) && vertex_nodes_[nH.idx()] == INVALID_NODE &&
+            voxelKey(mesh.getVertexPosition(nH), cell_size_) == key)
+        {
+          vertex_nodes_[nH.idx()] = node;
+          queue.push_back(nH);
+        }
+      }
+    }
+    positions_.push_back(sum / static_cast<float>(queue.size()));
+    node_sizes.push_back(queue.size());
+  }
+
+  // node -> vertices
+  const size_t num_nodes = positions_.size();
+  node_offsets_.assign(num_nodes + 1, 0);
+  for (size_t node = 0; node < num_nodes; node++)
+  {
+    node_offsets_[node + 1] = node_offsets_[node] + node_sizes[node];
+  }
+  std::vector<uint32_t> fill(node_offsets_.begin(), node_offsets_.end() - 1);
+  node_vertices_.assign(node_offsets_.back(), lvr2::VertexHandle(0));
+  for (size_t i = 0; i < num_vertex_slots; i++)
+  {
+    if (vertex_nodes_[i] != INVALID_NODE)
+    {
+      node_vertices_[fill[vertex_nodes_[i]]++] = lvr2::VertexHandle(i);
+    }
+  }
+
+  // node -> neighbour nodes, the mesh edges are symmetric and so are the node edges
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (size_t i = 0; i < num_vertex_slots; i++)
+  {
+    const uint32_t node = vertex_nodes_[i];
+    if (node == INVALID_NODE)
+    {
+      continue;
+    }
+    for (const auto& nH : topology.neighboursOfVertex(lvr2::VertexHandle(i)))
+    {
+      const uint32_t neighbour = nodeOf(nH);
+      if (neighbour != INVALID_NODE && neighbour != node)
+      {
+        edges.emplace_back(node, neighbour);
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  edge_offsets_.assign(num_nodes + 1, 0);
+  edge_targets_.reserve(edges.size());
+  edge_lengths_.reserve(edges.size());
+  for (const auto& edge : edges)
+  {
+    edge_offsets_[edge.first + 1]++;
+    edge_targets_.push_back(edge.second);
+    edge_lengths_.push_back(positions_[edge.first].distance(positions_[edge.second]));
+  }
+  for (size_t node = 0; node < num_nodes; node++)
+  {
+    edge_offsets_[node + 1] += edge_offsets_[node];
+  }
+}
+
+CoarseGraph::ConstPtr CoarseGraph::deserialize(const unsigned char* data, const size_t size, const uint64_t mesh_hash)
+{
+  CoarseGraphHeader header;
+  if (size < sizeof(header))
+  {
+    return ConstPtr();
+  }
+  std::memcpy(&header, data, sizeof(header));
+  const size_t expected_size = sizeof(header) + header.num_vertex_slots * sizeof(uint32_t) +
+                               (header.num_nodes + 1) * 2 * sizeof(uint32_t) +
+                               header.num_clustered * sizeof(uint32_t) +
+                               header.num_nodes * sizeof(lvr2::BaseVector<float>) +
+                               header.num_edges * (sizeof(uint32_t) + sizeof(float));
+  if (header.magic != COARSE_GRAPH_MAGIC || header.mesh_hash != mesh_hash || size != expected_size)
+  {
+    return ConstPtr();
+  }
+
+  auto graph = std::shared_ptr<CoarseGraph>(new CoarseGraph());
+  graph->cell_size_ = header.cell_size;
+  const unsigned char* src = data + sizeof(header);
+  read(src, graph->vertex_nodes_, header.num_vertex_slots);
+  read(src, graph->node_offsets_, header.num_nodes + 1);
+  std::vector<uint32_t> node_vertices;
+  read(src, node_vertices, header.num_clustered);
+  read(src, graph->positions_, header.num_nodes);
+  read(src, graph->edge_offsets_, header.num_nodes + 1);
+  read(src, graph->edge_targets_, header.num_edges);
+  read(src, graph->edge_lengths_, header.num_edges);
+  if (graph->node_offsets_.back() != header.num_clustered || graph->edge_offsets_.back() != header.num_edges)
+  {
+    return ConstPtr();
+  }
+  graph->node_vertices_.reserve(node_vertices.size());
+  for (const auto idx : node_vertices)
+  {
+    graph->node_vertices_.push_back(lvr2::VertexHandle(idx));
+  }
+  return graph;
+}
+
+void CoarseGraph::serialize(const uint64_t mesh_hash, std::vector<unsigned char>& data) const
+{
+  const CoarseGraphHeader header = { COARSE_GRAPH_MAGIC, cell_size_,         mesh_hash,           vertex_nodes_.size(),
+                                     positions_.size(),  node_vertices_.size(), edge_targets_.size() };
+  std::vector<uint32_t> node_vertices;
+  node_vertices.reserve(node_vertices_.size());
+  for (const auto& vH : node_vertices_)
+  {
+    node_vertices.push_back(vH.idx());
+  }
+
+  data.resize(sizeof(header) + (vertex_nodes_.size() + node_offsets_.size() + node_vertices.size() +
+                                edge_offsets_.size() + edge_targets_.size()) * sizeof(uint32_t) +
+              positions_.size() * sizeof(lvr2::BaseVector<float>) + edge_lengths_.size() * sizeof(float));
+  std::memcpy(data.data(), &header, sizeof(header));
+  unsigned char* dst = data.data() + sizeof(header);
+  write(dst, vertex_nodes_);
+  write(dst, node_offsets_);
+  write(dst, node_vertices);
+  write(dst, positions_);
+  write(dst, edge_offsets_);
+  write(dst, edge_targets_);
+  write(dst, edge_lengths_);
+}
+
+void CoarseGraph::blockedNodes(const lvr2::DenseVertexMap<float>& costs, const float cost_limit,
+                               std::vector<uint8_t>& blocked) const
+{
+  blocked.assign(numNodes(), false);
+  for (size_t node = 0; node < numNodes(); node++)
+  {
+    const auto vertices = verticesOfNode(node);
+    size_t num_lethal = 0;
+    for (const auto& vH : vertices)
+    {
+      if (!std::isfinite(costs[vH]) || costs[vH] > cost_limit)
+      {
+        num_lethal++;
+      }
+    }
+    blocked[node] = 2 * num_lethal > vertices.size();
+  }
+}
+
+bool CoarseGraph::shortestPath(const uint32_t start, const uint32_t goal, const std::vector<uint8_t>& blocked,
+                               std::vector<uint32_t>& path) const
+{
+  path.clear();
+  if (start >= numNodes() || goal >= numNodes())
+  {
+    return false;
+  }
+
+  std::vector<float> distances(numNodes(), std::numeric_limits<float>::infinity());
+  std::vector<uint32_t> predecessors(numNodes(), INVALID_NODE);
+  std::vector<uint8_t> closed(numNodes(), false);
+  MinQueue queue;
+  distances[start] = 0;
+  queue.emplace(positions_[start].distance(positions_[goal]), start);
+
+  while (!queue.empty())
+  {
+    const uint32_t node = queue.top().second;
+    queue.pop();
+    if (closed[node])
+    {
+      continue;
+    }
+    closed[node] = true;
+    if (node == goal)
+    {
+      break;
+    }
+
+    for (uint32_t i = edge_offsets_[node]; i < edge_offsets_[node + 1]; i++)
+    {
+      const uint32_t neighbour = edge_targets_[i];
+      // the start and goal node are entered regardless, the robot might stand in front of an obstacle
+      if (closed[neighbour] || (blocked[neighbour] && neighbour != goal))
+      {
+        continue;
+      }
+      const float distance = distances[node] + edge_lengths_[i];
+      if (distance < distances[neighbour])
+      {
+        distances[neighbour] = distance;
+        predecessors[neighbour] = node;
+        queue.emplace(distance + positions_[neighbour].distance(positions_[goal]), neighbour);
+      }
+    }
+  }
+
+  if (!closed[goal])
+  {
+    return false;
+  }
+  for (uint32_t node = goal; node != INVALID_NODE; node = predecessors[node])
+  {
+    path.push_back(node);
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
+
+void CoarseGraph::corridor(const std::vector<uint32_t>& path, const float width, std::vector<uint8_t>& corridor) const
+{
+  corridor.assign(numNodes(), false);
+  std::vector<float> distances(numNodes(), std::numeric_limits<float>::infinity());
+  MinQueue queue;
+  for (const auto node : path)
+  {
+    distances[node] = 0;
+    queue.emplace(0, node);
+  }
+
+  // grow along the graph instead of the euclidean distance, which would include levels above or below the route
+  while (!queue.empty())
+  {
+    const auto entry = queue.top();
+    queue.pop();
+    const uint32_t node = entry.second;
+    if (entry.first > distances[node] || corridor[node])
+    {
+      continue;
+    }
+    corridor[node] = true;
+    for (uint32_t i = edge_offsets_[node]; i < edge_offsets_[node + 1]; i++)
+    {
+      const uint32_t neighbour = edge_targets_[i];
+      const float distance = entry.first + edge_lengths_[i];
+      if (distance <= width && distance < distances[neighbour])
+      {
+        distances[neighbour] = distance;
+        queue.emplace(distance, neighbour);
+      }
+    }
+  }
+}
+
+} /* namespace mesh_map */
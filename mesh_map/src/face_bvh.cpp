@@ -0,0 +1,621 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <mesh_map/face_bvh.h>
+
+namespace mesh_map
+{
+
+namespace
+{
+//! number of centroid bins per axis evaluated by the surface area heuristic
+const size_t SAH_BINS = 16;
+
+//! maximum depth of the hierarchy, which bounds the traversal stack
+const size_t MAX_DEPTH = 64;
+
+//! face id of the padding slots of the leaves
+const uint32_t INVALID_FACE = std::numeric_limits<uint32_t>::max();
+
+//! rays which are almost parallel to a triangle do not hit it
+const float DET_EPSILON = 1e-12;
+
+const float INF = std::numeric_limits<float>::infinity();
+
+inline float coord(const lvr2::BaseVector<float>& vec, const size_t axis)
+{
+  return axis == 0 ? vec.x : (axis == 1 ? vec.y : vec.z);
+}
+
+inline void resetBounds(float min[3], float max[3])
+{
+  for (size_t axis = 0; axis < 3; axis++)
+  {
+    min[axis] = INF;
+    max[axis] = -INF;
+  }
+}
+
+inline void growBounds(float min[3], float max[3], const float other_min[3], const float other_max[3])
+{
+  for (size_t axis = 0; axis < 3; axis++)
+  {
+    min[axis] = std::min(min[axis], other_min[axis]);
+    max[axis] = std::max(max[axis], other_max[axis]);
+  }
+}
+
+//! surface area of the box, zero for empty bounds
+inline float surfaceArea(const float min[3], const float max[3])
+{
+  const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+  return dx < 0 ? 0 : 2 * (dx * dy + dy * dz + dz * dx);
+}
+
+//! slab test, returns the entry distance of the ray or infinity if it misses the box within max_distance
+inline float intersectBox(const float min[3], const float max[3], const float origin[3], const float inv_direction[3],
+                          const float max_distance)
+{
+  float t_near = 0, t_far = max_distance;
+  for (size_t axis = 0; axis < 3; axis++)
+  {
+    const float t1 = (min[axis] - origin[axis]) * inv_direction[axis];
+    const float t2 = (max[axis] - origin[axis]) * inv_direction[axis];
+    t_near = std::max(t_near, std::min(t1, t2));
+    t_far = std::min(t_far, std::max(t1, t2));
+  }
+  return t_near <= t_far ? t_near : INF;
+}
+
+//! squared distance of the point to the box, zero inside
+inline float boxDistance2(const float min[3], const float max[3], const lvr2::BaseVector<float>& point)
+{
+  float distance2 = 0;
+  for (size_t axis = 0; axis < 3; axis++)
+  {
+    const float c = coord(point, axis);
+    const float d = std::max(std::max(min[axis] - c, 0.0f), c - max[axis]);
+    distance2 += d * d;
+  }
+  return distance2;
+}
+
+/**
+ * @brief Closest point on the triangle abc, see Ericson, Real-Time Collision Detection, 5.1.5
+ */
+lvr2::BaseVector<float> closestOnTriangle(const lvr2::BaseVector<float>& p, const lvr2::BaseVector<float>& a,
+                                          const lvr2::BaseVector<float>& b, const lvr2::BaseVector<float>& c,
+                                          std::array<float, 3>& bary_coords)
+{
+  const lvr2::BaseVector<float> ab = b - a, ac = c - a, ap = p - a;
+  const float d1 = ab.dot(ap), d2 = ac.dot(ap);
+  if (d1 <= 0 && d2 <= 0)
+  {
+    bary_coords = { 1, 0, 0 };
+    return a;
+  }
+
+  const lvr2::BaseVector<float> bp = p - b;
+  const float d3 = ab.dot(bp), d4 = ac.dot(bp);
+  if (d3 >= 0 && d4 <= d3)
+  {
+    bary_coords = { 0, 1, 0 };
+    return b;
+  }
+
+  const float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0 && d1 >= 0 && d3 <= 0)
+  {
+    const float v = d1 / (d1 - d3);
+    bary_coords = { 1 - v, v, 0 };
+    return a + ab * v;
+  }
+
+  const lvr2::BaseVector<float> cp = p - c;
+  const float d5 = ab.dot(cp), d6 = ac.dot(cp);
+  if (d6 >= 0 && d5 <= d6)
+  {
+    bary_coords = { 0, 0, 1 };
+    return c;
+  }
+
+  const float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0 && d2 >= 0 && d6 <= 0)
+  {
+    const float w = d2 / (d2 - d6);
+    bary_coords = { 1 - w, 0, w };
+    return a + ac * w;
+  }
+
+  const float va = d3 * d6 - d5 * d4;
+  if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+  {
+    const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    bary_coords = { 0, 1 - w, w };
+    return b + (c - b) * w;
+  }
+
+  const float denom = 1 / (va + vb + vc);
+  const float v = vb * denom, w = vc * denom;
+  bary_coords = { 1 - v - w, v, w };
+  return a + ab * v + ac * w;
+}
+}  // namespace
+
+FaceBVH::FaceBVH(const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+                 const std::vector<lvr2::FaceHandle>& faces, const size_t max_leaf_size)
+  : num_faces_(0)
+{
+  build(triangles, faces, max_leaf_size);
+}
+
+FaceBVH::FaceBVH(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh, const size_t max_leaf_size) : num_faces_(0)
+{
+  std::vector<std::array<lvr2::BaseVector<float>, 3>> triangles;
+  std::vector<lvr2::FaceHandle> faces;
+  triangles.reserve(mesh.numFaces());
+  faces.reserve(mesh.numFaces());
+  for (const auto fH : mesh.faces())
+  {
+    triangles.push_back(mesh.getVertexPositionsOfFace(fH));
+    faces.push_back(fH);
+  }
+  build(triangles, faces, max_leaf_size);
+}
+
+void FaceBVH::build(const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+                    const std::vector<lvr2::FaceHandle>& faces, const size_t max_leaf_size)
+{
+  num_faces_ = triangles.size();
+  if (triangles.empty())
+  {
+    return;
+  }
+
+  std::vector<BuildRef> refs(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i++)
+  {
+    BuildRef& ref = refs[i];
+    resetBounds(ref.min, ref.max);
+    for (const auto& corner : triangles[i])
+    {
+      for (size_t axis = 0; axis < 3; axis++)
+      {
+        ref.min[axis] = std::min(ref.min[axis], coord(corner, axis));
+        ref.max[axis] = std::max(ref.max[axis], coord(corner, axis));
+      }
+    }
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+      ref.centroid[axis] = 0.5 * (ref.min[axis] + ref.max[axis]);
+    }
+    ref.triangle = i;
+  }
+
+  const size_t leaf_size = std::max<size_t>(1, max_leaf_size);
+  nodes_.reserve(2 * triangles.size() / leaf_size + 1);
+  const size_t num_slots = triangles.size() + (PACKET_SIZE - 1) * (2 * triangles.size() / leaf_size + 1);
+  for (auto* array : { &v0x_, &v0y_, &v0z_, &e1x_, &e1y_, &e1z_, &e2x_, &e2y_, &e2z_ })
+  {
+    array->reserve(num_slots);
+  }
+  face_ids_.reserve(num_slots);
+
+  buildNode(refs, 0, refs.size(), 0, leaf_size, triangles, faces);
+}
+
+uint32_t FaceBVH::buildNode(std::vector<BuildRef>& refs, const size_t begin, const size_t end, const size_t depth,
+                            const size_t max_leaf_size,
+                            const std::vector<std::array<lvr2::BaseVector<float>, 3>>& triangles,
+                            const std::vector<lvr2::FaceHandle>& faces)
+{
+  // the nodes vector grows during the recursion, the node is written by index at the end
+  const uint32_t index = nodes_.size();
+  nodes_.emplace_back();
+
+  Node node;
+  float centroid_min[3], centroid_max[3];
+  resetBounds(node.min, node.max);
+  resetBounds(centroid_min, centroid_max);
+  for (size_t i = begin; i < end; i++)
+  {
+    growBounds(node.min, node.max, refs[i].min, refs[i].max);
+    growBounds(centroid_min, centroid_max, refs[i].centroid, refs[i].centroid);
+  }
+
+  const size_t count = end - begin;
+  size_t mid = begin;
+  if (count > max_leaf_size && depth < MAX_DEPTH)
+  {
+    // binned surface area heuristic, the cost of a split is the number of triangles on each side weighted by the
+    // surface area of its bounds
+    float best_cost = INF;
+    size_t best_axis = 0;
+    size_t best_bin = 0;
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+      const float extent = centroid_max[axis] - centroid_min[axis];
+      if (extent <= 0)
+      {
+        continue;
+      }
+      const float scale = SAH_BINS / extent;
+
+      size_t bin_count[SAH_BINS] = {};
+      float bin_min[SAH_BINS][3], bin_max[SAH_BINS][3];
+      for (size_t b = 0; b < SAH_BINS; b++)
+      {
+        resetBounds(bin_min[b], bin_max[b]);
+      }
+      for (size_t i = begin; i < end; i++)
+      {
+        const size_t b = std::min(SAH_BINS - 1, static_cast<size_t>((refs[i].centroid[axis] - centroid_min[axis]) * scale));
+        bin_count[b]++;
+        growBounds(bin_min[b], bin_max[b], refs[i].min, refs[i].max);
+      }
+
+      // right_area[b] and right_count[b] describe the bins b to SAH_BINS - 1
+      float right_area[SAH_BINS];
+      size_t right_count[SAH_BINS];
+      float acc_min[3], acc_max[3];
+      size_t acc_count = 0;
+      resetBounds(acc_min, acc_max);
+      for (size_t b = SAH_BINS - 1; b > 0; b--)
+      {
+        growBounds(acc_min, acc_max, bin_min[b], bin_max[b]);
+        acc_count += bin_count[b];
+        right_area[b] = surfaceArea(acc_min, acc_max);
+        right_count[b] = acc_count;
+      }
+
+      acc_count = 0;
+      resetBounds(acc_min, acc_max);
+      for (size_t b = 0; b + 1 < SAH_BINS; b++)
+      {
+        growBounds(acc_min, acc_max, bin_min[b], bin_max[b]);
+        acc_count += bin_count[b];
+        if (acc_count == 0 || right_count[b + 1] == 0)
+        {
+          continue;
+        }
+        const float cost = acc_count * surfaceArea(acc_min, acc_max) + right_count[b + 1] * right_area[b + 1];
+        if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = axis;
+          best_bin = b;
+        }
+      }
+    }
+
+    if (best_cost < INF)
+    {
+      const float extent = centroid_max[best_axis] - centroid_min[best_axis];
+      const float scale = SAH_BINS / extent;
+      mid = std::partition(refs.begin() + begin, refs.begin() + end,
+                           [&](const BuildRef& ref) {
+                             const size_t b = std::min(SAH_BINS - 1, static_cast<size_t>(
+                                 (ref.centroid[best_axis] - centroid_min[best_axis]) * scale));
+                             return b <= best_bin;
+                           }) -
+            refs.begin();
+    }
+    if (mid == begin || mid == end)
+    {
+      // all centroids coincide, split at the median of the largest axis of the bounds
+      size_t axis = 0;
+      for (size_t a = 1; a < 3; a++)
+      {
+        if (node.max[a] - node.min[a] > node.max[axis] - node.min[axis])
+        {
+          axis = a;
+        }
+      }
+      mid = begin + count / 2;
+      std::nth_element(refs.begin() + begin, refs.begin() + mid, refs.begin() + end,
+                       [axis](const BuildRef& lhs, const BuildRef& rhs) {
+                         return lhs.centroid[axis] < rhs.centroid[axis];
+                       });
+    }
+  }
+
+  if (mid != begin)
+  {
+    // the first child directly follows its parent
+    buildNode(refs, begin, mid, depth + 1, max_leaf_size, triangles, faces);
+    node.offset = buildNode(refs, mid, end, depth + 1, max_leaf_size, triangles, faces);
+    node.count = 0;
+    nodes_[index] = node;
+    return index;
+  }
+
+  // leaf: append the triangles as packets, padded with degenerate triangles
+  const size_t first_slot = face_ids_.size();
+  for (size_t i = begin; i < end; i++)
+  {
+    const auto& triangle = triangles[refs[i].triangle];
+    const lvr2::BaseVector<float> e1 = triangle[1] - triangle[0];
+    const lvr2::BaseVector<float> e2 = triangle[2] - triangle[0];
+    v0x_.push_back(triangle[0].x);
+    v0y_.push_back(triangle[0].y);
+    v0z_.push_back(triangle[0].z);
+    e1x_.push_back(e1.x);
+    e1y_.push_back(e1.y);
+    e1z_.push_back(e1.z);
+    e2x_.push_back(e2.x);
+    e2y_.push_back(e2.y);
+    e2z_.push_back(e2.z);
+    face_ids_.push_back(faces[refs[i].triangle].idx());
+  }
+  while (face_ids_.size() % PACKET_SIZE != 0)
+  {
+    for (auto* array : { &v0x_, &v0y_, &v0z_, &e1x_, &e1y_, &e1z_, &e2x_, &e2y_, &e2z_ })
+    {
+      array->push_back(0);
+    }
+    face_ids_.push_back(INVALID_FACE);
+  }
+  node.offset = first_slot / PACKET_SIZE;
+  node.count = face_ids_.size() / PACKET_SIZE - node.offset;
+  nodes_[index] = node;
+  return index;
+}
+
+bool FaceBVH::intersectRay(const lvr2::BaseVector<float>& origin, const lvr2::BaseVector<float>& direction,
+                           const float max_distance, RayHit& hit) const
+{
+  hit = RayHit();
+  if (nodes_.empty())
+  {
+    return false;
+  }
+
+  const float o[3] = { origin.x, origin.y, origin.z };
+  const float d[3] = { direction.x, direction.y, direction.z };
+  const float inv_d[3] = { 1 / d[0], 1 / d[1], 1 / d[2] };
+
+  // the entry distance is kept to skip nodes behind a hit found in the meantime
+  std::pair<uint32_t, float> stack[MAX_DEPTH + 2];
+  size_t top = 0;
+  hit.distance = max_distance;
+  const float root_t = intersectBox(nodes_[0].min, nodes_[0].max, o, inv_d, hit.distance);
+  if (root_t < INF)
+  {
+    stack[top++] = { 0, root_t };
+  }
+
+  while (top > 0)
+  {
+    const auto entry = stack[--top];
+    if (entry.second > hit.distance)
+    {
+      continue;
+    }
+    const Node& node = nodes_[entry.first];
+    if (node.count > 0)
+    {
+      intersectLeaf(node, o, d, hit);
+      continue;
+    }
+
+    const uint32_t first = entry.first + 1, second = node.offset;
+    const float t_first = intersectBox(nodes_[first].min, nodes_[first].max, o, inv_d, hit.distance);
+    const float t_second = intersectBox(nodes_[second].min, nodes_[second].max, o, inv_d, hit.distance);
+    // push the farther child first, so the nearer one is traversed next
+    const bool first_near = t_first <= t_second;
+    const uint32_t near = first_near ? first : second, far = first_near ? second : first;
+    const float t_near = std::min(t_first, t_second), t_far = std::max(t_first, t_second);
+    if (t_far < INF)
+    {
+      stack[top++] = { far, t_far };
+    }
+    if (t_near < INF)
+    {
+      stack[top++] = { near, t_near };
+    }
+  }
+
+  if (!hit.face)
+  {
+    hit.distance = INF;
+    return false;
+  }
+  return true;
+}
+
+void FaceBVH::intersectLeaf(const Node& node, const float o[3], const float d[3], RayHit& hit) const
+{
+  for (uint32_t packet = node.offset; packet < node.offset + node.count; packet++)
+  {
+    const size_t base = packet * PACKET_SIZE;
+    float t[PACKET_SIZE], u[PACKET_SIZE], v[PACKET_SIZE];
+
+    // Möller-Trumbore for all triangles of the packet without branches, so that the loop gets vectorized
+    for (size_t k = 0; k < PACKET_SIZE; k++)
+    {
+      const size_t i = base + k;
+      const float px = d[1] * e2z_[i] - d[2] * e2y_[i];
+      const float py = d[2] * e2x_[i] - d[0] * e2z_[i];
+      const float pz = d[0] * e2y_[i] - d[1] * e2x_[i];
+      const float det = e1x_[i] * px + e1y_[i] * py + e1z_[i] * pz;
+      const float inv_det = 1 / det;
+
+      const float tx = o[0] - v0x_[i], ty = o[1] - v0y_[i], tz = o[2] - v0z_[i];
+      const float uu = (tx * px + ty * py + tz * pz) * inv_det;
+
+      const float qx = ty * e1z_[i] - tz * e1y_[i];
+      const float qy = tz * e1x_[i] - tx * e1z_[i];
+      const float qz = tx * e1y_[i] - ty * e1x_[i];
+      const float vv = (d[0] * qx + d[1] * qy + d[2] * qz) * inv_det;
+      const float tt = (e2x_[i] * qx + e2y_[i] * qy + e2z_[i] * qz) * inv_det;
+
+      const bool valid = (std::fabs(det) > DET_EPSILON) & (uu >= 0) & (vv >= 0) & (uu + vv <= 1) & (tt >= 0);
+      t[k] = valid ? tt : INF;
+      u[k] = uu;
+      v[k] = vv;
+    }
+
+    // misses and padding slots are at infinity, which is not a hit even for an infinite maximum distance
+    for (size_t k = 0; k < PACKET_SIZE; k++)
+    {
+      if (t[k] < INF && t[k] <= hit.distance)
+      {
+        hit.distance = t[k];
+        hit.face = lvr2::OptionalFaceHandle(lvr2::FaceHandle(face_ids_[base + k]));
+        hit.bary_coords = { 1 - u[k] - v[k], u[k], v[k] };
+      }
+    }
+  }
+}
+
+void FaceBVH::intersectRays(const std::vector<lvr2::BaseVector<float>>& origins,
+                            const std::vector<lvr2::BaseVector<float>>& directions, const float max_distance,
+                            std::vector<RayHit>& hits) const
+{
+  hits.resize(origins.size());
+  for (size_t i = 0; i < origins.size(); i++)
+  {
+    intersectRay(origins[i], directions[i], max_distance, hits[i]);
+  }
+}
+
+bool FaceBVH::closestPoint(const lvr2::BaseVector<float>& query, const float max_distance,
+                           ClosestPoint& result) const
+{
+  result = ClosestPoint();
+  if (nodes_.empty())
+  {
+    return false;
+  }
+
+  float best_squared = max_distance * max_distance;
+  std::pair<uint32_t, float> stack[MAX_DEPTH + 2];
+  size_t top = 0;
+  const float root_d2 = boxDistance2(nodes_[0].min, nodes_[0].max, query);
+  if (root_d2 <= best_squared)
+  {
+    stack[top++] = { 0, root_d2 };
+  }
+
+  while (top > 0)
+  {
+    const auto entry = stack[--top];
+    if (entry.second > best_squared)
+    {
+      continue;
+    }
+    const Node& node = nodes_[entry.first];
+    if (node.count > 0)
+    {
+      closestInLeaf(node, query, best_squared, result);
+      continue;
+    }
+
+    const uint32_t first = entry.first + 1, second = node.offset;
+    const float d_first = boxDistance2(nodes_[first].min, nodes_[first].max, query);
+    const float d_second = boxDistance2(nodes_[second].min, nodes_[second].max, query);
+    const bool first_near = d_first <= d_second;
+    const uint32_t near = first_near ? first : second, far = first_near ? second : first;
+    const float d_near = std::min(d_first, d_second), d_far = std::max(d_first, d_second);
+    if (d_far <= best_squared)
+    {
+      stack[top++] = { far, d_far };
+    }
+    if (d_near <= best_squared)
+    {
+      stack[top++] = { near, d_near };
+    }
+  }
+
+  if (!result.face)
+  {
+    return false;
+  }
+  result.distance = std::sqrt(best_squared);
+  return true;
+}
+
+void FaceBVH::closestInLeaf(const Node& node, const lvr2::BaseVector<float>& query, float& best_squared,
+                            ClosestPoint& result) const
+{
+  const size_t end = (node.offset + node.count) * PACKET_SIZE;
+  for (size_t i = node.offset * PACKET_SIZE; i < end; i++)
+  {
+    if (face_ids_[i] == INVALID_FACE)
+    {
+      continue;
+    }
+    const lvr2::BaseVector<float> a(v0x_[i], v0y_[i], v0z_[i]);
+    const lvr2::BaseVector<float> b = a + lvr2::BaseVector<float>(e1x_[i], e1y_[i], e1z_[i]);
+    const lvr2::BaseVector<float> c = a + lvr2::BaseVector<float>(e2x_[i], e2y_[i], e2z_[i]);
+    std::array<float, 3> bary_coords;
+    const lvr2::BaseVector<float> point = closestOnTriangle(query, a, b, c, bary_coords);
+    const float distance2 = query.distance2(point);
+    if (distance2 <= best_squared)
+    {
+      best_squared = distance2;
+      result.face = lvr2::OptionalFaceHandle(lvr2::FaceHandle(face_ids_[i]));
+      result.point = point;
+      result.bary_coords = bary_coords;
+    }
+  }
+}
+
+void FaceBVH::closestPoints(const std::vector<lvr2::BaseVector<float>>& queries, const float max_distance,
+                            std::vector<ClosestPoint>& results) const
+{
+  results.resize(queries.size());
+  for (size_t i = 0; i < queries.size(); i++)
+  {
+    closestPoint(queries[i], max_distance, results[i]);
+  }
+}
+
+size_t FaceBVH::memoryUsage() const
+{
+  size_t triangle_bytes = 0;
+  for (const auto* array : { &v0x_, &v0y_, &v0z_, &e1x_, &e1y_, &e1z_, &e2x_, &e2y_, &e2z_ })
+  {
+    triangle_bytes += array->capacity() * sizeof(float);
+  }
+  return nodes_.capacity() * sizeof(Node) + triangle_bytes + face_ids_.capacity() * sizeof(uint32_t);
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,251 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <mesh_map/face_locator.h>
+#include <mesh_map/util.h>
+
+namespace mesh_map
+{
+
+FaceLocator::FaceLocator(std::shared_ptr<const lvr2::BaseMesh<lvr2::BaseVector<float>>> mesh,
+                         MeshTopology::ConstPtr topology, NearestVertices nearest_vertices, const size_t num_nearest)
+  : mesh_(mesh), topology_(topology), nearest_vertices_(nearest_vertices), num_nearest_(num_nearest), query_(0), num_visited_(0)
+{
+}
+
+bool FaceLocator::walk(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& start, const float max_dist,
+                       FaceLocation& location)
+{
+  if (!topology_->containsFace(start))
+  {
+    return false;
+  }
+
+  resetVisited();
+  lvr2::FaceHandle current = start;
+  // a face is visited twice if the walk runs in a cycle, which happens on strongly curved surfaces
+  while (visit(current))
+  {
+    if (project(pos, current, location))
+    {
+      // the projection is inside, but a position far away from the plane belongs to another part of the surface
+      return std::fabs(location.dist) <= max_dist;
+    }
+
+    // cross the edge opposite to the most negative barycentric coordinate
+    const auto& bary_coords = location.bary_coords;
+    size_t corner = 0;
+    for (size_t i = 1; i < 3; i++)
+    {
+      if (bary_coords[i] < bary_coords[corner])
+      {
+        corner = i;
+      }
+    }
+    const lvr2::OptionalFaceHandle next = faceAcross(current, corner);
+    if (!next)
+    {
+      // reached the mesh boundary or a hole
+      return false;
+    }
+    current = next.unwrap();
+  }
+  return false;
+}
+
+bool FaceLocator::searchAround(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& start,
+                               const float max_radius, const float max_dist, FaceLocation& location)
+{
+  if (!topology_->containsFace(start))
+  {
+    return false;
+  }
+
+  const auto& start_vertices = topology_->verticesOfFace(start);
+  std::array<lvr2::BaseVector<float>, 3> start_positions;
+  lvr2::BaseVector<float> center(0, 0, 0);
+  for (size_t i = 0; i < 3; i++)
+  {
+    start_positions[i] = mesh_->getVertexPosition(start_vertices[i]);
+    center += start_positions[i];
+  }
+  center /= 3;
+
+  float vertex_center_max = 0;
+  for (const auto& vertex : start_positions)
+  {
+    vertex_center_max = std::max(vertex_center_max, vertex.distance(center));
+  }
+  const float ext_radius = max_radius + vertex_center_max;
+  const float max_radius_sq = ext_radius * ext_radius;
+
+  resetVisited();
+  queue_.clear();
+  queue_.push_back(start);
+  visit(start);
+  for (size_t i = 0; i < queue_.size(); i++)
+  {
+    const lvr2::FaceHandle fH = queue_[i];
+    if (project(pos, fH, location) && std::fabs(location.dist) <= max_dist)
+    {
+      return true;
+    }
+
+    for (const auto& vH : topology_->verticesOfFace(fH))
+    {
+      if (center.distance2(mesh_->getVertexPosition(vH)) >= max_radius_sq)
+      {
+        continue;
+      }
+      for (const auto& neighbour : topology_->facesOfVertex(vH))
+      {
+        if (topology_->containsFace(neighbour) && visit(neighbour))
+        {
+          queue_.push_back(neighbour);
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool FaceLocator::searchNearest(const lvr2::BaseVector<float>& pos, const float max_dist, FaceLocation& location)
+{
+  if (nearest_vertices_(pos, num_nearest_, nearest_) == 0)
+  {
+    return false;
+  }
+
+  resetVisited();
+  bool found = false;
+  float closest_dist = std::numeric_limits<float>::max();
+  FaceLocation candidate;
+  for (const auto& vH : nearest_)
+  {
+    for (const auto& fH : topology_->facesOfVertex(vH))
+    {
+      if (!topology_->containsFace(fH) || !visit(fH))
+      {
+        continue;
+      }
+      if (project(pos, fH, candidate) && std::fabs(candidate.dist) <= max_dist &&
+          std::fabs(candidate.dist) < closest_dist)
+      {
+        closest_dist = std::fabs(candidate.dist);
+        location = candidate;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+bool FaceLocator::locate(const lvr2::BaseVector<float>& pos, const lvr2::OptionalFaceHandle& hint,
+                         const float max_radius, const float max_dist, FaceLocation& location)
+{
+  if (hint && (walk(pos, hint.unwrap(), max_dist, location) ||
+               searchAround(pos, hint.unwrap(), max_radius, max_dist, location)))
+  {
+    return true;
+  }
+  return searchNearest(pos, max_dist, location);
+}
+
+bool FaceLocator::project(const lvr2::BaseVector<float>& pos, const lvr2::FaceHandle& fH,
+                          FaceLocation& location) const
+{
+  const auto& vertices = topology_->verticesOfFace(fH);
+  location.face = fH;
+  for (size_t i = 0; i < 3; i++)
+  {
+    location.vertices[i] = mesh_->getVertexPosition(vertices[i]);
+  }
+  return mesh_map::projectedBarycentricCoords(pos, location.vertices, location.bary_coords, location.dist);
+}
+
+lvr2::OptionalFaceHandle FaceLocator::faceAcross(const lvr2::FaceHandle& fH, const size_t corner) const
+{
+  const auto& vertices = topology_->verticesOfFace(fH);
+  const lvr2::VertexHandle& a = vertices[(corner + 1) % 3];
+  const lvr2::VertexHandle& b = vertices[(corner + 2) % 3];
+  for (const auto& neighbour : topology_->facesOfVertex(a))
+  {
+    if (neighbour == fH || !topology_->containsFace(neighbour))
+    {
+      continue;
+    }
+    const auto& neighbour_vertices = topology_->verticesOfFace(neighbour);
+    if (neighbour_vertices[0] == b || neighbour_vertices[1] == b || neighbour_vertices[2] == b)
+    {
+      return lvr2::OptionalFaceHandle(neighbour);
+    }
+  }
+  return lvr2::OptionalFaceHandle();
+}
+
+void FaceLocator::resetVisited()
+{
+  if (visited_.size() < topology_->numFaceSlots())
+  {
+    visited_.resize(topology_->numFaceSlots(), 0);
+  }
+  if (++query_ == 0)
+  {
+    // the stamps wrapped around, stamps of older queries would read as visited
+    std::fill(visited_.begin(), visited_.end(), 0);
+    query_ = 1;
+  }
+}
+
+bool FaceLocator::visit(const lvr2::FaceHandle& fH)
+{
+  uint32_t& stamp = visited_[fH.idx()];
+  if (stamp == query_)
+  {
+    return false;
+  }
+  stamp = query_;
+  num_visited_++;
+  return true;
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,172 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/fast_iterative_method.h>
+
+namespace mesh_map
+{
+
+//! ranges below this size are processed by the calling thread only, the synchronization would dominate
+static const size_t MIN_PARALLEL_SIZE = 256;
+
+FastIterativeMethod::FastIterativeMethod(const size_t num_threads)
+{
+  const size_t threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+  workers_.reserve(threads - 1);
+  for (size_t i = 1; i < threads; i++)
+  {
+    workers_.emplace_back(&FastIterativeMethod::workerLoop, this, i);
+  }
+}
+
+FastIterativeMethod::~FastIterativeMethod()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+void FastIterativeMethod::parallelFor(const size_t size, const std::function<void(size_t, size_t, size_t)>& fn)
+{
+  if (workers_.empty() || size < MIN_PARALLEL_SIZE)
+  {
+    fn(0, 0, size);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &fn;
+    task_size_ = size;
+    pending_ = workers_.size();
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  const size_t chunk = (size + numThreads() - 1) / numThreads();
+  fn(0, 0, std::min(chunk, size));
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return pending_ == 0; });
+  task_ = nullptr;
+}
+
+void FastIterativeMethod::workerLoop(const size_t thread)
+{
+  size_t generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    start_cv_.wait(lock, [this, generation]() { return stop_ || generation_ != generation; });
+    if (stop_)
+    {
+      return;
+    }
+    generation = generation_;
+    const auto& fn = *task_;
+    const size_t size = task_size_;
+    lock.unlock();
+
+    const size_t chunk = (size + numThreads() - 1) / numThreads();
+    const size_t begin = std::min(thread * chunk, size);
+    fn(thread, begin, std::min(begin + chunk, size));
+
+    lock.lock();
+    if (--pending_ == 0)
+    {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+float FastIterativeMethod::solveVertex(const MeshTopology& topology, const lvr2::VertexHandle& vH,
+                                       const EikonalEdgeUpdate& update, uint32_t& face) const
+{
+  // faces of the vertex with two reached vertices, gathered for the batched kernel
+  constexpr size_t BATCH_SIZE = 16;
+  float u1[BATCH_SIZE], u2[BATCH_SIZE], a[BATCH_SIZE], b[BATCH_SIZE], c[BATCH_SIZE], u3[BATCH_SIZE];
+  uint32_t faces[BATCH_SIZE];
+
+  float best = std::numeric_limits<float>::infinity();
+  face = NO_FACE;
+  const auto faces_of_vertex = topology.facesOfVertex(vH);
+  size_t next = 0;
+  while (next < faces_of_vertex.size())
+  {
+    size_t n = 0;
+    for (; next < faces_of_vertex.size() && n < BATCH_SIZE; next++)
+    {
+      const lvr2::FaceHandle& fH = faces_of_vertex[next];
+      if (!topology.containsFace(fH))
+        continue;
+
+      // rotate the face such that the vertex is the third one, edge i connects the vertices i and i + 1
+      const auto& vertices = topology.verticesOfFace(fH);
+      const auto& edges = topology.edgesOfFace(fH);
+      const size_t corner = vertices[0] == vH ? 0 : vertices[1] == vH ? 1 : 2;
+      u1[n] = distances_[vertices[(corner + 1) % 3].idx()];
+      u2[n] = distances_[vertices[(corner + 2) % 3].idx()];
+      if (u1[n] == std::numeric_limits<float>::infinity() || u2[n] == std::numeric_limits<float>::infinity())
+        continue;
+
+      b[n] = update.edge_weights[edges[corner]];
+      c[n] = update.edge_weights[edges[(corner + 1) % 3]];
+      a[n] = update.edge_weights[edges[(corner + 2) % 3]];
+      faces[n] = fH.idx();
+      n++;
+    }
+
+    update.kernel.distances(n, u1, u2, a, b, c, u3);
+    for (size_t i = 0; i < n; i++)
+    {
+      if (u3[i] < best)
+      {
+        best = u3[i];
+        face = faces[i];
+      }
+    }
+  }
+  return best;
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <unistd.h>
+
+#include <mesh_map/instrumentation.h>
+
+namespace mesh_map
+{
+
+namespace
+{
+//! index of the bucket counting the value, i.e. its bit width
+size_t bucketIndex(const uint64_t value)
+{
+  size_t width = 0;
+  for (uint64_t v = value; v; v >>= 1)
+  {
+    width++;
+  }
+  return std::min(width, Histogram::NUM_BUCKETS - 1);
+}
+
+//! small thread ids are easier to read in the trace viewers than hashed std::thread::ids
+uint32_t traceThreadId()
+{
+  static std::atomic<uint32_t> next_id(1);
+  thread_local const uint32_t id = next_id++;
+  return id;
+}
+
+double traceTimestamp(const std::chrono::steady_clock::time_point& time)
+{
+  return std::chrono::duration<double, std::micro>(time.time_since_epoch()).count();
+}
+}  // namespace
+
+std::atomic<bool> Instrumentation::enabled_(false);
+std::atomic<bool> Instrumentation::tracing_(false);
+
+double Histogram::Summary::percentile(const double p) const
+{
+  if (count == 0)
+  {
+    return 0.0;
+  }
+  const double target = std::clamp(p, 0.0, 1.0) * count;
+  uint64_t before = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++)
+  {
+    if (buckets[i] == 0 || before + buckets[i] < target)
+    {
+      before += buckets[i];
+      continue;
+    }
+    const double lower = i == 0 ? 0.0 : static_cast<double>(uint64_t(1) << (i - 1));
+    const double upper = i == 0 ? 0.0 : (i == NUM_BUCKETS - 1 ? max : static_cast<double>(uint64_t(1) << i));
+    const double value = lower + (upper - lower) * (target - before) / buckets[i];
+    return std::clamp(value, static_cast<double>(min), static_cast<double>(max));
+  }
+  return max;
+}
+
+Histogram::Histogram(const std::string& name, const std::string& unit)
+  : name_(name), unit_(unit), count_(0), sum_(0), min_(std::numeric_limits<uint64_t>::max()), max_(0)
+{
+  for (auto& bucket : buckets_)
+  {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::record(const uint64_t value)
+{
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t min = min_.load(std::memory_order_relaxed);
+  while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed))
+  {
+  }
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+Histogram::Summary Histogram::summary(const bool reset)
+{
+  // values recorded concurrently may be attributed to the next period, which is fine for monitoring
+  Summary summary;
+  summary.name = name_;
+  summary.unit = unit_;
+  if (reset)
+  {
+    summary.count = count_.exchange(0, std::memory_order_relaxed);
+    summary.sum = sum_.exchange(0, std::memory_order_relaxed);
+    summary.min = min_.exchange(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    summary.max = max_.exchange(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_BUCKETS; i++)
+    {
+      summary.buckets[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+    }
+  }
+  else
+  {
+    summary.count = count_.load(std::memory_order_relaxed);
+    summary.sum = sum_.load(std::memory_order_relaxed);
+    summary.min = min_.load(std::memory_order_relaxed);
+    summary.max = max_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_BUCKETS; i++)
+    {
+      summary.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+  }
+  if (summary.count == 0)
+  {
+    summary.min = 0;
+  }
+  return summary;
+}
+
+Instrumentation& Instrumentation::instance()
+{
+  static Instrumentation instrumentation;
+  return instrumentation;
+}
+
+void Instrumentation::setEnabled(const bool enabled)
+{
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+Histogram& Instrumentation::histogram(const std::string& name, const std::string& unit)
+{
+  std::lock_guard<std::mutex> lock(histograms_mtx_);
+  auto& histogram = histograms_[name];
+  if (!histogram)
+  {
+    histogram = std::make_unique<Histogram>(name, unit);
+  }
+  return *histogram;
+}
+
+std::vector<Histogram::Summary> Instrumentation::summaries(const bool reset)
+{
+  std::lock_guard<std::mutex> lock(histograms_mtx_);
+  std::vector<Histogram::Summary> summaries;
+  for (auto& entry : histograms_)
+  {
+    auto summary = entry.second->summary(reset);
+    if (summary.count > 0)
+    {
+      summaries.push_back(std::move(summary));
+    }
+  }
+  return summaries;
+}
+
+bool Instrumentation::startTrace(const std::string& file_name)
+{
+  stopTrace();
+  std::lock_guard<std::mutex> lock(trace_mtx_);
+  trace_file_.open(file_name, std::ios::out | std::ios::trunc);
+  if (!trace_file_)
+  {
+    return false;
+  }
+  trace_file_ << "{\"traceEvents\":[";
+  first_event_ = true;
+  tracing_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void Instrumentation::stopTrace()
+{
+  std::lock_guard<std::mutex> lock(trace_mtx_);
+  tracing_.store(false, std::memory_order_relaxed);
+  if (trace_file_.is_open())
+  {
+    trace_file_ << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    trace_file_.close();
+  }
+}
+
+void Instrumentation::traceDuration(const Histogram& histogram, const std::chrono::steady_clock::time_point& start,
+                                    const std::chrono::steady_clock::duration& duration)
+{
+  std::ostringstream event;
+  event << std::fixed << std::setprecision(3) << "{\"name\":\"" << histogram.name()
+        << "\",\"cat\":\"mesh_navigation\",\"ph\":\"X\",\"ts\":" << traceTimestamp(start)
+        << ",\"dur\":" << std::chrono::duration<double, std::micro>(duration).count() << ",\"pid\":" << getpid()
+        << ",\"tid\":" << traceThreadId() << "}";
+  writeEvent(event.str());
+}
+
+void Instrumentation::traceCounter(const Histogram& histogram, const uint64_t value)
+{
+  std::ostringstream event;
+  event << std::fixed << std::setprecision(3) << "{\"name\":\"" << histogram.name()
+        << "\",\"cat\":\"mesh_navigation\",\"ph\":\"C\",\"ts\":" << traceTimestamp(std::chrono::steady_clock::now())
+        << ",\"pid\":" << getpid() << ",\"tid\":" << traceThreadId() << ",\"args\":{\"value\":" << value << "}}";
+  writeEvent(event.str());
+}
+
+void Instrumentation::writeEvent(const std::string& event)
+{
+  std::lock_guard<std::mutex> lock(trace_mtx_);
+  if (!trace_file_.is_open())
+  {
+    return;
+  }
+  trace_file_ << (first_event_ ? "\n" : ",\n") << event;
+  first_event_ = false;
+}
+
+} /* namespace mesh_map */
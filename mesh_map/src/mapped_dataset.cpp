@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/mapped_dataset.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <hdf5.h>
+
+namespace mesh_map
+{
+
+namespace
+{
+/**
+ * @brief Collects the storage properties of a dataset, the HDF5 handles are closed in the destructor
+ */
+struct DatasetInfo
+{
+  hid_t file = -1;
+  hid_t dataset = -1;
+  hid_t type = -1;
+  hid_t space = -1;
+  hid_t plist = -1;
+
+  ~DatasetInfo()
+  {
+    if (plist >= 0)
+      H5Pclose(plist);
+    if (space >= 0)
+      H5Sclose(space);
+    if (type >= 0)
+      H5Tclose(type);
+    if (dataset >= 0)
+      H5Dclose(dataset);
+    if (file >= 0)
+      H5Fclose(file);
+  }
+};
+}  // namespace
+
+MappedDataset::MappedDataset(void* mapping, size_t mapping_size, const void* data, size_t rows, size_t cols)
+  : mapping_(mapping), mapping_size_(mapping_size), data_(data), rows_(rows), cols_(cols)
+{
+}
+
+MappedDataset::~MappedDataset()
+{
+  munmap(mapping_, mapping_size_);
+}
+
+MappedDataset::Ptr MappedDataset::map(const std::string& file, const std::string& dataset, ElementType type)
+{
+  DatasetInfo info;
+  haddr_t offset = HADDR_UNDEF;
+  hsize_t dims[2] = { 0, 0 };
+
+  // missing datasets are an expected case, do not print the HDF5 error stack
+  H5E_BEGIN_TRY
+  {
+    info.file = H5Fopen(file.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (info.file >= 0)
+    {
+      // the file might still be open for writing in this process, make sure the data has reached the disk
+      H5Fflush(info.file, H5F_SCOPE_GLOBAL);
+      info.dataset = H5Dopen2(info.file, dataset.c_str(), H5P_DEFAULT);
+    }
+  }
+  H5E_END_TRY;
+
+  if (info.dataset < 0)
+  {
+    return nullptr;
+  }
+
+  info.type = H5Dget_type(info.dataset);
+  info.space = H5Dget_space(info.dataset);
+  info.plist = H5Dget_create_plist(info.dataset);
+  if (info.type < 0 || info.space < 0 || info.plist < 0)
+  {
+    return nullptr;
+  }
+
+  const hid_t native_type = type == FLOAT32 ? H5T_NATIVE_FLOAT : H5T_NATIVE_UINT32;
+  if (H5Tequal(info.type, native_type) <= 0 || H5Pget_layout(info.plist) != H5D_CONTIGUOUS ||
+      H5Pget_nfilters(info.plist) != 0)
+  {
+    return nullptr;
+  }
+
+  const int rank = H5Sget_simple_extent_ndims(info.space);
+  if (rank < 1 || rank > 2 || H5Sget_simple_extent_dims(info.space, dims, nullptr) < 0)
+  {
+    return nullptr;
+  }
+  if (rank == 1)
+  {
+    dims[1] = 1;
+  }
+
+  offset = H5Dget_offset(info.dataset);
+  const size_t element_size = H5Tget_size(info.type);
+  const size_t data_size = dims[0] * dims[1] * element_size;
+  if (offset == HADDR_UNDEF || data_size == 0 || offset % element_size != 0 ||
+      H5Dget_storage_size(info.dataset) < data_size)
+  {
+    return nullptr;
+  }
+
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return nullptr;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < offset + data_size)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  // mmap requires a page aligned file offset
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t mapping_offset = offset - offset % page_size;
+  const size_t mapping_size = offset + data_size - mapping_offset;
+
+  // private copy-on-write mapping, writes through the buffer never reach the file
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, mapping_offset);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    return nullptr;
+  }
+
+  const void* data = static_cast<const char*>(mapping) + (offset - mapping_offset);
+  return Ptr(new MappedDataset(mapping, mapping_size, data, dims[0], dims[1]));
+}
+
+lvr2::MeshBufferPtr mapMeshBuffer(const std::string& file, const std::string& mesh_part)
+{
+  const std::string group = "meshes/" + mesh_part + "/";
+  const auto vertices = MappedDataset::map(file, group + "vertices", MappedDataset::FLOAT32);
+  const auto faces = MappedDataset::map(file, group + "face_indices", MappedDataset::UINT32);
+  if (!vertices || !faces || vertices->cols() != 3 || faces->cols() != 3)
+  {
+    return nullptr;
+  }
+
+  // the arrays keep the mappings alive, the deleters only release the references
+  lvr2::floatArr vertex_array(static_cast<float*>(const_cast<void*>(vertices->data())),
+                              [vertices](float*) {});
+  lvr2::indexArray face_array(static_cast<unsigned int*>(const_cast<void*>(faces->data())),
+                              [faces](unsigned int*) {});
+
+  auto mesh_buffer = std::make_shared<lvr2::MeshBuffer>();
+  mesh_buffer->setVertices(vertex_array, vertices->rows());
+  mesh_buffer->setFaceIndices(face_array, faces->rows());
+  return mesh_buffer;
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,215 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#include <mesh_map/mesh_boundary.h>
+#include <mesh_map/vertex_kernels.h>
+
+namespace mesh_map
+{
+
+MeshBoundary::MeshBoundary(const MeshTopology& topology, const size_t num_threads) : num_boundary_edges_(0)
+{
+  edge_states_.resize(topology.numEdgeSlots(), INTERIOR);
+  // every edge is classified by one of its vertices, the threads write to disjoint states
+  parallelForEachVertex(topology.numVertexSlots(), num_threads,
+                        [&](const size_t, const lvr2::VertexHandle& vH) {
+                          if (!topology.isValid(vH))
+                          {
+                            return;
+                          }
+                          for (const auto& eH : topology.edgesOfVertex(vH))
+                          {
+                            const auto& vertices = topology.verticesOfEdge(eH);
+                            const auto& owner = topology.isValid(vertices[0]) ? vertices[0] : vertices[1];
+                            if (owner == vH)
+                            {
+                              edge_states_[eH.idx()] = classify(topology, eH);
+                            }
+                          }
+                        });
+  link(topology);
+}
+
+void MeshBoundary::update(const MeshTopology& topology, const std::vector<lvr2::VertexHandle>& vertices)
+{
+  edge_states_.resize(topology.numEdgeSlots(), INTERIOR);
+  for (const auto& vH : vertices)
+  {
+    if (!topology.isValid(vH))
+    {
+      continue;
+    }
+    for (const auto& eH : topology.edgesOfVertex(vH))
+    {
+      edge_states_[eH.idx()] = classify(topology, eH);
+    }
+  }
+  link(topology);
+}
+
+MeshBoundary::EdgeState MeshBoundary::classify(const MeshTopology& topology, const lvr2::EdgeHandle& eH)
+{
+  const auto& vertices = topology.verticesOfEdge(eH);
+  const bool first = topology.isValid(vertices[0]);
+  const auto& vH = first ? vertices[0] : vertices[1];
+  const auto& nH = first ? vertices[1] : vertices[0];
+  if (!topology.isValid(vH))
+  {
+    return INTERIOR;
+  }
+
+  size_t num_faces = 0;
+  bool outgoing = false;
+  for (const auto& fH : topology.facesOfVertex(vH))
+  {
+    const auto& face_vertices = topology.verticesOfFace(fH);
+    for (size_t j = 0; j < 3; j++)
+    {
+      if (face_vertices[j] == vH)
+      {
+        if (face_vertices[(j + 1) % 3] == nH)
+        {
+          num_faces++;
+          outgoing = true;
+        }
+        else if (face_vertices[(j + 2) % 3] == nH)
+        {
+          num_faces++;
+          outgoing = false;
+        }
+        break;
+      }
+    }
+  }
+  if (num_faces != 1)
+  {
+    return INTERIOR;
+  }
+  // the boundary half-edge runs opposite to the half-edge of the only face
+  return outgoing != first ? FORWARD : BACKWARD;
+}
+
+void MeshBoundary::link(const MeshTopology& topology)
+{
+  const size_t num_edges = edge_states_.size();
+  visited_.assign((num_edges + 63) / 64, 0);
+  boundary_vertices_.assign(topology.numVertexSlots(), 0);
+  contour_vertices_.clear();
+  contour_offsets_.clear();
+  contour_offsets_.push_back(0);
+  num_boundary_edges_ = 0;
+
+  for (size_t i = 0; i < num_edges; i++)
+  {
+    if (edge_states_[i] != INTERIOR && !topology.containsEdge(lvr2::EdgeHandle(i)))
+    {
+      edge_states_[i] = INTERIOR;
+    }
+    if (edge_states_[i] != INTERIOR)
+    {
+      num_boundary_edges_++;
+    }
+  }
+  contour_vertices_.reserve(num_boundary_edges_);
+
+  auto visit = [&](const lvr2::EdgeHandle& start) {
+    const lvr2::VertexHandle start_vertex = tail(topology, start);
+    lvr2::EdgeHandle eH = start;
+    while (true)
+    {
+      visited_[eH.idx() / 64] |= uint64_t(1) << (eH.idx() % 64);
+      const auto& vH = tail(topology, eH);
+      contour_vertices_.push_back(vH);
+      boundary_vertices_[vH.idx()] = 1;
+
+      const lvr2::VertexHandle next_vertex = head(topology, eH);
+      if (next_vertex == start_vertex)
+      {
+        break;
+      }
+
+      // continue with an outgoing boundary half-edge, broken vertices have none and end the contour
+      bool found = false;
+      if (topology.isValid(next_vertex))
+      {
+        for (const auto& next : topology.edgesOfVertex(next_vertex))
+        {
+          if (edge_states_[next.idx()] != INTERIOR && !(visited_[next.idx() / 64] >> (next.idx() % 64) & 1) &&
+              tail(topology, next) == next_vertex)
+          {
+            eH = next;
+            found = true;
+            break;
+          }
+        }
+      }
+      if (!found)
+      {
+        contour_vertices_.push_back(next_vertex);
+        boundary_vertices_[next_vertex.idx()] = 1;
+        break;
+      }
+    }
+    contour_offsets_.push_back(contour_vertices_.size());
+  };
+
+  // open contours start at broken vertices, walk them first to not split them up
+  for (size_t pass = 0; pass < 2; pass++)
+  {
+    for (size_t i = 0; i < num_edges; i++)
+    {
+      const lvr2::EdgeHandle eH(i);
+      if (edge_states_[i] == INTERIOR || visited_[i / 64] >> (i % 64) & 1)
+      {
+        continue;
+      }
+      if (pass == 1 || !topology.isValid(tail(topology, eH)))
+      {
+        visit(eH);
+      }
+    }
+  }
+}
+
+size_t MeshBoundary::memoryUsage() const
+{
+  return edge_states_.capacity() + boundary_vertices_.capacity() + visited_.capacity() * sizeof(uint64_t) +
+         contour_vertices_.capacity() * sizeof(lvr2::VertexHandle) + contour_offsets_.capacity() * sizeof(uint32_t);
+}
+
+} /* namespace mesh_map */
@@ -35,6 +35,16 @@
  *
  */
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <exception>
+#include <future>
 #include <unordered_set>
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid.hpp>
@@ -60,12 +70,15 @@
 #include <lvr2/geometry/HalfEdgeMesh.hpp>
 #include <lvr2/geometry/PMPMesh.hpp>
 
+#include <mesh_map/instrumentation.h>
+#include <mesh_map/mapped_dataset.h>
 #include <mesh_map/mesh_map.h>
 #include <mesh_map/util.h>
 #include <mesh_msgs/msg/mesh_geometry_stamped.hpp>
 #include <mesh_msgs_conversions/conversions.h>
 #include <mutex>
 #include <rclcpp/rclcpp.hpp>
+#include <thread>
 #include <visualization_msgs/msg/marker.hpp>
 
 #include <filesystem>
@@ -97,12 +110,36 @@ std::shared_ptr<lvr2::BaseMesh<Vector> > createHemByName(std::string hem_impl, l
 
 using HDF5MeshIO = lvr2::Hdf5Build<lvr2::hdf5features::MeshIO>;
 
+//! formats a hash value as fixed width hex string
+static std::string hashToString(const uint64_t hash)
+{
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ss.str();
+}
+
+//! number of cost revisions for which the changed vertices are kept
+static const size_t COST_HISTORY_SIZE = 32;
+
+//! name under which the combined costs are published
+static const std::string COMBINED_COSTS_NAME = "Combined Costs";
+
+//! number of samples on the footprint circle of a cost query
+static const size_t FOOTPRINT_SAMPLES = 8;
+
 MeshMap::MeshMap(tf2_ros::Buffer& tf, const rclcpp::Node::SharedPtr& node)
-  : tf_buffer(tf_buffer)
+  : tf_buffer(tf)
   , node(node)
   , first_config(true)
   , map_loaded(false)
   , layer_loader("mesh_map", "mesh_map::AbstractLayer")
+  , cost_revision(0)
+  , cost_history_begin(0)
+  , combined_layer_factor(0)
+  , vector_field_version(0)
+  , cost_subscribers(0)
+  , mesh_hash(0)
+  , cache_valid(false)
 {
   auto min_contour_size_desc = rcl_interfaces::msg::ParameterDescriptor{}; 
   min_contour_size_desc.name = MESH_MAP_NAMESPACE + ".min_contour_size";
@@ -136,6 +173,151 @@ MeshMap::MeshMap(tf2_ros::Buffer& tf, const rclcpp::Node::SharedPtr& node)
 
   hem_impl_ = node->declare_parameter(MESH_MAP_NAMESPACE + ".hem", "pmp");
 
+  auto parallel_layer_init_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  parallel_layer_init_desc.name = MESH_MAP_NAMESPACE + ".parallel_layer_init";
+  parallel_layer_init_desc.type = rclcpp::ParameterType::PARAMETER_BOOL;
+  parallel_layer_init_desc.description = "Computes the layers which do not depend on the lethal vertices of previous "
+                                         "layers concurrently, if they could not be read from the map file.";
+  parallel_layer_init_desc.read_only = true;
+  parallel_layer_init = node->declare_parameter(MESH_MAP_NAMESPACE + ".parallel_layer_init", false, parallel_layer_init_desc);
+
+  auto layer_init_threads_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  layer_init_threads_desc.name = MESH_MAP_NAMESPACE + ".layer_init_threads";
+  layer_init_threads_desc.type = rclcpp::ParameterType::PARAMETER_INTEGER;
+  layer_init_threads_desc.description = "Number of threads for the concurrent layer computation, 0 uses the number of "
+                                        "hardware threads.";
+  layer_init_threads_desc.read_only = true;
+  auto layer_init_threads_range = rcl_interfaces::msg::IntegerRange{};
+  layer_init_threads_range.from_value = 0;
+  layer_init_threads_range.to_value = 256;
+  layer_init_threads_desc.integer_range.push_back(layer_init_threads_range);
+  layer_init_threads = node->declare_parameter(MESH_MAP_NAMESPACE + ".layer_init_threads", 0, layer_init_threads_desc);
+
+  auto geometry_cache_size_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  geometry_cache_size_desc.name = MESH_MAP_NAMESPACE + ".geometry_cache_size";
+  geometry_cache_size_desc.type = rclcpp::ParameterType::PARAMETER_INTEGER;
+  geometry_cache_size_desc.description = "Maximum size in MiB of the vertex neighbourhoods of one radius which are "
+                                         "shared by the layers, larger neighbourhoods are walked by each layer.";
+  geometry_cache_size_desc.read_only = true;
+  auto geometry_cache_size_range = rcl_interfaces::msg::IntegerRange{};
+  geometry_cache_size_range.from_value = 0;
+  geometry_cache_size_range.to_value = 65536;
+  geometry_cache_size_desc.integer_range.push_back(geometry_cache_size_range);
+  geometry_cache_size = node->declare_parameter(MESH_MAP_NAMESPACE + ".geometry_cache_size", 512, geometry_cache_size_desc);
+
+  auto cost_storage_bits_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  cost_storage_bits_desc.name = MESH_MAP_NAMESPACE + ".cost_storage_bits";
+  cost_storage_bits_desc.type = rclcpp::ParameterType::PARAMETER_INTEGER;
+  cost_storage_bits_desc.description = "Bits per vertex of the layer costs kept by the map: 32 stores floats, 16 or 8 "
+                                       "quantize the costs of each layer to its value range to save memory.";
+  cost_storage_bits_desc.read_only = true;
+  cost_storage_bits = node->declare_parameter(MESH_MAP_NAMESPACE + ".cost_storage_bits", 32, cost_storage_bits_desc);
+  if (cost_storage_bits != 8 && cost_storage_bits != 16 && cost_storage_bits != 32)
+  {
+    RCLCPP_WARN_STREAM(node->get_logger(), "Unsupported cost storage bits " << cost_storage_bits
+        << ", the layer costs are stored as floats.");
+    cost_storage_bits = 32;
+  }
+
+  auto mmap_loading_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  mmap_loading_desc.name = MESH_MAP_NAMESPACE + ".mmap_loading";
+  mmap_loading_desc.type = rclcpp::ParameterType::PARAMETER_BOOL;
+  mmap_loading_desc.description = "Maps the vertices and faces of the working file into memory instead of copying "
+                                  "them, if they are stored contiguous and uncompressed.";
+  mmap_loading_desc.read_only = true;
+  mmap_loading = node->declare_parameter(MESH_MAP_NAMESPACE + ".mmap_loading", false, mmap_loading_desc);
+
+  auto tiled_loading_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  tiled_loading_desc.name = MESH_MAP_NAMESPACE + ".tiled_loading";
+  tiled_loading_desc.type = rclcpp::ParameterType::PARAMETER_BOOL;
+  tiled_loading_desc.description = "Splits the working mesh into tiles and only keeps the tiles within tile_radius "
+                                   "around tile_center resident, the layers are computed for them only and "
+                                   "stored in a mesh part of the resident tiles.";
+  tiled_loading_desc.read_only = true;
+  tiled_loading = node->declare_parameter(MESH_MAP_NAMESPACE + ".tiled_loading", false, tiled_loading_desc);
+
+  auto tile_size_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  tile_size_desc.name = MESH_MAP_NAMESPACE + ".tile_size";
+  tile_size_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  tile_size_desc.description = "Edge length of the square tiles in the xy plane.";
+  tile_size_desc.read_only = true;
+  auto tile_size_range = rcl_interfaces::msg::FloatingPointRange{};
+  tile_size_range.from_value = 1.0;
+  tile_size_range.to_value = 1000.0;
+  tile_size_desc.floating_point_range.push_back(tile_size_range);
+  tile_size = node->declare_parameter(MESH_MAP_NAMESPACE + ".tile_size", 50.0, tile_size_desc);
+
+  auto tile_halo_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  tile_halo_desc.name = MESH_MAP_NAMESPACE + ".tile_halo";
+  tile_halo_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  tile_halo_desc.description = "Overlap of neighbouring tiles, the faces within this distance of a tile border "
+                               "belong to both tiles.";
+  tile_halo_desc.read_only = true;
+  auto tile_halo_range = rcl_interfaces::msg::FloatingPointRange{};
+  tile_halo_range.from_value = 0.0;
+  tile_halo_range.to_value = 100.0;
+  tile_halo_desc.floating_point_range.push_back(tile_halo_range);
+  tile_halo = node->declare_parameter(MESH_MAP_NAMESPACE + ".tile_halo", 2.0, tile_halo_desc);
+
+  auto tile_radius_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  tile_radius_desc.name = MESH_MAP_NAMESPACE + ".tile_radius";
+  tile_radius_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  tile_radius_desc.description = "Radius around tile_center in which the tiles are kept resident.";
+  tile_radius_desc.read_only = true;
+  auto tile_radius_range = rcl_interfaces::msg::FloatingPointRange{};
+  tile_radius_range.from_value = 0.0;
+  tile_radius_range.to_value = 100000.0;
+  tile_radius_desc.floating_point_range.push_back(tile_radius_range);
+  tile_radius = node->declare_parameter(MESH_MAP_NAMESPACE + ".tile_radius", 100.0, tile_radius_desc);
+
+  auto tile_center_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  tile_center_desc.name = MESH_MAP_NAMESPACE + ".tile_center";
+  tile_center_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  tile_center_desc.description = "The x and y coordinate of the center of the resident tiles in the map frame.";
+  tile_center_desc.read_only = true;
+  tile_center = node->declare_parameter(MESH_MAP_NAMESPACE + ".tile_center", std::vector<double>{ 0.0, 0.0 },
+                                        tile_center_desc);
+  if (tile_center.size() != 2)
+  {
+    throw rclcpp::exceptions::InvalidParametersException("The parameter " + MESH_MAP_NAMESPACE +
+                                                         ".tile_center must contain the x and y coordinate!");
+  }
+
+  auto cost_publish_rate_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  cost_publish_rate_desc.name = MESH_MAP_NAMESPACE + ".cost_publish_rate";
+  cost_publish_rate_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  cost_publish_rate_desc.description = "Maximum rate in Hz at which changed costs are published, changes in between "
+                                       "are merged. 0 publishes every change immediately.";
+  cost_publish_rate_desc.read_only = true;
+  auto cost_publish_rate_range = rcl_interfaces::msg::FloatingPointRange{};
+  cost_publish_rate_range.from_value = 0.0;
+  cost_publish_rate_range.to_value = 100.0;
+  cost_publish_rate_desc.floating_point_range.push_back(cost_publish_rate_range);
+  cost_publish_rate = node->declare_parameter(MESH_MAP_NAMESPACE + ".cost_publish_rate", 0.0, cost_publish_rate_desc);
+
+  auto cost_delta_updates_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  cost_delta_updates_desc.name = MESH_MAP_NAMESPACE + ".cost_delta_updates";
+  cost_delta_updates_desc.type = rclcpp::ParameterType::PARAMETER_BOOL;
+  cost_delta_updates_desc.description = "Publishes only the changed vertex costs on \"~/vertex_costs_updates\". The "
+                                        "full costs are still published on \"~/vertex_costs\" for new subscribers "
+                                        "and if the changes are not known.";
+  cost_delta_updates_desc.read_only = true;
+  cost_delta_updates = node->declare_parameter(MESH_MAP_NAMESPACE + ".cost_delta_updates", false, cost_delta_updates_desc);
+
+  auto vector_field_resolution_desc = rcl_interfaces::msg::ParameterDescriptor{};
+  vector_field_resolution_desc.name = MESH_MAP_NAMESPACE + ".vector_field_resolution";
+  vector_field_resolution_desc.type = rclcpp::ParameterType::PARAMETER_DOUBLE;
+  vector_field_resolution_desc.description = "Cell size in meters of the grid in which one vertex vector and one face "
+                                             "vector of the published vector fields are visualized. 0 visualizes the "
+                                             "vectors of all vertices and faces.";
+  vector_field_resolution_desc.read_only = true;
+  auto vector_field_resolution_range = rcl_interfaces::msg::FloatingPointRange{};
+  vector_field_resolution_range.from_value = 0.0;
+  vector_field_resolution_range.to_value = 10.0;
+  vector_field_resolution_desc.floating_point_range.push_back(vector_field_resolution_range);
+  vector_field_resolution = node->declare_parameter(MESH_MAP_NAMESPACE + ".vector_field_resolution", 0.1,
+                                                    vector_field_resolution_desc);
+
   mesh_file = node->declare_parameter(MESH_MAP_NAMESPACE + ".mesh_file", "");
   mesh_part = node->declare_parameter(MESH_MAP_NAMESPACE + ".mesh_part", "");
   mesh_working_file = node->declare_parameter(MESH_MAP_NAMESPACE + ".mesh_working_file", "");
@@ -172,10 +354,54 @@ MeshMap::MeshMap(tf2_ros::Buffer& tf, const rclcpp::Node::SharedPtr& node)
   marker_pub = node->create_publisher<visualization_msgs::msg::Marker>("~/marker", 100);
   mesh_geometry_pub = node->create_publisher<mesh_msgs::msg::MeshGeometryStamped>("~/mesh", rclcpp::QoS(1).transient_local());
   vertex_costs_pub = node->create_publisher<mesh_msgs::msg::MeshVertexCostsStamped>("~/vertex_costs", rclcpp::QoS(1).transient_local());
+  vertex_costs_update_pub = node->create_publisher<mesh_msgs::msg::MeshVertexCostsSparseStamped>("~/vertex_costs_updates", 10);
   vertex_colors_pub = node->create_publisher<mesh_msgs::msg::MeshVertexColorsStamped>("~/vertex_colors", rclcpp::QoS(1).transient_local());
   vector_field_pub = node->create_publisher<visualization_msgs::msg::Marker>("~/vector_field", rclcpp::QoS(1).transient_local());
+  stop_vector_field_thread = false;
+  republish_vector_fields = false;
+  vector_field_subscribers = 0;
+  vector_field_thread = std::thread(&MeshMap::publishPendingVectorFields, this);
   config_callback = node->add_on_set_parameters_callback(std::bind(&MeshMap::reconfigureCallback, this, std::placeholders::_1));
 
+  if (cost_publish_rate > 0)
+  {
+    cost_publish_timer = node->create_wall_timer(std::chrono::duration<double>(1.0 / cost_publish_rate), [this]() {
+      if (!map_loaded)
+        return;
+      // the layer costs must not change while they are serialized
+      std::lock_guard<std::mutex> lock(layer_mtx);
+      publishPendingCosts();
+    });
+  }
+
+  // the costs and vector fields are published only on changes, subscribers which join later get them from here
+  subscriber_check_timer = node->create_wall_timer(std::chrono::seconds(1), [this]() {
+    if (!map_loaded)
+      return;
+    if (cost_publish_rate <= 0 && hasNewCostSubscribers())
+    {
+      std::lock_guard<std::mutex> lock(layer_mtx);
+      publishPendingCosts();
+    }
+    checkVectorFieldSubscribers();
+  });
+
+  save_result_pub = node->create_publisher<std_msgs::msg::String>("~/save_map/result", 10);
+  persistence_queue = std::make_unique<PersistenceQueue>([this](const std::string& key, bool success) {
+    std_msgs::msg::String msg;
+    if (success)
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "Finished writing '" << key << "' to file.");
+      msg.data = "Saved '" + key + "'";
+    }
+    else
+    {
+      RCLCPP_ERROR_STREAM(node->get_logger(), "Error while writing '" << key << "' to file.");
+      msg.data = "Failed to save '" + key + "'";
+    }
+    save_result_pub->publish(msg);
+  });
+
   save_service = node->create_service<std_srvs::srv::Trigger>("~/save_map", [this](
     const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
     std::shared_ptr<std_srvs::srv::Trigger::Response>      response)
@@ -184,8 +410,27 @@ MeshMap::MeshMap(tf2_ros::Buffer& tf, const rclcpp::Node::SharedPtr& node)
   });
 }
 
+MeshMap::~MeshMap()
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_vector_fields_mtx);
+    stop_vector_field_thread = true;
+  }
+  pending_vector_fields_cv.notify_all();
+  vector_field_thread.join();
+
+  // the writes access the members of the map
+  persistence_queue.reset();
+}
+
 bool MeshMap::readMap()
 { 
+  MESH_MAP_SCOPED_TIMER("mesh_map.read_map");
+  // a newly imported mesh is converted from the import buffer directly, while the working file is written
+  lvr2::MeshBufferPtr mesh_buffer;
+  std::shared_ptr<HDF5MeshIO> hdf5_mesh_io;
+  bool imported = false;
+
   if(!mesh_io_ptr)
   {
     if(mesh_file.empty())
@@ -219,7 +464,7 @@ bool MeshMap::readMap()
       // directly work on the input file
       RCLCPP_INFO_STREAM(node->get_logger(), "Connect to \"" << mesh_working_part << "\" from file \"" << mesh_working_file << "\"...");
 
-      auto hdf5_mesh_io = std::make_shared<HDF5MeshIO>();
+      hdf5_mesh_io = std::make_shared<HDF5MeshIO>();
       hdf5_mesh_io->open(mesh_working_file);
       hdf5_mesh_io->setMeshName(mesh_working_part);
       mesh_io_ptr = hdf5_mesh_io;
@@ -229,7 +474,6 @@ bool MeshMap::readMap()
         RCLCPP_INFO_STREAM(node->get_logger(), "Initially loading \"" << mesh_part << "\" from file \"" << mesh_file << "\"...");
       
         std::cout << "Generate seperate working file..." << std::endl;
-        lvr2::MeshBufferPtr mesh_buffer;
 
         // we have to create the working h5 first
         if(fs::path(mesh_file).extension() == ".h5")
@@ -267,8 +511,8 @@ bool MeshMap::readMap()
 
         RCLCPP_INFO_STREAM(node->get_logger(), "Loaded mesh buffer: \n" << *mesh_buffer);
 
-        // write
-        hdf5_mesh_io->save(mesh_working_part, mesh_buffer);
+        // the buffer is written to the working file in the background once the map has been built from it
+        imported = true;
       } else {
         RCLCPP_INFO_STREAM(node->get_logger(), "Working mesh == input mesh");
       }
@@ -279,25 +523,95 @@ bool MeshMap::readMap()
 
   RCLCPP_DEBUG_STREAM(node->get_logger(), "Start reading the mesh part '" << mesh_part << "' from the map file '" << mesh_file << "'...");
 
-  auto hdf5_mesh_input = std::make_shared<HDF5MeshIO>();
-  hdf5_mesh_input->open(mesh_working_file);
-  hdf5_mesh_input->setMeshName(mesh_working_part);
-  lvr2::MeshBufferPtr mesh_buffer = hdf5_mesh_input->MeshIO::load(mesh_working_part);
+  // the reads are sequenced with the writes which might still be pending from an earlier call
+  auto load_lock = persistence_queue->lockFile();
+  if (!imported && mmap_loading)
+  {
+    // map the vertices and faces directly from the working file, this falls back to the copying loader if the datasets
+    // are chunked or compressed
+    mesh_buffer = mapMeshBuffer(mesh_working_file, mesh_working_part);
+    if (mesh_buffer)
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "Mapped the mesh buffer from the working file.");
+    }
+    else
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "The mesh datasets of the working file can not be mapped, they are "
+                                             "loaded with the HDF5 mesh io.");
+    }
+  }
+
+  if (!mesh_buffer)
+  {
+    // reuse the connection to the working file instead of opening it a second time
+    if (!hdf5_mesh_io)
+    {
+      hdf5_mesh_io = std::dynamic_pointer_cast<HDF5MeshIO>(mesh_io_ptr);
+    }
+    if (!hdf5_mesh_io)
+    {
+      hdf5_mesh_io = std::make_shared<HDF5MeshIO>();
+      hdf5_mesh_io->open(mesh_working_file);
+      hdf5_mesh_io->setMeshName(mesh_working_part);
+    }
+    mesh_buffer = hdf5_mesh_io->MeshIO::load(mesh_working_part);
+  }
+  load_lock.unlock();
 
   RCLCPP_DEBUG_STREAM(node->get_logger(), "Convert buffer to HEM: \n" << *mesh_buffer);
 
   if(mesh_buffer)
   {
+    // the working part keeps the whole mesh, only the half-edge mesh is built from the resident tiles and their
+    // attributes are kept in a mesh part of their own
+    bool save_tiling = false;
+    resident_vertex_ids.clear();
+    setAttributePart(mesh_working_part);
+    const lvr2::MeshBufferPtr resident_buffer =
+        tiled_loading ? extractResidentTiles(mesh_buffer, save_tiling) : mesh_buffer;
+
     RCLCPP_DEBUG_STREAM(node->get_logger(), "Creating mesh of type '" << hem_impl_ << "'");
-    mesh_ptr = createHemByName(hem_impl_, mesh_buffer);
+    mesh_ptr = createHemByName(hem_impl_, resident_buffer);
+    if (imported)
+    {
+      // the writes of the map attributes are queued behind the mesh write
+      persistence_queue->enqueue("mesh", [this, hdf5_mesh_io, buffer = mesh_buffer, part = mesh_working_part]() {
+        return accessWorkingPart([&]() {
+          hdf5_mesh_io->save(part, buffer);
+          return true;
+        });
+      });
+    }
+    if (save_tiling)
+    {
+      saveTiling();
+    }
+    // the half-edge mesh holds its own copy, release the buffer before the layers allocate their maps
+    mesh_buffer.reset();
     RCLCPP_INFO_STREAM(node->get_logger(), "The mesh of type '" << hem_impl_ <<  "' has been loaded successfully with " 
       << mesh_ptr->numVertices() << " vertices and " << mesh_ptr->numFaces() << " faces and "
       << mesh_ptr->numEdges() << " edges.");
-    // build a tree for fast lookups
+    // build a tree for fast lookups, or reuse the one stored in the working file if the mesh has not changed
+    const auto kd_tree_start = std::chrono::steady_clock::now();
+    MESH_MAP_SCOPED_TIMER("mesh_map.read_map.kd_tree");
+    mesh_hash = meshContentHash(*mesh_ptr);
     adaptor_ptr = std::make_unique<NanoFlannMeshAdaptor>(mesh_ptr);
     kd_tree_ptr = std::make_unique<KDTree>(3,*adaptor_ptr, nanoflann::KDTreeSingleIndexAdaptorParams(10));
-    kd_tree_ptr->buildIndex();
-    RCLCPP_INFO_STREAM(node->get_logger(), "The k-d tree has been build successfully!");
+    if (!imported && loadKdTree())
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "The k-d tree has been loaded from the map file.");
+    }
+    else
+    {
+      kd_tree_ptr->buildIndex();
+      if (!saveKdTree())
+      {
+        RCLCPP_WARN_STREAM(node->get_logger(), "Could not serialize the k-d tree for the map file!");
+      }
+    }
+    const auto kd_tree_duration = std::chrono::steady_clock::now() - kd_tree_start;
+    RCLCPP_INFO_STREAM(node->get_logger(), "The k-d tree has been build successfully in "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(kd_tree_duration).count() << "ms!");
   }
   else
   {
@@ -308,14 +622,61 @@ bool MeshMap::readMap()
 
   vertex_costs = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
   edge_weights = lvr2::DenseEdgeMap<float>(mesh_ptr->nextEdgeIndex(), 0);
-  invalid = lvr2::DenseVertexMap<bool>(mesh_ptr->nextVertexIndex(), false);
+  invalid = VertexFlags(mesh_ptr->nextVertexIndex());
 
-  // TODO read and write uuid
-  boost::uuids::random_generator gen;
-  boost::uuids::uuid uuid = gen();
-  uuid_str = boost::uuids::to_string(uuid);
+  const auto t_topology_start = std::chrono::steady_clock::now();
+  topology_ptr = std::make_shared<const MeshTopology>(*mesh_ptr);
+  {
+    std::lock_guard<std::mutex> lock(face_bvh_mtx);
+    face_bvh_ptr.reset();
+  }
+  {
+    std::lock_guard<std::mutex> lock(coarse_graph_mtx);
+    coarse_graph_ptr.reset();
+  }
+  geometry_cache.clear();
+  for (size_t i = 0; i < topology_ptr->numVertexSlots(); i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    if (topology_ptr->isBroken(vH))
+    {
+      invalid.insert(vH, true);
+    }
+  }
+  const auto topology_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - t_topology_start);
+  RCLCPP_INFO_STREAM(node->get_logger(), "The topology snapshot has been built in " << topology_duration_ms.count()
+      << " ms using " << topology_ptr->memoryUsage() / (1024 * 1024) << " MiB, "
+      << topology_ptr->numBrokenVertices() << " vertices are marked as invalid.");
+
+  // the uuid identifies the map as long as the mesh content does not change, the stored hash also tells whether the
+  // attributes cached in the working file belong to the current mesh
+  std::string stored_hash, stored_uuid;
+  const std::string current_hash = hashToString(mesh_hash);
+  cache_valid = !imported && readStringChannel("mesh_map", "mesh_hash", stored_hash) && stored_hash == current_hash;
+  if (cache_valid && readStringChannel("mesh_map", "uuid", stored_uuid) && !stored_uuid.empty())
+  {
+    uuid_str = stored_uuid;
+    RCLCPP_INFO_STREAM(node->get_logger(), "Using the map uuid " << uuid_str << " from the map file.");
+  }
+  else
+  {
+    if (!stored_hash.empty() && !cache_valid)
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "The mesh has changed, the attributes cached in the map file are recomputed.");
+    }
+    boost::uuids::random_generator gen;
+    boost::uuids::uuid uuid = gen();
+    uuid_str = boost::uuids::to_string(uuid);
+    saveMapIdentity();
+  }
 
-  auto face_normals_opt = mesh_io_ptr->getDenseAttributeMap<lvr2::DenseFaceMap<Normal>>("face_normals");
+  boost::optional<lvr2::DenseFaceMap<Normal>> face_normals_opt;
+  if (cache_valid)
+  {
+    auto file_lock = persistence_queue->lockFile();
+    face_normals_opt = mesh_io_ptr->getDenseAttributeMap<lvr2::DenseFaceMap<Normal>>("face_normals");
+  }
   if (face_normals_opt)
   {
     face_normals = face_normals_opt.get();
@@ -326,18 +687,16 @@ bool MeshMap::readMap()
     RCLCPP_INFO_STREAM(node->get_logger(), "No face normals found in the given map file, computing them...");
     face_normals = lvr2::calcFaceNormals(*mesh_ptr); // -> lvr2::DenseFaceMap<Normal>
     RCLCPP_INFO_STREAM(node->get_logger(), "Computed " << face_normals.numValues() << " face normals.");
-    if (mesh_io_ptr->addDenseAttributeMap(face_normals, "face_normals"))
-    {
-      RCLCPP_INFO_STREAM(node->get_logger(), "Saved face normals to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Could not save face normals to map file!");
-    }
+    saveFaceNormals();
   }
 
   RCLCPP_INFO_STREAM(node->get_logger(), "Create 'vertex_normals'");
-  auto vertex_normals_opt = mesh_io_ptr->getDenseAttributeMap<lvr2::DenseVertexMap<Normal>>("vertex_normals");
+  boost::optional<lvr2::DenseVertexMap<Normal>> vertex_normals_opt;
+  if (cache_valid)
+  {
+    auto file_lock = persistence_queue->lockFile();
+    vertex_normals_opt = mesh_io_ptr->getDenseAttributeMap<lvr2::DenseVertexMap<Normal>>("vertex_normals");
+  }
 
   if (vertex_normals_opt)
   {
@@ -348,14 +707,7 @@ bool MeshMap::readMap()
   {
     RCLCPP_INFO_STREAM(node->get_logger(), "No vertex normals found in the given map file, computing them...");
     vertex_normals = lvr2::calcVertexNormals(*mesh_ptr, face_normals);
-    if (mesh_io_ptr->addDenseAttributeMap(vertex_normals, "vertex_normals"))
-    {
-      RCLCPP_INFO_STREAM(node->get_logger(), "Saved vertex normals to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Could not save vertex normals to map file!");
-    }
+    saveVertexNormals();
   }
 
   rclcpp::Time map_stamp = node->now();
@@ -370,10 +722,26 @@ bool MeshMap::readMap()
     map_stamp = node->now();
   }
   mesh_geometry_pub->publish(mesh_msgs_conversions::toMeshGeometryStamped<float>(mesh_ptr, global_frame, uuid_str, vertex_normals, map_stamp));
-  publishVertexColors(map_stamp);
+  if (imported)
+  {
+    // the vertex colors are read from the working file once the mesh has been written
+    persistence_queue->enqueue("vertex_colors", [this, map_stamp]() {
+      publishVertexColors(map_stamp);
+      return true;
+    });
+  }
+  else
+  {
+    publishVertexColors(map_stamp);
+  }
 
   RCLCPP_INFO_STREAM(node->get_logger(), "Try to read edge distances from map file...");
-  auto edge_distances_opt = mesh_io_ptr->getAttributeMap<lvr2::DenseEdgeMap<float>>("edge_distances");
+  boost::optional<lvr2::DenseEdgeMap<float>> edge_distances_opt;
+  if (cache_valid)
+  {
+    auto file_lock = persistence_queue->lockFile();
+    edge_distances_opt = mesh_io_ptr->getAttributeMap<lvr2::DenseEdgeMap<float>>("edge_distances");
+  }
 
   if (edge_distances_opt)
   {
@@ -384,16 +752,7 @@ bool MeshMap::readMap()
   {
     RCLCPP_INFO_STREAM(node->get_logger(), "Computing edge distances...");
     edge_distances = lvr2::calcVertexDistances(*mesh_ptr);
-    RCLCPP_INFO_STREAM(node->get_logger(), "Saving " << edge_distances.numValues() << " edge distances to map file...");
-
-    if (mesh_io_ptr->addAttributeMap(edge_distances, "edge_distances"))
-    {
-      RCLCPP_INFO_STREAM(node->get_logger(), "Saved edge distances to map file.");
-    }
-    else
-    {
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Could not save edge distances to map file!");
-    }
+    saveEdgeDistances();
   }
 
   RCLCPP_INFO_STREAM(node->get_logger(), "Load layer plugins...");
@@ -442,56 +801,120 @@ bool MeshMap::loadLayerPlugins()
 void MeshMap::layerChanged(const std::string& layer_name)
 {
   std::lock_guard<std::mutex> lock(layer_mtx);
+  MESH_MAP_SCOPED_TIMER("mesh_map.layer_changed");
 
   RCLCPP_INFO_STREAM(node->get_logger(), "Layer \"" << layer_name << "\" changed.");
 
-  lethals.clear();
-
-  RCLCPP_INFO_STREAM(node->get_logger(), "Combine underlining lethal sets...");
-
-  // TODO pre-compute combined lethals upto a layer level
-  auto layer_iter = loaded_layers.begin();
-  for (; layer_iter != loaded_layers.end(); layer_iter++)
+  const auto layer_iter = std::find_if(loaded_layers.begin(), loaded_layers.end(),
+                                       [&layer_name](const auto& layer) { return layer.first == layer_name; });
+  if (layer_iter == loaded_layers.end())
   {
-    // TODO add lethal and removae lethal sets
-    lethals.insert(layer_iter->second->lethals().begin(), layer_iter->second->lethals().end());
-    // TODO merge with std::set_merge
-    if (layer_iter->first == layer_name)
-      break;
+    RCLCPP_ERROR_STREAM(node->get_logger(), "The changed layer \"" << layer_name << "\" is not loaded!");
+    return;
   }
+  const size_t changed_index = layer_iter - loaded_layers.begin();
 
-  vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(layer_iter->second->costs(), mesh_ptr->numVertices(),
-                                                         layer_iter->second->defaultValue(), layer_iter->first,
-                                                         global_frame, uuid_str));
-
-  if (layer_iter != loaded_layers.end())
-    layer_iter++;
+  // changes of the combined lethals up to the current layer level, which are passed on to the next layer
+  std::vector<lvr2::VertexHandle> prefix_added, prefix_removed;
+  std::vector<lvr2::VertexHandle> layer_added, layer_removed;
+  std::vector<lvr2::VertexHandle> next_added, next_removed;
 
-  RCLCPP_INFO_STREAM(node->get_logger(), "Combine  lethal sets...");
+  // vertices whose layer costs changed, the combined costs are updated only for them if all layers report them
+  std::vector<lvr2::VertexHandle> changed_vertices, layer_changed;
+  bool changes_known = layer_cost_arrays.size() == loaded_layers.size();
 
-  for (; layer_iter != loaded_layers.end(); layer_iter++)
+  for (size_t i = changed_index; i < loaded_layers.size(); i++)
   {
-    // TODO add lethal and remove lethal sets as param
-    layer_iter->second->updateLethal(lethals, lethals);
+    auto& layer_plugin = loaded_layers[i].second;
+    bool costs_changed = i == changed_index;
+    if (i == changed_index)
+    {
+      layer_lethals[i].update(layer_plugin->lethals(), layer_added, layer_removed);
+    }
+    else if (prefix_added.empty() && prefix_removed.empty())
+    {
+      // the combined lethals of the preceding layers did not change, the following layers are not affected
+      break;
+    }
+    else if (layer_plugin->dependsOnLethals())
+    {
+      std::set<lvr2::VertexHandle> added(prefix_added.begin(), prefix_added.end());
+      std::set<lvr2::VertexHandle> removed(prefix_removed.begin(), prefix_removed.end());
+      layer_plugin->updateLethal(added, removed);
+      layer_lethals[i].update(layer_plugin->lethals(), layer_added, layer_removed);
+      costs_changed = true;
+    }
+    else
+    {
+      layer_added.clear();
+      layer_removed.clear();
+    }
 
-    lethals.insert(layer_iter->second->lethals().begin(), layer_iter->second->lethals().end());
+    // a vertex is a combined lethal if it is lethal in the preceding layers or in this layer, thus only the vertices
+    // which changed in one of them have to be checked
+    next_added.clear();
+    next_removed.clear();
+    auto check = [&](const lvr2::VertexHandle& vH) {
+      const bool lethal = (i > 0 && prefix_lethals[i - 1].contains(vH)) || layer_lethals[i].contains(vH);
+      if (lethal ? prefix_lethals[i].insert(vH) : prefix_lethals[i].erase(vH))
+      {
+        (lethal ? next_added : next_removed).push_back(vH);
+      }
+    };
+    std::for_each(prefix_added.begin(), prefix_added.end(), check);
+    std::for_each(prefix_removed.begin(), prefix_removed.end(), check);
+    std::for_each(layer_added.begin(), layer_added.end(), check);
+    std::for_each(layer_removed.begin(), layer_removed.end(), check);
+    prefix_added.swap(next_added);
+    prefix_removed.swap(next_removed);
+
+    if (costs_changed)
+    {
+      const bool layer_changes_known = layer_plugin->lastChangedVertices(layer_changed);
+      if (layer_changes_known && changes_known)
+      {
+        gatherLayerCosts(i, layer_changed);
+        changed_vertices.insert(changed_vertices.end(), layer_changed.begin(), layer_changed.end());
+      }
+      changes_known &= layer_changes_known;
+      requestCostPublishing(loaded_layers[i].first, node->now(), layer_changes_known ? &layer_changed : nullptr);
+    }
+  }
 
-    vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(layer_iter->second->costs(), mesh_ptr->numVertices(),
-                                                           layer_iter->second->defaultValue(), layer_iter->first,
-                                                           global_frame, uuid_str));
+  // the remaining changes are the ones of the last layer level, i.e. of all lethals
+  for (const auto& vH : prefix_added)
+  {
+    lethals.insert(vH);
+  }
+  for (const auto& vH : prefix_removed)
+  {
+    lethals.erase(vH);
   }
 
   RCLCPP_INFO_STREAM(node->get_logger(), "Found " << lethals.size() << " lethal vertices");
   RCLCPP_INFO_STREAM(node->get_logger(), "Combine layer costs...");
 
-  combineVertexCosts(node->now());
+  if (changes_known)
+  {
+    // the combined costs of vertices which became lethal or not lethal anymore change as well
+    changed_vertices.insert(changed_vertices.end(), prefix_added.begin(), prefix_added.end());
+    changed_vertices.insert(changed_vertices.end(), prefix_removed.begin(), prefix_removed.end());
+    combineVertexCosts(node->now(), changed_vertices);
+  }
+  else
+  {
+    combineVertexCosts(node->now());
+  }
   // TODO new lethals old lethals -> renew potential field! around this areas
 }
 
 bool MeshMap::initLayerPlugins()
 {
-  lethals.clear();
-  lethal_indices.clear();
+  MESH_MAP_SCOPED_TIMER("mesh_map.init_layer_plugins");
+  const size_t num_slots = mesh_ptr->nextVertexIndex();
+  lethals = VertexBitset(num_slots);
+  layer_lethals.assign(loaded_layers.size(), VertexBitset(num_slots));
+  prefix_lethals.assign(loaded_layers.size(), VertexBitset(num_slots));
 
   for (auto& layer : loaded_layers)
   {
@@ -505,703 +928,1789 @@ bool MeshMap::initLayerPlugins()
       RCLCPP_ERROR_STREAM(node->get_logger(), "Could not initialize the layer plugin with the name \"" << layer_name << "\"!");
       return false;
     }
+  }
+
+  // layers which are already computed, the others are read or computed in the configured order below
+  std::vector<bool> computed(loaded_layers.size(), false);
+  if (parallel_layer_init)
+  {
+    // the map file is not thread safe, try to read all independent layers first and compute the missing ones afterwards
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < loaded_layers.size(); i++)
+    {
+      auto& layer_plugin = loaded_layers[i].second;
+      if (layer_plugin->dependsOnLethals())
+      {
+        continue;
+      }
+      computed[i] = true;
+      if (!readCachedLayer(loaded_layers[i].first, layer_plugin, lethals))
+      {
+        missing.push_back(i);
+      }
+    }
+    computeLayersConcurrently(missing);
+  }
+
+  for (size_t i = 0; i < loaded_layers.size(); i++)
+  {
+    auto& layer_plugin = loaded_layers[i].second;
+    const auto& layer_name = loaded_layers[i].first;
 
-    std::set<lvr2::VertexHandle> empty;
-    layer_plugin->updateLethal(lethals, empty);
-    if (!layer_plugin->readLayer())
+    if (layer_plugin->dependsOnLethals())
+    {
+      // the layer has not seen any lethals so far, all of them are new
+      std::set<lvr2::VertexHandle> added(lethals.begin(), lethals.end());
+      std::set<lvr2::VertexHandle> empty;
+      layer_plugin->updateLethal(added, empty);
+    }
+    if (!computed[i] && !readCachedLayer(layer_name, layer_plugin, lethals))
     {
       RCLCPP_INFO_STREAM(node->get_logger(), "Computing layer '" << layer_name << "' ...");
+      ScopedTimer timer([&]() -> Histogram& {
+        return Instrumentation::instance().histogram("mesh_map.compute_layer." + layer_name, "us");
+      });
       layer_plugin->computeLayer();
     }
 
-    lethal_indices[layer_name].insert(layer_plugin->lethals().begin(), layer_plugin->lethals().end());
+    layer_lethals[i].insert(layer_plugin->lethals().begin(), layer_plugin->lethals().end());
     lethals.insert(layer_plugin->lethals().begin(), layer_plugin->lethals().end());
+    prefix_lethals[i] = lethals;
   }
 
   return true;
 }
 
-void MeshMap::combineVertexCosts(const rclcpp::Time& map_stamp)
+std::string MeshMap::layerCacheSignature(const AbstractLayer::Ptr& layer_plugin, const VertexBitset& preceding_lethals)
 {
-  RCLCPP_INFO_STREAM(node->get_logger(), "Combining costs...");
-
-  float combined_min = std::numeric_limits<float>::max();
-  float combined_max = std::numeric_limits<float>::min();
-
-  vertex_costs = lvr2::DenseVertexMap<float>(mesh_ptr->nextVertexIndex(), 0);
-
-  bool hasNaN = false;
-  for (auto layer : loaded_layers)
+  std::string signature = hashToString(mesh_hash) + ";" + layer_plugin->parameterSignature();
+  if (layer_plugin->dependsOnLethals())
   {
-    const auto& costs = layer.second->costs();
-    float min, max;
-    mesh_map::getMinMax(costs, min, max);
-    const float norm = max - min;
-    const float factor = 1.0;
-    // TODO: carefully think about this
-    const float norm_factor = factor / norm;
-
-    if(norm <= 0.00001)
-    {
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Layer \"" << layer.first << "\": ERROR - range between max and min value has to be >0.");
-    }
-
-    RCLCPP_INFO_STREAM(node->get_logger(), "Layer \"" << layer.first << "\" max value: " << max << " min value: " << min << " norm: " << norm
-                               << " factor: " << factor << " norm factor: " << norm_factor);
-
-    const float default_value = layer.second->defaultValue();
-    hasNaN = false;
-    for (auto vH : mesh_ptr->vertices())
+    uint64_t lethals_hash = 14695981039346656037ULL;
+    for (const auto& vH : preceding_lethals)
     {
-      const float cost = costs.containsKey(vH) ? costs[vH] : default_value;
-      if (std::isnan(cost))
-        hasNaN = true;
-      vertex_costs[vH] += factor * cost;
-      if (std::isfinite(cost))
-      {
-        combined_max = std::max(combined_max, vertex_costs[vH]);
-        combined_min = std::min(combined_min, vertex_costs[vH]);
-      }
+      lethals_hash = (lethals_hash ^ vH.idx()) * 1099511628211ULL;
     }
-    if (hasNaN)
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Layer \"" << layer.first << "\" contains NaN values!");
+    signature += ";lethals=" + hashToString(lethals_hash);
   }
+  return signature;
+}
 
-  const float combined_norm = combined_max - combined_min;
-
-  for (auto vH : lethals)
+bool MeshMap::readCachedLayer(const std::string& layer_name, const AbstractLayer::Ptr& layer_plugin,
+                              const VertexBitset& preceding_lethals)
+{
+  std::string stored_signature;
+  if (!cache_valid || !readStringChannel("layer_signatures", layer_name, stored_signature) ||
+      stored_signature != layerCacheSignature(layer_plugin, preceding_lethals))
   {
-    vertex_costs[vH] = std::numeric_limits<float>::infinity();
+    RCLCPP_INFO_STREAM(node->get_logger(), "The layer '" << layer_name << "' in the map file is missing or has been "
+                                           "computed with other parameters.");
+    return false;
   }
+  return layer_plugin->readLayer();
+}
 
-  vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(vertex_costs, "Combined Costs", global_frame, uuid_str, map_stamp));
-
-  hasNaN = false;
-
-  RCLCPP_INFO_STREAM(node->get_logger(), "Layer weighting factor is: " << layer_factor);
-  for (auto eH : mesh_ptr->edges())
+bool MeshMap::readStringChannel(const std::string& group, const std::string& name, std::string& value)
+{
+  auto file_lock = persistence_queue->lockFile();
+  lvr2::UCharChannelOptional channel_opt;
+  if (!mesh_io_ptr->getChannel(group, name, channel_opt) || !channel_opt)
   {
-    // Get both Vertices of the current Edge
-    std::array<lvr2::VertexHandle, 2> eH_vHs = mesh_ptr->getVerticesOfEdge(eH);
-    const lvr2::VertexHandle& vH1 = eH_vHs[0];
-    const lvr2::VertexHandle& vH2 = eH_vHs[1];
-    // Get the Riskiness for the current Edge (the maximum value from both
-    // Vertices)
-    if (layer_factor != 0)
-    {
-      if (std::isinf(vertex_costs[vH1]) || std::isinf(vertex_costs[vH2]))
-      {
-        edge_weights[eH] = edge_distances[eH];
-        // edge_weights[eH] = std::numeric_limits<float>::infinity();
-      }
-      else
-      {
-        float cost_diff = std::fabs(vertex_costs[vH1] - vertex_costs[vH2]);
-
-        float vertex_factor = layer_factor * cost_diff;
-        if (std::isnan(vertex_factor))
-          RCLCPP_INFO_STREAM(node->get_logger(), "NaN: v1:" << vertex_costs[vH1] << " v2:" << vertex_costs[vH2]
-                                     << " vertex_factor:" << vertex_factor << " cost_diff:" << cost_diff);
-        edge_weights[eH] = edge_distances[eH] * (1 + vertex_factor);
-      }
-    }
-    else
-    {
-      edge_weights[eH] = edge_distances[eH];
-    }
+    return false;
   }
+  const unsigned char* data = channel_opt->dataPtr().get();
+  value.assign(reinterpret_cast<const char*>(data), channel_opt->numElements() * channel_opt->width());
+  return true;
+}
 
-  RCLCPP_INFO(node->get_logger(), "Successfully combined costs!");
+bool MeshMap::writeStringChannel(const std::string& group, const std::string& name, const std::string& value)
+{
+  auto file_lock = persistence_queue->lockFile();
+  lvr2::UCharChannel channel(value.size(), 1);
+  std::memcpy(channel.dataPtr().get(), value.data(), value.size());
+  return mesh_io_ptr->addChannel(group, name, channel);
 }
 
-void MeshMap::findLethalByContours(const int& min_contour_size, std::set<lvr2::VertexHandle>& lethals)
+void MeshMap::saveFaceNormals()
 {
-  int size = lethals.size();
-  std::vector<std::vector<lvr2::VertexHandle>> contours;
-  findContours(contours, min_contour_size);
-  for (auto contour : contours)
-  {
-    lethals.insert(contour.begin(), contour.end());
-  }
-  RCLCPP_INFO_STREAM(node->get_logger(), "Found " << lethals.size() - size << " lethal vertices as contour vertices");
+  persistence_queue->enqueue("face_normals", [this, normals = face_normals]() {
+    return mesh_io_ptr->addDenseAttributeMap(normals, "face_normals");
+  });
 }
 
-void MeshMap::findContours(std::vector<std::vector<lvr2::VertexHandle>>& contours, int min_contour_size)
+void MeshMap::saveVertexNormals()
+{
+  persistence_queue->enqueue("vertex_normals", [this, normals = vertex_normals]() {
+    return mesh_io_ptr->addDenseAttributeMap(normals, "vertex_normals");
+  });
+}
+
+void MeshMap::saveEdgeDistances()
 {
-  RCLCPP_INFO_STREAM(node->get_logger(), "Find contours...");
+  persistence_queue->enqueue("edge_distances", [this, distances = edge_distances]() {
+    return mesh_io_ptr->addAttributeMap(distances, "edge_distances");
+  });
+}
 
-  std::vector<std::vector<lvr2::VertexHandle>> tmp_contours;
+void MeshMap::saveMapIdentity()
+{
+  persistence_queue->enqueue("uuid", [this, hash = hashToString(mesh_hash), uuid = uuid_str]() {
+    return writeStringChannel("mesh_map", "mesh_hash", hash) && writeStringChannel("mesh_map", "uuid", uuid);
+  });
+}
 
-  array<lvr2::OptionalFaceHandle, 2> facepair;
-  lvr2::SparseEdgeMap<bool> usedEdges(false);
-  for (auto eHStart : mesh_ptr->edges())
+void MeshMap::computeLayersConcurrently(const std::vector<size_t>& layer_indices)
+{
+  if (layer_indices.empty())
   {
-    lvr2::SparseVertexMap<bool> usedVertices(false);
-    lvr2::SparseEdgeMap<bool> local_usedEdges(false);
-    int count = 0;
+    return;
+  }
 
-    // Look for border Edges
-    facepair = mesh_ptr->getFacesOfEdge(eHStart);
+  const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t num_threads =
+      std::min(layer_indices.size(), layer_init_threads > 0 ? static_cast<size_t>(layer_init_threads) : hardware_threads);
 
-    // If border Edge found
-    if ((!facepair[0] || !facepair[1]) && !usedEdges[eHStart])
-    {
-      std::vector<lvr2::VertexHandle> contour;
-      // Set vector which links to the following Edge
-      std::array<lvr2::VertexHandle, 2> vertexPair = mesh_ptr->getVerticesOfEdge(eHStart);
-      lvr2::VertexHandle vH = vertexPair[1];
-      std::vector<lvr2::EdgeHandle> curEdges;
-      lvr2::EdgeHandle eHTemp = eHStart;
-      bool moving = true;
-      bool vertex_flag = false;
+  RCLCPP_INFO_STREAM(node->get_logger(), "Computing " << layer_indices.size() << " layers on " << num_threads
+                                                      << " threads ...");
+  const auto start = std::chrono::steady_clock::now();
 
-      // While the conotur did not come full circle
-      while (moving)
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_mtx;
+  auto worker = [&]() {
+    for (size_t i = next++; i < layer_indices.size(); i = next++)
+    {
+      const auto& layer = loaded_layers[layer_indices[i]];
+      try
       {
-        moving = false;
-        usedEdges.insert(eHTemp, true);
-        local_usedEdges.insert(eHTemp, true);
-        // Set vector which links to the following Edge
-        vertexPair = mesh_ptr->getVerticesOfEdge(eHTemp);
-        // Eliminate the possibility to choose the previous Vertex
-        if (vH != vertexPair[0])
-        {
-          vH = vertexPair[0];
-        }
-        else if (vH != vertexPair[1])
-        {
-          vH = vertexPair[1];
-        }
-
-        // Add the current Vertex to the contour
-        usedVertices.insert(vH, true);
-        count++;
-        contour.push_back(vH);
-        mesh_ptr->getEdgesOfVertex(vH, curEdges);
-
-        // Look for other edge of vertex that is a border Edge
-        for (auto eHT : curEdges)
+        const auto layer_start = std::chrono::steady_clock::now();
         {
-          if (!usedEdges[eHT] && !local_usedEdges[eHT])
-          {
-            facepair = mesh_ptr->getFacesOfEdge(eHT);
-            if (!facepair[0] || !facepair[1])
-            {
-              eHTemp = eHT;
-              moving = true;
-              continue;
-            }
-          }
+          ScopedTimer timer([&]() -> Histogram& {
+            return Instrumentation::instance().histogram("mesh_map.compute_layer." + layer.first, "us");
+          });
+          layer.second->computeLayer();
         }
+        const auto layer_duration = std::chrono::steady_clock::now() - layer_start;
+        RCLCPP_INFO_STREAM(node->get_logger(), "Computed layer '" << layer.first << "' in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(layer_duration).count() << "ms");
       }
-      // Add contour to list of contours
-      if (contour.size() > min_contour_size)
+      catch (...)
       {
-        contours.push_back(contour);
+        std::lock_guard<std::mutex> lock(error_mtx);
+        if (!error)
+        {
+          error = std::current_exception();
+        }
       }
     }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; i++)
+  {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers)
+  {
+    thread.join();
   }
 
-  RCLCPP_INFO_STREAM(node->get_logger(), "Found " << contours.size() << " contours.");
-}
+  const auto duration = std::chrono::steady_clock::now() - start;
+  RCLCPP_INFO_STREAM(node->get_logger(), "Concurrent layer computation duration (ms): "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
 
-void MeshMap::setVectorMap(lvr2::DenseVertexMap<mesh_map::Vector>& vector_map)
-{
-  this->vector_map = vector_map;
+  // report failures the same way as the sequential computation does
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
 }
 
-boost::optional<Vector> MeshMap::directionAtPosition(
-    const lvr2::VertexMap<lvr2::BaseVector<float>>& vector_map,
-    const std::array<lvr2::VertexHandle, 3>& vertices,
-    const std::array<float, 3>& barycentric_coords)
+void MeshMap::gatherLayerCosts(const size_t index)
 {
-  const auto& a = vector_map.get(vertices[0]);
-  const auto& b = vector_map.get(vertices[1]);
-  const auto& c = vector_map.get(vertices[2]);
+  const auto& layer = loaded_layers[index];
+  const auto& costs = layer.second->costs();
+  const float default_value = layer.second->defaultValue();
+
+  float min, max;
+  mesh_map::getMinMax(costs, min, max);
+  const float norm = max - min;
+  if (norm <= 0.00001)
+  {
+    RCLCPP_ERROR_STREAM(node->get_logger(), "Layer \"" << layer.first << "\": ERROR - range between max and min value has to be >0.");
+  }
+  RCLCPP_INFO_STREAM(node->get_logger(), "Layer \"" << layer.first << "\" max value: " << max << " min value: " << min
+                                         << " norm: " << norm);
 
-  if (a || b || c)
+  // deleted vertex slots contribute zero costs
+  std::vector<float> layer_costs(mesh_ptr->nextVertexIndex(), 0);
+  bool has_nan = false;
+  for (auto vH : mesh_ptr->vertices())
   {
-    lvr2::BaseVector<float> vec;
-    if (a) vec += a.get() * barycentric_coords[0];
-    if (b) vec += b.get() * barycentric_coords[1];
-    if (c) vec += c.get() * barycentric_coords[2];
-    if (std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z))
-      return vec;
-    else
-      RCLCPP_ERROR_THROTTLE(node->get_logger(), *node->get_clock(), 300, "vector map contains invalid vectors!");
+    const float cost = costs.containsKey(vH) ? costs[vH] : default_value;
+    has_nan |= std::isnan(cost);
+    layer_costs[vH.idx()] = cost;
   }
-  else
+  if (has_nan)
+    RCLCPP_ERROR_STREAM(node->get_logger(), "Layer \"" << layer.first << "\" contains NaN values!");
+
+  auto& layer_cost_array = layer_cost_arrays[index];
+  if (layer_cost_array.bits() != cost_storage_bits)
   {
-    RCLCPP_ERROR_THROTTLE(node->get_logger(), *node->get_clock(), 300, "vector map does not contain any of the corresponding vectors");
+    layer_cost_array = CostArray(cost_storage_bits);
   }
-  return boost::none;
+  layer_cost_array.assign(std::move(layer_costs));
 }
 
-float MeshMap::costAtPosition(const std::array<lvr2::VertexHandle, 3>& vertices,
-                              const std::array<float, 3>& barycentric_coords)
+void MeshMap::gatherLayerCosts(const size_t index, const std::vector<lvr2::VertexHandle>& vertices)
 {
-  return costAtPosition(vertex_costs, vertices, barycentric_coords);
-}
-
-float MeshMap::costAtPosition(const lvr2::DenseVertexMap<float>& costs,
-                              const std::array<lvr2::VertexHandle, 3>& vertices,
-                              const std::array<float, 3>& barycentric_coords)
-{
-  const auto& a = costs.get(vertices[0]);
-  const auto& b = costs.get(vertices[1]);
-  const auto& c = costs.get(vertices[2]);
-
-  if (a && b && c)
+  const auto& layer = loaded_layers[index];
+  const auto& costs = layer.second->costs();
+  const float default_value = layer.second->defaultValue();
+
+  auto& layer_costs = layer_cost_arrays[index];
+  bool has_nan = false;
+  bool in_range = true;
+  for (const auto& vH : vertices)
   {
-    std::array<float, 3> costs = { a.get(), b.get(), c.get() };
-    return mesh_map::linearCombineBarycentricCoords(costs, barycentric_coords);
+    const float cost = costs.containsKey(vH) ? costs[vH] : default_value;
+    has_nan |= std::isnan(cost);
+    in_range &= layer_costs.set(vH.idx(), cost);
   }
-  return std::numeric_limits<float>::quiet_NaN();
-}
-
-void MeshMap::publishDebugPoint(const Vector pos, const std_msgs::msg::ColorRGBA& color, const std::string& name)
-{
-  visualization_msgs::msg::Marker marker;
-  marker.header.frame_id = mapFrame();
-  marker.header.stamp = node->now();
-  marker.ns = name;
-  marker.id = 0;
-  marker.type = visualization_msgs::msg::Marker::SPHERE;
-  marker.action = visualization_msgs::msg::Marker::ADD;
-  geometry_msgs::msg::Vector3 scale;
-  scale.x = 0.05;
-  scale.y = 0.05;
-  scale.z = 0.05;
-  marker.scale = scale;
+  if (has_nan)
+    RCLCPP_ERROR_STREAM(node->get_logger(), "Layer \"" << layer.first << "\" contains NaN values!");
 
-  geometry_msgs::msg::Pose p;
-  p.position.x = pos.x;
-  p.position.y = pos.y;
-  p.position.z = pos.z;
-  marker.pose = p;
-  marker.color = color;
-  marker_pub->publish(marker);
+  // a quantized array can't represent costs beyond the range it has been fitted to
+  if (!in_range)
+  {
+    gatherLayerCosts(index);
+  }
 }
 
-void MeshMap::publishDebugFace(const lvr2::FaceHandle& face_handle, const std_msgs::msg::ColorRGBA& color,
-                               const std::string& name)
+void MeshMap::combineVertexCosts(const rclcpp::Time& map_stamp)
 {
-  const auto& vertices = mesh_ptr->getVerticesOfFace(face_handle);
-  visualization_msgs::msg::Marker marker;
-  marker.header.frame_id = mapFrame();
-  marker.header.stamp = node->now();
-  marker.ns = name;
-  marker.id = 0;
-  marker.type = visualization_msgs::msg::Marker::TRIANGLE_LIST;
-  marker.action = visualization_msgs::msg::Marker::ADD;
-  geometry_msgs::msg::Vector3 scale;
-  scale.x = 1.0;
-  scale.y = 1.0;
-  scale.z = 1.0;
-  marker.scale = scale;
+  MESH_MAP_SCOPED_TIMER("mesh_map.combine_vertex_costs");
+  RCLCPP_INFO_STREAM(node->get_logger(), "Combining costs...");
 
-  for (auto vertex : vertices)
+  layer_cost_arrays.resize(loaded_layers.size());
+  for (size_t i = 0; i < loaded_layers.size(); i++)
   {
-    auto& pos = mesh_ptr->getVertexPosition(vertex);
-    geometry_msgs::msg::Point p;
-    p.x = pos.x;
-    p.y = pos.y;
-    p.z = pos.z;
-    marker.points.push_back(p);
-    marker.colors.push_back(color);
+    gatherLayerCosts(i);
   }
-  marker_pub->publish(marker);
-}
 
-void MeshMap::publishVectorField(const std::string& name,
-                                 const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
-                                 const bool publish_face_vectors)
-{
-  publishVectorField(name, vector_map, vertex_costs, {}, publish_face_vectors);
-}
+  const size_t num_slots = mesh_ptr->nextVertexIndex();
 
-void MeshMap::publishCombinedVectorField()
-{
-  lvr2::DenseVertexMap<Vector> vertex_vectors;
-  lvr2::DenseFaceMap<Vector> face_vectors;
+  // keep the previous costs to record which vertices changed
+  std::vector<float> previous_costs;
+  previous_costs.swap(combined_costs);
+  combined_costs.assign(num_slots, 0);
 
-  vertex_vectors.reserve(mesh_ptr->nextVertexIndex());
-  face_vectors.reserve(mesh_ptr->nextFaceIndex());
+  // weighted sum of the contiguous layer arrays, the loops are free of branches to let the compiler vectorize them
+  const float factor = 1.0;
+  float* const combined = combined_costs.data();
+  size_t layer_costs_memory = 0;
+  for (const auto& layer_costs : layer_cost_arrays)
+  {
+    layer_costs.addTo(combined, factor);
+    layer_costs_memory += layer_costs.memoryUsage();
+  }
+  RCLCPP_DEBUG_STREAM(node->get_logger(), "The layer costs use " << layer_costs_memory / (1024 * 1024) << " MiB with "
+      << cost_storage_bits << " bits per vertex.");
 
-  for (const auto& [_, layer] : loaded_layers)
+  for (auto vH : lethals)
   {
-    lvr2::DenseFaceMap<uint8_t> vector_field_faces(mesh_ptr->nextFaceIndex(), 0);
-    auto opt_vec_map = layer->vectorMap();
-    if (!opt_vec_map)
-      continue;
+    combined_costs[vH.idx()] = std::numeric_limits<float>::infinity();
+  }
 
-    const auto& vecs = opt_vec_map.get();
-    for (auto vH : vecs)
+  // The edge weights only depend on the costs of their vertices and the layer factor. Thus, the changed vertices
+  // describe all changes, as long as the layer factor stays the same.
+  std::vector<lvr2::VertexHandle> changed;
+  const bool comparable = map_loaded && previous_costs.size() == combined_costs.size() &&
+                          combined_layer_factor == layer_factor;
+  if (comparable)
+  {
+    for (auto vH : mesh_ptr->vertices())
     {
-      auto opt_val = vertex_vectors.get(vH);
-      vertex_vectors.insert(vH, opt_val ? opt_val.get() + vecs[vH] : vecs[vH]);
-      for (auto fH : mesh_ptr->getFacesOfVertex(vH))
-        vector_field_faces[fH]++;
+      if (costChanged(previous_costs[vH.idx()], combined_costs[vH.idx()]))
+      {
+        changed.push_back(vH);
+      }
     }
+  }
 
-    for (auto fH : vector_field_faces)
+  RCLCPP_INFO_STREAM(node->get_logger(), "Layer weighting factor is: " << layer_factor);
+  {
+    // the readers only see the maps before or after the update
+    std::unique_lock<std::shared_mutex> lock(cost_mtx);
+    if (vertex_costs.numValues() != num_slots)
     {
-      if (vector_field_faces[fH] != 3)
-        continue;
+      vertex_costs = lvr2::DenseVertexMap<float>(num_slots, 0);
+    }
+    for (auto vH : mesh_ptr->vertices())
+    {
+      vertex_costs[vH] = combined_costs[vH.idx()];
+    }
 
-      const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
-      const auto& vertex_handles = mesh_ptr->getVerticesOfFace(fH);
-      mesh_map::Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
-      std::array<float, 3> barycentric_coords;
-      float dist;
-      if (mesh_map::projectedBarycentricCoords(center, vertices, barycentric_coords, dist))
+    for (size_t i = 0; i < topology_ptr->numEdgeSlots(); i++)
+    {
+      const lvr2::EdgeHandle eH(i);
+      if (topology_ptr->containsEdge(eH))
       {
-        auto opt_val = face_vectors.get(fH);
-        auto vec_at = layer->vectorAt(vertex_handles, barycentric_coords);
-        if (vec_at != Vector())
-        {
-          face_vectors.insert(fH, opt_val ? opt_val.get() + vec_at : vec_at);
-        }
+        updateEdgeWeight(eH);
       }
     }
+    recordCostChanges(comparable, std::move(changed));
   }
+
+  requestCostPublishing(COMBINED_COSTS_NAME, map_stamp, nullptr);
+
+  RCLCPP_INFO(node->get_logger(), "Successfully combined costs!");
 }
 
-void MeshMap::publishVectorField(const std::string& name,
-                                 const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
-                                 const lvr2::DenseVertexMap<float>& values,
-                                 const std::function<float(float)>& cost_function, const bool publish_face_vectors)
+void MeshMap::combineVertexCosts(const rclcpp::Time& map_stamp, const std::vector<lvr2::VertexHandle>& vertices)
 {
-  const auto mesh = this->mesh();
-  const auto& vertex_costs = vertexCosts();
-  const auto& face_normals = faceNormals();
+  MESH_MAP_SCOPED_TIMER("mesh_map.combine_vertex_costs.partial");
+  MESH_MAP_COUNT("mesh_map.combine_vertex_costs.partial.vertices", vertices.size());
+  if (combined_costs.size() != mesh_ptr->nextVertexIndex() || layer_cost_arrays.size() != loaded_layers.size() ||
+      combined_layer_factor != layer_factor)
+  {
+    combineVertexCosts(map_stamp);
+    return;
+  }
+
+  RCLCPP_INFO_STREAM(node->get_logger(), "Combining costs of " << vertices.size() << " vertices...");
+
+  const float factor = 1.0;
+  std::vector<lvr2::VertexHandle> changed;
+  for (const auto& vH : vertices)
+  {
+    float cost = 0;
+    for (const auto& layer_costs : layer_cost_arrays)
+    {
+      cost += factor * layer_costs[vH.idx()];
+    }
+    if (lethals.contains(vH))
+    {
+      cost = std::numeric_limits<float>::infinity();
+    }
+    // skips duplicates, as the cost is already updated
+    if (costChanged(combined_costs[vH.idx()], cost))
+    {
+      combined_costs[vH.idx()] = cost;
+      changed.push_back(vH);
+    }
+  }
+
+  {
+    // the readers only see the maps before or after the update
+    std::unique_lock<std::shared_mutex> lock(cost_mtx);
+    for (const auto& vH : changed)
+    {
+      vertex_costs[vH] = combined_costs[vH.idx()];
+    }
+
+    // the snapshot has no adjacency for broken vertices, they are invalid for the planners anyway
+    for (const auto& vH : changed)
+    {
+      for (const auto& eH : topology_ptr->edgesOfVertex(vH))
+      {
+        updateEdgeWeight(eH);
+      }
+    }
+    recordCostChanges(true, std::vector<lvr2::VertexHandle>(changed));
+  }
 
-  visualization_msgs::msg::Marker vector_field;
+  requestCostPublishing(COMBINED_COSTS_NAME, map_stamp, &changed);
 
-  geometry_msgs::msg::Pose pose;
-  pose.position.x = pose.position.y = pose.position.z = 0;
-  pose.orientation.x = pose.orientation.y = pose.orientation.z = 0;
-  pose.orientation.w = 1;
-  vector_field.pose = pose;
+  RCLCPP_INFO(node->get_logger(), "Successfully combined costs!");
+}
 
-  vector_field.type = visualization_msgs::msg::Marker::LINE_LIST;
-  vector_field.header.frame_id = mapFrame();
-  vector_field.header.stamp = node->now();
-  vector_field.ns = name;
-  vector_field.scale.x = 0.01;
-  vector_field.color.a = 1;
-  vector_field.id = 0;
+void MeshMap::updateEdgeWeight(const lvr2::EdgeHandle& eH)
+{
+  const auto& vertices = topology_ptr->verticesOfEdge(eH);
+  const float cost1 = combined_costs[vertices[0].idx()];
+  const float cost2 = combined_costs[vertices[1].idx()];
+  // Get the Riskiness for the current Edge (the maximum value from both
+  // Vertices)
+  if (layer_factor != 0 && !std::isinf(cost1) && !std::isinf(cost2))
+  {
+    float cost_diff = std::fabs(cost1 - cost2);
 
-  vector_field.colors.reserve(2 * vector_map.numValues());
-  vector_field.points.reserve(2 * vector_map.numValues());
+    float vertex_factor = layer_factor * cost_diff;
+    if (std::isnan(vertex_factor))
+      RCLCPP_INFO_STREAM(node->get_logger(), "NaN: v1:" << cost1 << " v2:" << cost2
+                                 << " vertex_factor:" << vertex_factor << " cost_diff:" << cost_diff);
+    edge_weights[eH] = edge_distances[eH] * (1 + vertex_factor);
+  }
+  else
+  {
+    // edge_weights[eH] = std::numeric_limits<float>::infinity();
+    edge_weights[eH] = edge_distances[eH];
+  }
+}
 
-  unsigned int cnt = 0;
-  unsigned int faces = 0;
+bool MeshMap::costChanged(const float previous, const float current)
+{
+  // infinite costs compare equal, NaN never does
+  return previous != current && !(std::isnan(previous) && std::isnan(current));
+}
 
-  lvr2::DenseFaceMap<uint8_t> vector_field_faces(mesh->numFaces(), 0);
-  std::set<lvr2::FaceHandle> complete_faces;
+void MeshMap::recordCostChanges(const bool comparable, std::vector<lvr2::VertexHandle>&& changed)
+{
+  std::lock_guard<std::mutex> lock(cost_history_mtx);
+  cost_revision++;
+  combined_layer_factor = layer_factor;
+  if (comparable)
+  {
+    cost_history.emplace_back(cost_revision, std::move(changed));
+    if (cost_history.size() > COST_HISTORY_SIZE)
+    {
+      cost_history.pop_front();
+      cost_history_begin = cost_history.front().first - 1;
+    }
+  }
+  else
+  {
+    cost_history.clear();
+    cost_history_begin = cost_revision;
+  }
+}
 
-  for (auto vH : vector_map)
+CostSnapshot::ConstPtr MeshMap::costSnapshot()
+{
   {
-    const auto& dir_vec = vector_map[vH];
-    const float len2 = dir_vec.length2();
-    if (len2 == 0 || !std::isfinite(len2))
+    // a current snapshot is returned without locking the costs, e.g. to a caller which holds sharedLock() and has
+    // pinned the snapshot with costSnapshot(costs_lock)
+    std::lock_guard<std::mutex> lock(cost_snapshot_mtx);
+    if (cost_snapshot && cost_snapshot->revision == costRevision())
     {
-      RCLCPP_DEBUG_STREAM_THROTTLE(node->get_logger(), *node->get_clock(), 300, "Found invalid direction vector in vector field \"" << name << "\". Ignoring it!");
-      continue;
+      return cost_snapshot;
     }
+  }
+  std::shared_lock<std::shared_mutex> costs_lock(cost_mtx);
+  return costSnapshot(costs_lock);
+}
+
+CostSnapshot::ConstPtr MeshMap::costSnapshot(const std::shared_lock<std::shared_mutex>& costs_lock)
+{
+  if (costs_lock.mutex() != &cost_mtx || !costs_lock.owns_lock())
+  {
+    throw std::runtime_error("Tried to take a cost snapshot without holding the lock of the costs");
+  }
+  // the revision only changes while the costs are locked exclusively
+  std::lock_guard<std::mutex> lock(cost_snapshot_mtx);
+  if (!cost_snapshot || cost_snapshot->revision != cost_revision)
+  {
+    auto snapshot = std::make_shared<CostSnapshot>();
+    snapshot->revision = cost_revision;
+    snapshot->vertex_costs = vertex_costs;
+    snapshot->edge_weights = edge_weights;
+    cost_snapshot = snapshot;
+  }
+  return cost_snapshot;
+}
 
-    auto u = mesh->getVertexPosition(vH);
-    auto v = u + dir_vec * 0.1;
+std::shared_lock<std::shared_mutex> MeshMap::sharedLock()
+{
+  return std::shared_lock<std::shared_mutex>(cost_mtx);
+}
 
-    u.z = u.z + 0.01;
-    v.z = v.z + 0.01;
+uint64_t MeshMap::costRevision()
+{
+  std::lock_guard<std::mutex> lock(cost_history_mtx);
+  return cost_revision;
+}
 
-    if (!std::isfinite(u.x) || !std::isfinite(u.y) || !std::isfinite(u.z) || !std::isfinite(v.x) ||
-        !std::isfinite(v.y) || !std::isfinite(v.z))
+bool MeshMap::changedVerticesSince(const uint64_t revision, std::vector<lvr2::VertexHandle>& changed)
+{
+  std::lock_guard<std::mutex> lock(cost_history_mtx);
+  changed.clear();
+  if (revision < cost_history_begin || revision > cost_revision)
+  {
+    return false;
+  }
+  for (const auto& entry : cost_history)
+  {
+    if (entry.first > revision)
     {
-      continue;
+      changed.insert(changed.end(), entry.second.begin(), entry.second.end());
     }
-    vector_field.points.push_back(toPoint(u));
-    vector_field.points.push_back(toPoint(v));
-
-    const float value = cost_function ? cost_function(values[vH]) : values[vH];
-    std_msgs::msg::ColorRGBA color = getRainbowColor(value);
-    vector_field.colors.push_back(color);
-    vector_field.colors.push_back(color);
+  }
+  return true;
+}
 
-    cnt++;
-    // vector.header.seq = cnt;
-    // vector.id = cnt++;
-    // vector_field.markers.push_back(vector);
-    try
+void MeshMap::findLethalByContours(const int& min_contour_size, std::set<lvr2::VertexHandle>& lethals)
+{
+  int size = lethals.size();
+  const auto boundary_ptr = boundary();
+  if (boundary_ptr)
+  {
+    for (size_t i = 0; i < boundary_ptr->numContours(); i++)
     {
-      for (auto fH : mesh->getFacesOfVertex(vH))
+      const auto contour = boundary_ptr->contour(i);
+      if (contour.size() > min_contour_size)
       {
-        if (++vector_field_faces[fH] == 3)
-        {
-          faces++;
-          complete_faces.insert(fH);
-        }
+        lethals.insert(contour.begin(), contour.end());
       }
     }
-    catch (lvr2::PanicException exception)
+  }
+  RCLCPP_INFO_STREAM(node->get_logger(), "Found " << lethals.size() - size << " lethal vertices as contour vertices");
+}
+
+void MeshMap::findLethalByContours(const int& min_contour_size, VertexBitset& lethals)
+{
+  const auto boundary_ptr = boundary();
+  if (!boundary_ptr)
+  {
+    return;
+  }
+  for (size_t i = 0; i < boundary_ptr->numContours(); i++)
+  {
+    const auto contour = boundary_ptr->contour(i);
+    if (contour.size() > min_contour_size)
+    {
+      lethals.insert(contour.begin(), contour.end());
+    }
+  }
+}
+
+void MeshMap::findContours(std::vector<std::vector<lvr2::VertexHandle>>& contours, int min_contour_size)
+{
+  const auto boundary_ptr = boundary();
+  if (!boundary_ptr)
+  {
+    return;
+  }
+  for (size_t i = 0; i < boundary_ptr->numContours(); i++)
+  {
+    const auto contour = boundary_ptr->contour(i);
+    if (contour.size() > min_contour_size)
+    {
+      contours.emplace_back(contour.begin(), contour.end());
+    }
+  }
+  RCLCPP_INFO_STREAM(node->get_logger(), "Found " << contours.size() << " contours.");
+}
+
+void MeshMap::setVectorField(const VectorField::Ptr& vector_field)
+{
+  std::lock_guard<std::mutex> lock(vector_field_mtx);
+  vector_field->version = ++vector_field_version;
+  this->vector_field = vector_field;
+}
+
+VectorField::ConstPtr MeshMap::vectorField()
+{
+  std::lock_guard<std::mutex> lock(vector_field_mtx);
+  return vector_field;
+}
+
+boost::optional<Vector> MeshMap::directionAtPosition(
+    const lvr2::VertexMap<lvr2::BaseVector<float>>& vector_map,
+    const std::array<lvr2::VertexHandle, 3>& vertices,
+    const std::array<float, 3>& barycentric_coords)
+{
+  const auto& a = vector_map.get(vertices[0]);
+  const auto& b = vector_map.get(vertices[1]);
+  const auto& c = vector_map.get(vertices[2]);
+
+  if (a || b || c)
+  {
+    lvr2::BaseVector<float> vec;
+    if (a) vec += a.get() * barycentric_coords[0];
+    if (b) vec += b.get() * barycentric_coords[1];
+    if (c) vec += c.get() * barycentric_coords[2];
+    if (std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z))
+      return vec;
+    else
+      RCLCPP_ERROR_THROTTLE(node->get_logger(), *node->get_clock(), 300, "vector map contains invalid vectors!");
+  }
+  else
+  {
+    RCLCPP_ERROR_THROTTLE(node->get_logger(), *node->get_clock(), 300, "vector map does not contain any of the corresponding vectors");
+  }
+  return boost::none;
+}
+
+float MeshMap::costAtPosition(const std::array<lvr2::VertexHandle, 3>& vertices,
+                              const std::array<float, 3>& barycentric_coords)
+{
+  return costAtPosition(vertex_costs, vertices, barycentric_coords);
+}
+
+float MeshMap::costAtPosition(const lvr2::DenseVertexMap<float>& costs,
+                              const std::array<lvr2::VertexHandle, 3>& vertices,
+                              const std::array<float, 3>& barycentric_coords)
+{
+  const auto& a = costs.get(vertices[0]);
+  const auto& b = costs.get(vertices[1]);
+  const auto& c = costs.get(vertices[2]);
+
+  if (a && b && c)
+  {
+    std::array<float, 3> costs = { a.get(), b.get(), c.get() };
+    return mesh_map::linearCombineBarycentricCoords(costs, barycentric_coords);
+  }
+  return std::numeric_limits<float>::quiet_NaN();
+}
+
+float MeshMap::costAtPosition(const CostArray& costs, const std::array<lvr2::VertexHandle, 3>& vertices,
+                              const std::array<float, 3>& barycentric_coords)
+{
+  for (const auto& vH : vertices)
+  {
+    if (vH.idx() >= costs.size())
+    {
+      return std::numeric_limits<float>::quiet_NaN();
+    }
+  }
+  const std::array<float, 3> corner_costs = { costs[vertices[0].idx()], costs[vertices[1].idx()],
+                                              costs[vertices[2].idx()] };
+  return mesh_map::linearCombineBarycentricCoords(corner_costs, barycentric_coords);
+}
+
+void MeshMap::queryCosts(const std::vector<Vector>& positions, const float footprint_radius, const float max_dist,
+                         std::vector<PoseCost>& results)
+{
+  results.assign(positions.size(), PoseCost());
+
+  const auto locator = faceLocator();
+  if (!locator || !map_loaded)
+  {
+    return;
+  }
+  const auto& topology = locator->topology();
+  const auto snapshot = costSnapshot();
+  const auto& costs = snapshot->vertex_costs;
+
+  // the buffers are shared by all queries of the batch
+  FaceLocation location;
+  const size_t num_samples = footprint_radius > 0 ? FOOTPRINT_SAMPLES : 0;
+  std::vector<Vector> offsets;
+  offsets.reserve(num_samples);
+
+  lvr2::OptionalFaceHandle previous_face;
+  for (size_t i = 0; i < positions.size(); i++)
+  {
+    PoseCost& result = results[i];
+    const Vector& pos = positions[i];
+
+    if (!locator->locate(pos, previous_face, footprint_radius, max_dist, location))
+    {
+      continue;
+    }
+    const lvr2::FaceHandle face = location.face;
+    result.face = previous_face = lvr2::OptionalFaceHandle(face);
+
+    // the circle around the position in the tangent plane of its face
+    offsets.clear();
+    if (num_samples > 0)
+    {
+      const Normal& normal = face_normals[face];
+      const Vector axis = std::fabs(normal.x) < 0.9 ? Vector(1, 0, 0) : Vector(0, 1, 0);
+      const Vector u = normal.cross(axis).normalized();
+      const Vector v = normal.cross(u).normalized();
+      for (size_t k = 0; k < num_samples; k++)
+      {
+        const float angle = 2 * M_PI * k / num_samples;
+        offsets.push_back((u * std::cos(angle) + v * std::sin(angle)) * footprint_radius);
+      }
+    }
+
+    const auto addSample = [&]() {
+      // lethal corners are infinite, corners without weight must not turn the interpolation into NaN
+      const auto& vertices = topology->verticesOfFace(location.face);
+      float cost = 0;
+      bool lethal = false, unknown = false;
+      for (size_t j = 0; j < 3; j++)
+      {
+        const float weight = location.bary_coords[j];
+        if (weight == 0)
+        {
+          continue;
+        }
+        const auto& opt_cost = costs.get(vertices[j]);
+        const float corner_cost = opt_cost ? opt_cost.get() : std::numeric_limits<float>::quiet_NaN();
+        if (std::isnan(corner_cost))
+        {
+          unknown = true;
+        }
+        else if (!std::isfinite(corner_cost))
+        {
+          lethal = true;
+        }
+        else
+        {
+          cost += weight * corner_cost;
+        }
+      }
+      if (lethal)
+      {
+        result.num_lethal++;
+      }
+      else if (unknown)
+      {
+        result.num_unknown++;
+      }
+      else
+      {
+        result.cost += cost;
+        result.max_cost = std::max(result.max_cost, cost);
+      }
+    };
+
+    addSample();
+    for (const auto& offset : offsets)
+    {
+      // the samples are close to the position, its face is a good hint
+      if (locator->locate(pos + offset, result.face, footprint_radius, max_dist, location))
+      {
+        addSample();
+      }
+      else
+      {
+        result.num_unknown++;
+      }
+    }
+
+    if (result.num_unknown > 0)
+    {
+      result.state = PoseCost::UNKNOWN;
+    }
+    else if (result.num_lethal > 0)
+    {
+      result.state = PoseCost::LETHAL;
+    }
+    else
+    {
+      result.state = PoseCost::FREE;
+    }
+  }
+}
+
+void MeshMap::publishDebugPoint(const Vector pos, const std_msgs::msg::ColorRGBA& color, const std::string& name)
+{
+  visualization_msgs::msg::Marker marker;
+  marker.header.frame_id = mapFrame();
+  marker.header.stamp = node->now();
+  marker.ns = name;
+  marker.id = 0;
+  marker.type = visualization_msgs::msg::Marker::SPHERE;
+  marker.action = visualization_msgs::msg::Marker::ADD;
+  geometry_msgs::msg::Vector3 scale;
+  scale.x = 0.05;
+  scale.y = 0.05;
+  scale.z = 0.05;
+  marker.scale = scale;
+
+  geometry_msgs::msg::Pose p;
+  p.position.x = pos.x;
+  p.position.y = pos.y;
+  p.position.z = pos.z;
+  marker.pose = p;
+  marker.color = color;
+  marker_pub->publish(marker);
+}
+
+void MeshMap::publishDebugFace(const lvr2::FaceHandle& face_handle, const std_msgs::msg::ColorRGBA& color,
+                               const std::string& name)
+{
+  const auto& vertices = mesh_ptr->getVerticesOfFace(face_handle);
+  visualization_msgs::msg::Marker marker;
+  marker.header.frame_id = mapFrame();
+  marker.header.stamp = node->now();
+  marker.ns = name;
+  marker.id = 0;
+  marker.type = visualization_msgs::msg::Marker::TRIANGLE_LIST;
+  marker.action = visualization_msgs::msg::Marker::ADD;
+  geometry_msgs::msg::Vector3 scale;
+  scale.x = 1.0;
+  scale.y = 1.0;
+  scale.z = 1.0;
+  marker.scale = scale;
+
+  for (auto vertex : vertices)
+  {
+    auto& pos = mesh_ptr->getVertexPosition(vertex);
+    geometry_msgs::msg::Point p;
+    p.x = pos.x;
+    p.y = pos.y;
+    p.z = pos.z;
+    marker.points.push_back(p);
+    marker.colors.push_back(color);
+  }
+  marker_pub->publish(marker);
+}
+
+void MeshMap::publishVectorField(const std::string& name,
+                                 const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
+                                 const bool publish_face_vectors)
+{
+  publishVectorField(name, vector_map, vertex_costs, {}, publish_face_vectors);
+}
+
+void MeshMap::publishCombinedVectorField()
+{
+  const auto samples = vectorFieldSamples();
+  if (!samples)
+  {
+    return;
+  }
+  const bool subscribed = hasVectorFieldSubscribers();
+
+  // the vector maps of the layers are summed up at the samples only
+  lvr2::DenseVertexMap<Vector> vertex_vectors;
+  lvr2::DenseFaceMap<Vector> face_vectors;
+  for (const auto& [_, layer] : loaded_layers)
+  {
+    auto opt_vec_map = layer->vectorMap();
+    if (!opt_vec_map)
+      continue;
+
+    const auto& vecs = opt_vec_map.get();
+    for (const auto& vH : samples->vertices)
+    {
+      const auto vec = vecs.get(vH);
+      if (!vec)
+        continue;
+      auto opt_val = vertex_vectors.get(vH);
+      vertex_vectors.insert(vH, opt_val ? opt_val.get() + vec.get() : vec.get());
+    }
+
+    for (const auto& fH : samples->faces)
+    {
+      const auto& vertex_handles = mesh_ptr->getVerticesOfFace(fH);
+      if (!vecs.get(vertex_handles[0]) || !vecs.get(vertex_handles[1]) || !vecs.get(vertex_handles[2]))
+        continue;
+      const auto vec_at = layer->vectorAt(vertex_handles, { 1.0f / 3, 1.0f / 3, 1.0f / 3 });
+      if (vec_at != Vector())
+      {
+        auto opt_val = face_vectors.get(fH);
+        face_vectors.insert(fH, opt_val ? opt_val.get() + vec_at : vec_at);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(pending_vector_fields_mtx);
+  auto& pending = pending_vector_fields["combined"];
+  pending.pending = subscribed;
+  pending.deferred = !subscribed;
+  pending.stamp = node->now();
+  pending.points.clear();
+  pending.values.clear();
+  for (const auto vH : vertex_vectors)
+  {
+    const auto u = mesh_ptr->getVertexPosition(vH);
+    pending.points.push_back(u);
+    pending.points.push_back(u + vertex_vectors[vH] * 0.1);
+    pending.values.push_back(vertex_costs[vH]);
+  }
+  for (const auto fH : face_vectors)
+  {
+    const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
+    const auto& vertex_handles = mesh_ptr->getVerticesOfFace(fH);
+    const Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
+    pending.points.push_back(center);
+    pending.points.push_back(center + face_vectors[fH] * 0.1);
+    pending.values.push_back(costAtPosition(vertex_costs, vertex_handles, { 1.0f / 3, 1.0f / 3, 1.0f / 3 }));
+  }
+  if (subscribed)
+  {
+    pending_vector_fields_cv.notify_one();
+  }
+}
+
+void MeshMap::publishVectorField(const std::string& name,
+                                 const lvr2::DenseVertexMap<lvr2::BaseVector<float>>& vector_map,
+                                 const lvr2::DenseVertexMap<float>& values,
+                                 const std::function<float(float)>& cost_function, const bool publish_face_vectors)
+{
+  const auto samples = vectorFieldSamples();
+  if (!samples)
+  {
+    return;
+  }
+  const bool subscribed = hasVectorFieldSubscribers();
+
+  auto isFinite = [](const Vector& vec) {
+    return std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z);
+  };
+
+  std::lock_guard<std::mutex> lock(pending_vector_fields_mtx);
+  auto& pending = pending_vector_fields[name];
+  pending.pending = subscribed;
+  pending.deferred = !subscribed;
+  pending.stamp = node->now();
+  pending.points.clear();
+  pending.values.clear();
+
+  for (const auto& vH : samples->vertices)
+  {
+    const auto dir_vec = vector_map.get(vH);
+    if (!dir_vec)
+    {
+      continue;
+    }
+    const float len2 = dir_vec.get().length2();
+    if (len2 == 0 || !std::isfinite(len2))
+    {
+      RCLCPP_DEBUG_STREAM_THROTTLE(node->get_logger(), *node->get_clock(), 300, "Found invalid direction vector in vector field \"" << name << "\". Ignoring it!");
+      continue;
+    }
+
+    auto u = mesh_ptr->getVertexPosition(vH);
+    auto v = u + dir_vec.get() * 0.1;
+    u.z = u.z + 0.01;
+    v.z = v.z + 0.01;
+    if (!isFinite(u) || !isFinite(v))
+    {
+      continue;
+    }
+    pending.points.push_back(u);
+    pending.points.push_back(v);
+    pending.values.push_back(cost_function ? cost_function(values[vH]) : values[vH]);
+  }
+  const size_t num_vertex_vectors = pending.values.size();
+
+  if (publish_face_vectors)
+  {
+    // only faces with vectors at all vertices, the center has equal barycentric coordinates
+    const std::array<float, 3> barycentric_coords = { 1.0f / 3, 1.0f / 3, 1.0f / 3 };
+    for (const auto& fH : samples->faces)
+    {
+      const auto& vertex_handles = mesh_ptr->getVerticesOfFace(fH);
+      if (!vector_map.get(vertex_handles[0]) || !vector_map.get(vertex_handles[1]) ||
+          !vector_map.get(vertex_handles[2]))
+      {
+        continue;
+      }
+      boost::optional<mesh_map::Vector> dir_opt = directionAtPosition(vector_map, vertex_handles, barycentric_coords);
+      if (!dir_opt)
+      {
+        continue;
+      }
+
+      const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
+      const Vector u = (vertices[0] + vertices[1] + vertices[2]) / 3;
+      const Vector v = u + dir_opt.get() * 0.1;
+      if (!isFinite(u) || !isFinite(v))
+      {
+        continue;
+      }
+      const float cost = costAtPosition(values, vertex_handles, barycentric_coords);
+      pending.points.push_back(u);
+      pending.points.push_back(v);
+      pending.values.push_back(cost_function ? cost_function(cost) : cost);
+    }
+  }
+  if (subscribed)
+  {
+    pending_vector_fields_cv.notify_one();
+  }
+
+  RCLCPP_DEBUG_STREAM(node->get_logger(), "Sampled vector field \"" << name << "\" with " << num_vertex_vectors
+      << " vertex and " << pending.values.size() - num_vertex_vectors << " face vectors.");
+}
+
+bool MeshMap::hasVectorFieldSubscribers() const
+{
+  return vector_field_pub->get_subscription_count() + vector_field_pub->get_intra_process_subscription_count() > 0;
+}
+
+void MeshMap::checkVectorFieldSubscribers()
+{
+  const size_t subscribers =
+      vector_field_pub->get_subscription_count() + vector_field_pub->get_intra_process_subscription_count();
+  std::lock_guard<std::mutex> lock(pending_vector_fields_mtx);
+  if (subscribers > vector_field_subscribers)
+  {
+    for (auto& [_, vector_field] : pending_vector_fields)
+    {
+      if (vector_field.deferred)
+      {
+        vector_field.pending = true;
+        vector_field.deferred = false;
+      }
+    }
+    republish_vector_fields = true;
+    pending_vector_fields_cv.notify_one();
+  }
+  vector_field_subscribers = subscribers;
+}
+
+void MeshMap::publishPendingVectorFields()
+{
+  std::map<std::string, visualization_msgs::msg::Marker> markers;
+  PendingVectorField vector_field;
+  while (true)
+  {
+    std::string name;
+    std::vector<std::string> republish;
+    {
+      std::unique_lock<std::mutex> lock(pending_vector_fields_mtx);
+      pending_vector_fields_cv.wait(lock, [&]() {
+        return stop_vector_field_thread || republish_vector_fields ||
+               std::any_of(pending_vector_fields.begin(), pending_vector_fields.end(),
+                           [](const auto& entry) { return entry.second.pending; });
+      });
+      if (stop_vector_field_thread)
+      {
+        return;
+      }
+      if (republish_vector_fields)
+      {
+        // the markers which are not rebuilt anyway
+        republish_vector_fields = false;
+        for (const auto& [marker_name, _] : markers)
+        {
+          if (!pending_vector_fields[marker_name].pending)
+          {
+            republish.push_back(marker_name);
+          }
+        }
+      }
+    }
+
+    for (const auto& marker_name : republish)
+    {
+      vector_field_pub->publish(markers[marker_name]);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(pending_vector_fields_mtx);
+      auto iter = std::find_if(pending_vector_fields.begin(), pending_vector_fields.end(),
+                               [](const auto& entry) { return entry.second.pending; });
+      if (iter == pending_vector_fields.end())
+      {
+        continue;
+      }
+      // the next request of this name fills the buffers of the previous one
+      name = iter->first;
+      std::swap(vector_field, iter->second);
+      iter->second.pending = false;
+      iter->second.deferred = false;
+    }
+
+    auto& marker = markers[name];
+    if (marker.ns.empty())
+    {
+      marker.pose.orientation.w = 1;
+      marker.type = visualization_msgs::msg::Marker::LINE_LIST;
+      marker.ns = name;
+      marker.scale.x = 0.01;
+      marker.color.a = 1;
+      marker.id = 0;
+    }
+    marker.header.frame_id = mapFrame();
+    marker.header.stamp = vector_field.stamp;
+    marker.points.resize(vector_field.points.size());
+    marker.colors.resize(vector_field.points.size());
+    for (size_t i = 0; i < vector_field.values.size(); i++)
+    {
+      marker.points[2 * i] = toPoint(vector_field.points[2 * i]);
+      marker.points[2 * i + 1] = toPoint(vector_field.points[2 * i + 1]);
+      marker.colors[2 * i] = marker.colors[2 * i + 1] = getRainbowColor(vector_field.values[i]);
+    }
+    vector_field_pub->publish(marker);
+    RCLCPP_DEBUG_STREAM(node->get_logger(), "Published vector field \"" << name << "\" with " << vector_field.values.size()
+                                            << " elements.");
+  }
+}
+
+bool MeshMap::inTriangle(const Vector& pos, const lvr2::FaceHandle& face, const float& dist)
+{
+  const auto& vertices = mesh_ptr->getVerticesOfFace(face);
+  return mesh_map::inTriangle(pos, mesh_ptr->getVertexPosition(vertices[0]), mesh_ptr->getVertexPosition(vertices[1]),
+                              mesh_ptr->getVertexPosition(vertices[2]), dist, 0.0001);
+}
+
+boost::optional<std::tuple<lvr2::FaceHandle, std::array<Vector, 3>, std::array<float, 3>>>
+  MeshMap::searchNeighbourFaces(
+    const Vector& pos, const lvr2::FaceHandle& face,
+    const float& max_radius, const float& max_dist)
+{
+  const auto locator = faceLocator();
+  if (!locator)
+  {
+    return boost::none;
+  }
+  FaceLocation location;
+  const uint64_t visited_before = locator->numVisitedFaces();
+  // the walk is the cheap case, the breadth first search also finds positions behind holes and boundaries
+  const bool found = locator->walk(pos, face, max_dist, location) ||
+                     locator->searchAround(pos, face, max_radius, max_dist, location);
+  MESH_MAP_COUNT("mesh_map.search_neighbour_faces.faces_searched", locator->numVisitedFaces() - visited_before);
+  if (found)
+  {
+    return std::make_tuple(location.face, location.vertices, location.bary_coords);
+  }
+  return boost::none;
+}
+
+bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size)
+{
+  const auto field = vectorField();
+  if (!field)
+  {
+    return false;
+  }
+  return meshAhead(pos, face, step_size, *field);
+}
+
+bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size,
+                        const VectorField& field)
+{
+  std::array<float, 3> bary_coords;
+  float dist;
+  // get barycentric coordinates of the current face or the next neighbour face
+  if (mesh_map::projectedBarycentricCoords(pos, mesh_ptr->getVertexPositionsOfFace(face), bary_coords, dist))
+  {
+
+  }
+  else if (auto search_res_opt = searchNeighbourFaces(pos, face, step_size, 0.4))
+  {
+    auto search_res = *search_res_opt;
+    face = std::get<0>(search_res);
+    std::array<Vector, 3> vertices = std::get<1>(search_res);
+    bary_coords = std::get<2>(search_res);
+
+    // project position onto surface
+    pos = mesh_map::linearCombineBarycentricCoords(vertices, bary_coords);
+  }
+  else
+  {
+    return false;
+  }
+  const auto& opt_dir = directionAtPosition(field.vectors, mesh_ptr->getVerticesOfFace(face), bary_coords);
+  if (opt_dir)
+  {
+    Vector dir = opt_dir.get().normalized();
+    std::array<lvr2::VertexHandle, 3> handels = mesh_ptr->getVerticesOfFace(face);
+    // iter over all layer vector fields
+    for (auto layer : loaded_layers)
+    {
+      dir += layer.second->vectorAt(handels, bary_coords);
+    }
+    dir.normalize();
+    pos += dir * step_size;
+    return true;
+  }
+  return false;
+}
+
+lvr2::OptionalFaceHandle MeshMap::getContainingFace(Vector& position, const float& max_dist)
+{
+  auto search_result = searchContainingFace(position, max_dist);
+  if(search_result)
+  {
+    return std::get<0>(*search_result);
+  }
+  return lvr2::OptionalFaceHandle();
+}
+
+boost::optional<std::tuple<           // returns:
+    lvr2::FaceHandle,                 // -> face handle
+    std::array<mesh_map::Vector, 3>,  // -> closest face vertices (why no handles?)
+    std::array<float, 3>              // -> barycentric coords on closest face
+    >> MeshMap::searchContainingFace( // inputs:
+      Vector& query_point,            // -> query point
+      const float& max_dist)          // -> maximum search radius around query point
+{
+  const auto locator = faceLocator();
+  if (!locator)
+  {
+    RCLCPP_FATAL_STREAM(node->get_logger(), "Could not find the nearest vertex");
+    return boost::none;
+  }
+  FaceLocation location;
+  if (locator->searchNearest(query_point, max_dist, location))
+  {
+    return std::make_tuple(location.face, location.vertices, location.bary_coords);
+  }
+  RCLCPP_ERROR_STREAM(node->get_logger(), "No containing face found!");
+  return boost::none;
+}
+
+FaceLocator::Ptr MeshMap::createFaceLocator()
+{
+  if (!topology_ptr || !kd_tree_ptr)
+  {
+    return FaceLocator::Ptr();
+  }
+  return std::make_shared<FaceLocator>(
+      mesh_ptr, topology_ptr,
+      [this](const Vector& pos, const size_t k, std::vector<lvr2::VertexHandle>& vertices) {
+        thread_local std::vector<float> squared_distances;
+        return knnSearch(pos, k, vertices, squared_distances);
+      });
+}
+
+FaceLocator::Ptr MeshMap::faceLocator()
+{
+  // the locator keeps the topology it has been created for, thus a new topology is never mistaken for the old one
+  thread_local FaceLocator::Ptr locator;
+  if (!locator || locator->topology() != topology_ptr)
+  {
+    locator = createFaceLocator();
+  }
+  return locator;
+}
+
+FaceBVH::ConstPtr MeshMap::faceBVH()
+{
+  std::lock_guard<std::mutex> lock(face_bvh_mtx);
+  if (!face_bvh_ptr && mesh_ptr)
+  {
+    const auto t_start = std::chrono::steady_clock::now();
+    face_bvh_ptr = std::make_shared<const FaceBVH>(*mesh_ptr);
+    const auto duration_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start);
+    RCLCPP_INFO_STREAM(node->get_logger(), "The face BVH has been built in " << duration_ms.count() << " ms with "
+        << face_bvh_ptr->numNodes() << " nodes using " << face_bvh_ptr->memoryUsage() / (1024 * 1024) << " MiB.");
+  }
+  return face_bvh_ptr;
+}
+
+CoarseGraph::ConstPtr MeshMap::coarseGraph(const float cell_size)
+{
+  std::lock_guard<std::mutex> lock(coarse_graph_mtx);
+  if (!mesh_ptr || !topology_ptr)
+  {
+    return CoarseGraph::ConstPtr();
+  }
+  if (coarse_graph_ptr && coarse_graph_ptr->cellSize() == cell_size)
+  {
+    return coarse_graph_ptr;
+  }
+
+  {
+    auto file_lock = persistence_queue->lockFile();
+    lvr2::UCharChannelOptional channel_opt;
+    if (mesh_io_ptr->getChannel("mesh_map", "coarse_graph", channel_opt) && channel_opt)
+    {
+      coarse_graph_ptr = CoarseGraph::deserialize(channel_opt->dataPtr().get(),
+                                                  channel_opt->numElements() * channel_opt->width(), mesh_hash);
+    }
+  }
+  if (coarse_graph_ptr && coarse_graph_ptr->cellSize() == cell_size &&
+      coarse_graph_ptr->numVertexSlots() == topology_ptr->numVertexSlots())
+  {
+    RCLCPP_INFO_STREAM(node->get_logger(), "The coarse graph with " << coarse_graph_ptr->numNodes()
+        << " nodes has been loaded from the map file.");
+    return coarse_graph_ptr;
+  }
+
+  const auto t_start = std::chrono::steady_clock::now();
+  coarse_graph_ptr = std::make_shared<const CoarseGraph>(*mesh_ptr, *topology_ptr, cell_size);
+  RCLCPP_INFO_STREAM(node->get_logger(), "The coarse graph has been built in "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start).count()
+      << " ms with " << coarse_graph_ptr->numNodes() << " nodes for a cell size of " << cell_size << " m.");
+
+  std::vector<unsigned char> data;
+  coarse_graph_ptr->serialize(mesh_hash, data);
+  lvr2::UCharChannel channel(data.size(), 1);
+  std::memcpy(channel.dataPtr().get(), data.data(), data.size());
+  persistence_queue->enqueue("coarse_graph", [this, channel]() {
+    return mesh_io_ptr->addChannel("mesh_map", "coarse_graph", channel);
+  });
+  return coarse_graph_ptr;
+}
+
+lvr2::OptionalVertexHandle MeshMap::getNearestVertexHandle(const Vector& pos)
+{
+  float querry_point[3] = {pos.x, pos.y, pos.z};
+  size_t ret_index;
+  float out_dist_sqr;
+
+  if(!kd_tree_ptr)
+  {
+    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
+  }
+
+  size_t num_results = kd_tree_ptr->knnSearch(&querry_point[0], 1, &ret_index, &out_dist_sqr);
+  return num_results == 0 ? lvr2::OptionalVertexHandle() : adaptor_ptr->vertexHandle(ret_index);
+}
+
+//! identifies the k-d tree blob in the map file, followed by the nanoflann version and the mesh hash
+static const uint32_t KD_TREE_MAGIC = 0x444b4d4d;
+
+bool MeshMap::loadKdTree()
+{
+  lvr2::UCharChannelOptional channel_opt;
+  {
+    auto file_lock = persistence_queue->lockFile();
+    if (!mesh_io_ptr->getChannel("mesh_map", "kd_tree", channel_opt) || !channel_opt)
+    {
+      return false;
+    }
+  }
+
+  const unsigned char* data = channel_opt->dataPtr().get();
+  const size_t size = channel_opt->numElements() * channel_opt->width();
+  const size_t header_size = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+  if (size <= header_size)
+  {
+    return false;
+  }
+
+  uint32_t magic, version;
+  uint64_t hash;
+  std::memcpy(&magic, data, sizeof(magic));
+  std::memcpy(&version, data + sizeof(magic), sizeof(version));
+  std::memcpy(&hash, data + 2 * sizeof(uint32_t), sizeof(hash));
+  if (magic != KD_TREE_MAGIC || version != NANOFLANN_VERSION || hash != mesh_hash)
+  {
+    RCLCPP_INFO_STREAM(node->get_logger(), "The k-d tree in the map file does not belong to the current mesh.");
+    return false;
+  }
+
+  FILE* stream = fmemopen(const_cast<unsigned char*>(data + header_size), size - header_size, "rb");
+  if (!stream)
+  {
+    return false;
+  }
+
+  bool loaded = true;
+  try
+  {
+    kd_tree_ptr->loadIndex(stream);
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_WARN_STREAM(node->get_logger(), "Could not read the k-d tree from the map file: " << e.what());
+    loaded = false;
+  }
+  fclose(stream);
+
+  // the index refers to the points of the adaptor, it must not contain any index beyond them
+  const size_t num_points = adaptor_ptr->kdtree_get_point_count();
+  if (loaded && (kd_tree_ptr->m_size != num_points || kd_tree_ptr->vind.size() != num_points ||
+                 std::any_of(kd_tree_ptr->vind.begin(), kd_tree_ptr->vind.end(),
+                             [num_points](const size_t idx) { return idx >= num_points; })))
+  {
+    RCLCPP_WARN_STREAM(node->get_logger(), "The k-d tree in the map file is inconsistent with the current mesh.");
+    loaded = false;
+  }
+
+  if (!loaded)
+  {
+    // start with a fresh tree, the failed load might have left a partial one behind
+    kd_tree_ptr = std::make_unique<KDTree>(3, *adaptor_ptr, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+  }
+  return loaded;
+}
+
+bool MeshMap::saveKdTree()
+{
+  char* buffer = nullptr;
+  size_t buffer_size = 0;
+  FILE* stream = open_memstream(&buffer, &buffer_size);
+  if (!stream)
+  {
+    return false;
+  }
+  kd_tree_ptr->saveIndex(stream);
+  fclose(stream);
+
+  const uint32_t version = NANOFLANN_VERSION;
+  const size_t header_size = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+  lvr2::UCharChannel channel(header_size + buffer_size, 1);
+  unsigned char* data = channel.dataPtr().get();
+  std::memcpy(data, &KD_TREE_MAGIC, sizeof(KD_TREE_MAGIC));
+  std::memcpy(data + sizeof(uint32_t), &version, sizeof(version));
+  std::memcpy(data + 2 * sizeof(uint32_t), &mesh_hash, sizeof(mesh_hash));
+  std::memcpy(data + header_size, buffer, buffer_size);
+  free(buffer);
+
+  persistence_queue->enqueue("kd_tree", [this, channel]() {
+    return mesh_io_ptr->addChannel("mesh_map", "kd_tree", channel);
+  });
+  return true;
+}
+
+lvr2::MeshBufferPtr MeshMap::extractResidentTiles(const lvr2::MeshBufferPtr& mesh_buffer, bool& save_tiling)
+{
+  if (!std::dynamic_pointer_cast<HDF5MeshIO>(mesh_io_ptr))
+  {
+    RCLCPP_WARN_STREAM(node->get_logger(), "The attributes of the resident tiles can only be kept apart from the full "
+                                           "mesh in a HDF5 working file, the whole mesh is loaded.");
+    return mesh_buffer;
+  }
+  accessWorkingPart([&]() {
+    lvr2::UCharChannelOptional channel_opt;
+    if (mesh_io_ptr->getChannel("mesh_map", "tiles", channel_opt) && channel_opt)
     {
-      invalid.insert(vH, true);
+      tiling_ptr = MeshTiling::deserialize(channel_opt->dataPtr().get(),
+                                           channel_opt->numElements() * channel_opt->width());
     }
+    return true;
+  });
+  save_tiling = !tiling_ptr || !tiling_ptr->matches(*mesh_buffer, tile_size, tile_halo);
+  if (save_tiling)
+  {
+    const auto t_start = std::chrono::steady_clock::now();
+    tiling_ptr = std::make_shared<const MeshTiling>(*mesh_buffer, tile_size, tile_halo);
+    RCLCPP_INFO_STREAM(node->get_logger(), "The mesh has been split into " << tiling_ptr->numTiles() << " tiles in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start).count()
+        << " ms.");
   }
 
-  size_t invalid_cnt = 0;
-  for (auto vH : invalid)
+  const auto tiles = tiling_ptr->tilesAround(tile_center[0], tile_center[1], tile_radius);
+  auto resident_buffer = tiling_ptr->extract(*mesh_buffer, tiles, resident_vertex_ids);
+  if (!resident_buffer)
   {
-    if (invalid[vH])
-      invalid_cnt++;
+    RCLCPP_WARN_STREAM(node->get_logger(), "The tiles within " << tile_radius << " m around (" << tile_center[0]
+        << ", " << tile_center[1] << ") do not contain any face, the whole mesh is loaded.");
+    return mesh_buffer;
   }
+  setAttributePart(residentPart(tiles));
+  RCLCPP_INFO_STREAM(node->get_logger(), tiles.size() << " of " << tiling_ptr->numTiles() << " tiles are resident with "
+      << resident_buffer->numVertices() << " of " << mesh_buffer->numVertices() << " vertices, their attributes are "
+      << "kept in the mesh part '" << attribute_part << "'.");
+  return resident_buffer;
+}
 
-  if (invalid_cnt > 0)
+void MeshMap::saveTiling()
+{
+  std::vector<unsigned char> data;
+  tiling_ptr->serialize(data);
+  lvr2::UCharChannel channel(data.size(), 1);
+  std::memcpy(channel.dataPtr().get(), data.data(), data.size());
+  persistence_queue->enqueue("tiles", [this, channel]() {
+    return accessWorkingPart([&]() { return mesh_io_ptr->addChannel("mesh_map", "tiles", channel); });
+  });
+}
+
+std::string MeshMap::residentPart(const std::vector<uint32_t>& tiles) const
+{
+  const uint64_t fnv_offset = 14695981039346656037ULL;
+  const uint64_t fnv_prime = 1099511628211ULL;
+
+  // the tile indices only identify the same faces for the same tiling of the same mesh
+  uint64_t hash = fnv_offset;
+  auto combine = [&](const uint64_t value) { hash = (hash ^ value) * fnv_prime; };
+  auto combine_double = [&](const double value) {
+    uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    combine(word);
+  };
+  combine(tiling_ptr->contentHash());
+  combine_double(tile_size);
+  combine_double(tile_halo);
+  for (const auto tile : tiles)
   {
-    RCLCPP_WARN_STREAM(node->get_logger(), "Found " << invalid_cnt << " non manifold vertices!");
+    combine(tile);
   }
-  RCLCPP_INFO_STREAM(node->get_logger(), "Found " << faces << " complete vector faces!");
+  return mesh_working_part + "_tiles_" + hashToString(hash);
+}
 
-  if (publish_face_vectors)
+void MeshMap::setAttributePart(const std::string& part)
+{
+  auto file_lock = persistence_queue->lockFile();
+  attribute_part = part;
+  if (const auto hdf5_mesh_io = std::dynamic_pointer_cast<HDF5MeshIO>(mesh_io_ptr))
   {
-    vector_field.points.reserve(faces + cnt);
-
-    for (auto fH : complete_faces)
-    {
-      const auto& vertices = mesh->getVertexPositionsOfFace(fH);
-      const auto& vertex_handles = mesh->getVerticesOfFace(fH);
-      mesh_map::Vector center = (vertices[0] + vertices[1] + vertices[2]) / 3;
-      std::array<float, 3> barycentric_coords;
-      float dist;
-      if (mesh_map::projectedBarycentricCoords(center, vertices, barycentric_coords, dist))
-      {
-        boost::optional<mesh_map::Vector> dir_opt = directionAtPosition(vector_map, vertex_handles, barycentric_coords);
-        if (dir_opt)
-        {
-          const float& cost = costAtPosition(values, vertex_handles, barycentric_coords);
-          const float& value = cost_function ? cost_function(cost) : cost;
-
-          // vector.color = getRainbowColor(value);
-          // vector.pose = mesh_map::calculatePoseFromDirection(
-          //    center, dir_opt.get(), face_normals[fH]);
-
-          auto u = center;
-          auto v = u + dir_opt.get() * 0.1;
-
-          if (!std::isfinite(u.x) || !std::isfinite(u.y) || !std::isfinite(u.z) || !std::isfinite(v.x) ||
-              !std::isfinite(v.y) || !std::isfinite(v.z))
-          {
-            continue;
-          }
-
-          // vector_field.header.seq = cnt;
-          // vector_field.id = cnt++;
-          vector_field.points.push_back(toPoint(u));
-          vector_field.points.push_back(toPoint(v));
-
-          std_msgs::msg::ColorRGBA color = getRainbowColor(value);
-          vector_field.colors.push_back(color);
-          vector_field.colors.push_back(color);
-        }
-        else
-        {
-          RCLCPP_ERROR_STREAM_THROTTLE(node->get_logger(), *node->get_clock(), 300, "Could not compute the direction!");
-        }
-      }
-      else
-      {
-        RCLCPP_ERROR_STREAM_THROTTLE(node->get_logger(), *node->get_clock(), 300, "Could not compute the barycentric coords!");
-      }
-    }
+    hdf5_mesh_io->setMeshName(attribute_part);
   }
-  vector_field_pub->publish(vector_field);
-  RCLCPP_INFO_STREAM(node->get_logger(), "Published vector field \"" << name << "\" with " << cnt << " elements.");
 }
 
-bool MeshMap::inTriangle(const Vector& pos, const lvr2::FaceHandle& face, const float& dist)
+bool MeshMap::accessWorkingPart(const std::function<bool()>& access)
 {
-  const auto& vertices = mesh_ptr->getVerticesOfFace(face);
-  return mesh_map::inTriangle(pos, mesh_ptr->getVertexPosition(vertices[0]), mesh_ptr->getVertexPosition(vertices[1]),
-                              mesh_ptr->getVertexPosition(vertices[2]), dist, 0.0001);
+  // the lock keeps the writes of the persistence queue from running while the mesh-io points at the other part
+  auto file_lock = persistence_queue->lockFile();
+  const auto hdf5_mesh_io = std::dynamic_pointer_cast<HDF5MeshIO>(mesh_io_ptr);
+  if (!hdf5_mesh_io || attribute_part.empty() || attribute_part == mesh_working_part)
+  {
+    return access();
+  }
+  hdf5_mesh_io->setMeshName(mesh_working_part);
+  try
+  {
+    const bool result = access();
+    hdf5_mesh_io->setMeshName(attribute_part);
+    return result;
+  }
+  catch (...)
+  {
+    hdf5_mesh_io->setMeshName(attribute_part);
+    throw;
+  }
 }
 
-boost::optional<std::tuple<lvr2::FaceHandle, std::array<Vector, 3>, std::array<float, 3>>>
-  MeshMap::searchNeighbourFaces(
-    const Vector& pos, const lvr2::FaceHandle& face,
-    const float& max_radius, const float& max_dist)
+size_t MeshMap::radiusSearch(const Vector& pos, const float radius, std::vector<lvr2::VertexHandle>& vertices)
 {
-  std::list<lvr2::FaceHandle> possible_faces;
-  possible_faces.push_back(face);
-  std::list<lvr2::FaceHandle>::iterator face_iter = possible_faces.begin();
+  vertices.clear();
+  if(!kd_tree_ptr)
+  {
+    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
+  }
+
+  const float query_point[3] = {pos.x, pos.y, pos.z};
+  VertexRadiusResultSet result_set(radius * radius, *adaptor_ptr, vertices);
+  kd_tree_ptr->findNeighbors(result_set, &query_point[0], nanoflann::SearchParams(32, 0, false));
+  return result_set.size();
+}
 
-  Vector center(0, 0, 0);
-  const auto& start_vertices = mesh_ptr->getVertexPositionsOfFace(face);
-  for (auto vertex : start_vertices)
+void MeshMap::radiusSearch(const std::vector<Vector>& positions, const float radius, std::vector<uint32_t>& offsets,
+                           std::vector<lvr2::VertexHandle>& vertices)
+{
+  offsets.clear();
+  vertices.clear();
+  if(!kd_tree_ptr)
   {
-    center += vertex;
+    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
   }
-  center /= 3;
 
-  float vertex_center_max = 0;
-  for (auto vertex : start_vertices)
+  offsets.reserve(positions.size() + 1);
+  offsets.push_back(0);
+  for (const auto& pos : positions)
   {
-    vertex_center_max = std::max(vertex_center_max, vertex.distance(center));
+    const float query_point[3] = {pos.x, pos.y, pos.z};
+    VertexRadiusResultSet result_set(radius * radius, *adaptor_ptr, vertices);
+    kd_tree_ptr->findNeighbors(result_set, &query_point[0], nanoflann::SearchParams(32, 0, false));
+    offsets.push_back(vertices.size());
   }
+}
 
-  float ext_radius = max_radius + vertex_center_max;
-  float max_radius_sq = ext_radius * ext_radius;
+size_t MeshMap::knnSearch(const Vector& pos, const size_t k, std::vector<lvr2::VertexHandle>& vertices,
+                          std::vector<float>& squared_distances)
+{
+  vertices.clear();
+  squared_distances.clear();
+  if(!kd_tree_ptr)
+  {
+    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
+  }
 
-  lvr2::SparseFaceMap<bool> in_list_map;
-  in_list_map.insert(face, true);
+  if (k == 0)
+  {
+    return 0;
+  }
 
-  std::array<float, 3> bary_coords;
+  // the k-d tree reports point indices, keep the buffer for the conversion per thread
+  thread_local std::vector<size_t> indices;
+  indices.resize(k);
+  squared_distances.resize(k);
 
-  while (possible_faces.end() != face_iter)
+  const float query_point[3] = {pos.x, pos.y, pos.z};
+  const size_t num_results = kd_tree_ptr->knnSearch(&query_point[0], k, indices.data(), squared_distances.data());
+  squared_distances.resize(num_results);
+  vertices.reserve(num_results);
+  for (size_t i = 0; i < num_results; i++)
   {
-    const auto& vertices = mesh_ptr->getVertexPositionsOfFace(*face_iter);
-    float dist;
-    if (mesh_map::projectedBarycentricCoords(pos, vertices, bary_coords, dist) && std::fabs(dist) < max_dist)
-    {
-      return std::make_tuple(*face_iter, vertices, bary_coords);
-    }
-    else
-    {
-      const auto& vertices = mesh_ptr->getVerticesOfFace(*face_iter);
-      for (auto vertex : vertices)
-      {
-        if (center.distance2(mesh_ptr->getVertexPosition(vertex)) < max_radius_sq)
-        {
-          try
-          {
-            const auto& nn_faces = mesh_ptr->getFacesOfVertex(vertex);
-            for (auto nn_face : nn_faces)
-            {
-              if (!in_list_map.containsKey(nn_face))
-              {
-                possible_faces.push_back(nn_face);
-                in_list_map.insert(nn_face, true);
-              }
-            }
-          }
-          catch (lvr2::PanicException exception)
-          {
-            // TODO handle case properly
-          }
-        }
-      }
-      ++face_iter;
-    }
+    vertices.push_back(adaptor_ptr->vertexHandle(indices[i]));
   }
-
-  return boost::none;
+  return num_results;
 }
 
-bool MeshMap::meshAhead(mesh_map::Vector& pos, lvr2::FaceHandle& face, const float& step_size)
+void MeshMap::knnSearch(const std::vector<Vector>& positions, const size_t k, std::vector<uint32_t>& offsets,
+                        std::vector<lvr2::VertexHandle>& vertices, std::vector<float>& squared_distances)
 {
-  std::array<float, 3> bary_coords;
-  float dist;
-  // get barycentric coordinates of the current face or the next neighbour face
-  if (mesh_map::projectedBarycentricCoords(pos, mesh_ptr->getVertexPositionsOfFace(face), bary_coords, dist))
+  offsets.clear();
+  vertices.clear();
+  squared_distances.clear();
+  if(!kd_tree_ptr)
   {
-
+    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
   }
-  else if (auto search_res_opt = searchNeighbourFaces(pos, face, step_size, 0.4))
-  {
-    auto search_res = *search_res_opt;
-    face = std::get<0>(search_res);
-    std::array<Vector, 3> vertices = std::get<1>(search_res);
-    bary_coords = std::get<2>(search_res);
 
-    // project position onto surface
-    pos = mesh_map::linearCombineBarycentricCoords(vertices, bary_coords);
-  }
-  else
+  offsets.push_back(0);
+  if (k == 0)
   {
-    return false;
+    offsets.resize(positions.size() + 1, 0);
+    return;
   }
-  const auto& opt_dir = directionAtPosition(vector_map, mesh_ptr->getVerticesOfFace(face), bary_coords);
-  if (opt_dir)
+
+  thread_local std::vector<size_t> indices;
+  indices.resize(k);
+  offsets.reserve(positions.size() + 1);
+  vertices.reserve(positions.size() * k);
+  squared_distances.reserve(positions.size() * k);
+  for (const auto& pos : positions)
   {
-    Vector dir = opt_dir.get().normalized();
-    std::array<lvr2::VertexHandle, 3> handels = mesh_ptr->getVerticesOfFace(face);
-    // iter over all layer vector fields
-    for (auto layer : loaded_layers)
+    const float query_point[3] = {pos.x, pos.y, pos.z};
+    const size_t begin = squared_distances.size();
+    squared_distances.resize(begin + k);
+    const size_t num_results =
+        kd_tree_ptr->knnSearch(&query_point[0], k, indices.data(), squared_distances.data() + begin);
+    squared_distances.resize(begin + num_results);
+    for (size_t i = 0; i < num_results; i++)
     {
-      dir += layer.second->vectorAt(handels, bary_coords);
+      vertices.push_back(adaptor_ptr->vertexHandle(indices[i]));
     }
-    dir.normalize();
-    pos += dir * step_size;
-    return true;
+    offsets.push_back(vertices.size());
   }
-  return false;
 }
 
-lvr2::OptionalFaceHandle MeshMap::getContainingFace(Vector& position, const float& max_dist)
+LocalNeighborhood MeshMap::localNeighborhood(const std::string& strategy)
 {
-  auto search_result = searchContainingFace(position, max_dist);
-  if(search_result)
+  LocalNeighborhood neighborhood(*mesh_ptr, *topology_ptr);
+  if (strategy == "radius")
   {
-    return std::get<0>(*search_result);
+    neighborhood.useRadiusSearch(
+        [this](const Vector& pos, const float radius, std::vector<lvr2::VertexHandle>& vertices) {
+          return radiusSearch(pos, radius, vertices);
+        });
   }
-  return lvr2::OptionalFaceHandle();
+  return neighborhood;
 }
 
-boost::optional<std::tuple<           // returns:
-    lvr2::FaceHandle,                 // -> face handle 
-    std::array<mesh_map::Vector, 3>,  // -> closest face vertices (why no handles?)
-    std::array<float, 3>              // -> barycentric coords on closest face
-    >> MeshMap::searchContainingFace( // inputs:
-      Vector& query_point,            // -> query point
-      const float& max_dist)          // -> maximum search radius around query point
+LocalNeighborhood MeshMap::localNeighborhood(const std::string& strategy, const float radius, const size_t num_threads)
 {
-  if(auto vH_opt = getNearestVertexHandle(query_point))
+  LocalNeighborhood neighborhood = localNeighborhood(strategy);
+  neighborhood.useNeighbourhoods(vertexNeighbourhoods(strategy, radius, num_threads));
+  return neighborhood;
+}
+
+VertexNeighbourhoods::ConstPtr MeshMap::vertexNeighbourhoods(const std::string& strategy, const float radius,
+                                                             const size_t num_threads)
+{
+  if (!mesh_ptr || !topology_ptr || !isValidNeighborhoodStrategy(strategy))
   {
-    auto vH = vH_opt.unwrap();
-    float lowest_distance_found = std::numeric_limits<float>::max();
-    std::array<Vector, 3> closest_face_vertices;
-    std::array<float, 3> bary_coords_on_closest_face;
-    lvr2::OptionalFaceHandle opt_closest_face_handle;
-    for(auto current_face_handle : mesh_ptr->getFacesOfVertex(vH))
-    {
-      const auto& current_vertices = mesh_ptr->getVertexPositionsOfFace(current_face_handle);
-      float distance_to_current_face = 0;
-      std::array<float, 3> current_bary_coords;
-      const bool is_query_point_in_current_face = mesh_map::projectedBarycentricCoords(query_point, current_vertices, current_bary_coords, distance_to_current_face);
+    return VertexNeighbourhoods::ConstPtr();
+  }
 
-      if(is_query_point_in_current_face && distance_to_current_face < lowest_distance_found)
+  const std::string key = "vertex_neighbourhoods/" + strategy + "/" + std::to_string(radius);
+  return geometry_cache.get<VertexNeighbourhoods>(key, [&]() -> VertexNeighbourhoods::ConstPtr {
+    const auto t_start = std::chrono::steady_clock::now();
+    const size_t num_vertex_slots = mesh_ptr->nextVertexIndex();
+    const size_t cache_bytes = static_cast<size_t>(geometry_cache_size) * 1024 * 1024;
+    const size_t offset_bytes = (num_vertex_slots + 1) * sizeof(uint32_t);
+    const size_t max_entries = cache_bytes > offset_bytes ? (cache_bytes - offset_bytes) / sizeof(lvr2::VertexHandle) : 0;
+
+    // collect the neighbourhood of each vertex, the walk stops early once the neighbourhoods exceed the cache size
+    std::vector<std::vector<lvr2::VertexHandle>> vertex_lists(num_vertex_slots);
+    std::vector<LocalNeighborhood> neighborhoods(num_threads, localNeighborhood(strategy));
+    std::atomic<size_t> num_entries(0);
+    parallelForEachVertex(num_vertex_slots, num_threads, [&](const size_t thread, const lvr2::VertexHandle& vH) {
+      if (!mesh_ptr->containsVertex(vH) || num_entries > max_entries)
       {
-        lowest_distance_found = distance_to_current_face;
-        opt_closest_face_handle = current_face_handle;
-        closest_face_vertices = current_vertices;
-        bary_coords_on_closest_face = current_bary_coords;
+        return;
       }
+      auto& vertices = vertex_lists[vH.idx()];
+      neighborhoods[thread].visit(vH, radius, [&](const lvr2::VertexHandle& vertex) { vertices.push_back(vertex); });
+      vertices.shrink_to_fit();
+      num_entries += vertices.size();
+    });
+    if (num_entries > max_entries)
+    {
+      RCLCPP_INFO_STREAM(node->get_logger(), "The " << strategy << " neighbourhoods of radius " << radius
+          << " m exceed the geometry cache size of " << geometry_cache_size << " MiB, the layers walk them on demand.");
+      return VertexNeighbourhoods::ConstPtr();
     }
-    if(opt_closest_face_handle)
+
+    std::vector<uint32_t> offsets;
+    offsets.reserve(num_vertex_slots + 1);
+    std::vector<lvr2::VertexHandle> vertices;
+    vertices.reserve(num_entries);
+    for (auto& vertex_list : vertex_lists)
     {
-      return std::make_tuple(opt_closest_face_handle.unwrap(), closest_face_vertices, bary_coords_on_closest_face);
+      offsets.push_back(vertices.size());
+      vertices.insert(vertices.end(), vertex_list.begin(), vertex_list.end());
+      std::vector<lvr2::VertexHandle>().swap(vertex_list);
     }
-    RCLCPP_ERROR_STREAM(node->get_logger(), "No containing face found!");
-    return boost::none;
+    offsets.push_back(vertices.size());
+
+    auto neighbourhoods = std::make_shared<const VertexNeighbourhoods>(radius, std::move(offsets), std::move(vertices));
+    RCLCPP_INFO_STREAM(node->get_logger(), "The " << strategy << " neighbourhoods of radius " << radius
+        << " m have been computed in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start).count()
+        << " ms using " << neighbourhoods->memoryUsage() / (1024 * 1024) << " MiB.");
+    return neighbourhoods;
+  });
+}
+
+std::shared_ptr<const lvr2::DenseFaceMap<float>> MeshMap::faceAreas()
+{
+  if (!mesh_ptr)
+  {
+    return std::shared_ptr<const lvr2::DenseFaceMap<float>>();
   }
-  RCLCPP_FATAL_STREAM(node->get_logger(), "Could not find the nearest vertex");
-  return boost::none;
+
+  return geometry_cache.get<lvr2::DenseFaceMap<float>>("face_areas", [&]() {
+    auto areas = std::make_shared<lvr2::DenseFaceMap<float>>(mesh_ptr->nextFaceIndex(), 0);
+    for (const auto& fH : mesh_ptr->faces())
+    {
+      const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
+      (*areas)[fH] = 0.5 * (vertices[1] - vertices[0]).cross(vertices[2] - vertices[0]).length();
+    }
+    return std::shared_ptr<const lvr2::DenseFaceMap<float>>(areas);
+  });
 }
 
-lvr2::OptionalVertexHandle MeshMap::getNearestVertexHandle(const Vector& pos)
+MeshBoundary::ConstPtr MeshMap::boundary()
 {
-  float querry_point[3] = {pos.x, pos.y, pos.z};
-  size_t ret_index;
-  float out_dist_sqr;
+  if (!topology_ptr)
+  {
+    return MeshBoundary::ConstPtr();
+  }
 
-  if(!kd_tree_ptr)
+  return geometry_cache.get<MeshBoundary>("boundary", [&]() {
+    const auto t_start = std::chrono::steady_clock::now();
+    auto boundary_ptr = std::make_shared<const MeshBoundary>(*topology_ptr, resolveThreadCount(0));
+    RCLCPP_INFO_STREAM(node->get_logger(), "Found " << boundary_ptr->numContours() << " contours with "
+        << boundary_ptr->numBoundaryEdges() << " boundary edges in "
+        << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t_start).count() << " ms.");
+    return MeshBoundary::ConstPtr(boundary_ptr);
+  });
+}
+
+std::shared_ptr<const MeshMap::VectorFieldSamples> MeshMap::vectorFieldSamples()
+{
+  if (!mesh_ptr)
   {
-    throw std::runtime_error("Tried to access kd tree which is not yet initialized");
+    return std::shared_ptr<const VectorFieldSamples>();
   }
 
-  size_t num_results = kd_tree_ptr->knnSearch(&querry_point[0], 1, &ret_index, &out_dist_sqr);
-  return num_results == 0 ? lvr2::OptionalVertexHandle() : lvr2::VertexHandle(ret_index);
+  return geometry_cache.get<VectorFieldSamples>("vector_field_samples", [&]() {
+    auto samples = std::make_shared<VectorFieldSamples>();
+    if (vector_field_resolution <= 0)
+    {
+      samples->vertices.reserve(mesh_ptr->numVertices());
+      samples->faces.reserve(mesh_ptr->numFaces());
+      for (const auto& vH : mesh_ptr->vertices())
+      {
+        samples->vertices.push_back(vH);
+      }
+      for (const auto& fH : mesh_ptr->faces())
+      {
+        samples->faces.push_back(fH);
+      }
+      return std::shared_ptr<const VectorFieldSamples>(samples);
+    }
+
+    // the first vertex and face center in each grid cell, the cell coordinates are packed with 21 bits each
+    auto cell = [this](const Vector& p) {
+      const auto coordinate = [this](const float value) {
+        return static_cast<uint64_t>(static_cast<int64_t>(std::floor(value / vector_field_resolution))) & 0x1FFFFF;
+      };
+      return coordinate(p.x) << 42 | coordinate(p.y) << 21 | coordinate(p.z);
+    };
+    std::unordered_set<uint64_t> cells;
+    for (const auto& vH : mesh_ptr->vertices())
+    {
+      if (cells.insert(cell(mesh_ptr->getVertexPosition(vH))).second)
+      {
+        samples->vertices.push_back(vH);
+      }
+    }
+    cells.clear();
+    for (const auto& fH : mesh_ptr->faces())
+    {
+      const auto& vertices = mesh_ptr->getVertexPositionsOfFace(fH);
+      if (cells.insert(cell((vertices[0] + vertices[1] + vertices[2]) / 3)).second)
+      {
+        samples->faces.push_back(fH);
+      }
+    }
+    RCLCPP_INFO_STREAM(node->get_logger(), "Vector fields are visualized at " << samples->vertices.size()
+        << " vertices and " << samples->faces.size() << " faces with a resolution of " << vector_field_resolution
+        << " m.");
+    samples->vertices.shrink_to_fit();
+    samples->faces.shrink_to_fit();
+    return std::shared_ptr<const VectorFieldSamples>(samples);
+  });
 }
 
 inline const geometry_msgs::msg::Point MeshMap::toPoint(const Vector& vec)
@@ -1233,28 +2742,48 @@ mesh_map::AbstractLayer::Ptr MeshMap::layer(const std::string& layer_name)
 std_srvs::srv::Trigger::Response MeshMap::writeLayers()
 {
   std::stringstream ss;
-  bool write_failure = false;
+  const VertexBitset no_lethals;
 
-  for (auto& layer : loaded_layers)
+  for (size_t i = 0; i < loaded_layers.size(); i++)
   {
-    auto& layer_plugin = layer.second;
-    const auto& layer_name = layer.first;
+    auto& layer_plugin = loaded_layers[i].second;
+    const auto& layer_name = loaded_layers[i].first;
+    const VertexBitset& preceding_lethals = i > 0 && i <= prefix_lethals.size() ? prefix_lethals[i - 1] : no_lethals;
+
+    // the costs are copied, the layer may change them while the write is pending
+    lvr2::DenseVertexMap<float> costs_snapshot;
+    const lvr2::VertexMap<float>& costs = layer_plugin->costs();
+    const auto* dense_costs = dynamic_cast<const lvr2::DenseVertexMap<float>*>(&costs);
+    if (dense_costs)
+    {
+      costs_snapshot = *dense_costs;
+    }
+    else
+    {
+      costs_snapshot.reserve(mesh_ptr->nextVertexIndex());
+      for (auto vH : costs)
+      {
+        costs_snapshot.insert(vH, costs[vH]);
+      }
+    }
+
+    RCLCPP_INFO_STREAM(node->get_logger(), "Enqueue writing '" << layer_name << "' to file.");
+    persistence_queue->enqueue(layer_name, [this, layer_name, costs = std::move(costs_snapshot),
+                                            signature = layerCacheSignature(layer_plugin, preceding_lethals)]() {
+      return mesh_io_ptr->addDenseAttributeMap(costs, layer_name) &&
+             writeStringChannel("layer_signatures", layer_name, signature);
+    });
 
-    RCLCPP_INFO_STREAM(node->get_logger(), "Writing '" << layer_name << "' to file.");
-    if(layer_plugin->writeLayer())
+    // this is not the first layer. add a comma in between
+    if (ss.tellp() > 0)
     {
-      RCLCPP_INFO_STREAM(node->get_logger(), "Finished writing '" << layer_name << "' to file.");
-    } else {
-      // this is not the first failure. add a comma in between 
-      if(write_failure){ss << ",";}
-      ss << layer_name;
-      write_failure = true;
-      RCLCPP_ERROR_STREAM(node->get_logger(), "Error while writing '" << layer_name << "' to file.");      
+      ss << ",";
     }
+    ss << layer_name;
   }
 
   std_srvs::srv::Trigger::Response res;
-  res.success = !write_failure;
+  res.success = true;
   res.message = ss.str();
   return res;
 }
@@ -1332,17 +2861,136 @@ bool MeshMap::resetLayers()
 
 void MeshMap::publishCostLayers(const rclcpp::Time& map_stamp)
 {
-  for (const auto& [layer_name, layer_ptr] : loaded_layers)
+  for (const auto& layer : loaded_layers)
+  {
+    requestCostPublishing(layer.first, map_stamp, nullptr);
+  }
+  requestCostPublishing(COMBINED_COSTS_NAME, map_stamp, nullptr);
+}
+
+void MeshMap::requestCostPublishing(const std::string& name, const rclcpp::Time& map_stamp,
+                                    const std::vector<lvr2::VertexHandle>* vertices)
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_costs_mtx);
+    auto& pending = pending_costs[name];
+    pending.stamp = map_stamp;
+    if (!vertices)
+    {
+      pending.full = true;
+      pending.vertices.clear();
+    }
+    else if (!pending.full)
+    {
+      pending.vertices.insert(pending.vertices.end(), vertices->begin(), vertices->end());
+    }
+  }
+
+  if (cost_publish_rate <= 0)
+  {
+    publishPendingCosts();
+  }
+}
+
+void MeshMap::publishPendingCosts()
+{
+  std::map<std::string, PendingCosts> pending;
+  size_t subscribers, update_subscribers;
+  {
+    std::lock_guard<std::mutex> lock(pending_costs_mtx);
+    subscribers = vertex_costs_pub->get_subscription_count() + vertex_costs_pub->get_intra_process_subscription_count();
+    update_subscribers = vertex_costs_update_pub->get_subscription_count() +
+                         vertex_costs_update_pub->get_intra_process_subscription_count();
+
+    // new subscribers receive all costs, as subscribers which join while nothing is published get nothing latched
+    if (subscribers > cost_subscribers)
+    {
+      const rclcpp::Time now = node->now();
+      for (const auto& layer : loaded_layers)
+      {
+        pending_costs[layer.first] = PendingCosts{ true, {}, now };
+      }
+      pending_costs[COMBINED_COSTS_NAME] = PendingCosts{ true, {}, now };
+    }
+    cost_subscribers = subscribers;
+
+    // nobody listens, the costs are not serialized at all
+    if (subscribers == 0 && update_subscribers == 0)
+    {
+      pending_costs.clear();
+      return;
+    }
+    pending.swap(pending_costs);
+  }
+
+  for (auto& [name, costs] : pending)
+  {
+    const bool combined = name == COMBINED_COSTS_NAME;
+    const auto layer_iter = std::find_if(loaded_layers.begin(), loaded_layers.end(),
+                                         [&name](const auto& layer) { return layer.first == name; });
+    if (!combined && layer_iter == loaded_layers.end())
+    {
+      continue;
+    }
+    const auto layer_ptr = combined ? AbstractLayer::Ptr() : layer_iter->second;
+    const lvr2::VertexMap<float>& values = combined ? vertex_costs : layer_ptr->costs();
+    const float default_value = combined ? 0 : layer_ptr->defaultValue();
+    std::shared_lock<std::shared_mutex> costs_lock(cost_mtx, std::defer_lock);
+    if (combined)
+    {
+      costs_lock.lock();
+    }
+
+    if (costs.full || !cost_delta_updates)
+    {
+      if (subscribers > 0)
+      {
+        vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(
+            values, mesh_ptr->numVertices(), default_value, name, global_frame, uuid_str, costs.stamp));
+      }
+    }
+    else if (update_subscribers > 0 && !costs.vertices.empty())
+    {
+      std::sort(costs.vertices.begin(), costs.vertices.end());
+      costs.vertices.erase(std::unique(costs.vertices.begin(), costs.vertices.end()), costs.vertices.end());
+
+      mesh_msgs::msg::MeshVertexCostsSparseStamped msg;
+      msg.header.frame_id = global_frame;
+      msg.header.stamp = costs.stamp;
+      msg.uuid = uuid_str;
+      msg.type = name;
+      msg.mesh_vertex_costs.vertices.reserve(costs.vertices.size());
+      msg.mesh_vertex_costs.costs.reserve(costs.vertices.size());
+      for (const auto& vH : costs.vertices)
+      {
+        msg.mesh_vertex_costs.vertices.push_back(vH.idx());
+        msg.mesh_vertex_costs.costs.push_back(values.containsKey(vH) ? values[vH] : default_value);
+      }
+      vertex_costs_update_pub->publish(msg);
+    }
+  }
+}
+
+bool MeshMap::hasNewCostSubscribers()
+{
+  std::lock_guard<std::mutex> lock(pending_costs_mtx);
+  const size_t subscribers =
+      vertex_costs_pub->get_subscription_count() + vertex_costs_pub->get_intra_process_subscription_count();
+  if (subscribers > cost_subscribers)
   {
-    vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(layer_ptr->costs(), mesh_ptr->numVertices(),
-                                                           layer_ptr->defaultValue(), layer_name, global_frame,
-                                                           uuid_str, map_stamp));
+    return true;
   }
-  vertex_costs_pub->publish(mesh_msgs_conversions::toVertexCostsStamped(vertex_costs, "Combined Costs", global_frame, uuid_str, map_stamp));
+  // subscribers which left, so that the next joining one is noticed
+  cost_subscribers = subscribers;
+  return false;
 }
 
 void MeshMap::publishVertexCosts(const lvr2::VertexMap<float>& costs, const std::string& name, const rclcpp::Time& map_stamp)
 {
+  if (vertex_costs_pub->get_subscription_count() + vertex_costs_pub->get_intra_process_subscription_count() == 0)
+  {
+    return;
+  }
   vertex_costs_pub->publish(
       mesh_msgs_conversions::toVertexCostsStamped(costs, mesh_ptr->numVertices(), 0, name, global_frame, uuid_str, map_stamp));
 }
@@ -1351,24 +2999,50 @@ void MeshMap::publishVertexColors(const rclcpp::Time& map_stamp)
 {
   using VertexColorMapOpt = lvr2::DenseVertexMapOptional<std::array<uint8_t, 3>>;
   using VertexColorMap = lvr2::DenseVertexMap<std::array<uint8_t, 3>>;
-  VertexColorMapOpt vertex_colors_opt = this->mesh_io_ptr->getDenseAttributeMap<VertexColorMap>("vertex_colors");
+  VertexColorMapOpt vertex_colors_opt;
+  // the colors are a channel of the full working mesh
+  accessWorkingPart([&]() {
+    vertex_colors_opt = this->mesh_io_ptr->getDenseAttributeMap<VertexColorMap>("vertex_colors");
+    return true;
+  });
   if (vertex_colors_opt)
   {
     const VertexColorMap colors = vertex_colors_opt.get();
-    mesh_msgs::msg::MeshVertexColorsStamped msg;
-    msg.header.frame_id = mapFrame();
-    msg.header.stamp = map_stamp;
-    msg.uuid = uuid_str;
-    msg.mesh_vertex_colors.vertex_colors.reserve(colors.numValues());
-    for (auto vH : colors)
-    {
+    auto toColor = [](const std::array<uint8_t, 3>& color_array) {
       std_msgs::msg::ColorRGBA color_rgba;
-      const auto& color_array = colors[vH];
       color_rgba.a = 1;
       color_rgba.r = color_array[0] / 255.0;
       color_rgba.g = color_array[1] / 255.0;
       color_rgba.b = color_array[2] / 255.0;
-      msg.mesh_vertex_colors.vertex_colors.push_back(color_rgba);
+      return color_rgba;
+    };
+    mesh_msgs::msg::MeshVertexColorsStamped msg;
+    msg.header.frame_id = mapFrame();
+    msg.header.stamp = map_stamp;
+    msg.uuid = uuid_str;
+    if (resident_vertex_ids.empty())
+    {
+      msg.mesh_vertex_colors.vertex_colors.reserve(colors.numValues());
+      for (auto vH : colors)
+      {
+        msg.mesh_vertex_colors.vertex_colors.push_back(toColor(colors[vH]));
+      }
+    }
+    else
+    {
+      // only the resident vertices are part of the published mesh, in the order of the half-edge mesh
+      msg.mesh_vertex_colors.vertex_colors.reserve(resident_vertex_ids.size());
+      for (const auto vertex_id : resident_vertex_ids)
+      {
+        const auto color_opt = colors.get(lvr2::VertexHandle(vertex_id));
+        if (!color_opt)
+        {
+          RCLCPP_WARN_STREAM(node->get_logger(), "The vertex colors do not cover the resident vertices, they are not "
+                                                 "published.");
+          return;
+        }
+        msg.mesh_vertex_colors.vertex_colors.push_back(toColor(*color_opt));
+      }
     }
     this->vertex_colors_pub->publish(msg);
   }
@@ -0,0 +1,305 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <mesh_map/mesh_tiling.h>
+
+namespace mesh_map
+{
+
+//! identifies a serialized tiling
+static const uint32_t TILING_MAGIC = 0x4C49544D;  // "MTIL"
+//! version of the serialized layout, tilings of other versions are rebuilt
+static const uint32_t TILING_VERSION = 2;
+
+namespace
+{
+struct TilingHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_x;
+  uint32_t num_y;
+  float min_x;
+  float min_y;
+  float tile_size;
+  float halo;
+  uint64_t num_vertices;
+  uint64_t num_faces;
+  uint64_t num_entries;
+  uint64_t content_hash;
+};
+
+//! clamped index of the tile column or row containing the coordinate
+inline uint32_t cell(const float value, const float min, const float tile_size, const uint32_t num)
+{
+  const float index = std::floor((value - min) / tile_size);
+  return index <= 0 ? 0 : std::min<uint32_t>(num - 1, static_cast<uint32_t>(index));
+}
+}  // namespace
+
+uint64_t MeshTiling::contentHash(lvr2::MeshBuffer& buffer)
+{
+  const uint64_t fnv_offset = 14695981039346656037ULL;
+  const uint64_t fnv_prime = 1099511628211ULL;
+
+  uint64_t hash = fnv_offset;
+  auto combine = [&](const uint32_t word) { hash = (hash ^ word) * fnv_prime; };
+
+  const float* const vertices = buffer.getVertices().get();
+  combine(buffer.numVertices());
+  for (size_t i = 0; i < 3 * buffer.numVertices(); i++)
+  {
+    uint32_t word;
+    std::memcpy(&word, vertices + i, sizeof(word));
+    combine(word);
+  }
+  const unsigned int* const faces = buffer.getFaceIndices().get();
+  combine(buffer.numFaces());
+  for (size_t i = 0; i < 3 * buffer.numFaces(); i++)
+  {
+    combine(faces[i]);
+  }
+  return hash;
+}
+
+MeshTiling::MeshTiling(lvr2::MeshBuffer& buffer, const float tile_size, const float halo)
+  : tile_size_(tile_size)
+  , halo_(halo)
+  , num_vertices_(buffer.numVertices())
+  , num_faces_(buffer.numFaces())
+  , content_hash_(contentHash(buffer))
+{
+  const float* const vertices = buffer.getVertices().get();
+  const unsigned int* const faces = buffer.getFaceIndices().get();
+
+  float max_x = 0, max_y = 0;
+  if (num_vertices_ > 0)
+  {
+    min_x_ = max_x = vertices[0];
+    min_y_ = max_y = vertices[1];
+  }
+  for (size_t i = 1; i < num_vertices_; i++)
+  {
+    min_x_ = std::min(min_x_, vertices[3 * i]);
+    max_x = std::max(max_x, vertices[3 * i]);
+    min_y_ = std::min(min_y_, vertices[3 * i + 1]);
+    max_y = std::max(max_y, vertices[3 * i + 1]);
+  }
+  num_x_ = std::max<uint32_t>(1, std::ceil((max_x - min_x_) / tile_size_));
+  num_y_ = std::max<uint32_t>(1, std::ceil((max_y - min_y_) / tile_size_));
+
+  // the tile range of each face, visited twice to count and to fill the face lists
+  auto forEachTile = [&](const size_t face, const auto& function) {
+    float face_min_x = vertices[3 * faces[3 * face]], face_max_x = face_min_x;
+    float face_min_y = vertices[3 * faces[3 * face] + 1], face_max_y = face_min_y;
+    for (size_t corner = 1; corner < 3; corner++)
+    {
+      const float* const position = vertices + 3 * faces[3 * face + corner];
+      face_min_x = std::min(face_min_x, position[0]);
+      face_max_x = std::max(face_max_x, position[0]);
+      face_min_y = std::min(face_min_y, position[1]);
+      face_max_y = std::max(face_max_y, position[1]);
+    }
+    const uint32_t x_begin = cell(face_min_x - halo_, min_x_, tile_size_, num_x_);
+    const uint32_t x_end = cell(face_max_x + halo_, min_x_, tile_size_, num_x_);
+    const uint32_t y_begin = cell(face_min_y - halo_, min_y_, tile_size_, num_y_);
+    const uint32_t y_end = cell(face_max_y + halo_, min_y_, tile_size_, num_y_);
+    for (uint32_t y = y_begin; y <= y_end; y++)
+    {
+      for (uint32_t x = x_begin; x <= x_end; x++)
+      {
+        function(y * num_x_ + x);
+      }
+    }
+  };
+
+  tile_offsets_.assign(static_cast<size_t>(num_x_) * num_y_ + 1, 0);
+  for (size_t face = 0; face < num_faces_; face++)
+  {
+    forEachTile(face, [this](const uint32_t tile) { tile_offsets_[tile + 1]++; });
+  }
+  for (size_t tile = 0; tile < numTiles(); tile++)
+  {
+    tile_offsets_[tile + 1] += tile_offsets_[tile];
+  }
+
+  std::vector<uint32_t> fill(tile_offsets_.begin(), tile_offsets_.end() - 1);
+  tile_faces_.resize(tile_offsets_.back());
+  for (size_t face = 0; face < num_faces_; face++)
+  {
+    forEachTile(face, [&](const uint32_t tile) { tile_faces_[fill[tile]++] = face; });
+  }
+}
+
+MeshTiling::ConstPtr MeshTiling::deserialize(const unsigned char* data, const size_t size)
+{
+  TilingHeader header;
+  if (size < sizeof(header))
+  {
+    return ConstPtr();
+  }
+  std::memcpy(&header, data, sizeof(header));
+  const size_t num_tiles = static_cast<size_t>(header.num_x) * header.num_y;
+  if (header.magic != TILING_MAGIC || header.version != TILING_VERSION ||
+      size != sizeof(header) + (num_tiles + 1 + header.num_entries) * sizeof(uint32_t))
+  {
+    return ConstPtr();
+  }
+
+  auto tiling = std::shared_ptr<MeshTiling>(new MeshTiling());
+  tiling->min_x_ = header.min_x;
+  tiling->min_y_ = header.min_y;
+  tiling->tile_size_ = header.tile_size;
+  tiling->halo_ = header.halo;
+  tiling->num_x_ = header.num_x;
+  tiling->num_y_ = header.num_y;
+  tiling->num_vertices_ = header.num_vertices;
+  tiling->num_faces_ = header.num_faces;
+  tiling->content_hash_ = header.content_hash;
+  tiling->tile_offsets_.resize(num_tiles + 1);
+  tiling->tile_faces_.resize(header.num_entries);
+  const unsigned char* offsets = data + sizeof(header);
+  std::memcpy(tiling->tile_offsets_.data(), offsets, tiling->tile_offsets_.size() * sizeof(uint32_t));
+  std::memcpy(tiling->tile_faces_.data(), offsets + tiling->tile_offsets_.size() * sizeof(uint32_t),
+              tiling->tile_faces_.size() * sizeof(uint32_t));
+  if (tiling->tile_offsets_.back() != header.num_entries)
+  {
+    return ConstPtr();
+  }
+  return tiling;
+}
+
+void MeshTiling::serialize(std::vector<unsigned char>& data) const
+{
+  const TilingHeader header = { TILING_MAGIC,  TILING_VERSION, num_x_,
+                                num_y_,        min_x_,         min_y_,
+                                tile_size_,    halo_,          num_vertices_,
+                                num_faces_,    tile_faces_.size(), content_hash_ };
+  const size_t offsets_size = tile_offsets_.size() * sizeof(uint32_t);
+  data.resize(sizeof(header) + offsets_size + tile_faces_.size() * sizeof(uint32_t));
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::memcpy(data.data() + sizeof(header), tile_offsets_.data(), offsets_size);
+  std::memcpy(data.data() + sizeof(header) + offsets_size, tile_faces_.data(), tile_faces_.size() * sizeof(uint32_t));
+}
+
+bool MeshTiling::matches(lvr2::MeshBuffer& buffer, const float tile_size, const float halo) const
+{
+  // the sizes are compared first, they rule out most other meshes without reading the buffer
+  return tile_size_ == tile_size && halo_ == halo && num_vertices_ == buffer.numVertices() &&
+         num_faces_ == buffer.numFaces() && content_hash_ == contentHash(buffer);
+}
+
+std::vector<uint32_t> MeshTiling::tilesAround(const float x, const float y, const float radius) const
+{
+  std::vector<uint32_t> tiles;
+  const uint32_t x_begin = cell(x - radius, min_x_, tile_size_, num_x_);
+  const uint32_t x_end = cell(x + radius, min_x_, tile_size_, num_x_);
+  const uint32_t y_begin = cell(y - radius, min_y_, tile_size_, num_y_);
+  const uint32_t y_end = cell(y + radius, min_y_, tile_size_, num_y_);
+  for (uint32_t ty = y_begin; ty <= y_end; ty++)
+  {
+    for (uint32_t tx = x_begin; tx <= x_end; tx++)
+    {
+      // distance of the position to the tile rectangle
+      const float tile_x = min_x_ + tx * tile_size_, tile_y = min_y_ + ty * tile_size_;
+      const float dx = std::max(std::max(tile_x - x, 0.0f), x - (tile_x + tile_size_));
+      const float dy = std::max(std::max(tile_y - y, 0.0f), y - (tile_y + tile_size_));
+      if (dx * dx + dy * dy <= radius * radius)
+      {
+        tiles.push_back(ty * num_x_ + tx);
+      }
+    }
+  }
+  return tiles;
+}
+
+lvr2::MeshBufferPtr MeshTiling::extract(lvr2::MeshBuffer& buffer, const std::vector<uint32_t>& tiles,
+                                        std::vector<uint32_t>& vertex_ids) const
+{
+  const float* const vertices = buffer.getVertices().get();
+  const unsigned int* const faces = buffer.getFaceIndices().get();
+
+  // the halos overlap, thus a face can be part of several of the tiles
+  std::vector<uint32_t> face_ids;
+  for (const auto tile : tiles)
+  {
+    face_ids.insert(face_ids.end(), tile_faces_.begin() + tile_offsets_[tile],
+                    tile_faces_.begin() + tile_offsets_[tile + 1]);
+  }
+  std::sort(face_ids.begin(), face_ids.end());
+  face_ids.erase(std::unique(face_ids.begin(), face_ids.end()), face_ids.end());
+  if (face_ids.empty())
+  {
+    vertex_ids.clear();
+    return lvr2::MeshBufferPtr();
+  }
+
+  vertex_ids.clear();
+  vertex_ids.reserve(3 * face_ids.size());
+  for (const auto face : face_ids)
+  {
+    vertex_ids.insert(vertex_ids.end(), faces + 3 * face, faces + 3 * face + 3);
+  }
+  std::sort(vertex_ids.begin(), vertex_ids.end());
+  vertex_ids.erase(std::unique(vertex_ids.begin(), vertex_ids.end()), vertex_ids.end());
+
+  lvr2::floatArr new_vertices(new float[3 * vertex_ids.size()]);
+  for (size_t i = 0; i < vertex_ids.size(); i++)
+  {
+    std::memcpy(new_vertices.get() + 3 * i, vertices + 3 * vertex_ids[i], 3 * sizeof(float));
+  }
+  lvr2::indexArray new_faces(new unsigned int[3 * face_ids.size()]);
+  for (size_t i = 0; i < face_ids.size(); i++)
+  {
+    for (size_t corner = 0; corner < 3; corner++)
+    {
+      const auto vertex = faces[3 * face_ids[i] + corner];
+      new_faces[3 * i + corner] = std::lower_bound(vertex_ids.begin(), vertex_ids.end(), vertex) - vertex_ids.begin();
+    }
+  }
+
+  auto sub_buffer = std::make_shared<lvr2::MeshBuffer>();
+  sub_buffer->setVertices(new_vertices, vertex_ids.size());
+  sub_buffer->setFaceIndices(new_faces, face_ids.size());
+  return sub_buffer;
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/mesh_topology.h>
+
+namespace mesh_map
+{
+
+MeshTopology::MeshTopology(const lvr2::BaseMesh<lvr2::BaseVector<float>>& mesh) : num_broken_(0)
+{
+  const size_t num_vertex_slots = mesh.nextVertexIndex();
+  const size_t num_face_slots = mesh.nextFaceIndex();
+  const size_t num_edge_slots = mesh.nextEdgeIndex();
+
+  const lvr2::VertexHandle placeholder_vertex(0);
+  const lvr2::EdgeHandle placeholder_edge(0);
+
+  // edge -> vertices
+  edge_vertices_.reserve(num_edge_slots);
+  edge_valid_.resize(num_edge_slots, false);
+  for (size_t i = 0; i < num_edge_slots; i++)
+  {
+    const lvr2::EdgeHandle eH(i);
+    if (mesh.containsEdge(eH))
+    {
+      edge_vertices_.push_back(mesh.getVerticesOfEdge(eH));
+      edge_valid_[i] = true;
+    }
+    else
+    {
+      edge_vertices_.push_back({ placeholder_vertex, placeholder_vertex });
+    }
+  }
+
+  // vertex -> neighbours, edges and faces
+  vertex_state_.resize(num_vertex_slots, DELETED);
+  vertex_offsets_.reserve(num_vertex_slots + 1);
+  vertex_face_offsets_.reserve(num_vertex_slots + 1);
+  vertex_neighbours_.reserve(2 * num_edge_slots);
+  vertex_edges_.reserve(2 * num_edge_slots);
+  vertex_faces_.reserve(3 * num_face_slots);
+
+  std::vector<lvr2::EdgeHandle> edges;
+  std::vector<lvr2::FaceHandle> faces;
+  for (size_t i = 0; i < num_vertex_slots; i++)
+  {
+    vertex_offsets_.push_back(vertex_edges_.size());
+    vertex_face_offsets_.push_back(vertex_faces_.size());
+
+    const lvr2::VertexHandle vH(i);
+    if (!mesh.containsVertex(vH))
+    {
+      continue;
+    }
+
+    edges.clear();
+    faces.clear();
+    try
+    {
+      mesh.getEdgesOfVertex(vH, edges);
+      mesh.getFacesOfVertex(vH, faces);
+    }
+    catch (lvr2::PanicException exception)
+    {
+      vertex_state_[i] = BROKEN;
+      num_broken_++;
+      continue;
+    }
+    catch (lvr2::VertexLoopException exception)
+    {
+      vertex_state_[i] = BROKEN;
+      num_broken_++;
+      continue;
+    }
+
+    vertex_state_[i] = VALID;
+    for (const auto& eH : edges)
+    {
+      const auto& vertices = edge_vertices_[eH.idx()];
+      vertex_neighbours_.push_back(vertices[0] == vH ? vertices[1] : vertices[0]);
+      vertex_edges_.push_back(eH);
+    }
+    vertex_faces_.insert(vertex_faces_.end(), faces.begin(), faces.end());
+  }
+  vertex_offsets_.push_back(vertex_edges_.size());
+  vertex_face_offsets_.push_back(vertex_faces_.size());
+
+  // face -> vertices and edges
+  face_valid_.resize(num_face_slots, false);
+  face_vertices_.reserve(num_face_slots);
+  face_edges_.reserve(num_face_slots);
+  for (size_t i = 0; i < num_face_slots; i++)
+  {
+    const lvr2::FaceHandle fH(i);
+    if (!mesh.containsFace(fH))
+    {
+      face_vertices_.push_back({ placeholder_vertex, placeholder_vertex, placeholder_vertex });
+      face_edges_.push_back({ placeholder_edge, placeholder_edge, placeholder_edge });
+      continue;
+    }
+
+    const auto vertices = mesh.getVerticesOfFace(fH);
+    std::array<lvr2::EdgeHandle, 3> face_edges = { placeholder_edge, placeholder_edge, placeholder_edge };
+    bool complete = true;
+    for (size_t j = 0; j < 3; j++)
+    {
+      const auto& v1 = vertices[j];
+      const auto& v2 = vertices[(j + 1) % 3];
+      // broken vertices have no adjacency in the snapshot, ask the half-edge mesh directly
+      lvr2::OptionalEdgeHandle eH = isValid(v1) ? edgeBetween(v1, v2) : lvr2::OptionalEdgeHandle();
+      if (!eH)
+      {
+        try
+        {
+          eH = mesh.getEdgeBetween(v1, v2);
+        }
+        catch (lvr2::PanicException exception)
+        {
+        }
+      }
+      if (eH)
+      {
+        face_edges[j] = eH.unwrap();
+      }
+      else
+      {
+        complete = false;
+      }
+    }
+    face_valid_[i] = complete;
+    face_vertices_.push_back(vertices);
+    face_edges_.push_back(face_edges);
+  }
+}
+
+size_t MeshTopology::memoryUsage() const
+{
+  return vertex_offsets_.capacity() * sizeof(uint32_t) + vertex_face_offsets_.capacity() * sizeof(uint32_t) +
+         vertex_neighbours_.capacity() * sizeof(lvr2::VertexHandle) +
+         vertex_edges_.capacity() * sizeof(lvr2::EdgeHandle) + vertex_faces_.capacity() * sizeof(lvr2::FaceHandle) +
+         face_vertices_.capacity() * sizeof(std::array<lvr2::VertexHandle, 3>) +
+         face_edges_.capacity() * sizeof(std::array<lvr2::EdgeHandle, 3>) +
+         edge_vertices_.capacity() * sizeof(std::array<lvr2::VertexHandle, 2>) + vertex_state_.capacity() +
+         face_valid_.capacity() / 8 + edge_valid_.capacity() / 8;
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/path_simplification.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mesh_map
+{
+
+namespace
+{
+typedef lvr2::BaseVector<float> Vec;
+
+//! distance of the point to the segment between a and b
+float distanceToSegment(const Vec& point, const Vec& a, const Vec& b)
+{
+  const Vec ab = b - a;
+  const float length_sq = ab.dot(ab);
+  if (length_sq <= 0)
+  {
+    return point.distance(a);
+  }
+  const float t = std::min(std::max((point - a).dot(ab) / length_sq, 0.0f), 1.0f);
+  return point.distance(a + ab * t);
+}
+
+//! angle between the two directions, zero if one of them is degenerated
+float turningAngle(const Vec& d1, const Vec& d2)
+{
+  const float lengths = d1.length() * d2.length();
+  if (lengths <= 0)
+  {
+    return 0;
+  }
+  return std::acos(std::min(std::max(d1.dot(d2) / lengths, -1.0f), 1.0f));
+}
+}  // namespace
+
+std::vector<size_t> simplifyPath(const MeshPath& path, const float max_deviation, const float max_angle,
+                                 const float max_segment_length)
+{
+  std::vector<size_t> selected;
+  if (path.empty())
+  {
+    return selected;
+  }
+  selected.reserve(std::min<size_t>(path.size(), 64));
+  selected.push_back(0);
+
+  size_t anchor = 0;
+  float turned = 0;
+  for (size_t j = 1; j < path.size(); j++)
+  {
+    const Vec& current = path[j].first;
+    if (j >= anchor + 2)
+    {
+      turned += turningAngle(path[j - 1].first - path[j - 2].first, current - path[j - 1].first);
+    }
+
+    bool split = turned > max_angle || path[anchor].first.distance(current) > max_segment_length;
+    for (size_t k = anchor + 1; k < j && !split; k++)
+    {
+      split = distanceToSegment(path[k].first, path[anchor].first, current) > max_deviation;
+    }
+
+    if (split && j - 1 > anchor)
+    {
+      anchor = j - 1;
+      selected.push_back(anchor);
+      turned = 0;
+    }
+  }
+
+  if (selected.back() != path.size() - 1)
+  {
+    selected.push_back(path.size() - 1);
+  }
+  return selected;
+}
+
+} /* namespace mesh_map */
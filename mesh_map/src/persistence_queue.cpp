@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <mesh_map/persistence_queue.h>
+
+namespace mesh_map
+{
+
+PersistenceQueue::PersistenceQueue(CompletionCallback callback)
+  : busy_(false), stop_(false), callback_(callback), thread_(&PersistenceQueue::run, this)
+{
+}
+
+PersistenceQueue::~PersistenceQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cond_.notify_one();
+  thread_.join();
+}
+
+bool PersistenceQueue::enqueue(const std::string& key, Write write)
+{
+  bool enqueued;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = writes_.find(key);
+    enqueued = iter == writes_.end();
+    if (enqueued)
+    {
+      order_.push_back(key);
+      writes_.emplace(key, std::move(write));
+    }
+    else
+    {
+      iter->second = std::move(write);
+    }
+  }
+  work_cond_.notify_one();
+  return enqueued;
+}
+
+void PersistenceQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cond_.wait(lock, [this] { return order_.empty() && !busy_; });
+}
+
+size_t PersistenceQueue::pending() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return order_.size() + (busy_ ? 1 : 0);
+}
+
+void PersistenceQueue::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    work_cond_.wait(lock, [this] { return stop_ || !order_.empty(); });
+    if (order_.empty())
+    {
+      // stopped and all writes are done
+      break;
+    }
+
+    const std::string key = order_.front();
+    order_.pop_front();
+    Write write = std::move(writes_[key]);
+    writes_.erase(key);
+    busy_ = true;
+    lock.unlock();
+
+    bool success = false;
+    {
+      std::lock_guard<std::recursive_mutex> file_lock(file_mutex_);
+      try
+      {
+        success = write();
+      }
+      catch (...)
+      {
+        success = false;
+      }
+    }
+    if (callback_)
+    {
+      callback_(key, success);
+    }
+
+    lock.lock();
+    busy_ = false;
+    if (order_.empty())
+    {
+      idle_cond_.notify_all();
+    }
+  }
+  idle_cond_.notify_all();
+}
+
+} /* namespace mesh_map */
@@ -42,6 +42,7 @@
 #include <tf2/LinearMath/Transform.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
+#include <cstring>
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -218,6 +219,51 @@ lvr2::MeshBufferPtr extractMeshByName(
   return mesh;
 }
 
+uint64_t meshContentHash(const lvr2::BaseMesh<Vector>& mesh)
+{
+  const uint64_t fnv_offset = 14695981039346656037ULL;
+  const uint64_t fnv_prime = 1099511628211ULL;
+
+  uint64_t hash = fnv_offset;
+  auto combine = [&](const uint32_t word) { hash = (hash ^ word) * fnv_prime; };
+  auto combine_float = [&](const float value) {
+    uint32_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    combine(word);
+  };
+
+  combine(mesh.nextVertexIndex());
+  for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    if (!mesh.containsVertex(vH))
+    {
+      combine(0xffffffff);
+      continue;
+    }
+    const Vector position = mesh.getVertexPosition(vH);
+    combine_float(position.x);
+    combine_float(position.y);
+    combine_float(position.z);
+  }
+
+  combine(mesh.nextFaceIndex());
+  for (size_t i = 0; i < mesh.nextFaceIndex(); i++)
+  {
+    const lvr2::FaceHandle fH(i);
+    if (!mesh.containsFace(fH))
+    {
+      combine(0xffffffff);
+      continue;
+    }
+    for (const auto& vH : mesh.getVerticesOfFace(fH))
+    {
+      combine(vH.idx());
+    }
+  }
+  return hash;
+}
+
 void getMinMax(const lvr2::VertexMap<float>& costs, float& min, float& max)
 {
   max = std::numeric_limits<float>::min();
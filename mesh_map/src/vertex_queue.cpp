@@ -0,0 +1,346 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <mesh_map/vertex_queue.h>
+
+namespace mesh_map
+{
+
+MeapVertexQueue::MeapVertexQueue(const size_t num_vertices) : meap_(num_vertices)
+{
+}
+
+void MeapVertexQueue::insert(const lvr2::VertexHandle& vH, const float key)
+{
+  meap_.insert(vH, key);
+  stats_.inserts++;
+  stats_.max_size = std::max(stats_.max_size, meap_.numValues());
+}
+
+lvr2::VertexHandle MeapVertexQueue::popMin()
+{
+  stats_.pops++;
+  return meap_.popMin().key();
+}
+
+bool MeapVertexQueue::isEmpty() const
+{
+  return meap_.isEmpty();
+}
+
+void MeapVertexQueue::clear()
+{
+  meap_.clear();
+}
+
+QuaternaryHeapVertexQueue::QuaternaryHeapVertexQueue(const size_t num_vertices)
+  : current_key_(num_vertices, std::numeric_limits<float>::infinity()), queued_(num_vertices, false), size_(0)
+{
+}
+
+void QuaternaryHeapVertexQueue::insert(const lvr2::VertexHandle& vH, const float key)
+{
+  const lvr2::Index idx = vH.idx();
+  if (idx >= queued_.size())
+  {
+    current_key_.resize(idx + 1, std::numeric_limits<float>::infinity());
+    queued_.resize(idx + 1, false);
+  }
+
+  // a NaN key would never match itself and could not be popped
+  const float k = std::isnan(key) ? std::numeric_limits<float>::infinity() : key;
+  if (!queued_[idx])
+  {
+    queued_[idx] = true;
+    size_++;
+  }
+  current_key_[idx] = k;
+
+  heap_.push_back({ k, idx });
+  siftUp(heap_.size() - 1);
+
+  stats_.inserts++;
+  stats_.max_size = std::max(stats_.max_size, heap_.size());
+}
+
+lvr2::VertexHandle QuaternaryHeapVertexQueue::popMin()
+{
+  while (true)
+  {
+    const Entry top = heap_.front();
+    heap_.front() = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty())
+    {
+      siftDown(0);
+    }
+
+    if (queued_[top.idx] && current_key_[top.idx] == top.key)
+    {
+      queued_[top.idx] = false;
+      size_--;
+      stats_.pops++;
+      return lvr2::VertexHandle(top.idx);
+    }
+    stats_.stale++;
+  }
+}
+
+bool QuaternaryHeapVertexQueue::isEmpty() const
+{
+  return size_ == 0;
+}
+
+void QuaternaryHeapVertexQueue::clear()
+{
+  heap_.clear();
+  std::fill(queued_.begin(), queued_.end(), false);
+  size_ = 0;
+}
+
+void QuaternaryHeapVertexQueue::siftUp(size_t pos)
+{
+  const Entry entry = heap_[pos];
+  while (pos > 0)
+  {
+    const size_t parent = (pos - 1) / 4;
+    if (heap_[parent].key <= entry.key)
+    {
+      break;
+    }
+    heap_[pos] = heap_[parent];
+    pos = parent;
+  }
+  heap_[pos] = entry;
+}
+
+void QuaternaryHeapVertexQueue::siftDown(size_t pos)
+{
+  const size_t size = heap_.size();
+  const Entry entry = heap_[pos];
+  while (true)
+  {
+    const size_t first_child = 4 * pos + 1;
+    if (first_child >= size)
+    {
+      break;
+    }
+
+    const size_t last_child = std::min(first_child + 4, size);
+    size_t min_child = first_child;
+    for (size_t child = first_child + 1; child < last_child; child++)
+    {
+      if (heap_[child].key < heap_[min_child].key)
+      {
+        min_child = child;
+      }
+    }
+
+    if (entry.key <= heap_[min_child].key)
+    {
+      break;
+    }
+    heap_[pos] = heap_[min_child];
+    pos = min_child;
+  }
+  heap_[pos] = entry;
+}
+
+RadixHeapVertexQueue::RadixHeapVertexQueue(const size_t num_vertices)
+  : last_key_(0), current_key_(num_vertices, 0), queued_(num_vertices, false), size_(0), num_entries_(0)
+{
+}
+
+uint32_t RadixHeapVertexQueue::toRadixKey(const float key)
+{
+  // negative values and NaN are mapped to zero, the propagation distances are non-negative
+  if (!(key > 0))
+  {
+    return 0;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &key, sizeof(bits));
+  return bits;
+}
+
+size_t RadixHeapVertexQueue::bucketIndex(const uint32_t key) const
+{
+  return key == last_key_ ? 0 : 32 - __builtin_clz(key ^ last_key_);
+}
+
+void RadixHeapVertexQueue::insert(const lvr2::VertexHandle& vH, const float key)
+{
+  const lvr2::Index idx = vH.idx();
+  if (idx >= queued_.size())
+  {
+    current_key_.resize(idx + 1, 0);
+    queued_.resize(idx + 1, false);
+  }
+
+  const uint32_t k = std::max(toRadixKey(key), last_key_);
+  if (!queued_[idx])
+  {
+    queued_[idx] = true;
+    size_++;
+  }
+  current_key_[idx] = k;
+
+  buckets_[bucketIndex(k)].push_back({ k, idx });
+  num_entries_++;
+
+  stats_.inserts++;
+  stats_.max_size = std::max(stats_.max_size, num_entries_);
+}
+
+lvr2::VertexHandle RadixHeapVertexQueue::popMin()
+{
+  while (true)
+  {
+    if (buckets_[0].empty())
+    {
+      redistribute();
+    }
+
+    const Entry entry = buckets_[0].back();
+    buckets_[0].pop_back();
+    num_entries_--;
+
+    if (isCurrent(entry))
+    {
+      queued_[entry.idx] = false;
+      size_--;
+      stats_.pops++;
+      return lvr2::VertexHandle(entry.idx);
+    }
+    stats_.stale++;
+  }
+}
+
+void RadixHeapVertexQueue::redistribute()
+{
+  for (size_t i = 1; i < buckets_.size(); i++)
+  {
+    std::vector<Entry>& bucket = buckets_[i];
+    if (bucket.empty())
+    {
+      continue;
+    }
+
+    uint32_t min_key = std::numeric_limits<uint32_t>::max();
+    bool found = false;
+    for (const Entry& entry : bucket)
+    {
+      if (isCurrent(entry))
+      {
+        min_key = std::min(min_key, entry.key);
+        found = true;
+      }
+    }
+
+    if (found)
+    {
+      last_key_ = min_key;
+    }
+
+    // all current entries end up in a lower bucket, since they share more leading bits with the new last key
+    for (const Entry& entry : bucket)
+    {
+      if (found && isCurrent(entry))
+      {
+        buckets_[bucketIndex(entry.key)].push_back(entry);
+      }
+      else
+      {
+        num_entries_--;
+        stats_.stale++;
+      }
+    }
+    bucket.clear();
+
+    if (found)
+    {
+      return;
+    }
+  }
+}
+
+bool RadixHeapVertexQueue::isEmpty() const
+{
+  return size_ == 0;
+}
+
+void RadixHeapVertexQueue::clear()
+{
+  for (auto& bucket : buckets_)
+  {
+    bucket.clear();
+  }
+  std::fill(queued_.begin(), queued_.end(), false);
+  last_key_ = 0;
+  size_ = 0;
+  num_entries_ = 0;
+}
+
+VertexQueue::Ptr createVertexQueue(const std::string& type, const size_t num_vertices)
+{
+  if (type == "meap")
+  {
+    return std::make_unique<MeapVertexQueue>(num_vertices);
+  }
+  else if (type == "quaternary_heap")
+  {
+    return std::make_unique<QuaternaryHeapVertexQueue>(num_vertices);
+  }
+  else if (type == "radix_heap")
+  {
+    return std::make_unique<RadixHeapVertexQueue>(num_vertices);
+  }
+  return nullptr;
+}
+
+bool isValidVertexQueueType(const std::string& type)
+{
+  return type == "meap" || type == "quaternary_heap" || type == "radix_heap";
+}
+
+} /* namespace mesh_map */
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include <mesh_map/compact_maps.h>
+
+using namespace ::testing;
+
+TEST(CompactMapsTest, quantizedCostsStayWithinHalfAStep)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> distribution(-2, 3);
+  std::vector<float> costs(1000);
+  for (auto& cost : costs)
+  {
+    cost = distribution(rng);
+  }
+  costs[7] = std::numeric_limits<float>::infinity();
+
+  for (const int bits : { 8, 16, 32 })
+  {
+    mesh_map::CostArray array(bits);
+    array.assign(std::vector<float>(costs));
+    ASSERT_EQ(array.size(), costs.size());
+    EXPECT_TRUE(std::isinf(array[7]));
+    for (size_t i = 0; i < costs.size(); i++)
+    {
+      if (i != 7)
+      {
+        EXPECT_NEAR(array[i], costs[i], 0.5 * array.step() + 1e-6) << bits << " bits, slot " << i;
+      }
+    }
+
+    std::vector<float> sum(costs.size(), 1);
+    array.addTo(sum.data(), 2);
+    EXPECT_TRUE(std::isinf(sum[7]));
+    EXPECT_FLOAT_EQ(sum[3], 1 + 2 * array[3]);
+  }
+
+  mesh_map::CostArray array(8);
+  array.assign(std::vector<float>(costs));
+  EXPECT_EQ(array.memoryUsage(), costs.size());
+  EXPECT_TRUE(array.set(3, 0.5));
+  EXPECT_NEAR(array[3], 0.5, 0.5 * array.step() + 1e-6);
+  EXPECT_TRUE(array.set(3, std::numeric_limits<float>::infinity()));
+  EXPECT_FALSE(array.set(3, 10));
+  EXPECT_NEAR(array[3], 3, array.step());
+
+  EXPECT_THROW(mesh_map::CostArray(12), std::invalid_argument);
+}
+
+TEST(CompactMapsTest, constantCostsRejectOtherCosts)
+{
+  // e.g. a layer without any obstacles yet
+  for (const int bits : { 8, 16 })
+  {
+    mesh_map::CostArray array(bits);
+    array.assign(std::vector<float>(10, 0));
+    EXPECT_TRUE(array.set(2, 0));
+    EXPECT_EQ(array[2], 0);
+    EXPECT_TRUE(array.set(2, std::numeric_limits<float>::infinity()));
+    EXPECT_FALSE(array.set(2, 0.3));
+    EXPECT_FALSE(array.set(2, 0.5));
+    EXPECT_FALSE(array.set(2, -0.2));
+  }
+}
+
+TEST(CompactMapsTest, octahedralRoundTrip)
+{
+  std::mt19937 rng(7);
+  std::normal_distribution<float> distribution;
+  for (size_t i = 0; i < 10000; i++)
+  {
+    const lvr2::BaseVector<float> vec =
+        lvr2::BaseVector<float>(distribution(rng), distribution(rng), distribution(rng)).normalized();
+    const uint32_t code = mesh_map::encodeOctahedral(vec);
+    EXPECT_NE(code, 0u);
+    const auto decoded = mesh_map::decodeOctahedral(code);
+    // the chord length equals the angle for small angles
+    const lvr2::BaseVector<float> error(decoded.x - vec.x, decoded.y - vec.y, decoded.z - vec.z);
+    EXPECT_LT(error.length(), 0.01 * M_PI / 180);
+  }
+
+  mesh_map::CompactVectorMap map(4);
+  EXPECT_FALSE(map.get(lvr2::VertexHandle(2)));
+  map.insert(lvr2::VertexHandle(2), lvr2::BaseVector<float>(0, 0, -1));
+  map.insert(lvr2::VertexHandle(9), lvr2::BaseVector<float>(1, 0, 0));
+  EXPECT_EQ(map.size(), 2u);
+  ASSERT_TRUE(map.get(lvr2::VertexHandle(2)));
+  EXPECT_NEAR(map.get(lvr2::VertexHandle(2))->z, -1, 1e-6);
+  map.erase(lvr2::VertexHandle(2));
+  EXPECT_FALSE(map.containsKey(lvr2::VertexHandle(2)));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(CompactMapsTest, vertexFlagsAreSetConcurrently)
+{
+  mesh_map::VertexFlags flags(1000);
+  EXPECT_EQ(flags.memoryUsage(), 16u * sizeof(uint64_t));
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++)
+  {
+    threads.emplace_back([&flags, t]() {
+      for (size_t i = t; i < 1000; i += 4)
+      {
+        flags.insert(lvr2::VertexHandle(i), i % 3 == 0);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(flags.count(), 334u);
+  EXPECT_TRUE(flags[lvr2::VertexHandle(999)]);
+  EXPECT_FALSE(flags[lvr2::VertexHandle(998)]);
+  EXPECT_FALSE(flags[lvr2::VertexHandle(5000)]);
+  flags.insert(lvr2::VertexHandle(999), false);
+  EXPECT_FALSE(flags[lvr2::VertexHandle(999)]);
+  EXPECT_THROW(flags.insert(lvr2::VertexHandle(1000), true), std::out_of_range);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <mesh_map/eikonal_update.h>
+
+using mesh_map::EikonalKernel;
+using mesh_map::EikonalPrecision;
+using mesh_map::EikonalResult;
+using mesh_map::EikonalScheme;
+
+namespace
+{
+const EikonalScheme SCHEMES[] = { EikonalScheme::LAW_OF_COSINES, EikonalScheme::SIGNED_AREA,
+                                  EikonalScheme::KIMMEL_SETHIAN };
+const EikonalPrecision PRECISIONS[] = { EikonalPrecision::FLOAT, EikonalPrecision::DOUBLE };
+
+struct Point
+{
+  double x, y;
+};
+
+double dist(const Point& p, const Point& q)
+{
+  return std::hypot(p.x - q.x, p.y - q.y);
+}
+
+//! triangle with v1 and v2 on the x axis and v3 above, the arguments in the order of eikonalUpdate()
+struct Triangle
+{
+  Point v1, v2, v3;
+
+  float a() const
+  {
+    return dist(v2, v3);
+  }
+
+  float b() const
+  {
+    return dist(v1, v3);
+  }
+
+  float c() const
+  {
+    return dist(v1, v2);
+  }
+};
+
+const Triangle TRIANGLE{ { 0, 0 }, { 1, 0 }, { 0.4, 0.9 } };
+}  // namespace
+
+TEST(EikonalUpdateTest, pointSourceBehindTheEdge)
+{
+  const Point source{ 0.6, -2.0 };
+  const float u1 = dist(source, TRIANGLE.v1), u2 = dist(source, TRIANGLE.v2);
+  const double expected = dist(source, TRIANGLE.v3);
+
+  EikonalResult result;
+  ASSERT_TRUE((mesh_map::eikonalUpdate<EikonalScheme::LAW_OF_COSINES, double>(
+      u1, u2, INFINITY, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result)));
+  EXPECT_NEAR(result.distance, expected, 1e-5);
+  // the predecessor is the vertex with the smaller angle at v3, the direction is the angle to the source
+  const double angle_v1 = std::acos(((TRIANGLE.v1.x - TRIANGLE.v3.x) * (source.x - TRIANGLE.v3.x) +
+                                     (TRIANGLE.v1.y - TRIANGLE.v3.y) * (source.y - TRIANGLE.v3.y)) /
+                                    (TRIANGLE.b() * expected));
+  const double angle_v2 = std::acos(((TRIANGLE.v2.x - TRIANGLE.v3.x) * (source.x - TRIANGLE.v3.x) +
+                                     (TRIANGLE.v2.y - TRIANGLE.v3.y) * (source.y - TRIANGLE.v3.y)) /
+                                    (TRIANGLE.a() * expected));
+  EXPECT_EQ(result.from_v1, angle_v1 < angle_v2);
+  EXPECT_NEAR(result.direction, std::min(angle_v1, angle_v2), 1e-4);
+
+  // the signed area scheme chooses the predecessor with the smaller distance
+  ASSERT_TRUE((mesh_map::eikonalUpdate<EikonalScheme::SIGNED_AREA, double>(
+      u1, u2, INFINITY, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result)));
+  EXPECT_NEAR(result.distance, expected, 1e-5);
+  EXPECT_FALSE(result.from_v1);
+  EXPECT_NEAR(result.direction, -angle_v2, 1e-4);
+
+  // the planar front through v1 and v2 approximates the point source, but never exceeds the paths along the edges
+  ASSERT_TRUE((mesh_map::eikonalUpdate<EikonalScheme::KIMMEL_SETHIAN, double>(
+      u1, u2, INFINITY, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result)));
+  EXPECT_LE(result.distance, std::min(u1 + TRIANGLE.b(), u2 + TRIANGLE.a()) + 1e-6);
+  EXPECT_NEAR(result.distance, expected, 0.1);
+}
+
+TEST(EikonalUpdateTest, planarFront)
+{
+  // front moving along the unit direction (0.3, 0.95394)
+  const double nx = 0.3, ny = std::sqrt(1 - nx * nx);
+  const auto u = [&](const Point& p) { return nx * p.x + ny * p.y + 1.0; };
+
+  EikonalResult result;
+  ASSERT_TRUE((mesh_map::eikonalUpdate<EikonalScheme::KIMMEL_SETHIAN, double>(
+      u(TRIANGLE.v1), u(TRIANGLE.v2), INFINITY, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result)));
+  EXPECT_NEAR(result.distance, u(TRIANGLE.v3), 1e-5);
+  EXPECT_TRUE(result.from_v1);
+
+  // no update if the current distance is already smaller
+  EXPECT_FALSE((mesh_map::eikonalUpdate<EikonalScheme::KIMMEL_SETHIAN, double>(
+      u(TRIANGLE.v1), u(TRIANGLE.v2), u(TRIANGLE.v3) - 1e-3, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result)));
+
+  // a front parallel to the edge reaches v3 after its height, also in single precision
+  const EikonalKernel kernel{ EikonalScheme::KIMMEL_SETHIAN, EikonalPrecision::FLOAT };
+  ASSERT_TRUE(kernel.update(0, 0, INFINITY, TRIANGLE.a(), TRIANGLE.b(), TRIANGLE.c(), result));
+  EXPECT_NEAR(result.distance, TRIANGLE.v3.y, 1e-5);
+}
+
+TEST(EikonalUpdateTest, batchMatchesScalar)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> coordinate(-1, 1);
+  std::uniform_real_distribution<float> height(0.05, 1);
+  std::uniform_real_distribution<float> offset(0, 1);
+
+  // an odd size, to cover the scalar remainder of the batch
+  const size_t n = 103;
+  std::vector<float> u1(n), u2(n), a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    const Triangle triangle{ { 0, 0 }, { 1, 0 }, { coordinate(rng), height(rng) } };
+    a[i] = triangle.a();
+    b[i] = triangle.b();
+    c[i] = triangle.c();
+    u1[i] = offset(rng);
+    u2[i] = std::max(0.0f, u1[i] + coordinate(rng) * c[i]);
+  }
+  u2[7] = INFINITY;
+
+  for (const auto scheme : SCHEMES)
+  {
+    for (const auto precision : PRECISIONS)
+    {
+      const EikonalKernel kernel{ scheme, precision };
+      std::vector<float> u3(n);
+      kernel.distances(n, u1.data(), u2.data(), a.data(), b.data(), c.data(), u3.data());
+      for (size_t i = 0; i < n; i++)
+      {
+        EikonalResult result;
+        if (kernel.update(u1[i], u2[i], INFINITY, a[i], b[i], c[i], result))
+        {
+          EXPECT_NEAR(u3[i], result.distance, 1e-5 * result.distance) << "triangle " << i;
+        }
+        else
+        {
+          EXPECT_EQ(u3[i], INFINITY) << "triangle " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(EikonalUpdateTest, parsesKernel)
+{
+  EikonalKernel kernel;
+  EXPECT_TRUE(kernel.parse("kimmel_sethian", "float"));
+  EXPECT_EQ(kernel.scheme, EikonalScheme::KIMMEL_SETHIAN);
+  EXPECT_EQ(kernel.precision, EikonalPrecision::FLOAT);
+  EXPECT_FALSE(kernel.parse("fmm", "double"));
+  EXPECT_FALSE(kernel.parse("signed_area", "half"));
+  EXPECT_EQ(kernel.scheme, EikonalScheme::KIMMEL_SETHIAN);
+  EXPECT_EQ(kernel.precision, EikonalPrecision::FLOAT);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <limits>
+#include <random>
+#include <vector>
+#include <mesh_map/face_bvh.h>
+
+using namespace ::testing;
+
+typedef lvr2::BaseVector<float> Vec;
+
+namespace
+{
+void randomTriangles(const size_t num, std::vector<std::array<Vec, 3>>& triangles,
+                     std::vector<lvr2::FaceHandle>& faces)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> position(-10, 10);
+  std::uniform_real_distribution<float> offset(-0.5, 0.5);
+  for (size_t i = 0; i < num; i++)
+  {
+    const Vec center(position(gen), position(gen), position(gen));
+    triangles.push_back({ center + Vec(offset(gen), offset(gen), offset(gen)),
+                          center + Vec(offset(gen), offset(gen), offset(gen)),
+                          center + Vec(offset(gen), offset(gen), offset(gen)) });
+    faces.push_back(lvr2::FaceHandle(i));
+  }
+}
+}  // namespace
+
+TEST(FaceBVHTest, raysHitStackedFloorsFromAbove)
+{
+  // two floors above each other, as in a multi-level building
+  const std::vector<std::array<Vec, 3>> triangles = {
+    { Vec(0, 0, 0), Vec(4, 0, 0), Vec(0, 4, 0) },
+    { Vec(0, 0, 3), Vec(4, 0, 3), Vec(0, 4, 3) },
+  };
+  const std::vector<lvr2::FaceHandle> faces = { lvr2::FaceHandle(7), lvr2::FaceHandle(9) };
+  const mesh_map::FaceBVH bvh(triangles, faces);
+  EXPECT_EQ(bvh.numFaces(), 2u);
+
+  mesh_map::FaceBVH::RayHit hit;
+  ASSERT_TRUE(bvh.intersectRay(Vec(1, 1, 1), Vec(0, 0, -1), 10, hit));
+  EXPECT_EQ(hit.face.unwrap(), lvr2::FaceHandle(7));
+  EXPECT_NEAR(hit.distance, 1, 1e-5);
+  EXPECT_NEAR(hit.bary_coords[0], 0.5, 1e-5);
+  EXPECT_NEAR(hit.bary_coords[1], 0.25, 1e-5);
+  EXPECT_NEAR(hit.bary_coords[2], 0.25, 1e-5);
+
+  ASSERT_TRUE(bvh.intersectRay(Vec(1, 1, 5), Vec(0, 0, -1), 10, hit));
+  EXPECT_EQ(hit.face.unwrap(), lvr2::FaceHandle(9));
+  EXPECT_NEAR(hit.distance, 2, 1e-5);
+
+  EXPECT_FALSE(bvh.intersectRay(Vec(1, 1, 5), Vec(0, 0, -1), 1.5, hit));
+  EXPECT_FALSE(bvh.intersectRay(Vec(5, 5, 5), Vec(0, 0, -1), 10, hit));
+  EXPECT_FALSE(hit.face);
+}
+
+TEST(FaceBVHTest, infiniteMaxDistanceReportsOnlyHits)
+{
+  const std::vector<std::array<Vec, 3>> triangles = {
+    { Vec(0, 0, 0), Vec(4, 0, 0), Vec(0, 4, 0) },
+  };
+  const std::vector<lvr2::FaceHandle> faces = { lvr2::FaceHandle(3) };
+  const mesh_map::FaceBVH bvh(triangles, faces);
+  const float infinity = std::numeric_limits<float>::infinity();
+
+  mesh_map::FaceBVH::RayHit hit;
+  ASSERT_TRUE(bvh.intersectRay(Vec(1, 1, 5), Vec(0, 0, -1), infinity, hit));
+  EXPECT_EQ(hit.face.unwrap(), lvr2::FaceHandle(3));
+  EXPECT_NEAR(hit.distance, 5, 1e-5);
+
+  // inside the bounding box of the leaf, but beside the triangle
+  EXPECT_FALSE(bvh.intersectRay(Vec(3, 3, 5), Vec(0, 0, -1), infinity, hit));
+  EXPECT_FALSE(hit.face);
+  EXPECT_FALSE(bvh.intersectRay(Vec(5, 5, 5), Vec(0, 0, -1), infinity, hit));
+  EXPECT_FALSE(hit.face);
+}
+
+TEST(FaceBVHTest, closestPointProjectsOntoFace)
+{
+  const std::vector<std::array<Vec, 3>> triangles = { { Vec(0, 0, 0), Vec(4, 0, 0), Vec(0, 4, 0) } };
+  const mesh_map::FaceBVH bvh(triangles, { lvr2::FaceHandle(0) });
+
+  mesh_map::FaceBVH::ClosestPoint result;
+  ASSERT_TRUE(bvh.closestPoint(Vec(1, 1, 0.5), 1, result));
+  EXPECT_NEAR(result.point.x, 1, 1e-5);
+  EXPECT_NEAR(result.point.y, 1, 1e-5);
+  EXPECT_NEAR(result.point.z, 0, 1e-5);
+  EXPECT_NEAR(result.distance, 0.5, 1e-5);
+
+  // outside the triangle the closest point is on its boundary
+  ASSERT_TRUE(bvh.closestPoint(Vec(-1, -1, 0), 2, result));
+  EXPECT_NEAR(result.point.x, 0, 1e-5);
+  EXPECT_NEAR(result.point.y, 0, 1e-5);
+  EXPECT_NEAR(result.bary_coords[0], 1, 1e-5);
+
+  EXPECT_FALSE(bvh.closestPoint(Vec(1, 1, 5), 1, result));
+}
+
+TEST(FaceBVHTest, hierarchyMatchesSingleLeaf)
+{
+  std::vector<std::array<Vec, 3>> triangles;
+  std::vector<lvr2::FaceHandle> faces;
+  randomTriangles(2000, triangles, faces);
+
+  // a single leaf tests all triangles, i.e. it is the brute force reference for the hierarchy
+  const mesh_map::FaceBVH bvh(triangles, faces);
+  const mesh_map::FaceBVH reference(triangles, faces, triangles.size());
+  EXPECT_GT(bvh.numNodes(), 1u);
+  EXPECT_EQ(reference.numNodes(), 1u);
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> position(-12, 12);
+  std::uniform_real_distribution<float> direction(-1, 1);
+  std::vector<Vec> origins, directions;
+  for (size_t i = 0; i < 500; i++)
+  {
+    origins.emplace_back(position(gen), position(gen), position(gen));
+    directions.emplace_back(direction(gen), direction(gen), direction(gen));
+  }
+
+  std::vector<mesh_map::FaceBVH::RayHit> hits, reference_hits;
+  bvh.intersectRays(origins, directions, 100, hits);
+  reference.intersectRays(origins, directions, 100, reference_hits);
+  ASSERT_EQ(hits.size(), origins.size());
+  size_t num_hits = 0;
+  for (size_t i = 0; i < hits.size(); i++)
+  {
+    ASSERT_EQ(static_cast<bool>(hits[i].face), static_cast<bool>(reference_hits[i].face));
+    if (hits[i].face)
+    {
+      EXPECT_NEAR(hits[i].distance, reference_hits[i].distance, 1e-4);
+      num_hits++;
+    }
+  }
+  EXPECT_GT(num_hits, 0u);
+
+  std::vector<mesh_map::FaceBVH::ClosestPoint> points, reference_points;
+  bvh.closestPoints(origins, 2, points);
+  reference.closestPoints(origins, 2, reference_points);
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    ASSERT_EQ(static_cast<bool>(points[i].face), static_cast<bool>(reference_points[i].face));
+    if (points[i].face)
+    {
+      EXPECT_NEAR(points[i].distance, reference_points[i].distance, 1e-4);
+    }
+  }
+}
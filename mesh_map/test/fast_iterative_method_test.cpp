@@ -0,0 +1,271 @@
+/*
+ *  Copyright 2020, Sebastian Pütz
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *
+ */
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <lvr2/geometry/HalfEdgeMesh.hpp>
+#include <mesh_map/fast_iterative_method.h>
+#include <mesh_map/mesh_topology.h>
+
+namespace
+{
+typedef lvr2::BaseVector<float> Vec;
+
+//! regular grid of size x size squares in the xy plane, each split into two triangles
+std::shared_ptr<lvr2::HalfEdgeMesh<Vec>> gridMesh(const size_t size)
+{
+  const size_t num_vertices = (size + 1) * (size + 1);
+  lvr2::floatArr vertices(new float[3 * num_vertices]);
+  for (size_t y = 0; y <= size; y++)
+  {
+    for (size_t x = 0; x <= size; x++)
+    {
+      const size_t i = y * (size + 1) + x;
+      vertices[3 * i] = x;
+      vertices[3 * i + 1] = y;
+      vertices[3 * i + 2] = 0;
+    }
+  }
+  lvr2::indexArray faces(new unsigned int[6 * size * size]);
+  size_t f = 0;
+  for (size_t y = 0; y < size; y++)
+  {
+    for (size_t x = 0; x < size; x++)
+    {
+      const unsigned int v0 = y * (size + 1) + x, v1 = v0 + 1, v2 = v0 + size + 1, v3 = v2 + 1;
+      for (const unsigned int corner : { v0, v1, v3, v0, v3, v2 })
+      {
+        faces[f++] = corner;
+      }
+    }
+  }
+  auto buffer = std::make_shared<lvr2::MeshBuffer>();
+  buffer->setVertices(vertices, num_vertices);
+  buffer->setFaceIndices(faces, 2 * size * size);
+  return std::make_shared<lvr2::HalfEdgeMesh<Vec>>(buffer);
+}
+
+//! first order eikonal update on a triangle with unit speed, falling back to the edges
+float triangleUpdate(const Vec& p1, const Vec& p2, const Vec& p3, const float u1, const float u2)
+{
+  const Vec e1 = p1 - p3, e2 = p2 - p3;
+  const float a = e1.dot(e1), c = e2.dot(e2);
+  const float du = u2 - u1;
+  // minimize u1 + t * du + |e1 + t * (e2 - e1)| over t in [0, 1]
+  const Vec d = e2 - e1;
+  const float dd = d.dot(d), ed = e1.dot(d);
+  float best = std::min(u1 + std::sqrt(a), u2 + std::sqrt(c));
+  if (dd > 0 && std::fabs(du) < std::sqrt(dd))
+  {
+    const float h2 = a - ed * ed / dd;
+    const float t = -ed / dd - du * std::sqrt(std::max(h2, 0.0f) / (dd * (dd - du * du)));
+    if (t > 0 && t < 1)
+    {
+      best = std::min(best, u1 + t * du + (e1 + d * t).length());
+    }
+  }
+  return best;
+}
+
+class FastIterativeMethodTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    mesh = gridMesh(40);
+    topology = std::make_shared<mesh_map::MeshTopology>(*mesh);
+    update = [this](const lvr2::FaceHandle&, const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
+                    const lvr2::VertexHandle& v3, const float u1, const float u2) {
+      return triangleUpdate(mesh->getVertexPosition(v1), mesh->getVertexPosition(v2), mesh->getVertexPosition(v3),
+                            u1, u2);
+    };
+    // the two vertices of the diagonal of the center square
+    const lvr2::VertexHandle seed(20 * 41 + 20);
+    seeds = { { seed, 0.0f } };
+    for (const auto& nH : topology->neighboursOfVertex(seed))
+    {
+      seeds.push_back({ nH, mesh->getVertexPosition(nH).distance(mesh->getVertexPosition(seed)) });
+    }
+  }
+
+  //! sequential fast marching with the same update, the reference for the parallel solver
+  std::vector<float> fastMarching(const float max_distance)
+  {
+    std::vector<float> distances(topology->numVertexSlots(), std::numeric_limits<float>::infinity());
+    std::vector<uint8_t> fixed(topology->numVertexSlots(), false);
+    typedef std::pair<float, lvr2::Index> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (const auto& seed : seeds)
+    {
+      distances[seed.first.idx()] = seed.second;
+      queue.push({ seed.second, seed.first.idx() });
+    }
+    while (!queue.empty())
+    {
+      const lvr2::VertexHandle vH(queue.top().second);
+      queue.pop();
+      if (fixed[vH.idx()])
+        continue;
+      fixed[vH.idx()] = true;
+      if (distances[vH.idx()] > max_distance)
+        continue;
+      for (const auto& nH : topology->neighboursOfVertex(vH))
+      {
+        for (const auto& fH : topology->facesOfVertex(nH))
+        {
+          const auto& vertices = topology->verticesOfFace(fH);
+          const size_t corner = vertices[0] == nH ? 0 : vertices[1] == nH ? 1 : 2;
+          const auto& v1 = vertices[(corner + 1) % 3];
+          const auto& v2 = vertices[(corner + 2) % 3];
+          if (fixed[nH.idx()] || !fixed[v1.idx()] || !fixed[v2.idx()])
+            continue;
+          const float u3 = update(fH, v1, v2, nH, distances[v1.idx()], distances[v2.idx()]);
+          if (u3 < distances[nH.idx()])
+          {
+            distances[nH.idx()] = u3;
+            queue.push({ u3, nH.idx() });
+          }
+        }
+      }
+    }
+    return distances;
+  }
+
+  std::shared_ptr<lvr2::HalfEdgeMesh<Vec>> mesh;
+  std::shared_ptr<mesh_map::MeshTopology> topology;
+  std::function<float(const lvr2::FaceHandle&, const lvr2::VertexHandle&, const lvr2::VertexHandle&,
+                      const lvr2::VertexHandle&, const float, const float)>
+      update;
+  std::vector<std::pair<lvr2::VertexHandle, float>> seeds;
+};
+
+const auto all_accessible = [](const lvr2::VertexHandle&) { return true; };
+}  // namespace
+
+TEST_F(FastIterativeMethodTest, matchesFastMarching)
+{
+  mesh_map::FastIterativeMethod fim(4);
+  const auto inf = std::numeric_limits<float>::infinity();
+  fim.solve(*topology, seeds, inf, {}, 0, all_accessible, update);
+  const auto reference = fastMarching(inf);
+
+  EXPECT_EQ(fim.reached().size(), mesh->numVertices());
+  for (size_t i = 0; i < reference.size(); i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    ASSERT_TRUE(std::isfinite(reference[i]));
+    EXPECT_NEAR(fim.distance(vH), reference[i], 1e-3 * (1 + reference[i])) << "vertex " << i;
+    // both are upper bounds of the euclidean distance on the plane
+    EXPECT_GE(fim.distance(vH) + 1e-4, mesh->getVertexPosition(vH).distance(Vec(20, 20, 0)));
+  }
+}
+
+TEST_F(FastIterativeMethodTest, resultDoesNotDependOnThreads)
+{
+  mesh_map::FastIterativeMethod sequential(1), parallel(8);
+  sequential.solve(*topology, seeds, 12, {}, 0, all_accessible, update);
+  parallel.solve(*topology, seeds, 12, {}, 0, all_accessible, update);
+  EXPECT_EQ(sequential.reached().size(), parallel.reached().size());
+  for (size_t i = 0; i < topology->numVertexSlots(); i++)
+  {
+    const lvr2::VertexHandle vH(i);
+    EXPECT_EQ(sequential.distance(vH), parallel.distance(vH));
+    EXPECT_EQ(sequential.face(vH), parallel.face(vH));
+  }
+}
+
+TEST_F(FastIterativeMethodTest, stopsBehindTargetsAndObstacles)
+{
+  mesh_map::FastIterativeMethod fim(4);
+  const lvr2::VertexHandle target(20 * 41 + 25);
+  // a wall at x = 15 is not entered
+  const auto accessible = [this](const lvr2::VertexHandle& vH) { return mesh->getVertexPosition(vH).x != 15; };
+  fim.solve(*topology, seeds, std::numeric_limits<float>::infinity(), { target }, 0.5, accessible, update);
+
+  EXPECT_NEAR(fim.distance(target), 5, 1e-3);
+  const lvr2::VertexHandle far(20 * 41 + 35);
+  EXPECT_FALSE(std::isfinite(fim.distance(far)));
+  const lvr2::VertexHandle wall(20 * 41 + 15);
+  EXPECT_FALSE(std::isfinite(fim.distance(wall)));
+  EXPECT_LT(fim.reached().size(), mesh->numVertices() / 2);
+  // seeds have no face, reached vertices do
+  EXPECT_EQ(fim.face(seeds.front().first), mesh_map::FastIterativeMethod::NO_FACE);
+  EXPECT_NE(fim.face(lvr2::VertexHandle(20 * 41 + 23)), mesh_map::FastIterativeMethod::NO_FACE);
+}
+
+TEST_F(FastIterativeMethodTest, batchedEikonalUpdateMatchesScalarKernel)
+{
+  lvr2::DenseEdgeMap<float> edge_lengths(topology->numEdgeSlots(), 0);
+  for (size_t i = 0; i < topology->numEdgeSlots(); i++)
+  {
+    const auto& vertices = topology->verticesOfEdge(lvr2::EdgeHandle(i));
+    edge_lengths[lvr2::EdgeHandle(i)] =
+        mesh->getVertexPosition(vertices[0]).distance(mesh->getVertexPosition(vertices[1]));
+  }
+
+  const auto inf = std::numeric_limits<float>::infinity();
+  for (const auto scheme : { mesh_map::EikonalScheme::LAW_OF_COSINES, mesh_map::EikonalScheme::KIMMEL_SETHIAN })
+  {
+    const mesh_map::EikonalKernel kernel{ scheme, mesh_map::EikonalPrecision::FLOAT };
+    const auto scalar_update = [&](const lvr2::FaceHandle&, const lvr2::VertexHandle& v1, const lvr2::VertexHandle& v2,
+                                   const lvr2::VertexHandle& v3, const float u1, const float u2) {
+      mesh_map::EikonalResult result;
+      return kernel.update(u1, u2, inf, edge_lengths[topology->edgeBetween(v2, v3).unwrap()],
+                           edge_lengths[topology->edgeBetween(v1, v3).unwrap()],
+                           edge_lengths[topology->edgeBetween(v1, v2).unwrap()], result) ? result.distance : inf;
+    };
+
+    mesh_map::FastIterativeMethod scalar(2), batched(2);
+    scalar.solve(*topology, seeds, inf, {}, 0, all_accessible, scalar_update);
+    batched.solve(*topology, seeds, inf, {}, 0, all_accessible, mesh_map::EikonalEdgeUpdate{ edge_lengths, kernel });
+
+    ASSERT_EQ(batched.reached().size(), scalar.reached().size());
+    for (size_t i = 0; i < topology->numVertexSlots(); i++)
+    {
+      const lvr2::VertexHandle vH(i);
+      EXPECT_NEAR(batched.distance(vH), scalar.distance(vH), 1e-4 * (1 + scalar.distance(vH))) << "vertex " << i;
+      EXPECT_GE(batched.distance(vH) + 1e-4, mesh->getVertexPosition(vH).distance(Vec(20, 20, 0)));
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <mesh_map/geometry_cache.h>
+
+using namespace ::testing;
+
+TEST(GeometryCacheTest, computesEachKeyOnce)
+{
+  mesh_map::GeometryCache cache;
+  std::atomic<int> num_computed(0);
+  const std::function<std::shared_ptr<const std::vector<float>>()> compute = [&]() {
+    num_computed++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return std::make_shared<const std::vector<float>>(100, 1.0f);
+  };
+
+  std::vector<std::shared_ptr<const std::vector<float>>> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    threads.emplace_back([&, i]() { results[i] = cache.get<std::vector<float>>("face_areas", compute); });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(num_computed, 1);
+  for (const auto& result : results)
+  {
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result, results.front());
+  }
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(cache.find<std::vector<float>>("face_areas"), results.front());
+  EXPECT_FALSE(cache.find<std::vector<float>>("vertex_areas"));
+  EXPECT_THROW(cache.get<std::vector<int>>("face_areas", []() { return std::shared_ptr<const std::vector<int>>(); }),
+               std::logic_error);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(results.front()->size(), 100u);
+  cache.get<std::vector<float>>("face_areas", compute);
+  EXPECT_EQ(num_computed, 2);
+}
+
+TEST(GeometryCacheTest, cachesEmptyResults)
+{
+  mesh_map::GeometryCache cache;
+  int num_computed = 0;
+  const std::function<std::shared_ptr<const int>()> compute = [&]() {
+    num_computed++;
+    return std::shared_ptr<const int>();
+  };
+  EXPECT_FALSE(cache.get<int>("too_large", compute));
+  EXPECT_FALSE(cache.get<int>("too_large", compute));
+  EXPECT_EQ(num_computed, 1);
+}
+
+TEST(GeometryCacheTest, neighbourhoodsOfVertices)
+{
+  std::vector<uint32_t> offsets = { 0, 2, 2, 5 };
+  std::vector<lvr2::VertexHandle> vertices = { lvr2::VertexHandle(0), lvr2::VertexHandle(2), lvr2::VertexHandle(2),
+                                               lvr2::VertexHandle(0), lvr2::VertexHandle(1) };
+  const mesh_map::VertexNeighbourhoods neighbourhoods(0.3, std::move(offsets), std::move(vertices));
+  EXPECT_FLOAT_EQ(neighbourhoods.radius(), 0.3);
+  ASSERT_EQ(neighbourhoods.numVertexSlots(), 3u);
+  EXPECT_TRUE(neighbourhoods.of(lvr2::VertexHandle(1)).empty());
+  const auto range = neighbourhoods.of(lvr2::VertexHandle(2));
+  ASSERT_EQ(range.size(), 3u);
+  EXPECT_EQ(range[0], lvr2::VertexHandle(2));
+  EXPECT_EQ(range[2], lvr2::VertexHandle(1));
+
+  EXPECT_THROW(mesh_map::VertexNeighbourhoods(0.3, { 0, 3 }, { lvr2::VertexHandle(0) }), std::invalid_argument);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <mesh_map/instrumentation.h>
+
+using namespace ::testing;
+
+namespace
+{
+void timedScope()
+{
+  MESH_MAP_SCOPED_TIMER("instrumentation_test.timed_scope");
+}
+
+void countedValue(const uint64_t value)
+{
+  MESH_MAP_COUNT("instrumentation_test.counted_value", value);
+}
+}  // namespace
+
+TEST(InstrumentationTest, recordsNothingWhenDisabled)
+{
+  auto& instrumentation = mesh_map::Instrumentation::instance();
+  instrumentation.setEnabled(false);
+  timedScope();
+  countedValue(3);
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.timed_scope").summary().count, 0u);
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.counted_value").summary().count, 0u);
+}
+
+TEST(InstrumentationTest, looksUpRuntimeNamesOnlyWhenEnabled)
+{
+  auto& instrumentation = mesh_map::Instrumentation::instance();
+  bool looked_up = false;
+  auto histogram = [&]() -> mesh_map::Histogram& {
+    looked_up = true;
+    return instrumentation.histogram(std::string("instrumentation_test.") + "runtime_name");
+  };
+
+  instrumentation.setEnabled(false);
+  {
+    mesh_map::ScopedTimer timer(histogram);
+  }
+  EXPECT_FALSE(looked_up);
+
+  instrumentation.setEnabled(true);
+  {
+    mesh_map::ScopedTimer timer(histogram);
+  }
+  instrumentation.setEnabled(false);
+  EXPECT_TRUE(looked_up);
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.runtime_name").summary().count, 1u);
+}
+
+TEST(InstrumentationTest, aggregatesValuesOfAllThreads)
+{
+  auto& instrumentation = mesh_map::Instrumentation::instance();
+  instrumentation.setEnabled(true);
+  std::vector<std::thread> threads;
+  for (uint64_t t = 0; t < 4; t++)
+  {
+    threads.emplace_back([t]() {
+      for (uint64_t i = 1; i <= 100; i++)
+      {
+        countedValue(i);
+        timedScope();
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  instrumentation.setEnabled(false);
+
+  const auto summary = instrumentation.histogram("instrumentation_test.counted_value").summary(true);
+  EXPECT_EQ(summary.count, 400u);
+  EXPECT_EQ(summary.sum, 4u * 5050);
+  EXPECT_EQ(summary.min, 1u);
+  EXPECT_EQ(summary.max, 100u);
+  EXPECT_DOUBLE_EQ(summary.mean(), 50.5);
+  // the buckets only bound the percentiles by powers of two
+  EXPECT_THAT(summary.percentile(0.5), AllOf(Ge(32.0), Le(64.0)));
+  EXPECT_DOUBLE_EQ(summary.percentile(1.0), 100.0);
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.counted_value").summary().count, 0u);
+
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.timed_scope").unit(), "us");
+  EXPECT_EQ(instrumentation.histogram("instrumentation_test.timed_scope").summary(true).count, 400u);
+}
+
+TEST(InstrumentationTest, writesChromeTraceEvents)
+{
+  auto& instrumentation = mesh_map::Instrumentation::instance();
+  const std::string file_name = ::testing::TempDir() + "instrumentation_test_trace.json";
+  ASSERT_TRUE(instrumentation.startTrace(file_name));
+  instrumentation.setEnabled(true);
+  timedScope();
+  countedValue(7);
+  instrumentation.setEnabled(false);
+  instrumentation.stopTrace();
+
+  std::ifstream file(file_name);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_THAT(content.str(), StartsWith("{\"traceEvents\":["));
+  EXPECT_THAT(content.str(), HasSubstr("\"name\":\"instrumentation_test.timed_scope\",\"cat\":\"mesh_navigation\","
+                                       "\"ph\":\"X\""));
+  EXPECT_THAT(content.str(), HasSubstr("\"ph\":\"C\""));
+  EXPECT_THAT(content.str(), HasSubstr("\"args\":{\"value\":7}"));
+  EXPECT_THAT(content.str(), EndsWith("\"displayTimeUnit\":\"ms\"}\n"));
+  std::remove(file_name.c_str());
+
+  instrumentation.histogram("instrumentation_test.timed_scope").summary(true);
+  instrumentation.histogram("instrumentation_test.counted_value").summary(true);
+}
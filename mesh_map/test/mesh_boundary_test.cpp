@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <set>
+#include <vector>
+#include <lvr2/geometry/HalfEdgeMesh.hpp>
+#include <mesh_map/mesh_boundary.h>
+#include <mesh_map/mesh_topology.h>
+
+using namespace ::testing;
+
+namespace
+{
+typedef lvr2::BaseVector<float> Vec;
+
+//! flat grid of size x size unit squares, each split into two triangles, without the squares in holes
+std::shared_ptr<lvr2::HalfEdgeMesh<Vec>> gridMesh(const size_t size, const std::set<size_t>& holes = {})
+{
+  const size_t num_vertices = (size + 1) * (size + 1);
+  lvr2::floatArr vertices(new float[3 * num_vertices]);
+  for (size_t y = 0; y <= size; y++)
+  {
+    for (size_t x = 0; x <= size; x++)
+    {
+      const size_t i = y * (size + 1) + x;
+      vertices[3 * i] = x;
+      vertices[3 * i + 1] = y;
+      vertices[3 * i + 2] = 0;
+    }
+  }
+  lvr2::indexArray faces(new unsigned int[6 * size * size]);
+  size_t f = 0;
+  for (size_t y = 0; y < size; y++)
+  {
+    for (size_t x = 0; x < size; x++)
+    {
+      if (holes.count(y * size + x))
+      {
+        continue;
+      }
+      const unsigned int v0 = y * (size + 1) + x, v1 = v0 + 1, v2 = v0 + size + 1, v3 = v2 + 1;
+      for (const unsigned int corner : { v0, v1, v3, v0, v3, v2 })
+      {
+        faces[f++] = corner;
+      }
+    }
+  }
+  auto buffer = std::make_shared<lvr2::MeshBuffer>();
+  buffer->setVertices(vertices, num_vertices);
+  buffer->setFaceIndices(faces, f / 3);
+  return std::make_shared<lvr2::HalfEdgeMesh<Vec>>(buffer);
+}
+
+//! the contours as sets of vertex indices, independent of where the walks started
+std::set<std::set<size_t>> contourSets(const mesh_map::MeshBoundary& boundary)
+{
+  std::set<std::set<size_t>> contours;
+  for (size_t i = 0; i < boundary.numContours(); i++)
+  {
+    std::set<size_t> contour;
+    for (const auto& vH : boundary.contour(i))
+    {
+      contour.insert(vH.idx());
+    }
+    contours.insert(contour);
+  }
+  return contours;
+}
+}  // namespace
+
+TEST(MeshBoundaryTest, outerBorderIsOneLoop)
+{
+  const size_t size = 6;
+  auto mesh = gridMesh(size);
+  const mesh_map::MeshTopology topology(*mesh);
+  const mesh_map::MeshBoundary boundary(topology);
+
+  ASSERT_EQ(boundary.numContours(), 1u);
+  EXPECT_EQ(boundary.numBoundaryEdges(), 4 * size);
+  const auto contour = boundary.contour(0);
+  ASSERT_EQ(contour.size(), 4 * size);
+
+  // consecutive vertices are connected by boundary edges, including the last and the first
+  for (size_t i = 0; i < contour.size(); i++)
+  {
+    const auto eH = topology.edgeBetween(contour[i], contour[(i + 1) % contour.size()]);
+    ASSERT_TRUE(eH);
+    EXPECT_TRUE(boundary.isBoundaryEdge(eH.unwrap()));
+  }
+
+  EXPECT_TRUE(boundary.isBoundaryVertex(lvr2::VertexHandle(0)));
+  EXPECT_TRUE(boundary.isBoundaryVertex(lvr2::VertexHandle(size)));
+  EXPECT_FALSE(boundary.isBoundaryVertex(lvr2::VertexHandle(size + 2)));
+}
+
+TEST(MeshBoundaryTest, holesAreSeparateLoops)
+{
+  const size_t size = 8;
+  auto mesh = gridMesh(size, { 2 * size + 2, 5 * size + 5, 5 * size + 6 });
+  const mesh_map::MeshTopology topology(*mesh);
+  const mesh_map::MeshBoundary boundary(topology);
+
+  ASSERT_EQ(boundary.numContours(), 3u);
+  std::vector<size_t> sizes;
+  for (size_t i = 0; i < boundary.numContours(); i++)
+  {
+    sizes.push_back(boundary.contour(i).size());
+  }
+  EXPECT_THAT(sizes, UnorderedElementsAre(4 * size, 4u, 6u));
+  EXPECT_EQ(boundary.contourOffsets().back(), boundary.contourVertices().size());
+  EXPECT_TRUE(boundary.isBoundaryVertex(lvr2::VertexHandle(2 * (size + 1) + 2)));
+}
+
+TEST(MeshBoundaryTest, parallelMatchesSequential)
+{
+  const size_t size = 60;
+  auto mesh = gridMesh(size, { 10 * size + 10, 30 * size + 40, 50 * size + 20 });
+  const mesh_map::MeshTopology topology(*mesh);
+  const mesh_map::MeshBoundary sequential(topology, 1);
+  const mesh_map::MeshBoundary parallel(topology, 4);
+
+  EXPECT_EQ(parallel.numContours(), sequential.numContours());
+  EXPECT_EQ(parallel.numBoundaryEdges(), sequential.numBoundaryEdges());
+  EXPECT_EQ(contourSets(parallel), contourSets(sequential));
+}
+
+TEST(MeshBoundaryTest, updateMatchesRebuild)
+{
+  const size_t size = 8;
+  auto mesh = gridMesh(size);
+  mesh_map::MeshBoundary boundary{ mesh_map::MeshTopology(*mesh) };
+  ASSERT_EQ(boundary.numContours(), 1u);
+
+  // cut out an interior square
+  const size_t square = 3 * size + 4;
+  std::vector<lvr2::VertexHandle> vertices;
+  for (const auto fH : { lvr2::FaceHandle(2 * square), lvr2::FaceHandle(2 * square + 1) })
+  {
+    for (const auto& vH : mesh->getVerticesOfFace(fH))
+    {
+      vertices.push_back(vH);
+    }
+    mesh->removeFace(fH);
+  }
+  const mesh_map::MeshTopology topology(*mesh);
+  boundary.update(topology, vertices);
+
+  const mesh_map::MeshBoundary rebuilt(topology);
+  ASSERT_EQ(boundary.numContours(), 2u);
+  EXPECT_EQ(boundary.numBoundaryEdges(), rebuilt.numBoundaryEdges());
+  EXPECT_EQ(contourSets(boundary), contourSets(rebuilt));
+}
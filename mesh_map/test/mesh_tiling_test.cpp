@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <vector>
+#include <mesh_map/mesh_tiling.h>
+
+using namespace ::testing;
+
+namespace
+{
+//! flat grid of size x size unit squares, each split into two triangles
+lvr2::MeshBufferPtr gridBuffer(const size_t size)
+{
+  const size_t num_vertices = (size + 1) * (size + 1);
+  lvr2::floatArr vertices(new float[3 * num_vertices]);
+  for (size_t y = 0; y <= size; y++)
+  {
+    for (size_t x = 0; x <= size; x++)
+    {
+      const size_t i = y * (size + 1) + x;
+      vertices[3 * i] = x;
+      vertices[3 * i + 1] = y;
+      vertices[3 * i + 2] = 0;
+    }
+  }
+  lvr2::indexArray faces(new unsigned int[6 * size * size]);
+  size_t f = 0;
+  for (size_t y = 0; y < size; y++)
+  {
+    for (size_t x = 0; x < size; x++)
+    {
+      const unsigned int v = y * (size + 1) + x;
+      const unsigned int corners[6] = { v, v + 1, v + 1 + static_cast<unsigned int>(size + 1),
+                                        v, v + 1 + static_cast<unsigned int>(size + 1),
+                                        v + static_cast<unsigned int>(size + 1) };
+      for (const auto corner : corners)
+      {
+        faces[f++] = corner;
+      }
+    }
+  }
+  auto buffer = std::make_shared<lvr2::MeshBuffer>();
+  buffer->setVertices(vertices, num_vertices);
+  buffer->setFaceIndices(faces, 2 * size * size);
+  return buffer;
+}
+}  // namespace
+
+TEST(MeshTilingTest, tilesOverlapByHalo)
+{
+  auto buffer = gridBuffer(10);
+  const mesh_map::MeshTiling tiling(*buffer, 5, 0.5);
+  ASSERT_EQ(tiling.numTiles(), 4u);
+
+  // 5 x 5 squares per tile, grown by the column and row of squares touching the halo on the inner sides
+  EXPECT_EQ(tiling.numFacesOfTile(0), 2u * 6 * 6);
+
+  size_t num_entries = 0;
+  for (uint32_t tile = 0; tile < tiling.numTiles(); tile++)
+  {
+    num_entries += tiling.numFacesOfTile(tile);
+  }
+  EXPECT_GT(num_entries, buffer->numFaces());
+}
+
+TEST(MeshTilingTest, extractsConnectedSubMesh)
+{
+  auto buffer = gridBuffer(10);
+  const mesh_map::MeshTiling tiling(*buffer, 5, 0.5);
+
+  const auto tiles = tiling.tilesAround(2, 2, 1);
+  ASSERT_THAT(tiles, ElementsAre(0u));
+
+  std::vector<uint32_t> vertex_ids;
+  auto sub_buffer = tiling.extract(*buffer, tiles, vertex_ids);
+  ASSERT_TRUE(sub_buffer);
+  EXPECT_EQ(sub_buffer->numFaces(), tiling.numFacesOfTile(0));
+  EXPECT_EQ(sub_buffer->numVertices(), 7u * 7);
+  ASSERT_EQ(vertex_ids.size(), sub_buffer->numVertices());
+  EXPECT_TRUE(std::is_sorted(vertex_ids.begin(), vertex_ids.end()));
+
+  const float* sub_vertices = sub_buffer->getVertices().get();
+  const float* vertices = buffer->getVertices().get();
+  for (size_t i = 0; i < vertex_ids.size(); i++)
+  {
+    EXPECT_EQ(sub_vertices[3 * i], vertices[3 * vertex_ids[i]]);
+    EXPECT_EQ(sub_vertices[3 * i + 1], vertices[3 * vertex_ids[i] + 1]);
+  }
+
+  const unsigned int* sub_faces = sub_buffer->getFaceIndices().get();
+  for (size_t i = 0; i < 3 * sub_buffer->numFaces(); i++)
+  {
+    EXPECT_LT(sub_faces[i], sub_buffer->numVertices());
+  }
+
+  EXPECT_THAT(tiling.tilesAround(5, 5, 0.1), ElementsAre(0u, 1u, 2u, 3u));
+}
+
+TEST(MeshTilingTest, serializationRoundTrip)
+{
+  auto buffer = gridBuffer(12);
+  const mesh_map::MeshTiling tiling(*buffer, 4, 0.25);
+
+  std::vector<unsigned char> data;
+  tiling.serialize(data);
+  const auto restored = mesh_map::MeshTiling::deserialize(data.data(), data.size());
+  ASSERT_TRUE(restored);
+  EXPECT_TRUE(restored->matches(*buffer, 4, 0.25));
+  EXPECT_FALSE(restored->matches(*buffer, 5, 0.25));
+  ASSERT_EQ(restored->numTiles(), tiling.numTiles());
+  for (uint32_t tile = 0; tile < tiling.numTiles(); tile++)
+  {
+    EXPECT_EQ(restored->numFacesOfTile(tile), tiling.numFacesOfTile(tile));
+  }
+
+  EXPECT_FALSE(mesh_map::MeshTiling::deserialize(data.data(), data.size() - 1));
+}
+
+TEST(MeshTilingTest, editedMeshDoesNotMatch)
+{
+  auto buffer = gridBuffer(8);
+  const mesh_map::MeshTiling tiling(*buffer, 4, 0.25);
+  EXPECT_TRUE(tiling.matches(*buffer, 4, 0.25));
+
+  // the same vertex and face counts, but a moved vertex
+  auto edited = gridBuffer(8);
+  edited->getVertices()[3 * 10 + 2] += 0.5;
+  EXPECT_FALSE(tiling.matches(*edited, 4, 0.25));
+
+  std::vector<unsigned char> data;
+  tiling.serialize(data);
+  const auto restored = mesh_map::MeshTiling::deserialize(data.data(), data.size());
+  ASSERT_TRUE(restored);
+  EXPECT_TRUE(restored->matches(*buffer, 4, 0.25));
+  EXPECT_FALSE(restored->matches(*edited, 4, 0.25));
+}
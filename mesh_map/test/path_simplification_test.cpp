@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cmath>
+#include <mesh_map/path_simplification.h>
+
+using namespace ::testing;
+
+namespace
+{
+typedef lvr2::BaseVector<float> Vec;
+
+mesh_map::PathPoint point(const float x, const float y, const float z = 0)
+{
+  return { Vec(x, y, z), lvr2::FaceHandle(static_cast<lvr2::Index>(std::floor(x) + 100 * std::floor(y))) };
+}
+
+float distanceToSegment(const Vec& p, const Vec& a, const Vec& b)
+{
+  const Vec ab = b - a;
+  const float t = std::min(std::max((p - a).dot(ab) / ab.dot(ab), 0.0f), 1.0f);
+  return p.distance(a + ab * t);
+}
+}  // namespace
+
+TEST(PathSimplificationTest, straightLineKeepsSegmentLength)
+{
+  mesh_map::MeshPath path;
+  for (int i = 0; i <= 100; i++)
+  {
+    path.push_back(point(0.1 * i, 0));
+  }
+  const auto selected = mesh_map::simplifyPath(path, 0.05, 0.35, 2.0);
+  ASSERT_GE(selected.size(), 6u);
+  EXPECT_LE(selected.size(), 7u);
+  EXPECT_EQ(selected.front(), 0u);
+  EXPECT_EQ(selected.back(), 100u);
+  for (size_t i = 1; i < selected.size(); i++)
+  {
+    EXPECT_LE(path[selected[i - 1]].first.distance(path[selected[i]].first), 2.0 + 1e-4);
+  }
+}
+
+TEST(PathSimplificationTest, keepsCorners)
+{
+  // along the x axis to (5, 0), then up to (5, 5) in 0.25 steps
+  mesh_map::MeshPath path;
+  for (int i = 0; i <= 20; i++)
+  {
+    path.push_back(point(0.25 * i, 0));
+  }
+  for (int i = 1; i <= 20; i++)
+  {
+    path.push_back(point(5, 0.25 * i));
+  }
+  const auto selected = mesh_map::simplifyPath(path, 0.05, 0.35, 100);
+  EXPECT_THAT(selected, ElementsAre(0u, 20u, 40u));
+  // the face handles of the selected points are those of the dense path
+  EXPECT_EQ(path[selected[1]].second, point(5, 0).second);
+}
+
+TEST(PathSimplificationTest, arcWithinDeviationAndAngle)
+{
+  mesh_map::MeshPath path;
+  const float radius = 3;
+  for (int i = 0; i <= 200; i++)
+  {
+    const float alpha = M_PI * i / 200;
+    path.push_back(point(radius * std::cos(alpha), radius * std::sin(alpha), 0.01 * i));
+  }
+  const float max_deviation = 0.02, max_angle = 0.3;
+  const auto selected = mesh_map::simplifyPath(path, max_deviation, max_angle, 100);
+  EXPECT_LT(selected.size(), path.size() / 4);
+  // the half circle turns by pi, thus at least pi / max_angle segments
+  EXPECT_GE(selected.size(), static_cast<size_t>(M_PI / max_angle));
+  for (size_t i = 1; i < selected.size(); i++)
+  {
+    for (size_t k = selected[i - 1] + 1; k < selected[i]; k++)
+    {
+      EXPECT_LE(distanceToSegment(path[k].first, path[selected[i - 1]].first, path[selected[i]].first),
+                max_deviation);
+    }
+  }
+}
+
+TEST(PathSimplificationTest, shortPaths)
+{
+  EXPECT_TRUE(mesh_map::simplifyPath({}, 0.05, 0.35, 2).empty());
+  EXPECT_THAT(mesh_map::simplifyPath({ point(0, 0) }, 0.05, 0.35, 2), ElementsAre(0u));
+  EXPECT_THAT(mesh_map::simplifyPath({ point(0, 0), point(1, 1) }, 0.05, 0.35, 2), ElementsAre(0u, 1u));
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mesh_map/persistence_queue.h>
+
+using namespace ::testing;
+
+struct PersistenceQueueTest : public Test
+{
+  //! blocks the I/O thread until release() is called, to enqueue writes while the queue is busy
+  void block(mesh_map::PersistenceQueue& queue)
+  {
+    std::promise<void> started;
+    auto started_future = started.get_future();
+    auto released = release_.get_future().share();
+    queue.enqueue("block", [&started, released]() {
+      started.set_value();
+      released.wait();
+      return true;
+    });
+    started_future.wait();
+  }
+
+  void release()
+  {
+    release_.set_value();
+  }
+
+  mesh_map::PersistenceQueue::Write record(const std::string& value)
+  {
+    return [this, value]() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      written_.push_back(value);
+      return true;
+    };
+  }
+
+  std::promise<void> release_;
+  std::mutex mutex_;
+  std::vector<std::string> written_;
+};
+
+TEST_F(PersistenceQueueTest, runsWritesInEnqueueOrder)
+{
+  mesh_map::PersistenceQueue queue;
+  queue.enqueue("a", record("a"));
+  queue.enqueue("b", record("b"));
+  queue.enqueue("c", record("c"));
+  queue.flush();
+
+  EXPECT_THAT(written_, ElementsAre("a", "b", "c"));
+  EXPECT_EQ(queue.pending(), 0u);
+}
+
+TEST_F(PersistenceQueueTest, coalescesPendingWritesWithTheSameKey)
+{
+  mesh_map::PersistenceQueue queue;
+  block(queue);
+
+  EXPECT_TRUE(queue.enqueue("a", record("a1")));
+  EXPECT_TRUE(queue.enqueue("b", record("b1")));
+  EXPECT_FALSE(queue.enqueue("a", record("a2")));
+  EXPECT_EQ(queue.pending(), 3u);
+
+  release();
+  queue.flush();
+
+  // the replaced write keeps the position of the first one
+  EXPECT_THAT(written_, ElementsAre("a2", "b1"));
+}
+
+TEST_F(PersistenceQueueTest, reportsTheResultOfEachWrite)
+{
+  std::mutex results_mutex;
+  std::vector<std::pair<std::string, bool>> results;
+  mesh_map::PersistenceQueue queue([&](const std::string& key, bool success) {
+    std::lock_guard<std::mutex> lock(results_mutex);
+    results.emplace_back(key, success);
+  });
+
+  queue.enqueue("ok", []() { return true; });
+  queue.enqueue("failed", []() { return false; });
+  queue.enqueue("throws", []() -> bool { throw std::runtime_error("write failed"); });
+  queue.flush();
+
+  EXPECT_THAT(results, ElementsAre(Pair("ok", true), Pair("failed", false), Pair("throws", false)));
+}
+
+TEST_F(PersistenceQueueTest, runsPendingWritesOnDestruction)
+{
+  {
+    mesh_map::PersistenceQueue queue;
+    block(queue);
+    queue.enqueue("a", record("a"));
+    release();
+  }
+  EXPECT_THAT(written_, ElementsAre("a"));
+}
+
+TEST_F(PersistenceQueueTest, fileLockWaitsForRunningWrite)
+{
+  mesh_map::PersistenceQueue queue;
+  block(queue);
+
+  auto locked = std::async(std::launch::async, [&queue]() { auto lock = queue.lockFile(); });
+  EXPECT_EQ(locked.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+  release();
+  locked.wait();
+  queue.flush();
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <limits>
+#include <mesh_map/stamped_vertex_map.h>
+
+using namespace ::testing;
+
+TEST(StampedVertexMapTest, readsDefaultForUnwrittenKeys)
+{
+  const float inf = std::numeric_limits<float>::infinity();
+  mesh_map::StampedVertexMap<float> map(inf);
+  map.reset(4);
+
+  const auto& const_map = map;
+  EXPECT_FALSE(const_map.containsKey(lvr2::VertexHandle(2)));
+  EXPECT_EQ(const_map[lvr2::VertexHandle(2)], inf);
+  EXPECT_EQ(const_map[lvr2::VertexHandle(100)], inf);
+  EXPECT_EQ(map.numValues(), 0u);
+}
+
+TEST(StampedVertexMapTest, resetForgetsPreviousGeneration)
+{
+  mesh_map::StampedVertexMap<float> map(-1);
+  map.reset(4);
+  map.insert(lvr2::VertexHandle(1), 1.0);
+  map[lvr2::VertexHandle(3)] = 3.0;
+  EXPECT_TRUE(map.containsKey(lvr2::VertexHandle(1)));
+  EXPECT_EQ(map[lvr2::VertexHandle(3)], 3.0);
+  EXPECT_EQ(map.numValues(), 2u);
+
+  map.reset(4);
+  EXPECT_FALSE(map.containsKey(lvr2::VertexHandle(1)));
+  EXPECT_FALSE(map.containsKey(lvr2::VertexHandle(3)));
+  EXPECT_EQ(map.numValues(), 0u);
+  // a key of the old generation starts with the default value again
+  EXPECT_EQ(map[lvr2::VertexHandle(1)], -1);
+}
+
+TEST(StampedVertexMapTest, iteratesWrittenKeysInInsertionOrder)
+{
+  mesh_map::StampedVertexMap<uint8_t> map(false);
+  map.reset(8);
+  map[lvr2::VertexHandle(5)] = true;
+  map[lvr2::VertexHandle(2)] = true;
+  map[lvr2::VertexHandle(5)] = false;
+
+  std::vector<lvr2::VertexHandle> keys(map.begin(), map.end());
+  EXPECT_THAT(keys, ElementsAre(lvr2::VertexHandle(5), lvr2::VertexHandle(2)));
+}
+
+TEST(StampedVertexMapTest, growsBeyondResetSize)
+{
+  mesh_map::StampedVertexMap<float> map(0);
+  map.reset(1);
+  map.insert(lvr2::VertexHandle(42), 4.2);
+  EXPECT_TRUE(map.containsKey(lvr2::VertexHandle(42)));
+  EXPECT_FLOAT_EQ(map[lvr2::VertexHandle(42)], 4.2);
+}
+
+TEST(StampedVertexMapTest, eraseRemovesKeyFromIteration)
+{
+  mesh_map::StampedVertexMap<float> map(0);
+  map.reset(8);
+  map.insert(lvr2::VertexHandle(1), 1.0);
+  map.insert(lvr2::VertexHandle(2), 2.0);
+  map.insert(lvr2::VertexHandle(3), 3.0);
+
+  EXPECT_TRUE(map.erase(lvr2::VertexHandle(1)));
+  EXPECT_FALSE(map.erase(lvr2::VertexHandle(1)));
+  EXPECT_FALSE(map.containsKey(lvr2::VertexHandle(1)));
+  EXPECT_EQ(map.numValues(), 2u);
+
+  std::vector<lvr2::VertexHandle> keys(map.begin(), map.end());
+  EXPECT_THAT(keys, UnorderedElementsAre(lvr2::VertexHandle(2), lvr2::VertexHandle(3)));
+
+  // a re-inserted key is iterated once again
+  map.insert(lvr2::VertexHandle(1), 1.5);
+  EXPECT_TRUE(map.erase(lvr2::VertexHandle(3)));
+  keys.assign(map.begin(), map.end());
+  EXPECT_THAT(keys, UnorderedElementsAre(lvr2::VertexHandle(1), lvr2::VertexHandle(2)));
+  EXPECT_FLOAT_EQ(map[lvr2::VertexHandle(1)], 1.5);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <random>
+#include <set>
+#include <vector>
+#include <mesh_map/vertex_bitset.h>
+
+using namespace ::testing;
+
+TEST(VertexBitsetTest, insertsAndErasesVertices)
+{
+  mesh_map::VertexBitset set(100);
+  EXPECT_TRUE(set.empty());
+
+  EXPECT_TRUE(set.insert(lvr2::VertexHandle(3)));
+  EXPECT_FALSE(set.insert(lvr2::VertexHandle(3)));
+  EXPECT_TRUE(set.insert(lvr2::VertexHandle(64)));
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_TRUE(set.contains(lvr2::VertexHandle(3)));
+  EXPECT_TRUE(set.contains(lvr2::VertexHandle(64)));
+  EXPECT_FALSE(set.contains(lvr2::VertexHandle(63)));
+
+  EXPECT_TRUE(set.erase(lvr2::VertexHandle(3)));
+  EXPECT_FALSE(set.erase(lvr2::VertexHandle(3)));
+  EXPECT_FALSE(set.erase(lvr2::VertexHandle(1000)));
+  EXPECT_EQ(set.size(), 1u);
+  EXPECT_FALSE(set.contains(lvr2::VertexHandle(3)));
+}
+
+TEST(VertexBitsetTest, growsBeyondInitialSlots)
+{
+  mesh_map::VertexBitset set;
+  EXPECT_FALSE(set.contains(lvr2::VertexHandle(500)));
+  EXPECT_TRUE(set.insert(lvr2::VertexHandle(500)));
+  EXPECT_TRUE(set.contains(lvr2::VertexHandle(500)));
+  EXPECT_GE(set.numSlots(), 501u);
+}
+
+TEST(VertexBitsetTest, iteratesInAscendingOrder)
+{
+  mesh_map::VertexBitset set(300);
+  set.insert(lvr2::VertexHandle(257));
+  set.insert(lvr2::VertexHandle(0));
+  set.insert(lvr2::VertexHandle(63));
+  set.insert(lvr2::VertexHandle(64));
+
+  std::vector<lvr2::VertexHandle> vertices(set.begin(), set.end());
+  EXPECT_THAT(vertices, ElementsAre(lvr2::VertexHandle(0), lvr2::VertexHandle(63), lvr2::VertexHandle(64),
+                                    lvr2::VertexHandle(257)));
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST(VertexBitsetTest, updateReportsDifference)
+{
+  mesh_map::VertexBitset set(200);
+  set.insert(lvr2::VertexHandle(1));
+  set.insert(lvr2::VertexHandle(70));
+  set.insert(lvr2::VertexHandle(150));
+
+  const std::set<lvr2::VertexHandle> next = { lvr2::VertexHandle(1), lvr2::VertexHandle(71), lvr2::VertexHandle(300) };
+  std::vector<lvr2::VertexHandle> added, removed;
+  set.update(next, added, removed);
+
+  EXPECT_THAT(added, ElementsAre(lvr2::VertexHandle(71), lvr2::VertexHandle(300)));
+  EXPECT_THAT(removed, ElementsAre(lvr2::VertexHandle(70), lvr2::VertexHandle(150)));
+  EXPECT_EQ(set.size(), 3u);
+  std::vector<lvr2::VertexHandle> vertices(set.begin(), set.end());
+  EXPECT_THAT(vertices, ElementsAreArray(next.begin(), next.end()));
+
+  set.update(next, added, removed);
+  EXPECT_TRUE(added.empty());
+  EXPECT_TRUE(removed.empty());
+}
+
+TEST(VertexBitsetTest, matchesStdSet)
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> index(0, 999);
+  std::bernoulli_distribution coin(0.5);
+
+  mesh_map::VertexBitset set(1000);
+  std::set<lvr2::VertexHandle> expected;
+  for (size_t i = 0; i < 5000; i++)
+  {
+    const lvr2::VertexHandle vH(index(gen));
+    if (coin(gen))
+    {
+      EXPECT_EQ(set.insert(vH), expected.insert(vH).second);
+    }
+    else
+    {
+      EXPECT_EQ(set.erase(vH), expected.erase(vH) == 1);
+    }
+  }
+
+  EXPECT_EQ(set.size(), expected.size());
+  std::vector<lvr2::VertexHandle> vertices(set.begin(), set.end());
+  EXPECT_THAT(vertices, ElementsAreArray(expected.begin(), expected.end()));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <map>
+#include <random>
+#include <mesh_map/vertex_queue.h>
+
+using namespace ::testing;
+
+struct VertexQueueTest : public TestWithParam<std::string>
+{
+};
+
+TEST_P(VertexQueueTest, popsInKeyOrder)
+{
+  const auto queue = mesh_map::createVertexQueue(GetParam(), 8);
+  ASSERT_TRUE(queue);
+  EXPECT_TRUE(queue->isEmpty());
+
+  queue->insert(lvr2::VertexHandle(3), 0.3);
+  queue->insert(lvr2::VertexHandle(1), 0.1);
+  queue->insert(lvr2::VertexHandle(2), 0.2);
+  queue->insert(lvr2::VertexHandle(0), 0.0);
+
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(0));
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(1));
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(2));
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(3));
+  EXPECT_TRUE(queue->isEmpty());
+}
+
+TEST_P(VertexQueueTest, updatesKeyOfQueuedVertex)
+{
+  const auto queue = mesh_map::createVertexQueue(GetParam(), 4);
+  ASSERT_TRUE(queue);
+
+  queue->insert(lvr2::VertexHandle(0), 1.0);
+  queue->insert(lvr2::VertexHandle(1), 2.0);
+  queue->insert(lvr2::VertexHandle(1), 0.5);
+
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(1));
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(0));
+  EXPECT_TRUE(queue->isEmpty());
+  EXPECT_EQ(queue->statistics().inserts, 3u);
+  EXPECT_EQ(queue->statistics().pops, 2u);
+}
+
+TEST_P(VertexQueueTest, growsBeyondInitialSize)
+{
+  const auto queue = mesh_map::createVertexQueue(GetParam(), 1);
+  ASSERT_TRUE(queue);
+
+  queue->insert(lvr2::VertexHandle(42), 1.0);
+  queue->insert(lvr2::VertexHandle(7), 0.5);
+
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(7));
+  EXPECT_EQ(queue->popMin(), lvr2::VertexHandle(42));
+  EXPECT_TRUE(queue->isEmpty());
+}
+
+TEST_P(VertexQueueTest, matchesReferenceOnMonotonePropagation)
+{
+  const auto queue = mesh_map::createVertexQueue(GetParam(), 64);
+  ASSERT_TRUE(queue);
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> step(0, 1);
+
+  // simulates a wave front: new keys are never smaller than the last popped key
+  std::map<lvr2::Index, float> queued;
+  float last_key = 0;
+  for (size_t i = 0; i < 5000 || !queued.empty(); i++)
+  {
+    if (i < 5000 && (rng() % 3 != 0 || queued.empty()))
+    {
+      const lvr2::Index idx = rng() % 64;
+      const float key = last_key + step(rng);
+      queue->insert(lvr2::VertexHandle(idx), key);
+      queued[idx] = key;
+    }
+    else
+    {
+      ASSERT_FALSE(queue->isEmpty());
+      const lvr2::VertexHandle vH = queue->popMin();
+      ASSERT_EQ(queued.count(vH.idx()), 1u);
+      const float key = queued[vH.idx()];
+      for (const auto& entry : queued)
+      {
+        ASSERT_LE(key, entry.second);
+      }
+      last_key = key;
+      queued.erase(vH.idx());
+    }
+    ASSERT_EQ(queue->isEmpty(), queued.empty());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(QueueTypes, VertexQueueTest, Values("meap", "quaternary_heap", "radix_heap"));
+
+TEST(VertexQueueFactoryTest, rejectsUnknownType)
+{
+  EXPECT_FALSE(mesh_map::isValidVertexQueueType("fibonacci_heap"));
+  EXPECT_FALSE(mesh_map::createVertexQueue("fibonacci_heap", 8));
+}